@@ -4,13 +4,18 @@ Bayesian Regime-Switching Model
 A Bayesian approach to detecting market regime changes using Hidden Markov Models.
 """
 
-from .model import BayesianRegimeSwitchingModel
+from .model import BayesianRegimeSwitchingModel, fit_models
 from .inference import BayesianInference
 from .data_loader import MarketDataLoader
+from .online import PyRegimeFilter, RegimeStrategy, make_regime_filter
 
 __version__ = "0.1.0"
 __all__ = [
     "BayesianRegimeSwitchingModel",
+    "fit_models",
     "BayesianInference",
     "MarketDataLoader",
+    "PyRegimeFilter",
+    "RegimeStrategy",
+    "make_regime_filter",
 ]
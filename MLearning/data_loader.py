@@ -3,12 +3,27 @@ Data Loading and Preprocessing Module
 
 This module handles loading market data, computing returns,
 and preparing features for regime-switching analysis.
+
+feature_matrix() computes the prepare_features columns in one pass into a
+float32 matrix (natively when native/feature_matrix is built), and
+create_sequences() windows it as a strided view instead of a copy.
 """
 
 import numpy as np
 import pandas as pd
 from typing import Tuple, Optional, List, Dict
 from datetime import datetime
+import sys
+import os
+
+# native/ lives at the repository root
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+try:
+    from native import feature_matrix as _native_features
+except ImportError:  # extension not built, use the NumPy pipeline
+    _native_features = None
+
+FEATURE_NAMES = ('returns', 'volatility', 'momentum')
 
 
 class MarketDataLoader:
@@ -237,6 +252,85 @@ class MarketDataLoader:
 
         return features
 
+    def feature_matrix(self, price_data: pd.DataFrame, feature_config: Optional[Dict] = None,
+                       normalize: Optional[str] = None) -> Tuple[np.ndarray, pd.Index]:
+        """
+        prepare_features as one float32 matrix, for sequence models.
+
+        The returns, volatility and momentum columns (FEATURE_NAMES) are
+        computed together and only complete rows are written, so nothing
+        else is allocated per feature. With normalize ("standardize" or
+        "minmax") the matrix is scaled in place and the parameters are stored
+        as normalize_data does.
+
+        Args:
+            price_data: DataFrame with a close column
+            feature_config: Same keys as prepare_features
+            normalize: None, "standardize" or "minmax"
+
+        Returns:
+            Tuple of (matrix float32 [n_rows, 3], index of the kept rows)
+        """
+        if feature_config is None:
+            feature_config = {}
+        method = feature_config.get('returns_method', 'log')
+        vol_window = feature_config.get('volatility_window', 20)
+        mom_window = feature_config.get('momentum_window', 10)
+        close = price_data['close'].to_numpy(dtype=np.float64)
+
+        if _native_features is not None:
+            matrix, rows = _native_features.feature_rows(close, method, vol_window, mom_window)
+        else:
+            matrix, rows = self._feature_rows_python(close, method, vol_window, mom_window)
+
+        if normalize is not None:
+            if _native_features is not None:
+                center, scale = _native_features.normalize_columns(matrix, normalize)
+            else:
+                center, scale = self._normalize_columns_python(matrix, normalize)
+            keys = ('mean', 'std') if normalize == "standardize" else ('min', 'max')
+            self.normalization_params = {
+                'method': normalize,
+                'columns': {name: {keys[0]: center[j], keys[1]: scale[j]} for j, name in enumerate(FEATURE_NAMES)},
+            }
+
+        return matrix, price_data.index[rows]
+
+    def _feature_rows_python(self, close: np.ndarray, method: str, vol_window: int,
+                             mom_window: int) -> Tuple[np.ndarray, np.ndarray]:
+        """NumPy version of native.feature_matrix.feature_rows (same rows and values)"""
+        if method not in ("log", "simple"):
+            raise ValueError(f"Unknown method: {method}. Use 'log' or 'simple'.")
+        if vol_window < 1:
+            raise ValueError("volatility_window must be at least 1")
+        prices = pd.Series(close)
+        matrix = np.empty((len(close), len(FEATURE_NAMES)), dtype=np.float32)
+        returns = self.compute_returns(prices, method=method)
+        matrix[:, 0] = returns
+        matrix[:, 1] = self.compute_volatility(returns, window=vol_window)
+        matrix[:, 2] = self.compute_momentum(prices, window=mom_window)
+        rows = np.flatnonzero(~np.isnan(matrix).any(axis=1))
+        # Compact the complete rows to the front, as the native pass writes them
+        matrix[:len(rows)] = matrix[rows]
+        return matrix[:len(rows)], rows
+
+    def _normalize_columns_python(self, matrix: np.ndarray, method: str) -> Tuple[np.ndarray, np.ndarray]:
+        """NumPy version of native.feature_matrix.normalize_columns (in place)"""
+        values = matrix.astype(np.float64)
+        if method == "standardize":
+            center = values.mean(axis=0)
+            scale = values.std(axis=0, ddof=1) if len(values) > 1 else np.full(values.shape[1], np.nan)
+            scale = np.where((scale == 0) | np.isnan(scale), 1.0, scale)
+            matrix[:] = (values - center) / scale
+        elif method == "minmax":
+            center = values.min(axis=0) if len(values) else np.full(values.shape[1], np.nan)
+            scale = values.max(axis=0) if len(values) else np.full(values.shape[1], np.nan)
+            span = scale - center
+            matrix[:] = np.where(span == 0, 0.0, (values - center) / np.where(span == 0, 1.0, span))
+        else:
+            raise ValueError(f"Unknown normalization method: {method}. Use 'standardize' or 'minmax'.")
+        return center, scale
+
     def split_train_test(self, data: pd.DataFrame, train_ratio: float = 0.8) -> Tuple[pd.DataFrame, pd.DataFrame]:
         """
         Split data into training and testing sets.
@@ -268,27 +362,43 @@ class MarketDataLoader:
 
         return train_data, test_data
 
-    def create_sequences(self, data: np.ndarray, sequence_length: int) -> Tuple[np.ndarray, np.ndarray]:
+    def create_sequences(self, data: np.ndarray, sequence_length: int,
+                         target_column: int = 0) -> Tuple[np.ndarray, np.ndarray]:
         """
         Create sequences for sequence-based models.
 
+        Both outputs are read-only views of data: sequence i is rows
+        [i, i + sequence_length) through strides, so memory does not grow
+        with sequence_length. Copy a batch (np.array(X[a:b])) before
+        modifying it or handing it to code that needs contiguous input.
+
         Args:
-            data: 1D or 2D array of data
+            data: 1D or 2D array of data, e.g. from feature_matrix
             sequence_length: Length of each sequence
+            target_column: Column of 2D data used as the target
 
         Returns:
             Tuple of (sequences, targets)
             - sequences: [n_sequences, sequence_length, n_features]
             - targets: [n_sequences] (next value after each sequence)
-
-        TODO:
-        - Create sliding window sequences
-        - Handle 1D and 2D input data
-        - Set target as the value immediately after each sequence
-        - Ensure proper shapes for model input
-        - Return (X, y) arrays
         """
-        pass
+        if sequence_length < 1:
+            raise ValueError("sequence_length must be at least 1")
+        data = np.asarray(data)
+        if data.ndim == 1:
+            data = data[:, np.newaxis]
+        elif data.ndim != 2:
+            raise ValueError(f"Expected 1D or 2D data, got {data.ndim}D")
+
+        n_sequences = max(len(data) - sequence_length, 0)
+        row_stride, column_stride = data.strides
+        sequences = np.lib.stride_tricks.as_strided(
+            data, shape=(n_sequences, sequence_length, data.shape[1]),
+            strides=(row_stride, row_stride, column_stride), writeable=False)
+        targets = data[sequence_length:, target_column]
+        targets.flags.writeable = False
+
+        return sequences, targets
 
     def normalize_data(self, data: pd.DataFrame, method: str = "standardize") -> Tuple[pd.DataFrame, Dict]:
         """
@@ -3,6 +3,11 @@ Bayesian Regime-Switching Model
 
 This module implements a Bayesian approach to detecting market regime changes
 (bull vs bear states) using hidden Markov models and Bayesian inference.
+
+The forward-backward, Baum-Welch and Viterbi recursions run in native/hmm
+(scaled, with emissions evaluated for all states at once) when the
+extension is built, and as NumPy recursions vectorized over states
+otherwise. fit_models() fits many series or random restarts in parallel.
 """
 
 import numpy as np
@@ -14,6 +19,15 @@ import os
 sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
 from utils import log_sum_exp, normalize_log_probs
 
+# native/ lives at the repository root
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+try:
+    from native import hmm as _native_hmm
+except ImportError:  # extension not built, use the NumPy recursions
+    _native_hmm = None
+
+MIN_EMISSION_PROB = 1e-300
+
 
 class BayesianRegimeSwitchingModel:
     """
@@ -134,6 +148,38 @@ class BayesianRegimeSwitchingModel:
 
         return prob
 
+    def get_params(self) -> Tuple[np.ndarray, np.ndarray, np.ndarray, np.ndarray]:
+        """(means, stds, transition_matrix, initial_state_probs) as float64 arrays"""
+        means = np.array([p['mean'] for p in self.emission_params], dtype=np.float64)
+        stds = np.array([p['std'] for p in self.emission_params], dtype=np.float64)
+        return (means, stds, np.asarray(self.transition_matrix, dtype=np.float64),
+                np.asarray(self.initial_state_probs, dtype=np.float64))
+
+    def set_params(self, means, stds, transition_matrix, initial_state_probs) -> None:
+        """Inverse of get_params"""
+        self.emission_params = [{'mean': float(m), 'std': float(s)} for m, s in zip(means, stds)]
+        self.transition_matrix = np.array(transition_matrix, dtype=np.float64)
+        self.initial_state_probs = np.array(initial_state_probs, dtype=np.float64)
+
+    def log_emissions(self, observations: np.ndarray) -> np.ndarray:
+        """
+        Log emission probabilities of every observation under every state.
+
+        Args:
+            observations: Sequence of observations
+
+        Returns:
+            [T, n_states] array of log P(observations[t] | state=i), with the
+            same 1e-300 floor as compute_emission_probability
+        """
+        means, stds, _, _ = self.get_params()
+        observations = np.asarray(observations, dtype=np.float64)
+        if _native_hmm is not None:
+            return _native_hmm.log_emissions(observations, means, stds)
+        z = (observations[:, None] - means[None, :]) / stds[None, :]
+        log_pdf = -0.5 * z * z - np.log(stds)[None, :] - 0.5 * np.log(2 * np.pi)
+        return np.maximum(log_pdf, np.log(MIN_EMISSION_PROB))
+
     def forward_algorithm(self, observations: np.ndarray) -> Tuple[np.ndarray, float]:
         """
         Run forward algorithm to compute filtering probabilities.
@@ -151,27 +197,21 @@ class BayesianRegimeSwitchingModel:
         - Use log-space computation to prevent numerical underflow
         - Return normalized alpha matrix and total log-likelihood
         """
+        if _native_hmm is not None:
+            return _native_hmm.forward(observations, *self.get_params())
+
         T = len(observations)
         log_alpha = np.zeros((T, self.n_states))
+        log_b = self.log_emissions(observations)
+        log_a = np.log(self.transition_matrix)
 
         # Initialize at t=0: alpha[0, i] = P(state[0]=i) * P(obs[0] | state[0]=i)
-        for i in range(self.n_states):
-            emission_prob = self.compute_emission_probability(observations[0], i)
-            log_alpha[0, i] = np.log(self.initial_state_probs[i]) + np.log(emission_prob)
+        log_alpha[0] = np.log(self.initial_state_probs) + log_b[0]
 
-        # Forward recursion for t=1..T-1
+        # Forward recursion for t=1..T-1:
+        # Alpha[t, j] = P(obs[t] | state[t]=j) * sum_i(alpha[t-1, i] * transition[i, j])
         for t in range(1, T):
-            for j in range(self.n_states):
-                # Compute sum over all previous states
-                log_probs = np.zeros(self.n_states)
-                for i in range(self.n_states):
-                    log_probs[i] = log_alpha[t-1, i] + np.log(self.transition_matrix[i, j])
-
-                # Emission probability
-                emission_prob = self.compute_emission_probability(observations[t], j)
-
-                # Alpha[t, j] = P(obs[t] | state[t]=j) * sum_i(alpha[t-1, i] * transition[i, j])
-                log_alpha[t, j] = log_sum_exp(log_probs) + np.log(emission_prob)
+            log_alpha[t] = log_sum_exp(log_alpha[t-1][:, None] + log_a, axis=0) + log_b[t]
 
         # Compute total log-likelihood
         log_likelihood = log_sum_exp(log_alpha[-1, :])
@@ -194,25 +234,21 @@ class BayesianRegimeSwitchingModel:
         - Use log-space computation to prevent numerical underflow
         - Return normalized beta matrix
         """
+        if _native_hmm is not None:
+            return _native_hmm.backward(observations, *self.get_params())
+
         T = len(observations)
         log_beta = np.zeros((T, self.n_states))
+        log_b = self.log_emissions(observations)
+        log_a = np.log(self.transition_matrix)
 
         # Initialize at t=T-1: beta[T-1, i] = 1 (log = 0)
         log_beta[T-1, :] = 0.0
 
-        # Backward recursion for t=T-2..0
+        # Backward recursion for t=T-2..0:
+        # Beta[t, i] = sum_j(transition[i, j] * P(obs[t+1] | state[t+1]=j) * beta[t+1, j])
         for t in range(T-2, -1, -1):
-            for i in range(self.n_states):
-                # Compute sum over all next states
-                log_probs = np.zeros(self.n_states)
-                for j in range(self.n_states):
-                    emission_prob = self.compute_emission_probability(observations[t+1], j)
-                    log_probs[j] = (np.log(self.transition_matrix[i, j]) +
-                                   np.log(emission_prob) +
-                                   log_beta[t+1, j])
-
-                # Beta[t, i] = sum_j(transition[i, j] * P(obs[t+1] | state[t+1]=j) * beta[t+1, j])
-                log_beta[t, i] = log_sum_exp(log_probs)
+            log_beta[t] = log_sum_exp(log_a + (log_b[t+1] + log_beta[t+1])[None, :], axis=1)
 
         return log_beta
 
@@ -232,6 +268,10 @@ class BayesianRegimeSwitchingModel:
         - Normalize probabilities to sum to 1 at each time step
         - Return smoothed state probability matrix
         """
+        if _native_hmm is not None:
+            gamma, _ = _native_hmm.posteriors(observations, *self.get_params())
+            return gamma
+
         # Run forward and backward algorithms
         log_alpha, _ = self.forward_algorithm(observations)
         log_beta = self.backward_algorithm(observations)
@@ -241,14 +281,8 @@ class BayesianRegimeSwitchingModel:
         log_gamma = log_alpha + log_beta
 
         # Normalize at each time step
-        T = len(observations)
-        gamma = np.zeros((T, self.n_states))
-
-        for t in range(T):
-            log_normalizer = log_sum_exp(log_gamma[t, :])
-            gamma[t, :] = np.exp(log_gamma[t, :] - log_normalizer)
-
-        return gamma
+        log_normalizer = log_sum_exp(log_gamma, axis=1)
+        return np.exp(log_gamma - log_normalizer[:, None])
 
     def compute_transition_probabilities(self, observations: np.ndarray) -> np.ndarray:
         """
@@ -266,32 +300,25 @@ class BayesianRegimeSwitchingModel:
         - Normalize at each time step
         - Return pairwise transition probability tensor
         """
+        if _native_hmm is not None:
+            _, _, xi = _native_hmm.posteriors(observations, *self.get_params(), transitions=True)
+            return xi
+
         T = len(observations)
 
         # Run forward and backward algorithms
         log_alpha, _ = self.forward_algorithm(observations)
         log_beta = self.backward_algorithm(observations)
+        log_b = self.log_emissions(observations)
+        log_a = np.log(self.transition_matrix)
 
-        # Initialize xi tensor
-        xi = np.zeros((T-1, self.n_states, self.n_states))
+        # log_xi[t, i, j] = log_alpha[t, i] + log A[i, j] + log b[t+1, j] + log_beta[t+1, j]
+        log_xi = (log_alpha[:-1, :, None] + log_a[None, :, :] +
+                  (log_b[1:] + log_beta[1:])[:, None, :])
 
-        # Compute xi for each time step
-        for t in range(T-1):
-            log_xi = np.zeros((self.n_states, self.n_states))
-
-            for i in range(self.n_states):
-                for j in range(self.n_states):
-                    emission_prob = self.compute_emission_probability(observations[t+1], j)
-                    log_xi[i, j] = (log_alpha[t, i] +
-                                   np.log(self.transition_matrix[i, j]) +
-                                   np.log(emission_prob) +
-                                   log_beta[t+1, j])
-
-            # Normalize
-            log_normalizer = log_sum_exp(log_xi.flatten())
-            xi[t, :, :] = np.exp(log_xi - log_normalizer)
-
-        return xi
+        # Normalize each time step
+        log_normalizer = log_sum_exp(log_xi.reshape(T - 1, self.n_states * self.n_states), axis=1)
+        return np.exp(log_xi - log_normalizer[:, None, None])
 
     def baum_welch_step(self, observations: np.ndarray) -> float:
         """
@@ -310,6 +337,11 @@ class BayesianRegimeSwitchingModel:
         - Incorporate Bayesian priors in M-step (MAP estimation)
         - Return current log-likelihood for convergence check
         """
+        if _native_hmm is not None:
+            log_likelihood, params = _native_hmm.baum_welch_step(observations, *self.get_params())
+            self.set_params(*params)
+            return log_likelihood
+
         T = len(observations)
 
         # E-step: Compute gamma and xi
@@ -381,6 +413,11 @@ class BayesianRegimeSwitchingModel:
         if not self.is_fitted:
             self.initialize_parameters(observations)
 
+        self._run_em(observations, max_iterations, tolerance, verbose=True)
+
+    def _run_em(self, observations: np.ndarray, max_iterations: int, tolerance: float,
+                verbose: bool = False) -> None:
+        """Baum-Welch iterations from the current parameters (the loop of fit)"""
         # Track log-likelihoods
         log_likelihoods = []
         prev_log_likelihood = -np.inf
@@ -395,12 +432,13 @@ class BayesianRegimeSwitchingModel:
             improvement = log_likelihood - prev_log_likelihood
 
             if iteration > 0 and abs(improvement) < tolerance:
-                print(f"Converged after {iteration + 1} iterations")
+                if verbose:
+                    print(f"Converged after {iteration + 1} iterations")
                 break
 
             prev_log_likelihood = log_likelihood
 
-            if iteration % 10 == 0:
+            if verbose and iteration % 10 == 0:
                 print(f"Iteration {iteration}: Log-likelihood = {log_likelihood:.4f}")
 
         # Mark as fitted
@@ -417,6 +455,9 @@ class BayesianRegimeSwitchingModel:
         Returns:
             Current state probability distribution
 
+        For one new observation at a time, online_filter() gives the same
+        result without re-running the whole window.
+
         TODO:
         - Run forward algorithm on observation sequence
         - Extract final state probabilities
@@ -480,32 +521,26 @@ class BayesianRegimeSwitchingModel:
         - Backtrack to find most likely state sequence
         - Return state sequence and its log probability
         """
+        if _native_hmm is not None:
+            states, log_prob = _native_hmm.viterbi(observations, *self.get_params())
+            return states.tolist(), log_prob
+
         T = len(observations)
 
         # Initialize Viterbi probability matrix and backpointers
         log_delta = np.zeros((T, self.n_states))
         psi = np.zeros((T, self.n_states), dtype=int)
+        log_b = self.log_emissions(observations)
+        log_a = np.log(self.transition_matrix)
 
         # Initialize at t=0
-        for i in range(self.n_states):
-            emission_prob = self.compute_emission_probability(observations[0], i)
-            log_delta[0, i] = np.log(self.initial_state_probs[i]) + np.log(emission_prob)
+        log_delta[0] = np.log(self.initial_state_probs) + log_b[0]
 
-        # Recursively compute max probabilities
+        # Recursively compute max probabilities over previous states
         for t in range(1, T):
-            for j in range(self.n_states):
-                # Find max over previous states
-                log_probs = np.zeros(self.n_states)
-                for i in range(self.n_states):
-                    log_probs[i] = log_delta[t-1, i] + np.log(self.transition_matrix[i, j])
-
-                # Store max and argmax
-                psi[t, j] = np.argmax(log_probs)
-                max_log_prob = np.max(log_probs)
-
-                # Add emission probability
-                emission_prob = self.compute_emission_probability(observations[t], j)
-                log_delta[t, j] = max_log_prob + np.log(emission_prob)
+            log_probs = log_delta[t-1][:, None] + log_a
+            psi[t] = np.argmax(log_probs, axis=0)
+            log_delta[t] = np.max(log_probs, axis=0) + log_b[t]
 
         # Backtrack to find most likely sequence
         states = np.zeros(T, dtype=int)
@@ -630,15 +665,82 @@ class BayesianRegimeSwitchingModel:
         # Predict current state probabilities
         probs = self.predict_state_probabilities(observations)
 
-        # Map state indices to regime names
+        # Create human-readable dictionary
+        regime_probs = {name: prob for name, prob in zip(self.regime_names(), probs)}
+
+        return regime_probs
+
+    def regime_names(self) -> List[str]:
+        """Labels of the states, in state order"""
         if self.n_states == 2:
             # Binary: bear (low returns) and bull (high returns)
-            regime_names = ['Bear', 'Bull']
-        else:
-            # Multi-state: use generic names
-            regime_names = [f'Regime_{i}' for i in range(self.n_states)]
+            return ['Bear', 'Bull']
+        # Multi-state: use generic names
+        return [f'Regime_{i}' for i in range(self.n_states)]
 
-        # Create human-readable dictionary
-        regime_probs = {name: prob for name, prob in zip(regime_names, probs)}
+    def online_filter(self, lag: int = 0):
+        """
+        Incremental filter over the fitted parameters, for streamed observations.
 
-        return regime_probs
+        update(x) returns the same probabilities as predict_state_probabilities
+        on all observations so far, in O(n_states^2) per observation; see
+        MLearning.online.
+        """
+        from .online import make_regime_filter
+        return make_regime_filter(self, lag)
+
+
+def fit_models(series: List[np.ndarray], n_states: int = 2, n_restarts: int = 1,
+               max_iterations: int = 100, tolerance: float = 1e-4, n_threads: int = 0,
+               seed: int = 42) -> List[BayesianRegimeSwitchingModel]:
+    """
+    Fit one model per series, keeping the best of n_restarts EM runs each.
+
+    Restart 0 starts from initialize_parameters (k-means); the others from
+    means drawn from the series' own observations with its overall std.
+    With native/hmm built, every (series, restart) job runs in parallel
+    across n_threads workers (0 = all cores).
+
+    Args:
+        series: Observation arrays, e.g. the returns of several symbols
+        n_states: Hidden states per model
+        n_restarts: EM runs per series; the highest final log-likelihood wins
+        max_iterations: Maximum EM iterations per run
+        tolerance: Convergence threshold for log-likelihood change
+        n_threads: Worker threads for the native batch fit
+        seed: Seed of the restart initializations
+
+    Returns:
+        One fitted BayesianRegimeSwitchingModel per series
+    """
+    rng = np.random.default_rng(seed)
+    arrays = [np.asarray(s, dtype=np.float64) for s in series]
+    jobs = []  # (series index, initial model)
+    for k, observations in enumerate(arrays):
+        for restart in range(n_restarts):
+            model = BayesianRegimeSwitchingModel(n_states)
+            if restart == 0:
+                model.initialize_parameters(observations)
+            else:
+                means = np.sort(rng.choice(observations, size=n_states, replace=len(observations) < n_states))
+                std = max(float(np.std(observations)), 1e-6)
+                model.emission_params = [{'mean': float(m), 'std': std} for m in means]
+            jobs.append((k, model))
+
+    if _native_hmm is not None:
+        results = _native_hmm.fit_batch([arrays[k] for k, _ in jobs], [m.get_params() for _, m in jobs],
+                                        max_iterations, tolerance, n_threads)
+        for (_, model), result in zip(jobs, results):
+            model.set_params(result['means'], result['stds'], result['transition'], result['initial'])
+            model.is_fitted = True
+            model.log_likelihoods_ = result['log_likelihoods'].tolist()
+    else:
+        for k, model in jobs:
+            model._run_em(arrays[k], max_iterations, tolerance)
+
+    best = [None] * len(arrays)
+    for k, model in jobs:
+        final = model.log_likelihoods_[-1] if model.log_likelihoods_ else -np.inf
+        if best[k] is None or final > best[k][0]:
+            best[k] = (final, model)
+    return [model for _, model in best]
@@ -0,0 +1,233 @@
+"""
+Online regime inference for streamed bars
+
+predict_state_probabilities re-runs the forward algorithm over the whole
+observation window for every estimate. A regime filter instead keeps the
+normalized forward vector and folds in one observation per update, in
+O(n_states^2); with lag > 0 it also keeps the last lag forward vectors and
+emissions and returns the fixed-lag smoothed probabilities of the bar lag
+steps back, in O(lag * n_states^2).
+
+RegimeStrategy plugs a filter into the on_bar pipeline of LiveTradingEngine,
+MultiSymbolEngine and LiveTradingChart: it wraps any streaming strategy and
+adds the regime probabilities of each bar's log return to its row.
+"""
+
+import numpy as np
+from typing import Dict, Any, List, Optional
+import sys
+import os
+
+# native/ lives at the repository root
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+try:
+    from native.hmm import RegimeFilter
+except ImportError:  # extension not built, use the NumPy filter
+    RegimeFilter = None
+
+from .model import BayesianRegimeSwitchingModel, MIN_EMISSION_PROB
+
+_MIN_LOG_PDF = np.log(MIN_EMISSION_PROB)
+
+
+class PyRegimeFilter:
+    """NumPy version of native.hmm.RegimeFilter (same updates and properties)"""
+
+    def __init__(self, means, stds, transition, initial, lag: int = 0):
+        self.means = np.asarray(means, dtype=np.float64).ravel()
+        self.stds = np.asarray(stds, dtype=np.float64).ravel()
+        k = len(self.means)
+        self.transition = np.asarray(transition, dtype=np.float64).reshape(k, k)
+        self.initial = np.asarray(initial, dtype=np.float64).ravel()
+        if k == 0 or len(self.stds) != k or len(self.initial) != k:
+            raise ValueError("means, stds and initial need n_states values and transition n_states x n_states")
+        if np.any(self.stds <= 0):
+            raise ValueError("stds must be positive")
+        self.lag = int(lag)
+        self._offset = -np.log(self.stds) - 0.5 * np.log(2 * np.pi)
+        self.reset()
+
+    @property
+    def n_states(self) -> int:
+        return len(self.means)
+
+    def reset(self):
+        self.count = 0
+        self.log_likelihood = 0.0
+        self._alpha = np.zeros(self.n_states)
+        self._smoothed = np.zeros(self.n_states)
+        self._history_alpha = np.zeros((self.lag + 1, self.n_states))
+        self._history_b = np.zeros((self.lag + 1, self.n_states))
+
+    def update(self, x: float) -> np.ndarray:
+        """Add one observation; returns the filtered probabilities"""
+        z = (x - self.means) / self.stds
+        log_b = np.maximum(self._offset - 0.5 * z * z, _MIN_LOG_PDF)
+        shift = log_b.max()
+        b = np.exp(log_b - shift)
+
+        prior = self.initial if self.count == 0 else self.predict()
+        alpha = prior * b
+        c = alpha.sum()
+        self._alpha = alpha / c if c > 0 else alpha
+        self.log_likelihood += np.log(c) + shift
+
+        if self.lag > 0:
+            slot = self.count % (self.lag + 1)
+            self._history_alpha[slot] = self._alpha
+            self._history_b[slot] = b
+        self.count += 1
+        if self.lag == 0:
+            self._smoothed = self._alpha.copy()
+        elif self.count > self.lag:
+            self._smooth()
+        return self.probabilities
+
+    def update_many(self, observations) -> np.ndarray:
+        """update() for each observation; returns the filtered probabilities as [T, n_states]"""
+        observations = np.asarray(observations, dtype=np.float64).ravel()
+        out = np.empty((len(observations), self.n_states))
+        for t, x in enumerate(observations):
+            out[t] = self.update(x)
+        return out
+
+    def predict(self) -> np.ndarray:
+        """P(state t+1 | x[0..t])"""
+        return self._alpha @ self.transition
+
+    @property
+    def probabilities(self) -> np.ndarray:
+        return self._alpha.copy()
+
+    @property
+    def smoothed(self) -> Optional[np.ndarray]:
+        return self._smoothed.copy() if self.count > self.lag else None
+
+    def _smooth(self):
+        """Backward pass over the last lag observations, as HmmFilter::smooth"""
+        window = self.lag + 1
+        newest = self.count - 1
+        beta = np.ones(self.n_states)
+        for s in range(newest, newest - self.lag, -1):
+            beta = self.transition @ (self._history_b[s % window] * beta)
+            total = beta.sum()
+            beta = beta / total if total > 0 else np.zeros_like(beta)
+        smoothed = self._history_alpha[(newest - self.lag) % window] * beta
+        total = smoothed.sum()
+        self._smoothed = smoothed / total if total > 0 else np.zeros_like(smoothed)
+
+
+def make_regime_filter(model: BayesianRegimeSwitchingModel, lag: int = 0):
+    """
+    Regime filter over a fitted model's parameters, native when native/hmm is built.
+
+    The filter copies the parameters; refitting the model does not change it.
+    """
+    if not model.is_fitted:
+        raise ValueError("Model must be fitted before filtering")
+    filter_class = RegimeFilter if RegimeFilter is not None else PyRegimeFilter
+    return filter_class(*model.get_params(), lag=lag)
+
+
+class RegimeStrategy:
+    """
+    Streaming strategy wrapper adding regime probabilities to each row
+
+    Every bar's log return (against the previous close, as in MarketDataLoader)
+    updates a regime filter; the row gets one 'regime_<name>' column per state
+    and, when lag > 0, 'regime_<name>_smoothed' columns for the bar lag steps
+    back (NaN until available). With buy_regime set, buy signals of the inner
+    strategy only pass when that regime's filtered probability is at least
+    min_probability.
+    """
+
+    def __init__(self, strategy, model: BayesianRegimeSwitchingModel, lag: int = 0,
+                 buy_regime: Optional[str] = None, min_probability: float = 0.5):
+        self.strategy = strategy
+        self.model = model
+        self.lag = lag
+        self.regimes = [name.lower() for name in model.regime_names()]
+        if buy_regime is not None and buy_regime.lower() not in self.regimes:
+            raise ValueError(f"Unknown regime {buy_regime!r}, expected one of {self.regimes}")
+        self.buy_regime = buy_regime.lower() if buy_regime is not None else None
+        self.min_probability = min_probability
+        self.name = f"{strategy.name} + Regime"
+        self.params = {
+            **strategy.params,
+            "regime_lag": lag,
+            "buy_regime": buy_regime,
+            "min_probability": min_probability,
+        }
+        self._filter = make_regime_filter(model, lag)
+        self.reset_stream()
+
+    def _columns(self, suffix: str = '') -> List[str]:
+        return [f'regime_{name}{suffix}' for name in self.regimes]
+
+    def generate_signals(self, df):
+        """
+        Batch counterpart of on_bar: the filtered (and lagged smoothed)
+        columns for every row, bar for bar as on_bar would produce them
+        """
+        df = self.strategy.generate_signals(df)
+        close = df['Close'].to_numpy(dtype=np.float64)
+        filt = make_regime_filter(self.model, self.lag)
+        filtered = np.full((len(df), len(self.regimes)), np.nan)
+        smoothed = np.full_like(filtered, np.nan)
+        for t in range(1, len(close)):
+            # As in on_bar, a zero, negative or missing close has no log return
+            # and leaves the filter untouched
+            if close[t - 1] > 0 and close[t] > 0:
+                filtered[t] = filt.update(np.log(close[t] / close[t - 1]))
+            if self.lag > 0 and filt.smoothed is not None:
+                smoothed[t] = filt.smoothed
+        for j, column in enumerate(self._columns()):
+            df[column] = filtered[:, j]
+        if self.lag > 0:
+            for j, column in enumerate(self._columns('_smoothed')):
+                df[column] = smoothed[:, j]
+        if self.buy_regime is not None:
+            buy = self.strategy.get_signal_names()['buy']
+            df[buy] = df[buy] & (df[f'regime_{self.buy_regime}'] >= self.min_probability)
+        return df
+
+    def reset_stream(self):
+        """Reset the inner strategy, the filter and the previous close"""
+        self.strategy.reset_stream()
+        self._filter.reset()
+        self._prev_close = None
+
+    def on_bar(self, bar: Dict[str, Any]) -> Dict[str, Any]:
+        """Inner strategy row for one bar, with its regime probabilities"""
+        row = self.strategy.on_bar(bar)
+        close = float(bar['Close'])
+        probs = None
+        if self._prev_close is not None and self._prev_close > 0 and close > 0:
+            probs = self._filter.update(np.log(close / self._prev_close))
+        self._prev_close = close
+
+        for j, column in enumerate(self._columns()):
+            row[column] = probs[j] if probs is not None else np.nan
+        if self.lag > 0:
+            smoothed = self._filter.smoothed
+            for j, column in enumerate(self._columns('_smoothed')):
+                row[column] = smoothed[j] if smoothed is not None else np.nan
+
+        if self.buy_regime is not None:
+            buy = self.strategy.get_signal_names()['buy']
+            p = row[f'regime_{self.buy_regime}']
+            row[buy] = bool(row[buy]) and not np.isnan(p) and p >= self.min_probability
+        return row
+
+    def get_signal_names(self) -> Dict[str, str]:
+        return self.strategy.get_signal_names()
+
+    def get_indicators(self) -> List[str]:
+        columns = self._columns() + (self._columns('_smoothed') if self.lag > 0 else [])
+        return list(self.strategy.get_indicators()) + columns
+
+    def get_required_lookback(self) -> int:
+        return max(self.strategy.get_required_lookback(), self.lag + 2)
+
+    def validate_data(self, df) -> bool:
+        return self.strategy.validate_data(df)
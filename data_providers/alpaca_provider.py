@@ -1,16 +1,27 @@
 import requests
 import json
+import time
 import pandas as pd
 import alpaca_trade_api as tradeapi
 from datetime import datetime, timedelta
 from typing import Optional
 from .base_provider import BaseDataProvider
+from .streaming import AlpacaBarStream, AlpacaTradeUpdateStream
+from .fetcher import AlpacaFetcher
+from engines.order_book import make_order_book, BUY, SELL
 
 
 class AlpacaDataProvider(BaseDataProvider):
     """Alpaca data provider for crypto and stock data"""
 
-    def __init__(self, api_key: str = None, secret_key: str = None):
+    def __init__(self, api_key: str = None, secret_key: str = None, cache_dir: Optional[str] = None,
+                 **fetcher_options):
+        """
+        Args:
+            api_key, secret_key: Alpaca credentials
+            cache_dir: Directory for the incremental bar cache of get_data (None: no cache)
+            fetcher_options: AlpacaFetcher options (max_workers, rate, burst, ...)
+        """
         super().__init__(api_key)
         self.secret_key = secret_key
         self.base_url = "https://data.alpaca.markets"
@@ -20,6 +31,9 @@ class AlpacaDataProvider(BaseDataProvider):
             "APCA-API-KEY-ID": api_key,
             "APCA-API-SECRET-KEY": secret_key
         }
+        # One keep-alive connection pool, so polling does not pay a TLS handshake per call
+        self.session = requests.Session()
+        self.fetcher = AlpacaFetcher(api_key, secret_key, self.base_url, cache_dir=cache_dir, **fetcher_options)
 
     def _is_crypto(self, ticker: str) -> bool:
         """Determine if ticker is cryptocurrency"""
@@ -37,8 +51,14 @@ class AlpacaDataProvider(BaseDataProvider):
                  timespan: str = '1Min',
                  from_date: str = None,
                  to_date: str = None,
-                 limit: int = 1000) -> pd.DataFrame:
-        """Get historical data from Alpaca (crypto or stocks)"""
+                 limit: Optional[int] = 1000) -> pd.DataFrame:
+        """
+        Get historical data from Alpaca (crypto or stocks)
+
+        The range is fetched in parallel chunks following next_page_token, so
+        limit is the bars per request (None: the API maximum) rather than a
+        cap on the result. With a cache_dir only the uncached part is downloaded.
+        """
 
         is_crypto = self._is_crypto(ticker)
 
@@ -54,69 +74,24 @@ class AlpacaDataProvider(BaseDataProvider):
         if not from_date:
             from_date = (datetime.now() - timedelta(days=30)).strftime('%Y-%m-%d')
 
-        # Get appropriate endpoint
-        url = self._get_data_endpoint(ticker)
-
-        # Set parameters based on asset type
-        if is_crypto:
-            params = {
-                'symbols': symbol,
-                'timeframe': timespan,
-                'start': from_date,
-                'end': to_date,
-                'limit': limit,
-                'sort': 'asc'
-            }
-        else:
-            # Stock parameters - use the working format from your example
-            params = {
-                'symbols': symbol,
-                'timeframe': timespan,
-                'start': from_date,
-                'end': to_date,
-                'limit': limit,
-                'adjustment': 'raw',
-                'feed': 'sip',
-                'sort': 'asc'
-            }
-
         try:
-            response = requests.get(url, headers=self.headers, params=params)
-            response.raise_for_status()
-            data = response.json()
-
-            if 'bars' not in data or symbol not in data['bars']:
-                return pd.DataFrame()
-
-            # Convert to DataFrame
-            bars = data['bars'][symbol]
-            df = pd.DataFrame(bars)
-
-            if df.empty:
-                return df
-
-            # Standardize column names
-            df.rename(columns={
-                'o': 'Open',
-                'h': 'High',
-                'l': 'Low',
-                'c': 'Close',
-                'v': 'Volume',
-                't': 'timestamp'
-            }, inplace=True)
-
-            # Convert timestamp
-            df['timestamp'] = pd.to_datetime(df['timestamp'])
-
-            # Drop unnecessary columns
-            df.drop(columns=['vw', 'n'], inplace=True, errors='ignore')
-
-            return df
-
+            bars = self.fetcher.fetch(symbol, timespan, from_date, to_date, page_limit=limit)
         except Exception as e:
             print(f"Error fetching historical data for {ticker}: {e}")
             return pd.DataFrame()
 
+        if len(bars['timestamp']) == 0:
+            return pd.DataFrame()
+
+        return pd.DataFrame({
+            'timestamp': pd.to_datetime(bars['timestamp'], utc=True),
+            'Open': bars['open'],
+            'High': bars['high'],
+            'Low': bars['low'],
+            'Close': bars['close'],
+            'Volume': bars['volume'],
+        })
+
     def get_live_data(self, ticker: str, lookback_minutes: int = 100) -> pd.DataFrame:
         """Get recent live data for crypto"""
 
@@ -124,13 +99,15 @@ class AlpacaDataProvider(BaseDataProvider):
         end_time = datetime.now()
         start_time = end_time - timedelta(minutes=lookback_minutes)
 
-        return self.get_data(
+        df = self.get_data(
             ticker=ticker,
             timespan='1Min',
             from_date=start_time.strftime('%Y-%m-%d'),
             to_date=end_time.strftime('%Y-%m-%d'),
-            limit=lookback_minutes
+            limit=None
         )
+        # The most recent lookback_minutes bars of the fetched days
+        return df.tail(lookback_minutes).reset_index(drop=True)
 
     def get_latest_bar(self, ticker: str) -> dict:
         """Get only the latest bar for live trading using public endpoint"""
@@ -155,9 +132,9 @@ class AlpacaDataProvider(BaseDataProvider):
 
         try:
             if is_crypto:
-                response = requests.get(url, headers={"accept": "application/json"})
+                response = self.session.get(url, headers={"accept": "application/json"})
             else:
-                response = requests.get(url, headers=self.headers)
+                response = self.session.get(url, headers=self.headers)
 
             response.raise_for_status()
             data = response.json()
@@ -236,9 +213,9 @@ class AlpacaDataProvider(BaseDataProvider):
 
         try:
             if is_crypto:
-                response = requests.get(url, headers={"accept": "application/json"})
+                response = self.session.get(url, headers={"accept": "application/json"})
             else:
-                response = requests.get(url, headers=self.headers)
+                response = self.session.get(url, headers=self.headers)
 
             response.raise_for_status()
             data = response.json()
@@ -328,6 +305,37 @@ class AlpacaDataProvider(BaseDataProvider):
             traceback.print_exc()
             return pd.DataFrame()
 
+    def stream_bars(self, symbols, callback, interval_seconds: float = 60) -> AlpacaBarStream:
+        """
+        Push bars assembled from the real-time trade stream
+
+        Args:
+            symbols: Ticker or list of tickers (all crypto or all stocks)
+            callback: Called as callback(symbol, bar) when each bar closes,
+                on the stream's thread; symbol is spelled as passed in
+            interval_seconds: Bar length
+
+        Returns:
+            The started AlpacaBarStream (call stop() to disconnect)
+        """
+        if isinstance(symbols, str):
+            symbols = [symbols]
+        crypto = self._is_crypto(symbols[0])
+        # The crypto stream names pairs with a slash (BTC/USD)
+        names = {}
+        for ticker in symbols:
+            if crypto and '/' not in ticker:
+                names[f"{ticker[:-3]}/{ticker[-3:]}" if ticker.upper().endswith('USD') else f"{ticker}/USD"] = ticker
+            else:
+                names[ticker] = ticker
+
+        def on_bar(stream_symbol, bar):
+            callback(names.get(stream_symbol, stream_symbol), bar)
+
+        stream = AlpacaBarStream(self.api_key, self.secret_key, list(names), on_bar,
+                                 interval_seconds=interval_seconds, crypto=crypto)
+        return stream.start()
+
     def get_latest_quote(self, ticker: str) -> dict:
         """Get latest quote data"""
 
@@ -340,7 +348,7 @@ class AlpacaDataProvider(BaseDataProvider):
         params = {'symbols': symbol}
 
         try:
-            response = requests.get(url, headers=self.headers, params=params)
+            response = self.session.get(url, headers=self.headers, params=params)
             response.raise_for_status()
             data = response.json()
 
@@ -383,6 +391,8 @@ class AlpacaBroker:
             "APCA-API-KEY-ID": api_key,
             "APCA-API-SECRET-KEY": secret_key
         }
+        # One keep-alive connection pool for the direct API calls and submit_order
+        self.session = requests.Session()
 
     def get_account(self):
         """Get account information using alpaca_trade_api"""
@@ -446,7 +456,7 @@ class AlpacaBroker:
         # Try to get crypto positions (this will fail if crypto is not enabled)
         try:
             url = f"{self.base_url}/v2/positions"
-            response = requests.get(url, headers=self.headers)
+            response = self.session.get(url, headers=self.headers)
             response.raise_for_status()
             positions = response.json()
 
@@ -575,6 +585,50 @@ class AlpacaBroker:
 
             return {}
 
+    def submit_order(self, symbol: str, quantity: float, side: str, order_type: str = "market",
+                     limit_price: float = None, client_order_id: str = None) -> dict:
+        """
+        Place an order with one POST on the pooled session, without logging
+
+        Used by engines/order_gateway.py; fills arrive on stream_trade_updates.
+
+        Returns:
+            The order as Alpaca reports it (id, client_order_id, status, ...)
+
+        Raises:
+            requests.HTTPError: if Alpaca rejects the order
+        """
+        payload = {
+            'symbol': symbol.replace('/', ''),
+            'qty': str(quantity),
+            'side': side,
+            'type': order_type,
+            'time_in_force': 'gtc'
+        }
+        if order_type == "limit" and limit_price is not None:
+            payload['limit_price'] = str(limit_price)
+        if client_order_id:
+            payload['client_order_id'] = client_order_id
+        response = self.session.post(f"{self.base_url}/v2/orders", headers=self.headers, json=payload, timeout=10)
+        if response.status_code >= 400:
+            raise requests.HTTPError(f"Order rejected ({response.status_code}): {response.text}", response=response)
+        return response.json()
+
+    def stream_trade_updates(self, callback, on_connect=None) -> AlpacaTradeUpdateStream:
+        """
+        Push order events (new, fill, partial_fill, canceled, ...) from Alpaca's trade_updates stream
+
+        Args:
+            callback: Called as callback(update) with each update's data dict, on the stream's thread
+            on_connect: Called after every (re)connect, e.g. to resync missed events
+
+        Returns:
+            The started AlpacaTradeUpdateStream (call stop() to disconnect)
+        """
+        stream = AlpacaTradeUpdateStream(self.api_key, self.secret_key, callback,
+                                         paper=self.paper_trading, on_connect=on_connect)
+        return stream.start()
+
     def get_positions(self):
         """Get current positions using alpaca_trade_api"""
         try:
@@ -627,7 +681,7 @@ class AlpacaBroker:
         """Get all positions using direct API call"""
         try:
             url = f"{self.base_url}/v2/positions"
-            response = requests.get(url, headers=self.headers)
+            response = self.session.get(url, headers=self.headers)
             response.raise_for_status()
             return response.json()
         except Exception as e:
@@ -642,7 +696,7 @@ class AlpacaBroker:
                 symbol = symbol.replace('/', '')
 
             url = f"{self.base_url}/v2/positions/{symbol}"
-            response = requests.get(url, headers=self.headers)
+            response = self.session.get(url, headers=self.headers)
 
             if response.status_code == 404:
                 # No position exists
@@ -674,7 +728,7 @@ class AlpacaBroker:
         """Get account information using direct API call"""
         try:
             url = f"{self.base_url}/v2/account"
-            response = requests.get(url, headers=self.headers)
+            response = self.session.get(url, headers=self.headers)
             response.raise_for_status()
             return response.json()
         except Exception as e:
@@ -689,7 +743,7 @@ class AlpacaBroker:
                 'period': period,
                 'timeframe': '1Min'
             }
-            response = requests.get(url, headers=self.headers, params=params)
+            response = self.session.get(url, headers=self.headers, params=params)
             response.raise_for_status()
             return response.json()
         except Exception as e:
@@ -705,7 +759,7 @@ class AlpacaBroker:
                 'limit': limit,
                 'direction': 'desc'
             }
-            response = requests.get(url, headers=self.headers, params=params)
+            response = self.session.get(url, headers=self.headers, params=params)
             response.raise_for_status()
             return response.json()
         except Exception as e:
@@ -723,7 +777,7 @@ class AlpacaBroker:
             params = {
                 'cancel_orders': str(cancel_orders).lower()
             }
-            response = requests.delete(url, headers=self.headers, params=params)
+            response = self.session.delete(url, headers=self.headers, params=params)
             response.raise_for_status()
             return response.json()
         except Exception as e:
@@ -737,7 +791,7 @@ class AlpacaBroker:
             params = {
                 'cancel_orders': str(cancel_orders).lower()
             }
-            response = requests.delete(url, headers=self.headers, params=params)
+            response = self.session.delete(url, headers=self.headers, params=params)
             response.raise_for_status()
             return response.json()
         except Exception as e:
@@ -748,7 +802,7 @@ class AlpacaBroker:
         """Cancel a specific order using direct API call"""
         try:
             url = f"{self.base_url}/v2/orders/{order_id}"
-            response = requests.delete(url, headers=self.headers)
+            response = self.session.delete(url, headers=self.headers)
             response.raise_for_status()
             return response.json()
         except Exception as e:
@@ -759,10 +813,13 @@ class AlpacaBroker:
 class SimulatedBroker:
     """Simulated broker that uses live Alpaca data but manages local account"""
 
-    def __init__(self, api_key: str, secret_key: str, initial_balance: float = 10000):
+    def __init__(self, api_key: str, secret_key: str, initial_balance: float = 10000,
+                 order_expiry_seconds: float = None):
         self.api_key = api_key
         self.secret_key = secret_key
         self.initial_balance = initial_balance
+        # Pending limit orders expire after this long (None = good till cancelled)
+        self.order_expiry_seconds = order_expiry_seconds
 
         # Initialize data provider for live prices
         self.data_provider = AlpacaDataProvider(api_key, secret_key)
@@ -778,6 +835,7 @@ class SimulatedBroker:
         self.cash_balance = self.initial_balance
         self.positions = {}  # symbol -> {'qty': float, 'avg_entry_price': float, 'side': str}
         self.orders = {}  # order_id -> order details
+        self.order_books = {}  # symbol -> resting limit orders (engines/order_book.py)
         self.trade_history = []
 
     def get_current_price(self, symbol: str) -> float:
@@ -803,6 +861,31 @@ class SimulatedBroker:
         self.order_counter += 1
         return order_id
 
+    @staticmethod
+    def _book_id(order_id: str) -> int:
+        """Numeric key of a SIM_ order id in the order book"""
+        return int(order_id[4:])
+
+    def _rest_limit_order(self, order_id: str, symbol: str, quantity: float, side: str, limit_price: float):
+        """Store a pending limit order and rest it in the symbol's book"""
+        now_ns = time.time_ns()
+        expiry_ns = now_ns + int(self.order_expiry_seconds * 1e9) if self.order_expiry_seconds else 0
+        self.orders[order_id] = {
+            'id': order_id,
+            'symbol': symbol,
+            'qty': quantity,
+            'side': side,
+            'type': 'limit',
+            'limit_price': limit_price,
+            'status': 'pending',
+            'created_at': datetime.now()
+        }
+        book = self.order_books.get(symbol)
+        if book is None:
+            # Live checks match a single price, which fills at the limit as before
+            book = self.order_books[symbol] = make_order_book(gap_fills_at_open=False)
+        book.add(self._book_id(order_id), BUY if side == 'buy' else SELL, limit_price, quantity, now_ns, expiry_ns)
+
     def _calculate_portfolio_value(self) -> float:
         """Calculate total portfolio value (cash + positions)"""
         total_value = self.cash_balance
@@ -849,16 +932,7 @@ class SimulatedBroker:
             execution_price = limit_price
             if current_price > limit_price:  # Current price too high for buy limit
                 # Store as pending order
-                self.orders[order_id] = {
-                    'id': order_id,
-                    'symbol': symbol,
-                    'qty': quantity,
-                    'side': 'buy',
-                    'type': order_type,
-                    'limit_price': limit_price,
-                    'status': 'pending',
-                    'created_at': datetime.now()
-                }
+                self._rest_limit_order(order_id, symbol, quantity, 'buy', limit_price)
                 print(f"📋 BUY LIMIT ORDER PENDING - {quantity} {symbol} @ ${limit_price:.2f} (current: ${current_price:.2f})")
                 return {'id': order_id, 'status': 'pending', 'symbol': symbol, 'qty': quantity}
         else:
@@ -953,16 +1027,7 @@ class SimulatedBroker:
             execution_price = limit_price
             if current_price < limit_price:  # Current price too low for sell limit
                 # Store as pending order
-                self.orders[order_id] = {
-                    'id': order_id,
-                    'symbol': symbol,
-                    'qty': quantity,
-                    'side': 'sell',
-                    'type': order_type,
-                    'limit_price': limit_price,
-                    'status': 'pending',
-                    'created_at': datetime.now()
-                }
+                self._rest_limit_order(order_id, symbol, quantity, 'sell', limit_price)
                 print(f"📋 SELL LIMIT ORDER PENDING - {quantity} {symbol} @ ${limit_price:.2f} (current: ${current_price:.2f})")
                 return {'id': order_id, 'status': 'pending', 'symbol': symbol, 'qty': quantity}
         else:
@@ -1064,44 +1129,62 @@ class SimulatedBroker:
 
         # Remove from pending orders
         del self.orders[order_id]
+        book = self.order_books.get(order['symbol'])
+        if book is not None:
+            book.cancel(self._book_id(order_id))
         print(f" SIMULATED ORDER CANCELED - {order['side'].upper()} {order['qty']} {order['symbol']}")
 
         return {'status': 'canceled', 'order_id': order_id}
 
     def check_pending_orders(self):
         """Check if any pending limit orders can be filled based on current prices"""
-        filled_orders = []
-
-        for order_id, order in list(self.orders.items()):
-            if order['status'] == 'pending':
-                symbol = order['symbol']
-                current_price = self.get_current_price(symbol)
-
-                should_fill = False
-                if order['side'] == 'buy' and current_price <= order['limit_price']:
-                    should_fill = True
-                elif order['side'] == 'sell' and current_price >= order['limit_price']:
-                    should_fill = True
-
-                if should_fill:
-                    print(f"LIMIT ORDER TRIGGERED - {order['side'].upper()} {order['qty']} {symbol} @ ${order['limit_price']:.2f}")
-
-                    # Execute the order
-                    if order['side'] == 'buy':
-                        self._execute_buy(symbol, order['qty'], order['limit_price'], order_id)
-                    else:
-                        self._execute_sell(symbol, order['qty'], order['limit_price'], order_id)
-
-                    # Update order status
-                    order['status'] = 'filled'
-                    filled_orders.append(order_id)
-
-        # Remove filled orders from pending
-        for order_id in filled_orders:
-            if order_id in self.orders:
-                del self.orders[order_id]
-
-        return len(filled_orders)
+        filled = 0
+        for symbol, book in list(self.order_books.items()):
+            if not len(book):
+                continue
+            current_price = self.get_current_price(symbol)
+            if current_price <= 0:
+                continue
+            filled += self._match_book(symbol, book, current_price, current_price, current_price)
+        return filled
+
+    def on_bar(self, symbol: str, bar: dict) -> int:
+        """
+        Match a symbol's resting limit orders against a completed bar
+
+        Buys fill when the bar's low reaches the limit and sells when its high
+        does, in price-time priority, at the limit price. Use this when bars
+        are fed in (bar streams) so fills see the intrabar range, not only
+        the last price.
+
+        Returns:
+            Number of orders filled
+        """
+        book = self.order_books.get(symbol)
+        if book is None or not len(book):
+            return 0
+        return self._match_book(symbol, book, bar['Open'], bar['High'], bar['Low'])
+
+    def _match_book(self, symbol: str, book, open_: float, high: float, low: float) -> int:
+        """Expire, match and execute one symbol's resting orders"""
+        # Expiries run on the wall clock the orders were stamped with
+        fills, expired = book.on_bar(time.time_ns(), open_, high, low)
+        for book_id in expired:
+            order = self.orders.pop(f"SIM_{book_id:06d}", None)
+            if order is not None:
+                print(f" LIMIT ORDER EXPIRED - {order['side'].upper()} {order['qty']} {symbol} @ ${order['limit_price']:.2f}")
+        for book_id, side, _limit, price, quantity, _time in fills:
+            order_id = f"SIM_{book_id:06d}"
+            order = self.orders.pop(order_id, None)
+            if order is None:
+                continue
+            print(f"LIMIT ORDER TRIGGERED - {order['side'].upper()} {quantity} {symbol} @ ${price:.2f}")
+            if side == BUY:
+                self._execute_buy(symbol, quantity, price, order_id)
+            else:
+                self._execute_sell(symbol, quantity, price, order_id)
+            order['status'] = 'filled'
+        return len(fills)
 
     def get_position_for_symbol(self, symbol: str) -> dict:
         """Get position information for a specific symbol"""
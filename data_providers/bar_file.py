@@ -0,0 +1,165 @@
+"""
+Pure NumPy reader/writer for the binary bar file format (".bars")
+
+This is the same versioned columnar layout as research/optimization/bar_file.h,
+so caches written by the Cython backtest module can be used by pandas-based
+code (BacktestEngine, the CLI, the data fetcher) without building the
+extension, and vice versa. Columns are read with np.memmap, so opening a cache only maps it; pages are read on first use.
+"""
+
+import builtins
+import os
+import numpy as np
+import pandas as pd
+
+MAGIC = b'BATBARS\0'
+VERSION = 1
+HEADER_SIZE = 128
+ALIGNMENT = 64
+COLUMNS = ('timestamp', 'open', 'high', 'low', 'close', 'volume')
+
+HEADER_DTYPE = np.dtype([
+    ('magic', 'S8'),
+    ('version', '<u4'),
+    ('header_size', '<u4'),
+    ('rows', '<u8'),
+    ('source_size', '<u8'),
+    ('source_mtime_ns', '<i8'),
+    ('column_offset', '<u8', (len(COLUMNS),)),
+    ('reserved', 'V40'),
+])
+assert HEADER_DTYPE.itemsize == HEADER_SIZE
+
+
+def cache_path(csv_path: str) -> str:
+    """Path of the binary cache kept next to a CSV file"""
+    return os.path.splitext(csv_path)[0] + '.bars'
+
+
+def _align_up(value: int) -> int:
+    return (value + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+def write_bar_file(path: str, timestamp, open, high, low, close, volume,
+                   source_size: int = 0, source_mtime_ns: int = 0):
+    """
+    Write bars to path atomically (temp file + rename)
+
+    Args:
+        timestamp: datetime64 values or int64 epoch nanoseconds
+        open, high, low, close, volume: array-likes of the same length
+        source_size, source_mtime_ns: Fingerprint of the source CSV
+    """
+    ts = np.asarray(timestamp)
+    if ts.dtype.kind == 'M':
+        ts = ts.astype('datetime64[ns]').view(np.int64)
+    columns = [np.ascontiguousarray(ts, dtype='<i8')]
+    columns += [np.ascontiguousarray(c, dtype='<f8') for c in (open, high, low, close, volume)]
+    rows = len(columns[0])
+    if any(len(c) != rows for c in columns):
+        raise ValueError("All columns must have the same length")
+
+    header = np.zeros(1, dtype=HEADER_DTYPE)
+    header['magic'] = MAGIC
+    header['version'] = VERSION
+    header['header_size'] = HEADER_SIZE
+    header['rows'] = rows
+    header['source_size'] = source_size
+    header['source_mtime_ns'] = source_mtime_ns
+    offset = _align_up(HEADER_SIZE)
+    offsets = []
+    for _ in COLUMNS:
+        offsets.append(offset)
+        offset = _align_up(offset + rows * 8)
+    header['column_offset'] = offsets
+
+    tmp_path = f"{path}.tmp.{os.getpid()}"
+    try:
+        with builtins.open(tmp_path, 'wb') as f:
+            f.write(header.tobytes())
+            for column_offset, column in zip(offsets, columns):
+                f.write(b'\0' * (column_offset - f.tell()))
+                f.write(column.tobytes())
+        os.replace(tmp_path, path)
+    except BaseException:
+        if os.path.exists(tmp_path):
+            os.remove(tmp_path)
+        raise
+
+
+def read_bar_file(path: str):
+    """
+    Memory-map a bar file
+
+    Returns:
+        (header, columns): the header as a NumPy record and a dict of
+        read-only arrays keyed by COLUMNS ('timestamp' is datetime64[ns])
+
+    Raises:
+        ValueError: if the file is not a supported bar file
+    """
+    size = os.path.getsize(path)
+    if size < HEADER_SIZE:
+        raise ValueError(f"{path}: file is too small")
+    header = np.fromfile(path, dtype=HEADER_DTYPE, count=1)[0]
+    if header['magic'] != MAGIC.rstrip(b'\0'):  # 'S8' drops trailing NULs
+        raise ValueError(f"{path}: not a bar file")
+    if header['version'] != VERSION or header['header_size'] != HEADER_SIZE:
+        raise ValueError(f"{path}: unsupported bar file version")
+
+    rows = int(header['rows'])
+    columns = {}
+    for name, offset in zip(COLUMNS, header['column_offset']):
+        offset = int(offset)
+        if offset % 8 or offset < HEADER_SIZE or offset + rows * 8 > size:
+            raise ValueError(f"{path}: column extends past end of file")
+        dtype = '<i8' if name == 'timestamp' else '<f8'
+        columns[name] = np.memmap(path, dtype=dtype, mode='r', offset=offset, shape=(rows,))
+    columns['timestamp'] = columns['timestamp'].view('datetime64[ns]')
+    return header, columns
+
+
+def write_dataset_cache(csv_path: str, df: pd.DataFrame):
+    """Write the cache for a CSV from its DataFrame (Open/High/Low/Close/Volume/timestamp)"""
+    info = os.stat(csv_path)
+    volume = df['Volume'] if 'Volume' in df.columns else np.zeros(len(df))
+    timestamp = pd.to_datetime(df['timestamp'], utc=True).dt.tz_localize(None)
+    write_bar_file(cache_path(csv_path), timestamp.to_numpy(),
+                   df['Open'], df['High'], df['Low'], df['Close'], volume,
+                   info.st_size, info.st_mtime_ns)
+
+
+def load_dataset_frame(csv_path: str, use_cache: bool = True) -> pd.DataFrame:
+    """
+    Load a research dataset CSV as the DataFrame layout the providers return
+
+    A fresh cache (matching the CSV's size and mtime) is memory-mapped instead
+    of parsing the CSV; otherwise the CSV is read and the cache rewritten.
+    """
+    cache = cache_path(csv_path)
+    info = os.stat(csv_path)
+    if use_cache and os.path.exists(cache):
+        try:
+            header, columns = read_bar_file(cache)
+            if (int(header['source_size']) == info.st_size and
+                    int(header['source_mtime_ns']) == info.st_mtime_ns):
+                return pd.DataFrame({
+                    'Volume': columns['volume'],
+                    'Open': columns['open'],
+                    'Close': columns['close'],
+                    'High': columns['high'],
+                    'Low': columns['low'],
+                    'timestamp': columns['timestamp'],
+                })
+        except (OSError, ValueError):
+            pass
+
+    df = pd.read_csv(csv_path)
+    df['timestamp'] = pd.to_datetime(df['timestamp'])
+    if use_cache:
+        try:
+            write_dataset_cache(csv_path, df)
+        except OSError:
+            # A read-only dataset directory only costs the speedup
+            pass
+    return df
@@ -0,0 +1,142 @@
+"""
+Fixed-capacity bar history shared by a data-fetch thread and the live chart
+
+BarHistory wraps a single-producer / single-consumer ring of OHLCV bars:
+the fetch thread calls push_bar() and the strategy/chart thread calls
+pop_bar() and to_frame(). The ring is allocated once, so live ticks cost no
+reallocation, and DataFrames are only built when something asks for one.
+The native ring (native/ring_buffer.h) is lock-free; without it PyBarRing
+provides the same semantics under the GIL.
+"""
+
+import numpy as np
+import pandas as pd
+
+try:
+    from native.ring_buffer import BarRingBuffer
+except ImportError:  # extension not built, use the NumPy ring
+    BarRingBuffer = None
+
+OHLCV_COLUMNS = ('Open', 'High', 'Low', 'Close', 'Volume')
+
+
+class PyBarRing:
+    """NumPy version of native.ring_buffer.BarRingBuffer (mirrored columns, same full/view rules)"""
+
+    def __init__(self, capacity: int = 1024, window: int = 100):
+        if window < 1:
+            raise ValueError("window must be >= 1")
+        size = 1
+        while size < max(capacity, window + 1):
+            size <<= 1
+        self.capacity = size
+        self.window = window
+        self._timestamp = np.zeros(2 * size, dtype=np.int64)
+        self._values = {name: np.zeros(2 * size) for name in OHLCV_COLUMNS}
+        # Cursors are only stored after the slot is written; the GIL orders the two
+        self._head = 0
+        self.consumed = 0
+
+    def push(self, timestamp, open, high, low, close, volume) -> bool:
+        head = self._head
+        if head - self.consumed >= self.capacity - self.window:
+            return False
+        slot = head % self.capacity
+        for i in (slot, slot + self.capacity):
+            self._timestamp[i] = timestamp
+            self._values['Open'][i] = open
+            self._values['High'][i] = high
+            self._values['Low'][i] = low
+            self._values['Close'][i] = close
+            self._values['Volume'][i] = volume
+        self._head = head + 1
+        return True
+
+    def pending(self) -> int:
+        return self._head - self.consumed
+
+    def pop(self):
+        tail = self.consumed
+        if tail == self._head:
+            return None
+        slot = tail % self.capacity
+        bar = (int(self._timestamp[slot]),) + tuple(float(self._values[name][slot]) for name in OHLCV_COLUMNS)
+        self.consumed = tail + 1
+        return bar
+
+    def __len__(self):
+        return min(self.consumed, self.window)
+
+    def columns(self, k=None):
+        n = len(self) if k is None else min(k, len(self))
+        off = (self.consumed - n) % self.capacity
+        views = {'timestamp': self._timestamp[off:off + n]}
+        views.update((name, self._values[name][off:off + n]) for name in OHLCV_COLUMNS)
+        for view in views.values():
+            view.flags.writeable = False
+        return views
+
+
+class BarHistory:
+    """
+    Bar dicts in, bar dicts and on-demand DataFrames out
+
+    Timestamps are stored as UTC epoch nanoseconds; naive input timestamps
+    are treated as UTC and come back naive.
+    """
+
+    def __init__(self, capacity: int = 1024, window: int = 100):
+        ring_type = BarRingBuffer if BarRingBuffer is not None else PyBarRing
+        self.ring = ring_type(capacity, window)
+        self.naive_timestamps = None
+        self.last_pushed = None  # producer-side duplicate check
+
+    @property
+    def consumed(self) -> int:
+        return self.ring.consumed
+
+    def __len__(self):
+        return len(self.ring)
+
+    def push_bar(self, bar) -> bool:
+        """
+        Producer side: store a bar dict with 'timestamp' and OHLCV keys
+
+        Returns:
+            False when the bar is not newer than the last push or the ring is full
+        """
+        ts = pd.Timestamp(bar['timestamp'])
+        if self.naive_timestamps is None:
+            self.naive_timestamps = ts.tz is None
+        ts = ts.tz_localize('UTC') if ts.tz is None else ts.tz_convert('UTC')
+        if self.last_pushed is not None and ts.value <= self.last_pushed:
+            return False
+        if not self.ring.push(ts.value, bar['Open'], bar['High'], bar['Low'], bar['Close'],
+                              bar.get('Volume', 0) or 0):
+            return False
+        self.last_pushed = ts.value
+        return True
+
+    def pop_bar(self):
+        """Consumer side: the next bar as a dict, or None"""
+        values = self.ring.pop()
+        if values is None:
+            return None
+        bar = {'timestamp': self._timestamp(values[0])}
+        bar.update(zip(OHLCV_COLUMNS, values[1:]))
+        return bar
+
+    def to_frame(self, k=None) -> pd.DataFrame:
+        """Consumer side: the last k popped bars as a DataFrame"""
+        columns = self.ring.columns(k)
+        timestamps = pd.to_datetime(columns.pop('timestamp'), utc=True)
+        if self.naive_timestamps:
+            timestamps = timestamps.tz_localize(None)
+        frame = pd.DataFrame({'timestamp': timestamps})
+        for name in OHLCV_COLUMNS:
+            frame[name] = columns[name]
+        return frame
+
+    def _timestamp(self, value):
+        ts = pd.Timestamp(value, tz='UTC')
+        return ts.tz_localize(None) if self.naive_timestamps else ts
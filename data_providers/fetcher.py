@@ -0,0 +1,473 @@
+"""
+Concurrent historical bar downloads with an incremental on-disk cache
+
+The providers used to request a whole date range in one call, serially per
+ticker, and download all of it again on every refresh. A HistoricalFetcher:
+
+  - keeps one pooled keep-alive requests.Session (one connection per worker,
+    so TLS handshakes are paid once per connection, not per request);
+  - splits the missing part of a range into chunks of about one page each
+    and downloads them on a thread pool, every request first taking a token
+    from a shared TokenBucket so bursts stay under the API's rate limit;
+    429 responses are retried after Retry-After (or exponential backoff);
+  - follows next_url / next_page_token pagination within each chunk and
+    decodes every page as soon as it arrives, with native/bar_json.h when
+    the extension is built; the native scan releases the GIL, so decoding
+    overlaps the other downloads;
+  - with cache_dir set, keeps each (ticker, timespan) in a .bars file (the
+    data_providers/bar_file.py format) plus a small JSON sidecar with
+    the covered time range, and only requests the parts of a range outside
+    it. New bars are merged in, de-duplicated by timestamp, and the file is
+    rewritten atomically. The covered range ends one bar after the last bar
+    received, and never within coverage_lag of now, so the tail a delayed
+    or end-of-day feed has not published yet is requested again next time.
+
+PolygonFetcher and AlpacaFetcher only differ in how requests are built;
+fetch() returns int64 epoch-ns timestamps and float64 OHLCV columns and the
+providers shape them into their usual DataFrames.
+"""
+
+import json
+import os
+import re
+import threading
+import time
+from concurrent.futures import ThreadPoolExecutor
+from datetime import datetime, timezone
+from typing import Dict, Iterable, List, Optional, Tuple
+
+import numpy as np
+import pandas as pd
+import requests
+from requests.adapters import HTTPAdapter
+
+from data_providers.bar_file import read_bar_file, write_bar_file
+
+try:
+    from native.bar_json import parse_bars
+except ImportError:  # extension not built, use json.loads
+    parse_bars = None
+
+NS_PER_MS = 1_000_000
+NS_PER_SECOND = 1_000_000_000
+NS_PER_DAY = 86_400 * NS_PER_SECOND
+
+BAR_FIELDS = ('timestamp', 'open', 'high', 'low', 'close', 'volume')
+
+# Bar length by timespan name, for sizing chunks (Polygon names and Alpaca units)
+_UNIT_NS = {
+    'second': NS_PER_SECOND, 'sec': NS_PER_SECOND, 's': NS_PER_SECOND,
+    'minute': 60 * NS_PER_SECOND, 'min': 60 * NS_PER_SECOND, 't': 60 * NS_PER_SECOND,
+    'hour': 3_600 * NS_PER_SECOND, 'h': 3_600 * NS_PER_SECOND,
+    'day': NS_PER_DAY, 'd': NS_PER_DAY,
+    'week': 7 * NS_PER_DAY, 'w': 7 * NS_PER_DAY,
+    'month': 30 * NS_PER_DAY,
+    'quarter': 91 * NS_PER_DAY, 'year': 365 * NS_PER_DAY,
+}
+
+
+class FetchError(Exception):
+    """A request failed after its retries, or the API reported an error"""
+
+
+def py_parse_bars(payload: bytes) -> dict:
+    """Python version of native.bar_json.parse_bars (same keys and dtypes)"""
+    data = json.loads(payload)
+    bars = data.get('results')
+    if bars is None:
+        bars = data.get('bars')
+    if isinstance(bars, dict):
+        bars = [bar for symbol_bars in bars.values() for bar in (symbol_bars or [])]
+    bars = bars or []
+
+    times = [bar.get('t') for bar in bars]
+    if any(t is None for t in times):
+        raise ValueError("bar without a timestamp")  # missing or null, as in bar_json.h
+    if times and isinstance(times[0], str):
+        # Alpaca: RFC 3339 strings
+        timestamp = pd.to_datetime(times, utc=True).asi8
+    else:
+        # Polygon: epoch milliseconds
+        ms = np.array(times, dtype=np.float64)
+        if not np.isfinite(ms).all() or (np.abs(ms) > np.iinfo(np.int64).max // NS_PER_MS).any():
+            raise ValueError("malformed timestamp")
+        timestamp = np.array(times, dtype=np.int64) * NS_PER_MS
+    out = {'timestamp': np.asarray(timestamp, dtype=np.int64)}
+    for field, key in (('open', 'o'), ('high', 'h'), ('low', 'l'), ('close', 'c')):
+        out[field] = np.array([bar.get(key, np.nan) for bar in bars], dtype=np.float64)
+    out['volume'] = np.array([bar.get('v', 0.0) for bar in bars], dtype=np.float64)
+    out['next'] = data.get('next_url') or data.get('next_page_token') or None
+    out['status'] = data.get('status')
+    error = data.get('error', data.get('message'))
+    out['error'] = error if isinstance(error, str) else None
+    return out
+
+
+def bar_duration_ns(timespan: str) -> int:
+    """Nominal bar length of a timespan ('minute', 'hour', '1Min', '15Min', '1Day', ...)"""
+    match = re.fullmatch(r'(\d*)\s*([A-Za-z]+)', timespan.strip())
+    if not match:
+        raise ValueError(f"Unknown timespan: {timespan}")
+    count = int(match.group(1) or 1)
+    unit = match.group(2)
+    # Alpaca spells months 'M' / 'Month' and minutes 'Min' / 'T'
+    if unit in ('M', 'Month'):
+        key = 'month'
+    else:
+        key = unit.lower().rstrip('s') if len(unit) > 1 else unit.lower()
+    if key not in _UNIT_NS:
+        raise ValueError(f"Unknown timespan: {timespan}")
+    return count * _UNIT_NS[key]
+
+
+def date_range_ns(from_date: str, to_date: str) -> Tuple[int, int]:
+    """[start, end) in epoch ns of YYYY-MM-DD dates, both days included, in UTC"""
+    def midnight(date: str) -> int:
+        moment = datetime.strptime(date[:10], '%Y-%m-%d').replace(tzinfo=timezone.utc)
+        return int(moment.timestamp()) * NS_PER_SECOND
+    return midnight(from_date), midnight(to_date) + NS_PER_DAY
+
+
+def split_range(start_ns: int, end_ns: int, chunk_ns: int) -> List[Tuple[int, int]]:
+    """Consecutive [start, end) chunks of at most chunk_ns covering [start_ns, end_ns)"""
+    return [(t, min(t + chunk_ns, end_ns)) for t in range(start_ns, end_ns, chunk_ns)]
+
+
+class TokenBucket:
+    """
+    Thread-safe token bucket: rate tokens per second, at most burst saved up
+
+    acquire() blocks until a token is available, so N worker threads share
+    one request budget.
+    """
+
+    def __init__(self, rate: float, burst: int = 1):
+        if rate <= 0 or burst < 1:
+            raise ValueError("rate must be positive and burst at least 1")
+        self.rate = float(rate)
+        self.burst = int(burst)
+        self._tokens = float(burst)
+        self._last = time.monotonic()
+        self._lock = threading.Lock()
+
+    def acquire(self):
+        while True:
+            with self._lock:
+                now = time.monotonic()
+                self._tokens = min(self.burst, self._tokens + (now - self._last) * self.rate)
+                self._last = now
+                if self._tokens >= 1:
+                    self._tokens -= 1
+                    return
+                wait = (1 - self._tokens) / self.rate
+            time.sleep(wait)
+
+    def pause(self, seconds: float):
+        """Spend the bucket and hold new tokens back for seconds (after a 429)"""
+        with self._lock:
+            self._tokens = min(self._tokens, 0.0) - seconds * self.rate
+            self._last = time.monotonic()
+
+
+class HistoricalFetcher:
+    """
+    Base fetcher: pooled session, token bucket, chunked parallel fetches, cache
+
+    Subclasses set source / PAGE_LIMIT and implement _first_request and
+    _next_request. coverage_lag (seconds) is held out of the cached coverage:
+    bars newer than that may still be missing or revised (Polygon's DELAYED
+    feed lags 15 minutes), so each refresh asks for them again.
+    """
+
+    source = 'bars'
+    PAGE_LIMIT = 10000
+
+    def __init__(self, max_workers: int = 8, rate: float = 5.0, burst: int = 5,
+                 cache_dir: Optional[str] = None, max_retries: int = 5, timeout: float = 30.0,
+                 coverage_lag: float = 900.0):
+        if coverage_lag < 0:
+            raise ValueError("coverage_lag must not be negative")
+        self.max_workers = max_workers
+        self.coverage_lag = coverage_lag
+        self.bucket = TokenBucket(rate, burst)
+        self.cache_dir = cache_dir
+        self.max_retries = max_retries
+        self.timeout = timeout
+        self.requests_made = 0
+        self.session = requests.Session()
+        adapter = HTTPAdapter(pool_connections=1, pool_maxsize=max_workers)
+        self.session.mount('https://', adapter)
+        self.session.mount('http://', adapter)
+        self._executor = ThreadPoolExecutor(max_workers=max_workers, thread_name_prefix=f'{self.source}-fetch')
+        self._cache_locks: Dict[str, threading.Lock] = {}
+        self._counter_lock = threading.Lock()
+
+    def close(self):
+        self._executor.shutdown(wait=False)
+        self.session.close()
+
+    # Request building, per API
+
+    def _first_request(self, ticker: str, timespan: str, start_ns: int, end_ns: int,
+                       page_limit: int) -> Tuple[str, dict, dict]:
+        """(url, params, headers) of the first page of [start_ns, end_ns]"""
+        raise NotImplementedError
+
+    def _next_request(self, first: Tuple[str, dict, dict], cursor: str) -> Tuple[str, dict, dict]:
+        """(url, params, headers) of the page after the one that returned cursor"""
+        raise NotImplementedError
+
+    # Fetching
+
+    def _get(self, url: str, params: dict, headers: dict) -> bytes:
+        for attempt in range(self.max_retries + 1):
+            self.bucket.acquire()
+            with self._counter_lock:
+                self.requests_made += 1
+            try:
+                response = self.session.get(url, params=params, headers=headers, timeout=self.timeout)
+            except (requests.ConnectionError, requests.Timeout) as e:
+                if attempt == self.max_retries:
+                    raise FetchError(f"Request failed: {e}") from e
+                time.sleep(min(2 ** attempt, 30))
+                continue
+            if response.status_code == 429 or response.status_code >= 500:
+                if attempt == self.max_retries:
+                    break
+                try:
+                    delay = float(response.headers['Retry-After'])
+                except (KeyError, ValueError):
+                    delay = min(2 ** attempt, 30)
+                if response.status_code == 429:
+                    self.bucket.pause(delay)
+                time.sleep(delay)
+                continue
+            if response.status_code != 200:
+                raise FetchError(f"API request failed with status code {response.status_code}: {response.text}")
+            return response.content
+        raise FetchError(f"API request failed with status code {response.status_code} "
+                         f"after {self.max_retries} retries: {response.text}")
+
+    def _fetch_chunk(self, ticker: str, timespan: str, start_ns: int, end_ns: int, page_limit: int) -> List[dict]:
+        """Every page of one chunk, decoded; bars at or after end_ns are dropped"""
+        parse = parse_bars if parse_bars is not None else py_parse_bars
+        first = self._first_request(ticker, timespan, start_ns, end_ns, page_limit)
+        request = first
+        pages = []
+        while True:
+            page = parse(self._get(*request))
+            if page['error'] and page['status'] not in ('OK', 'DELAYED'):
+                raise FetchError(f"API error for {ticker}: {page['error']}")
+            keep = (page['timestamp'] >= start_ns) & (page['timestamp'] < end_ns)
+            if not keep.all():
+                page = {**page, **{field: page[field][keep] for field in BAR_FIELDS}}
+            pages.append(page)
+            if not page['next']:
+                return pages
+            request = self._next_request(first, page['next'])
+
+    def fetch_many(self, tickers: Iterable[str], timespan: str, from_date: str, to_date: str,
+                   page_limit: Optional[int] = None) -> Dict[str, Dict[str, np.ndarray]]:
+        """
+        Bars of several tickers over the same dates, all chunks in flight at once
+
+        Args:
+            tickers: Symbols, spelled as the API expects
+            timespan: The API's bar timespan ('minute' / '1Min', ...)
+            from_date, to_date: YYYY-MM-DD, both days included (UTC)
+            page_limit: Bars per request (the API maximum by default)
+
+        Returns:
+            {ticker: {'timestamp': int64 epoch ns, 'open', 'high', 'low',
+            'close', 'volume': float64}}, sorted by timestamp
+
+        Raises:
+            FetchError: if a request fails after its retries
+        """
+        page_limit = min(page_limit or self.PAGE_LIMIT, self.PAGE_LIMIT)
+        start_ns, end_ns = date_range_ns(from_date, to_date)
+        now_ns = time.time_ns()
+        bar_ns = bar_duration_ns(timespan)
+        end_ns = min(end_ns, now_ns + bar_ns)
+        # Bars are sized for 24/7 markets, so a chunk is at most about one page
+        chunk_ns = max(NS_PER_DAY, page_limit * bar_ns // NS_PER_DAY * NS_PER_DAY)
+
+        jobs = {}
+        for ticker in dict.fromkeys(tickers):
+            cached, coverage = self._load_cache(ticker, timespan)
+            if coverage:
+                # Caches written before the coverage was capped may claim a tail they never received
+                coverage = (coverage[0], max(coverage[0], min(coverage[1], self._covered_end(
+                    cached, coverage[1], now_ns, bar_ns))))
+            missing = self._missing_ranges(start_ns, end_ns, coverage)
+            futures = [self._executor.submit(self._fetch_chunk, ticker, timespan, a, b, page_limit)
+                       for lo, hi in missing for a, b in split_range(lo, hi, chunk_ns)]
+            jobs[ticker] = (cached, coverage, missing, futures)
+
+        results = {}
+        for ticker, (cached, coverage, missing, futures) in jobs.items():
+            parts = [cached] if cached is not None else []
+            for future in futures:
+                parts.extend(future.result())
+            merged = _merge(parts)
+            if self.cache_dir and missing:
+                covered_start = min(start_ns, coverage[0]) if coverage else start_ns
+                covered_end = self._covered_end(merged, end_ns, now_ns, bar_ns)
+                covered = (covered_start, max(covered_end, coverage[1] if coverage else covered_start))
+                self._store_cache(ticker, timespan, merged, covered)
+            in_range = (merged['timestamp'] >= start_ns) & (merged['timestamp'] < end_ns)
+            results[ticker] = {field: merged[field][in_range] for field in BAR_FIELDS}
+        return results
+
+    def fetch(self, ticker: str, timespan: str, from_date: str, to_date: str,
+              page_limit: Optional[int] = None) -> Dict[str, np.ndarray]:
+        """fetch_many for one ticker"""
+        return self.fetch_many([ticker], timespan, from_date, to_date, page_limit)[ticker]
+
+    # Incremental cache
+
+    def _covered_end(self, bars: Dict[str, np.ndarray], end_ns: int, now_ns: int, bar_ns: int) -> int:
+        """
+        Where the coverage of a fetch up to end_ns may end: one bar after the
+        last bar received, and not past now less the forming bar and
+        coverage_lag, so a feed that stopped short is asked for the rest later
+        """
+        if len(bars['timestamp']) == 0:
+            return 0
+        settled = now_ns - bar_ns - int(self.coverage_lag * NS_PER_SECOND)
+        return min(end_ns, settled, int(bars['timestamp'][-1]) + bar_ns)
+
+    @staticmethod
+    def _missing_ranges(start_ns: int, end_ns: int, coverage: Optional[Tuple[int, int]]) -> List[Tuple[int, int]]:
+        """Parts of [start_ns, end_ns) outside coverage; gaps to coverage are filled to keep it contiguous"""
+        if coverage is None:
+            return [(start_ns, end_ns)] if start_ns < end_ns else []
+        covered_start, covered_end = coverage
+        missing = []
+        if start_ns < covered_start:
+            missing.append((start_ns, covered_start))
+        if end_ns > covered_end:
+            missing.append((covered_end, end_ns))
+        return missing
+
+    def _cache_file(self, ticker: str, timespan: str) -> str:
+        clean_ticker = ticker.replace(':', '_').replace('/', '_')
+        return os.path.join(self.cache_dir, f"{self.source}_{clean_ticker}_{timespan}.bars")
+
+    def _load_cache(self, ticker: str, timespan: str):
+        """(columns, (covered_start_ns, covered_end_ns)), or (None, None) without a usable cache"""
+        if not self.cache_dir:
+            return None, None
+        path = self._cache_file(ticker, timespan)
+        try:
+            with open(path + '.json') as f:
+                coverage = json.load(f)
+            _, columns = read_bar_file(path)
+        except (OSError, ValueError):
+            return None, None
+        bars = {field: np.array(columns[field]) for field in BAR_FIELDS}
+        bars['timestamp'] = bars['timestamp'].view(np.int64)
+        return bars, (int(coverage['start_ns']), int(coverage['end_ns']))
+
+    def _store_cache(self, ticker: str, timespan: str, bars: Dict[str, np.ndarray], coverage: Tuple[int, int]):
+        path = self._cache_file(ticker, timespan)
+        lock = self._cache_locks.setdefault(path, threading.Lock())
+        with lock:
+            try:
+                os.makedirs(self.cache_dir, exist_ok=True)
+                write_bar_file(path, *(bars[field] for field in BAR_FIELDS))
+                tmp_path = f"{path}.json.tmp.{os.getpid()}"
+                with open(tmp_path, 'w') as f:
+                    json.dump({'ticker': ticker, 'timespan': timespan,
+                               'start_ns': coverage[0], 'end_ns': coverage[1]}, f)
+                os.replace(tmp_path, path + '.json')
+            except OSError as e:
+                # A read-only cache directory only costs the incremental refresh
+                print(f"Warning: could not update bar cache {path}: {e}")
+
+
+def _merge(parts: List[dict]) -> Dict[str, np.ndarray]:
+    """Concatenate bar columns, sorted by timestamp; for duplicate timestamps the last part wins"""
+    if not parts:
+        return {field: np.empty(0, dtype=np.int64 if field == 'timestamp' else np.float64) for field in BAR_FIELDS}
+    merged = {field: np.concatenate([part[field] for part in parts]) for field in BAR_FIELDS}
+    # Stable sort keeps part order within a timestamp; keep the last of each run
+    order = np.argsort(merged['timestamp'], kind='stable')
+    timestamp = merged['timestamp'][order]
+    last = np.ones(len(timestamp), dtype=bool)
+    last[:-1] = timestamp[1:] != timestamp[:-1]
+    keep = order[last]
+    return {field: merged[field][keep] for field in BAR_FIELDS}
+
+
+class PolygonFetcher(HistoricalFetcher):
+    """
+    Polygon aggregates (/v2/aggs/ticker/{ticker}/range/1/{timespan}/{from}/{to})
+
+    Chunk bounds are sent as millisecond timestamps. The default rate suits
+    the paid plans; pass rate=5 / 60 for the free tier's 5 requests a minute.
+    """
+
+    source = 'polygon'
+    PAGE_LIMIT = 50000
+
+    def __init__(self, api_key: str, base_url: str = "https://api.polygon.io/v2/aggs/ticker", **kwargs):
+        super().__init__(**kwargs)
+        self.api_key = api_key
+        self.base_url = base_url
+
+    def _first_request(self, ticker, timespan, start_ns, end_ns, page_limit):
+        url = f"{self.base_url}/{ticker}/range/1/{timespan}/{start_ns // NS_PER_MS}/{end_ns // NS_PER_MS}"
+        params = {'adjusted': 'true', 'sort': 'asc', 'limit': page_limit, 'apiKey': self.api_key}
+        return url, params, {}
+
+    def _next_request(self, first, cursor):
+        # next_url carries the query except the key
+        return cursor, {'apiKey': self.api_key}, {}
+
+
+class AlpacaFetcher(HistoricalFetcher):
+    """
+    Alpaca market data bars (v1beta3 crypto, v2 stocks), one symbol per request
+
+    Alpaca allows 200 requests a minute on the free plan.
+    """
+
+    source = 'alpaca'
+    PAGE_LIMIT = 10000
+
+    def __init__(self, api_key: str, secret_key: str, base_url: str = "https://data.alpaca.markets",
+                 rate: float = 3.0, burst: int = 5, **kwargs):
+        super().__init__(rate=rate, burst=burst, **kwargs)
+        self.base_url = base_url
+        self.headers = {
+            "accept": "application/json",
+            "APCA-API-KEY-ID": api_key,
+            "APCA-API-SECRET-KEY": secret_key
+        }
+
+    @staticmethod
+    def _is_crypto(ticker: str) -> bool:
+        return '/' in ticker or ticker.upper().endswith('USD')
+
+    def _first_request(self, ticker, timespan, start_ns, end_ns, page_limit):
+        def rfc3339(ns):
+            return datetime.fromtimestamp(ns // NS_PER_SECOND, tz=timezone.utc).strftime('%Y-%m-%dT%H:%M:%SZ')
+        params = {
+            'symbols': ticker,
+            'timeframe': timespan,
+            'start': rfc3339(start_ns),
+            'end': rfc3339(end_ns),
+            'limit': page_limit,
+            'sort': 'asc',
+        }
+        if self._is_crypto(ticker):
+            url = f"{self.base_url}/v1beta3/crypto/us/bars"
+        else:
+            url = f"{self.base_url}/v2/stocks/bars"
+            params.update({'adjustment': 'raw', 'feed': 'sip'})
+        return url, params, self.headers
+
+    def _next_request(self, first, cursor):
+        url, params, headers = first
+        return url, {**params, 'page_token': cursor}, headers
@@ -4,6 +4,7 @@ import pandas as pd
 from typing import Optional
 from datetime import datetime
 from data_providers.base_provider import BaseDataProvider
+from data_providers.streaming import OandaPriceStream
 import time
 
 
@@ -140,13 +141,50 @@ class OandaProvider(BaseDataProvider):
 
     def stream_prices(self, ticker: str, callback, duration: int = None):
         """
-        Stream live prices (for future implementation)
+        Stream live prices over OANDA's persistent pricing stream
 
         Args:
             ticker: Currency pair
-            callback: Function to call with each price update
-            duration: How long to stream (None for infinite)
+            callback: Function to call with each price update (the raw PRICE message)
+            duration: How long to stream in seconds (None for infinite)
         """
-        # This would use OANDA's streaming API
-        # For now, we'll use polling in the live trading engine
-        pass
\ No newline at end of file
+        stream = OandaPriceStream(self.api, self.account_id, [self._instrument(ticker)],
+                                  price_callback=callback)
+        stream.start()
+        try:
+            if duration is None:
+                while stream.running:
+                    time.sleep(1)
+            else:
+                time.sleep(duration)
+        finally:
+            stream.stop()
+
+    def stream_bars(self, symbols, callback, interval_seconds: float = 60) -> OandaPriceStream:
+        """
+        Push bars assembled from the pricing stream's mid prices
+
+        Args:
+            symbols: Currency pair or list of pairs
+            callback: Called as callback(symbol, bar) when each bar closes,
+                on the stream's thread; symbol is spelled as passed in
+            interval_seconds: Bar length
+
+        Returns:
+            The started OandaPriceStream (call stop() to disconnect)
+        """
+        if isinstance(symbols, str):
+            symbols = [symbols]
+        names = {self._instrument(ticker): ticker for ticker in symbols}
+
+        def on_bar(instrument, bar):
+            callback(names.get(instrument, instrument), bar)
+
+        stream = OandaPriceStream(self.api, self.account_id, list(names), on_bar,
+                                  interval_seconds=interval_seconds)
+        return stream.start()
+
+    @staticmethod
+    def _instrument(ticker: str) -> str:
+        """EURUSD -> EUR_USD"""
+        return ticker if '_' in ticker else f"{ticker[:3]}_{ticker[3:]}"
@@ -1,8 +1,9 @@
 import pandas as pd
 import requests
 from datetime import datetime, timedelta
-from typing import Optional
+from typing import Dict, Iterable, Optional
 from .base_provider import BaseDataProvider
+from .fetcher import PolygonFetcher
 
 # Forex works exactly like crypto using the same REST API - no special client needed
 
@@ -10,40 +11,65 @@ from .base_provider import BaseDataProvider
 class PolygonDataProvider(BaseDataProvider):
     """Polygon.io data provider"""
     
-    def __init__(self, api_key: str):
+    def __init__(self, api_key: str, cache_dir: Optional[str] = None, **fetcher_options):
+        """
+        Args:
+            api_key: Polygon API key
+            cache_dir: Directory for the incremental bar cache (None: no cache)
+            fetcher_options: PolygonFetcher options (max_workers, rate, burst, ...)
+        """
         super().__init__(api_key)
         self.base_url = "https://api.polygon.io/v2/aggs/ticker"
-    
-    def get_data(self,
-                 ticker: str = 'C:EURUSD',
-                 timespan: str = 'minute',
-                 from_date: Optional[str] = None,
-                 to_date: Optional[str] = None,
-                 limit: int = 50000) -> pd.DataFrame:
-        """Get historical data from Polygon API"""
-
-        # Forex pairs work exactly like crypto - use the same REST API approach
+        self.fetcher = PolygonFetcher(api_key, self.base_url, cache_dir=cache_dir, **fetcher_options)
 
-        # Use default dates if not provided
+    @staticmethod
+    def _default_dates(from_date: Optional[str], to_date: Optional[str]):
         if not to_date:
             to_date = (datetime.now() - timedelta(days=1)).strftime('%Y-%m-%d')
         if not from_date:
             from_date = (datetime.now() - timedelta(days=365)).strftime('%Y-%m-%d')
+        return from_date, to_date
+
+    @staticmethod
+    def _bars_frame(bars: Dict) -> pd.DataFrame:
+        """Fetched columns in the format_dataframe layout (naive UTC timestamps)"""
+        return pd.DataFrame({
+            'Volume': bars['volume'],
+            'Open': bars['open'],
+            'Close': bars['close'],
+            'High': bars['high'],
+            'Low': bars['low'],
+            'timestamp': pd.to_datetime(bars['timestamp']),
+        })
 
-        url = (f"{self.base_url}/{ticker}/range/1/{timespan}/{from_date}/{to_date}"
-               f"?adjusted=true&sort=asc&limit={limit}&apiKey={self.api_key}")
-
-        response = requests.get(url)
-
-        if response.status_code != 200:
-            raise Exception(f"API request failed with status code {response.status_code}: {response.text}")
+    def get_data(self,
+                 ticker: str = 'C:EURUSD',
+                 timespan: str = 'minute',
+                 from_date: Optional[str] = None,
+                 to_date: Optional[str] = None,
+                 limit: int = 50000) -> pd.DataFrame:
+        """
+        Get historical data from Polygon API
 
-        data = response.json()
+        The range is fetched in parallel chunks and every page is followed, so
+        limit is the bars per request rather than a cap on the result. With a
+        cache_dir only the part of the range not cached yet is downloaded.
+        """
 
-        if not self.validate_response(data):
-            raise Exception("Invalid API response format")
+        # Forex pairs work exactly like crypto - use the same REST API approach
+        from_date, to_date = self._default_dates(from_date, to_date)
+        return self._bars_frame(self.fetcher.fetch(ticker, timespan, from_date, to_date, page_limit=limit))
 
-        return self.format_dataframe(data)
+    def get_data_many(self,
+                      tickers: Iterable[str],
+                      timespan: str = 'minute',
+                      from_date: Optional[str] = None,
+                      to_date: Optional[str] = None,
+                      limit: int = 50000) -> Dict[str, pd.DataFrame]:
+        """get_data for several tickers, with all of their requests in flight together"""
+        from_date, to_date = self._default_dates(from_date, to_date)
+        bars = self.fetcher.fetch_many(tickers, timespan, from_date, to_date, page_limit=limit)
+        return {ticker: self._bars_frame(columns) for ticker, columns in bars.items()}
 
     def get_live_data(self, ticker: str = 'C:EURUSD') -> pd.DataFrame:
         """Get current day data (simulates live data)"""
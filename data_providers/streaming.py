@@ -0,0 +1,396 @@
+"""
+Push-based market data streams for live trading
+
+A BarStream keeps one persistent connection open on a background thread,
+assembles fixed-interval OHLCV bars from the ticks it receives and hands
+each completed bar to a callback as soon as it closes:
+
+    callback(symbol, bar)   # bar: {'timestamp', 'Open', 'High', 'Low', 'Close', 'Volume'}
+
+AlpacaBarStream reads trades from Alpaca's market data WebSocket;
+OandaPriceStream reads the chunked HTTP pricing stream and uses the mid
+price, counting ticks as volume like OANDA's own candles. Both reconnect
+with exponential backoff. Bar assembly runs in native/bar_aggregator.h
+when the extension is built.
+
+AlpacaTradeUpdateStream reuses the same connection thread for the trading
+API's trade_updates stream: no bars, each order event is handed to the
+callback as it arrives (engines/order_gateway.py tracks fills with it).
+"""
+
+import json
+import threading
+import time
+from typing import Callable, Dict, Iterable, Optional
+
+import pandas as pd
+
+try:
+    from native.bar_aggregator import TickBarAggregator
+except ImportError:  # extension not built, use the Python aggregator
+    TickBarAggregator = None
+
+NS_PER_SECOND = 1_000_000_000
+
+
+class PyTickBarAggregator:
+    """Python version of native.bar_aggregator.TickBarAggregator"""
+
+    def __init__(self, interval_ns: int):
+        if interval_ns <= 0:
+            raise ValueError("interval must be positive")
+        self.interval_ns = interval_ns
+        self.dropped = 0
+        self._bar = None
+        self._last_emitted = None
+
+    @property
+    def has_open(self) -> bool:
+        return self._bar is not None
+
+    def on_tick(self, ts: int, price: float, size: float = 0.0):
+        if price != price:
+            return None
+        start = ts - ts % self.interval_ns
+        bar = self._bar
+        if (bar is not None and start < bar[0]) or (self._last_emitted is not None and start <= self._last_emitted):
+            self.dropped += 1
+            return None
+
+        closed = None
+        if bar is not None and start > bar[0]:
+            closed = self._emit()
+            bar = None
+
+        if bar is None:
+            self._bar = [start, price, price, price, price, size]
+        else:
+            bar[2] = max(bar[2], price)
+            bar[3] = min(bar[3], price)
+            bar[4] = price
+            bar[5] += size
+        return closed
+
+    def flush(self, now: int):
+        if self._bar is None or now < self._bar[0] + self.interval_ns:
+            return None
+        return self._emit()
+
+    def _emit(self):
+        bar = tuple(self._bar)
+        self._last_emitted = bar[0]
+        self._bar = None
+        return bar
+
+
+def make_aggregator(interval_seconds: float):
+    """Native tick aggregator when available, otherwise the Python one"""
+    aggregator = TickBarAggregator if TickBarAggregator is not None else PyTickBarAggregator
+    return aggregator(int(interval_seconds * NS_PER_SECOND))
+
+
+def _bar_dict(bar) -> dict:
+    start, open_, high, low, close, volume = bar
+    return {
+        'timestamp': pd.Timestamp(start, tz='UTC'),
+        'Open': open_,
+        'High': high,
+        'Low': low,
+        'Close': close,
+        'Volume': volume
+    }
+
+
+class BarStream:
+    """
+    Base class: connection thread, per-symbol bar assembly and reconnects
+
+    Subclasses implement _run_connection(), which blocks on one connection
+    and calls _on_tick()/_flush() until it drops or stop() is called.
+    """
+
+    reconnect_delay = 1.0
+    max_reconnect_delay = 60.0
+
+    def __init__(self,
+                 symbols: Iterable[str],
+                 callback: Callable[[str, dict], None],
+                 interval_seconds: float = 60):
+        self.symbols = list(symbols)
+        self.callback = callback
+        self.interval_seconds = interval_seconds
+        self._aggregators: Dict[str, object] = {}
+        self._stop = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+        self.connected = False
+        self.last_error = None
+        self.last_tick_ns = None  # receive time of the latest tick
+
+    @property
+    def running(self) -> bool:
+        return self._thread is not None and self._thread.is_alive()
+
+    def start(self):
+        """Open the connection on a background thread (returns immediately)"""
+        if self.running:
+            return self
+        self._stop.clear()
+        self._thread = threading.Thread(target=self._run, name=f"{type(self).__name__}", daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self, timeout: float = 5):
+        """Close the connection and wait for the thread to exit"""
+        self._stop.set()
+        self._close_connection()
+        if self._thread is not None:
+            self._thread.join(timeout=timeout)
+            self._thread = None
+        self.connected = False
+
+    def _run(self):
+        delay = self.reconnect_delay
+        while not self._stop.is_set():
+            try:
+                self._run_connection()
+                delay = self.reconnect_delay
+            except Exception as e:
+                if self._stop.is_set():
+                    break  # stop() closed the connection under us
+                self.last_error = e
+                print(f"{type(self).__name__} connection error: {e}")
+            self.connected = False
+            if self._stop.wait(delay):
+                break
+            delay = min(delay * 2, self.max_reconnect_delay)
+
+    def _run_connection(self):
+        raise NotImplementedError
+
+    def _close_connection(self):
+        """Unblock _run_connection from stop(); optional"""
+
+    def _on_tick(self, symbol: str, ts_ns: int, price: float, size: float = 0.0):
+        self.last_tick_ns = time.time_ns()
+        aggregator = self._aggregators.get(symbol)
+        if aggregator is None:
+            aggregator = self._aggregators[symbol] = make_aggregator(self.interval_seconds)
+        bar = aggregator.on_tick(ts_ns, price, size)
+        if bar is not None:
+            self._emit(symbol, bar)
+
+    def _flush(self, now_ns: int = None):
+        """Close bars whose interval has elapsed with no later tick"""
+        now_ns = time.time_ns() if now_ns is None else now_ns
+        for symbol, aggregator in self._aggregators.items():
+            bar = aggregator.flush(now_ns)
+            if bar is not None:
+                self._emit(symbol, bar)
+
+    def _emit(self, symbol: str, bar):
+        try:
+            self.callback(symbol, _bar_dict(bar))
+        except Exception as e:
+            print(f"Error in bar callback for {symbol}: {e}")
+
+
+class AlpacaBarStream(BarStream):
+    """Bars assembled from Alpaca's real-time trade WebSocket (crypto or stocks)"""
+
+    crypto_url = "wss://stream.data.alpaca.markets/v1beta3/crypto/us"
+    stock_url = "wss://stream.data.alpaca.markets/v2/{feed}"
+
+    def __init__(self,
+                 api_key: str,
+                 secret_key: str,
+                 symbols: Iterable[str],
+                 callback: Callable[[str, dict], None],
+                 interval_seconds: float = 60,
+                 crypto: bool = True,
+                 feed: str = 'sip'):
+        super().__init__(symbols, callback, interval_seconds)
+        self.api_key = api_key
+        self.secret_key = secret_key
+        self.url = self.crypto_url if crypto else self.stock_url.format(feed=feed)
+        self._ws = None
+
+    def _run_connection(self):
+        import websocket  # websocket-client, installed with alpaca-trade-api
+
+        ws = websocket.create_connection(self.url, timeout=10)
+        self._ws = ws
+        try:
+            self._expect(ws.recv(), 'success')  # connected
+            ws.send(json.dumps({'action': 'auth', 'key': self.api_key, 'secret': self.secret_key}))
+            self._expect(ws.recv(), 'success')  # authenticated
+            ws.send(json.dumps({'action': 'subscribe', 'trades': self.symbols}))
+            self.connected = True
+
+            # Short receive timeout so bars still close when trading is quiet
+            ws.settimeout(0.25)
+            while not self._stop.is_set():
+                try:
+                    message = ws.recv()
+                except websocket.WebSocketTimeoutException:
+                    self._flush()
+                    continue
+                if not message:
+                    break  # server closed the connection
+                for event in json.loads(message):
+                    kind = event.get('T')
+                    if kind == 't':
+                        self._on_tick(event['S'], pd.Timestamp(event['t']).value,
+                                      float(event['p']), float(event['s']))
+                    elif kind == 'error':
+                        raise ConnectionError(f"Alpaca stream error {event.get('code')}: {event.get('msg')}")
+                self._flush()
+        finally:
+            self._ws = None
+            ws.close()
+
+    def _close_connection(self):
+        ws = self._ws
+        if ws is not None:
+            try:
+                ws.close()
+            except Exception:
+                pass
+
+    @staticmethod
+    def _expect(message: str, kind: str):
+        events = json.loads(message)
+        for event in events:
+            if event.get('T') == 'error':
+                raise ConnectionError(f"Alpaca stream error {event.get('code')}: {event.get('msg')}")
+        if not any(event.get('T') == kind for event in events):
+            raise ConnectionError(f"Unexpected Alpaca stream message: {message}")
+
+
+class AlpacaTradeUpdateStream(BarStream):
+    """Order events from Alpaca's trading WebSocket (trade_updates), passed through as they arrive"""
+
+    paper_url = "wss://paper-api.alpaca.markets/stream"
+    live_url = "wss://api.alpaca.markets/stream"
+
+    def __init__(self,
+                 api_key: str,
+                 secret_key: str,
+                 callback: Callable[[dict], None],
+                 paper: bool = True,
+                 on_connect: Optional[Callable[[], None]] = None):
+        super().__init__([], callback)
+        self.api_key = api_key
+        self.secret_key = secret_key
+        self.url = self.paper_url if paper else self.live_url
+        self.on_connect = on_connect
+        self.last_event_ns = None  # receive time of the latest update
+        self._ws = None
+
+    def _run_connection(self):
+        import websocket  # websocket-client, installed with alpaca-trade-api
+
+        ws = websocket.create_connection(self.url, timeout=10)
+        self._ws = ws
+        try:
+            ws.send(json.dumps({'action': 'auth', 'key': self.api_key, 'secret': self.secret_key}))
+            reply = self._decode(ws.recv())
+            if reply.get('data', {}).get('status') != 'authorized':
+                raise ConnectionError(f"Alpaca trade stream authorization failed: {reply}")
+            ws.send(json.dumps({'action': 'listen', 'data': {'streams': ['trade_updates']}}))
+            self.connected = True
+            if self.on_connect is not None:
+                self.on_connect()
+
+            # Receive timeout only to notice stop()
+            ws.settimeout(1.0)
+            while not self._stop.is_set():
+                try:
+                    message = ws.recv()
+                except websocket.WebSocketTimeoutException:
+                    continue
+                if not message:
+                    break  # server closed the connection
+                update = self._decode(message)
+                if update.get('stream') != 'trade_updates':
+                    continue
+                self.last_event_ns = time.time_ns()
+                try:
+                    self.callback(update['data'])
+                except Exception as e:
+                    print(f"Error in trade update callback: {e}")
+        finally:
+            self._ws = None
+            ws.close()
+
+    def _close_connection(self):
+        ws = self._ws
+        if ws is not None:
+            try:
+                ws.close()
+            except Exception:
+                pass
+
+    @staticmethod
+    def _decode(message) -> dict:
+        # The paper endpoint sends binary frames
+        if isinstance(message, bytes):
+            message = message.decode()
+        return json.loads(message)
+
+
+class OandaPriceStream(BarStream):
+    """
+    Bars assembled from OANDA's chunked HTTP pricing stream (mid prices)
+
+    With price_callback set, each raw PRICE message is also passed through
+    as it arrives.
+    """
+
+    def __init__(self,
+                 api,
+                 account_id: str,
+                 symbols: Iterable[str],
+                 callback: Optional[Callable[[str, dict], None]] = None,
+                 interval_seconds: float = 60,
+                 price_callback: Optional[Callable[[dict], None]] = None):
+        super().__init__(symbols, callback, interval_seconds)
+        self.api = api
+        self.account_id = account_id
+        self.price_callback = price_callback
+        self._request = None
+
+    def _run_connection(self):
+        import oandapyV20.endpoints.pricing as pricing
+
+        request = pricing.PricingStream(accountID=self.account_id,
+                                        params={'instruments': ','.join(self.symbols)})
+        self._request = request
+        try:
+            # Heartbeats arrive every 5 seconds and drive the flush when no prices do
+            for message in self.api.request(request):
+                if self._stop.is_set():
+                    break
+                self.connected = True
+                kind = message.get('type')
+                if kind == 'PRICE':
+                    if self.price_callback is not None:
+                        self.price_callback(message)
+                    if self.callback is not None and message.get('bids') and message.get('asks'):
+                        mid = (float(message['bids'][0]['price']) + float(message['asks'][0]['price'])) / 2
+                        self._on_tick(message['instrument'], pd.Timestamp(message['time']).value, mid, 1.0)
+                if self.callback is not None:
+                    self._flush()
+        finally:
+            self._request = None
+
+    def _close_connection(self):
+        request = self._request
+        if request is not None:
+            try:
+                request.terminate("stream stopped")
+            except Exception:
+                pass
+
+    def _emit(self, symbol: str, bar):
+        if self.callback is not None:
+            super()._emit(symbol, bar)
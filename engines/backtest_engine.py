@@ -5,18 +5,31 @@ import matplotlib.pyplot as plt
 import plotly.graph_objects as go
 from plotly.subplots import make_subplots
 
+from engines.decimation import m4_indices, ohlc_buckets
+from engines.equity import drawdown
+from engines.latency import LATENCY, now_ns
+from engines.metrics import PyMetricsAccumulator, periods_per_year
+
+try:
+    from native import execution as native_execution
+except ImportError:  # extension not built, use the Python loop
+    native_execution = None
+
 
 class BacktestEngine:
     """Backtesting engine for trading strategies supporting stocks and crypto"""
 
-    def __init__(self, initial_balance: float = 10000, trading_mode: str = "long_only", symbol: str = "", position_percentage: float = 100.0, spread_pips: float = 0.0):
+    def __init__(self, initial_balance: float = 10000, trading_mode: str = "long_only", symbol: str = "", position_percentage: float = 100.0, spread_pips: float = 0.0, use_native: bool = True,
+                 latency=None):
         self.initial_balance = initial_balance
+        self.latency = latency if latency is not None else LATENCY  # engines/latency.py recorder
         self.trading_mode = trading_mode
         self.symbol = symbol
         self.position_percentage = position_percentage / 100.0
         self.is_crypto = '/' in symbol
         self.is_forex = symbol.startswith('C:')
         self.spread_pips = spread_pips
+        self.use_native = use_native and native_execution is not None
         self.reset()
     
     def reset(self):
@@ -28,6 +41,10 @@ class BacktestEngine:
         self.balance_history = []
         self.current_balance = self.initial_balance
         self.shares_held = 0
+        self.metrics = None  # online metrics of the last run (engines/metrics.py fields)
+        self.equity_curve = np.zeros(0)  # mark-to-market worth per bar of the last run
+        self._events = 0
+        self._run_trades = None
 
     def _calculate_account_worth_realized_only(self):
         """Calculate total account worth based on REALIZED gains/losses only"""
@@ -53,13 +70,16 @@ class BacktestEngine:
         else:
             return self.current_balance
     
-    def backtest(self, df: pd.DataFrame, strategy) -> pd.DataFrame:
+    def backtest(self, df: pd.DataFrame, strategy, record_trades: bool = True) -> pd.DataFrame:
         """
         Run backtest with given data and strategy
 
         Args:
             df: DataFrame with OHLCV data
             strategy: Strategy instance
+            record_trades: Build the trade DataFrame and the per-bar equity
+                curve; False (native path only) keeps just the online
+                metrics, see evaluate()
 
         Returns:
             DataFrame with trade results
@@ -67,7 +87,10 @@ class BacktestEngine:
         self.reset()
 
         # Generate signals
+        latency = self.latency
+        start = now_ns()
         df_with_signals = strategy.generate_signals(df)
+        latency.since('backtest.signal', start)
         signal_names = strategy.get_signal_names()
 
         buy_signal_col = signal_names['buy']
@@ -77,18 +100,94 @@ class BacktestEngine:
         self.df_with_signals = df_with_signals
         self.strategy = strategy
 
-        # Process each bar based on trading mode
+        bars_per_year = periods_per_year(df_with_signals['timestamp'])
+        if self.use_native:
+            start = now_ns()
+            self._run_trades = self._backtest_native(df_with_signals, buy_signal_col, sell_signal_col,
+                                                     record_trades, bars_per_year)
+            latency.since('backtest.native', start)
+            return self._run_trades
+
+        # Process each bar based on trading mode, feeding the metrics as it goes
+        metrics = PyMetricsAccumulator()
+        equity = np.empty(len(df_with_signals))
+        if len(df_with_signals) > 0:
+            equity[0] = self._calculate_account_worth(df_with_signals['Close'].iloc[0])
+            metrics.on_equity(equity[0])
         for i in range(1, len(df_with_signals)):
+            tick = now_ns()
             current_row = df_with_signals.iloc[i]
             buy_signal = current_row[buy_signal_col]
             sell_signal = current_row[sell_signal_col]
+            n_trades = len(self.trades)
 
             if self.trading_mode == "long_only":
                 self._process_long_only_signals(current_row, buy_signal, sell_signal, i)
             else:  # long_short mode
                 self._process_long_short_signals(current_row, buy_signal, sell_signal, i)
+            if len(self.trades) > n_trades:
+                latency.since('backtest.tick_to_trade', tick)
+
+            for trade in self.trades[n_trades:]:
+                if 'Profit' in trade:
+                    metrics.on_trade_close(trade['Profit'])
+            equity[i] = self._calculate_account_worth(current_row['Close'])
+            metrics.on_equity(equity[i])
+            latency.since('backtest.bar', tick)
+
+        self.metrics = metrics.result(bars_per_year)
+        self.equity_curve = equity
+        self._events = len(self.trades)
+        self._run_trades = pd.DataFrame(self.trades)
+        return self._run_trades
+
+    def evaluate(self, df: pd.DataFrame, strategy) -> Dict[str, Any]:
+        """
+        analyze_results() of a run without building the trade log
 
-        return pd.DataFrame(self.trades)
+        For parameter searches: the native core only accumulates metrics, so
+        no per-trade rows or DataFrame are allocated.
+        """
+        self.backtest(df, strategy, record_trades=False)
+        return self.analyze_results()
+
+    def _spread_cost(self) -> float:
+        """Spread as a price offset (forex only, JPY pairs quote in 0.01 pips)"""
+        if self.is_forex and self.spread_pips > 0:
+            pip_value = 0.0001 if 'JPY' not in self.symbol else 0.01
+            return self.spread_pips * pip_value
+        return 0.0
+
+    def _backtest_native(self, df_with_signals: pd.DataFrame, buy_signal_col: str, sell_signal_col: str,
+                         record_trades: bool = True, bars_per_year: float = 1.0) -> pd.DataFrame:
+        """Run the bar loop in the C++ execution core (native/execution.h)"""
+        result = native_execution.execute_signals(
+            df_with_signals['Close'].to_numpy(),
+            df_with_signals[buy_signal_col].to_numpy(),
+            df_with_signals[sell_signal_col].to_numpy(),
+            long_short=self.trading_mode != "long_only",
+            initial_balance=self.initial_balance,
+            position_fraction=self.position_percentage,
+            spread=self._spread_cost(),
+            record_trades=record_trades,
+            periods_per_year=bars_per_year,
+            record_equity=record_trades,
+        )
+
+        self.position = result.position
+        self.entry_price = result.entry_price
+        self.realized_gains = result.realized_gains
+        self.current_balance = result.current_balance
+        self.shares_held = result.shares_held
+        self.balance_history = result.balance.tolist()
+        self.metrics = result.metrics
+        self._events = result.events
+        if result.equity is not None:
+            self.equity_curve = result.equity
+
+        if len(result) == 0:
+            return pd.DataFrame(self.trades)
+        return result.to_frame(df_with_signals['timestamp'])
 
     def _process_long_only_signals(self, current_row, buy_signal, sell_signal, i):
         """Process signals for long-only trading mode with percentage-based position sizing"""
@@ -374,8 +473,16 @@ class BacktestEngine:
                     self.trades.append(trade_data)
                     self.balance_history.append(trade_data['Balance'])
     
-    def analyze_results(self, trade_df: pd.DataFrame) -> Dict[str, Any]:
-        """Analyze backtest results - only count completed trades with profit/loss"""
+    def analyze_results(self, trade_df: pd.DataFrame = None) -> Dict[str, Any]:
+        """
+        Analyze backtest results - only count completed trades with profit/loss
+
+        The frame the last backtest() returned (or None for that run) is
+        answered from the metrics accumulated during the run; any other trade
+        frame is reduced column by column.
+        """
+        if self.metrics is not None and (trade_df is None or trade_df is self._run_trades):
+            return self._analysis_from_metrics()
         if len(trade_df) == 0:
             return {
                 'num_trades': 0,
@@ -459,6 +566,39 @@ class BacktestEngine:
             'avg_loss': float(avg_loss)
         }
     
+    def _analysis_from_metrics(self) -> Dict[str, Any]:
+        """analyze_results() of the last run from its online metrics"""
+        m = self.metrics
+        num_trades = int(m['num_trades'])
+        if self._events == 0:
+            final_balance = float(self.initial_balance)
+        elif num_trades == 0:
+            final_balance = float(self.current_balance)  # the last trade's Balance
+        else:
+            final_balance = float(self.initial_balance + self.realized_gains)  # its Total_Account_Worth
+        net_returns = final_balance - self.initial_balance
+        analysis = {
+            'num_trades': num_trades,
+            'winrate': float(m['win_rate']),
+            'final_balance': final_balance,
+            'net_returns': float(net_returns),
+            'percent_return': float(net_returns / self.initial_balance * 100),
+            'avg_profit_per_trade': float(net_returns / num_trades) if num_trades > 0 else 0.0,
+            'largest_win': float(m['largest_win']),
+            'largest_loss': float(m['largest_loss']),
+        }
+        if num_trades > 0:
+            analysis.update({'expectancy': float(m['expectancy']), 'avg_win': float(m['avg_win']),
+                             'avg_loss': float(m['avg_loss'])})
+        analysis.update({
+            'profit_factor': float(m['profit_factor']),
+            'max_drawdown': float(m['max_drawdown']),
+            'max_drawdown_pct': float(m['max_drawdown_pct']),
+            'sharpe_ratio': float(m['sharpe']),
+            'sortino_ratio': float(m['sortino']),
+        })
+        return analysis
+
     def print_analysis(self, trade_df: pd.DataFrame):
         """Print analysis results with appropriate formatting"""
         analysis = self.analyze_results(trade_df)
@@ -495,6 +635,11 @@ class BacktestEngine:
                 print(f"Largest Win: ${analysis['largest_win']:.4f}")
                 print(f"Largest Loss: ${analysis['largest_loss']:.4f}")
 
+        if 'max_drawdown' in analysis:
+            print(f"Max Drawdown: {analysis['max_drawdown_pct']:.2f}% (mark-to-market)")
+            print(f"Profit Factor: {analysis['profit_factor']:.2f}")
+            print(f"Sharpe Ratio: {analysis['sharpe_ratio']:.2f}  Sortino Ratio: {analysis['sortino_ratio']:.2f}")
+
         # Performance rating
         if analysis['percent_return'] > 20:
             print("Excellent performance!")
@@ -505,8 +650,25 @@ class BacktestEngine:
         else:
             print("Strategy needs improvement.")
     
+    def equity_points(self, n_buckets: int = 2000):
+        """
+        The last run's mark-to-market equity reduced for a chart
+
+        Returns:
+            (times, equity, drawdown) for the M4 samples of n_buckets
+            buckets (m4_indices, as for the indicator lines), so peaks and
+            troughs are exact; times are bar timestamps (bar positions
+            without them)
+        """
+        indices = m4_indices(self.equity_curve, n_buckets)
+        if hasattr(self, 'df_with_signals') and 'timestamp' in self.df_with_signals.columns:
+            times = pd.to_datetime(self.df_with_signals['timestamp']).iloc[indices].to_numpy()
+        else:
+            times = indices
+        return times, self.equity_curve[indices], drawdown(self.equity_curve)[indices]
+
     def plot_results(self, trade_df: pd.DataFrame):
-        """Plot total worth vs trades placed"""
+        """Plot the per-bar equity curve, total worth vs trades placed and trade P&L"""
         if len(trade_df) == 0:
             print("No trades to plot")
             return
@@ -514,10 +676,20 @@ class BacktestEngine:
         # Create trade numbers (x-axis)
         trade_numbers = list(range(1, len(trade_df) + 1))
 
-        plt.figure(figsize=(12, 8))
+        plt.figure(figsize=(12, 11))
+
+        # Mark-to-market equity of every bar, downsampled to the figure width
+        plt.subplot(3, 1, 1)
+        times, equity, _ = self.equity_points()
+        plt.plot(times, equity, linewidth=1, color='blue')
+        plt.axhline(y=self.initial_balance, color='red', linestyle='--', alpha=0.7)
+        plt.title("Account Worth per Bar (Mark-to-Market)")
+        plt.ylabel("Account Worth ($)")
+        plt.grid(True, alpha=0.3)
+        plt.gca().yaxis.set_major_formatter(plt.FuncFormatter(lambda x, p: f'${x:,.0f}'))
 
-        # Main plot - Total Worth vs Trades
-        plt.subplot(2, 1, 1)
+        # Total Worth vs Trades
+        plt.subplot(3, 1, 2)
         plt.plot(trade_numbers, trade_df['Total_Account_Worth'],
                 marker='o', linestyle='-', linewidth=2, markersize=6, color='blue')
 
@@ -545,7 +717,7 @@ class BacktestEngine:
         ax.yaxis.set_major_formatter(plt.FuncFormatter(lambda x, p: f'${x:,.0f}'))
 
         # Profit/Loss bar chart
-        plt.subplot(2, 1, 2)
+        plt.subplot(3, 1, 3)
 
         # Extract profits/losses for completed trades only
         profits = []
@@ -599,38 +771,54 @@ class BacktestEngine:
             print(f"Error displaying chart: {e}")
             plt.close('all')
 
-    def plot_interactive_chart(self, trade_df: pd.DataFrame):
-        """Plot interactive candlestick chart with trade markers and strategy indicators using Plotly"""
+    def plot_interactive_chart(self, trade_df: pd.DataFrame, max_candles: int = 3000):
+        """
+        Plot interactive candlestick chart with trade markers and strategy indicators using Plotly
+
+        Args:
+            max_candles: Screen resolution of the price and volume panels;
+                longer runs are decimated (engines/decimation.py): each candle
+                aggregates an equal run of bars and indicator lines keep every
+                bucket's first, lowest, highest and last value. Trade markers
+                stay at their exact bars.
+        """
         if not hasattr(self, 'df_with_signals') or not hasattr(self, 'strategy'):
             print("No strategy data available for plotting")
             return
 
-        df = self.df_with_signals.copy()
+        df = self.df_with_signals
 
         # Prepare data for Plotly
         if 'timestamp' in df.columns:
-            df['datetime'] = pd.to_datetime(df['timestamp'])
+            times = pd.to_datetime(df['timestamp']).to_numpy()
         else:
-            df['datetime'] = df.index
+            times = np.asarray(df.index)
+
+        candles = ohlc_buckets(df['Open'], df['High'], df['Low'], df['Close'],
+                               df['Volume'] if 'Volume' in df.columns else None, max_candles)
+        candle_times = times[candles['index']]
+        if len(candle_times) < len(df):
+            print(f"Chart decimated: {len(df):,} bars shown as {len(candle_times):,} candles "
+                  f"(up to {int(candles['count'].max())} bars each)")
 
         # Create subplots with secondary y-axis for volume
         symbol_display = self.symbol if self.symbol else "Asset"
         fig = make_subplots(
-            rows=2, cols=1,
+            rows=3, cols=1,
             shared_xaxes=True,
             vertical_spacing=0.03,
-            subplot_titles=[f'{symbol_display} - {self.strategy.name} Strategy', 'Volume'],
-            row_heights=[0.7, 0.3]
+            subplot_titles=[f'{symbol_display} - {self.strategy.name} Strategy', 'Equity', 'Volume'],
+            row_heights=[0.6, 0.2, 0.2]
         )
 
         # Add candlestick chart
         fig.add_trace(
             go.Candlestick(
-                x=df['datetime'],
-                open=df['Open'],
-                high=df['High'],
-                low=df['Low'],
-                close=df['Close'],
+                x=candle_times,
+                open=candles['open'],
+                high=candles['high'],
+                low=candles['low'],
+                close=candles['close'],
                 name='OHLC',
                 showlegend=False
             ),
@@ -646,10 +834,12 @@ class BacktestEngine:
         for i, indicator in enumerate(indicators):
             if indicator in df.columns:
                 color = indicator_colors[i % len(indicator_colors)]
+                values = df[indicator].to_numpy(dtype=np.float64)
+                keep = m4_indices(values, max_candles)
                 fig.add_trace(
                     go.Scatter(
-                        x=df['datetime'],
-                        y=df[indicator],
+                        x=times[keep],
+                        y=values[keep],
                         mode='lines',
                         name=indicator,
                         line=dict(color=color, width=2),
@@ -659,99 +849,57 @@ class BacktestEngine:
                 )
 
         # Add trade markers
-        if len(trade_df) > 0:
-            buy_trades = trade_df[trade_df['Position'] == 1]
-            sell_trades = trade_df[trade_df['Position'] == -1]
-            close_trades = trade_df[trade_df['Action'] == 'CLOSE']
-
-            # Add buy markers
-            if len(buy_trades) > 0:
-                buy_times = []
-                buy_prices = []
-                for _, trade in buy_trades.iterrows():
-                    if 'Index' in trade and trade['Index'] < len(df):
-                        buy_times.append(df.iloc[trade['Index']]['datetime'])
-                        buy_prices.append(trade['Price'])
-
-                if buy_times:
-                    fig.add_trace(
-                        go.Scatter(
-                            x=buy_times,
-                            y=buy_prices,
-                            mode='markers',
-                            name='Buy Signals',
-                            marker=dict(
-                                symbol='triangle-up',
-                                size=12,
-                                color='green',
-                                line=dict(width=2, color='darkgreen')
-                            )
-                        ),
-                        row=1, col=1
-                    )
-
-            # Add sell markers
-            if len(sell_trades) > 0:
-                sell_times = []
-                sell_prices = []
-                for _, trade in sell_trades.iterrows():
-                    if 'Index' in trade and trade['Index'] < len(df):
-                        sell_times.append(df.iloc[trade['Index']]['datetime'])
-                        sell_prices.append(trade['Price'])
-
-                if sell_times:
+        if len(trade_df) > 0 and 'Index' in trade_df.columns:
+            index = trade_df['Index'].to_numpy(dtype=np.int64)
+            prices = trade_df['Price'].to_numpy(dtype=np.float64)
+            valid = (index >= 0) & (index < len(df))
+            markers = (
+                ('Buy Signals', trade_df['Position'].to_numpy() == 1,
+                 dict(symbol='triangle-up', size=12, color='green', line=dict(width=2, color='darkgreen'))),
+                ('Sell Signals', trade_df['Position'].to_numpy() == -1,
+                 dict(symbol='triangle-down', size=12, color='red', line=dict(width=2, color='darkred'))),
+                ('Close Position', trade_df['Action'].to_numpy() == 'CLOSE',
+                 dict(symbol='x', size=12, color='orange', line=dict(width=2, color='darkorange'))),
+            )
+            for name, selected, marker in markers:
+                selected = selected & valid
+                if selected.any():
                     fig.add_trace(
                         go.Scatter(
-                            x=sell_times,
-                            y=sell_prices,
+                            x=times[index[selected]],
+                            y=prices[selected],
                             mode='markers',
-                            name='Sell Signals',
-                            marker=dict(
-                                symbol='triangle-down',
-                                size=12,
-                                color='red',
-                                line=dict(width=2, color='darkred')
-                            )
+                            name=name,
+                            marker=marker
                         ),
                         row=1, col=1
                     )
 
-            # Add close markers
-            if len(close_trades) > 0:
-                close_times = []
-                close_prices = []
-                for _, trade in close_trades.iterrows():
-                    if 'Index' in trade and trade['Index'] < len(df):
-                        close_times.append(df.iloc[trade['Index']]['datetime'])
-                        close_prices.append(trade['Price'])
-
-                if close_times:
-                    fig.add_trace(
-                        go.Scatter(
-                            x=close_times,
-                            y=close_prices,
-                            mode='markers',
-                            name='Close Position',
-                            marker=dict(
-                                symbol='x',
-                                size=12,
-                                color='orange',
-                                line=dict(width=2, color='darkorange')
-                            )
-                        ),
-                        row=1, col=1
-                    )
+        # Add the mark-to-market equity curve (downsampled, highs and lows kept)
+        if len(self.equity_curve) == len(df):
+            times_eq, equity, _ = self.equity_points(max_candles)
+            fig.add_trace(
+                go.Scatter(
+                    x=times_eq,
+                    y=equity,
+                    mode='lines',
+                    name='Equity',
+                    line=dict(color='blue', width=1),
+                    showlegend=False
+                ),
+                row=2, col=1
+            )
 
-        # Add volume bars
+        # Add volume bars (summed per candle)
         fig.add_trace(
             go.Bar(
-                x=df['datetime'],
-                y=df['Volume'],
+                x=candle_times,
+                y=candles['volume'],
                 name='Volume',
                 marker_color='rgba(158,202,225,0.8)',
                 showlegend=False
             ),
-            row=2, col=1
+            row=3, col=1
         )
 
         # Update layout
@@ -772,8 +920,9 @@ class BacktestEngine:
 
         # Update y-axes
         fig.update_yaxes(title_text="Price", row=1, col=1)
-        fig.update_yaxes(title_text="Volume", row=2, col=1)
-        fig.update_xaxes(title_text="Time", row=2, col=1)
+        fig.update_yaxes(title_text="Equity", row=2, col=1)
+        fig.update_yaxes(title_text="Volume", row=3, col=1)
+        fig.update_xaxes(title_text="Time", row=3, col=1)
 
         # Show the plot
         try:
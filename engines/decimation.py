@@ -0,0 +1,130 @@
+"""
+Screen-resolution decimation for the backtest and live charts
+
+A chart is a few thousand pixels wide, so sending every bar of a 350k-bar
+minute backtest to Plotly only stalls the browser. These reduce a series to
+n_buckets horizontal buckets of equal bar counts (native/decimate.h when
+native/decimate is built, NumPy otherwise, same buckets either way):
+
+    ohlc_buckets  one candle per bucket: first open, highest high, lowest
+                  low, last close, summed volume
+    m4_indices    each bucket's first, minimum, maximum and last sample,
+                  which draws the same pixels as the full line
+    lttb_indices  one sample per bucket by Largest Triangle Three Buckets
+
+Series already within the limit come back unchanged.
+"""
+
+import numpy as np
+
+try:
+    from native import decimate as _native
+except ImportError:  # extension not built, use the NumPy versions
+    _native = None
+
+
+def _bounds(n: int, buckets: int) -> np.ndarray:
+    """Bucket boundaries: bucket b covers [bounds[b], bounds[b + 1])"""
+    return np.arange(buckets + 1, dtype=np.int64) * n // buckets
+
+
+def _ohlc_python(o, h, l, c, v, n_buckets):
+    n = len(c)
+    buckets = n if n_buckets <= 0 or n_buckets > n else n_buckets
+    bounds = _bounds(n, buckets)
+    starts, ends = bounds[:-1], bounds[1:]
+    volume = np.zeros(buckets) if v is None else np.add.reduceat(np.nan_to_num(v, nan=0.0), starts)
+    with np.errstate(invalid='ignore'):
+        return {
+            'index': starts,
+            'count': ends - starts,
+            'open': o[starts],
+            'high': np.fmax.reduceat(h, starts),
+            'low': np.fmin.reduceat(l, starts),
+            'close': c[ends - 1],
+            'volume': volume,
+        }
+
+
+def ohlc_buckets(open, high, low, close, volume=None, n_buckets: int = 2000) -> dict:
+    """
+    Aggregate bars into at most n_buckets candles
+
+    Returns:
+        dict of 'index' (first bar of each candle), 'count', 'open', 'high',
+        'low', 'close' and 'volume' arrays
+    """
+    columns = [np.ascontiguousarray(x, dtype=np.float64) for x in (open, high, low, close)]
+    if volume is not None:
+        volume = np.ascontiguousarray(volume, dtype=np.float64)
+    if _native is not None:
+        return _native.ohlc(*columns, volume, n_buckets)
+    if len(columns[3]) == 0:
+        empty = np.zeros(0)
+        return {'index': np.zeros(0, dtype=np.int64), 'count': np.zeros(0, dtype=np.int64),
+                'open': empty, 'high': empty, 'low': empty, 'close': empty, 'volume': empty}
+    return _ohlc_python(*columns, volume, n_buckets)
+
+
+def _m4_python(y: np.ndarray, n_buckets: int) -> np.ndarray:
+    n = len(y)
+    if n_buckets <= 0 or n <= 4 * n_buckets:
+        return np.arange(n, dtype=np.int64)
+    bounds = _bounds(n, n_buckets)
+    finite = ~np.isnan(y)
+    keep = []
+    for begin, end in zip(bounds[:-1].tolist(), bounds[1:].tolist()):
+        chunk = y[begin:end]
+        mask = finite[begin:end]
+        if mask.any():
+            lo = begin + int(np.argmin(np.where(mask, chunk, np.inf)))
+            hi = begin + int(np.argmax(np.where(mask, chunk, -np.inf)))
+        else:
+            lo = hi = begin
+        keep.extend(sorted({begin, lo, hi, end - 1}))
+    return np.asarray(keep, dtype=np.int64)
+
+
+def m4_indices(values, n_buckets: int = 2000) -> np.ndarray:
+    """Ascending indices of at most 4 * n_buckets samples keeping each bucket's ends and extremes"""
+    y = np.ascontiguousarray(values, dtype=np.float64)
+    if _native is not None:
+        return _native.m4(y, n_buckets)
+    return _m4_python(y, n_buckets)
+
+
+def _lttb_python(y: np.ndarray, n_out: int, x: np.ndarray = None) -> np.ndarray:
+    n = len(y)
+    if n_out < 3 or n <= n_out:
+        return np.arange(n, dtype=np.int64)
+    xs = np.arange(n, dtype=np.float64) if x is None else x
+    buckets = n_out - 2
+    bounds = 1 + _bounds(n - 2, buckets)
+    keep = [0]
+    a = 0
+    for b in range(buckets):
+        begin, end = int(bounds[b]), int(bounds[b + 1])
+        next_end = int(bounds[b + 2]) if b + 1 < buckets else n
+        ny = y[end:next_end]
+        mask = ~np.isnan(ny)
+        if mask.any():
+            cx, cy = xs[end:next_end][mask].mean(), ny[mask].mean()
+        else:
+            cx, cy = xs[next_end - 1], y[next_end - 1]
+        ax, ay = xs[a], y[a]
+        area = np.abs((ax - cx) * (y[begin:end] - ay) - (ax - xs[begin:end]) * (cy - ay))
+        area = np.where(np.isnan(area), -1.0, area)
+        a = begin + int(np.argmax(area))
+        keep.append(a)
+    keep.append(n - 1)
+    return np.asarray(keep, dtype=np.int64)
+
+
+def lttb_indices(values, n_out: int = 2000, x=None) -> np.ndarray:
+    """Ascending indices of n_out samples that keep the line's visual shape"""
+    y = np.ascontiguousarray(values, dtype=np.float64)
+    if x is not None:
+        x = np.ascontiguousarray(x, dtype=np.float64)
+    if _native is not None:
+        return _native.lttb(y, n_out, x)
+    return _lttb_python(y, n_out, x)
@@ -0,0 +1,27 @@
+"""
+Per-bar equity curves for the backtest charts
+
+BacktestEngine keeps the mark-to-market account worth of every bar (from
+the native execution core, or from its Python loop). drawdown derives its
+running drawdown, natively when native/execution is built and with NumPy
+otherwise; the charts reduce the curve with engines.decimation.m4_indices
+like any other line.
+"""
+
+import numpy as np
+
+try:
+    from native.execution import drawdown as _native_drawdown
+except ImportError:  # extension not built, use the NumPy version
+    _native_drawdown = None
+
+
+def drawdown(equity) -> np.ndarray:
+    """Running drawdown as a fraction of the running peak"""
+    equity = np.ascontiguousarray(equity, dtype=np.float64)
+    if _native_drawdown is not None:
+        return _native_drawdown(equity)
+    if len(equity) == 0:
+        return equity.copy()
+    peak = np.maximum.accumulate(equity)
+    return np.where(peak > 0, (peak - equity) / np.where(peak > 0, peak, 1.0), 0.0)
@@ -5,7 +5,7 @@ Uses the IB TWS API for order execution on forex pairs
 
 import time
 import threading
-from typing import Optional, Dict
+from typing import Callable, Optional, Dict
 from ibapi.client import EClient
 from ibapi.wrapper import EWrapper
 from ibapi.contract import Contract
@@ -27,6 +27,8 @@ class IBBroker(EWrapper, EClient):
         self.order_status = {}
         self.order_fill_events = {}  # Track fill events per order
         self._positions_lock = threading.Lock()  # Thread safety for positions
+        self._order_id_lock = threading.Lock()
+        self.order_listeners = []  # callback(event) for order status and executions
 
     # IB API Callbacks
     def nextValidId(self, orderId: int):
@@ -88,6 +90,42 @@ class IBBroker(EWrapper, EClient):
             if orderId in self.order_fill_events:
                 self.order_fill_events[orderId].set()
 
+        self._notify({
+            'event': 'status',
+            'order_id': str(orderId),
+            'status': status,
+            'filled_qty': float(filled),
+            'remaining': float(remaining),
+            'avg_fill_price': float(avgFillPrice)
+        })
+
+    def execDetails(self, reqId: int, contract: Contract, execution):
+        """Execution callback - one per fill"""
+        symbol = contract.symbol
+        if contract.secType == 'CASH':
+            symbol = f"{contract.symbol}_{contract.currency}"
+        self._notify({
+            'event': 'fill',
+            'order_id': str(execution.orderId),
+            'exec_id': execution.execId,
+            'symbol': symbol,
+            'side': 'buy' if execution.side == 'BOT' else 'sell',
+            'qty': float(execution.shares),
+            'price': float(execution.price),
+            'filled_qty': float(execution.cumQty)
+        })
+
+    def add_order_listener(self, callback: Callable[[dict], None]):
+        """Call callback(event) on the IB reader thread for every order status and execution"""
+        self.order_listeners.append(callback)
+
+    def _notify(self, event: dict):
+        for callback in self.order_listeners:
+            try:
+                callback(event)
+            except Exception as e:
+                print(f"Error in IB order listener: {e}")
+
     # Connection methods
     def connect_to_tws(self, host: str = '127.0.0.1', port: int = 7497, client_id: int = 1) -> bool:
         """
@@ -148,40 +186,58 @@ class IBBroker(EWrapper, EClient):
         contract.exchange = 'IDEALPRO'
         return contract
 
-    def buy(self, symbol: str, quantity: float, order_type: str = "market", limit_price: float = None) -> dict:
+    def place_order(self, symbol: str, quantity: float, action: str, order_type: str = "market",
+                    limit_price: float = None) -> int:
         """
-        Place buy order and wait for confirmation
+        Send an order without waiting for it (status and fills go to the order listeners)
 
         Args:
-            symbol: Currency pair
-            quantity: Quantity in base currency units (20000 = 20K)
-            order_type: 'market' or 'limit'
-            limit_price: Limit price (for limit orders)
+            action: 'BUY' or 'SELL'
 
         Returns:
-            Order details
+            The IB order id
         """
         if not self.connected or not self.next_order_id:
-            return {'status': 'failed', 'error': 'Not connected to IB TWS'}
+            raise ConnectionError('Not connected to IB TWS')
 
         contract = self.create_forex_contract(symbol)
 
         order = Order()
-        order.action = "BUY"
+        order.action = action.upper()
         order.totalQuantity = quantity
         order.orderType = "MKT" if order_type.lower() == "market" else "LMT"
 
         if order_type.lower() == "limit" and limit_price:
             order.lmtPrice = limit_price
 
-        order_id = self.next_order_id
-        self.next_order_id += 1
+        with self._order_id_lock:
+            order_id = self.next_order_id
+            self.next_order_id += 1
 
         # Create event to track this order
         self.order_fill_events[order_id] = threading.Event()
 
         # Place order
         self.placeOrder(order_id, contract, order)
+        return order_id
+
+    def buy(self, symbol: str, quantity: float, order_type: str = "market", limit_price: float = None) -> dict:
+        """
+        Place buy order and wait for confirmation
+
+        Args:
+            symbol: Currency pair
+            quantity: Quantity in base currency units (20000 = 20K)
+            order_type: 'market' or 'limit'
+            limit_price: Limit price (for limit orders)
+
+        Returns:
+            Order details
+        """
+        if not self.connected or not self.next_order_id:
+            return {'status': 'failed', 'error': 'Not connected to IB TWS'}
+
+        order_id = self.place_order(symbol, quantity, "BUY", order_type, limit_price)
 
         # Wait for order acknowledgment (shorter for market, longer for limit)
         timeout = 2 if order_type.lower() == "market" else 5
@@ -228,24 +284,7 @@ class IBBroker(EWrapper, EClient):
         if not self.connected or not self.next_order_id:
             return {'status': 'failed', 'error': 'Not connected to IB TWS'}
 
-        contract = self.create_forex_contract(symbol)
-
-        order = Order()
-        order.action = "SELL"
-        order.totalQuantity = quantity
-        order.orderType = "MKT" if order_type.lower() == "market" else "LMT"
-
-        if order_type.lower() == "limit" and limit_price:
-            order.lmtPrice = limit_price
-
-        order_id = self.next_order_id
-        self.next_order_id += 1
-
-        # Create event to track this order
-        self.order_fill_events[order_id] = threading.Event()
-
-        # Place order
-        self.placeOrder(order_id, contract, order)
+        order_id = self.place_order(symbol, quantity, "SELL", order_type, limit_price)
 
         # Wait for order acknowledgment (shorter for market, longer for limit)
         timeout = 2 if order_type.lower() == "market" else 5
@@ -387,4 +426,11 @@ class IBBroker(EWrapper, EClient):
         self.position_event.clear()
         self.reqPositions()
         self.position_event.wait(timeout=2)
-        self.cancelPositions()
\ No newline at end of file
+        self.cancelPositions()
+
+    def get_positions_snapshot(self) -> Dict[str, dict]:
+        """Refresh and copy every position: {symbol: {'qty', 'avg_entry_price'}}"""
+        self.refresh_positions()
+        with self._positions_lock:
+            return {symbol: {'qty': p['qty'], 'avg_entry_price': p['avg_entry_price']}
+                    for symbol, p in self.positions.items()}
@@ -0,0 +1,282 @@
+"""
+Hot-path latency histograms for the live and backtest engines
+
+Stages are timed with time.perf_counter_ns and recorded into HDR-style
+(log-linear) histograms: 64 sub-buckets per power of two, so any value
+from 1 ns to hours is kept within 1.6% in a fixed 3.7k-slot table, and
+percentiles come from the counts rather than from stored samples.
+
+Every thread records into its own histograms (created on the thread's first
+sample and registered once), so the hot path takes no lock; snapshot()
+merges the threads' tables when asked. A tick is the moment new data was in
+hand (poll returned or a pushed bar arrived); begin_tick() stamps it for
+the calling thread and trade() records tick_to_trade when an order call of
+that tick returns, which is the number to tune before raising the polling
+frequency or the symbol count.
+
+Stages recorded by the engines:
+
+  live      fetch, bar_queue, signal, validate, position, submit,
+            tick_to_trade, iteration; order_queue, ack, fill, tick_to_fill
+            (AsyncOrderGateway)
+  backtest  backtest.signal, backtest.bar, backtest.tick_to_trade, backtest.native,
+            backtest.portfolio
+
+Export is pull-based (snapshot(), or serve() for an HTTP JSON endpoint) or
+a periodic JSON-lines dump (start_dump()). BAT_LATENCY=0 in the environment
+turns recording off.
+"""
+
+import json
+import os
+import threading
+import time
+from contextlib import contextmanager
+from typing import Dict, List, Optional
+
+SUB_BUCKET_BITS = 7
+SUB_BUCKETS = 1 << SUB_BUCKET_BITS
+HALF_BUCKETS = SUB_BUCKETS >> 1
+N_BUCKETS = SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * HALF_BUCKETS
+PERCENTILES = (50, 90, 99, 99.9)
+
+now_ns = time.perf_counter_ns
+
+
+def bucket_index(value: int) -> int:
+    """Log-linear bucket of a non-negative integer"""
+    if value < SUB_BUCKETS:
+        return value
+    shift = value.bit_length() - SUB_BUCKET_BITS
+    return SUB_BUCKETS + (shift - 1) * HALF_BUCKETS + (value >> shift) - HALF_BUCKETS
+
+
+def bucket_value(index: int) -> int:
+    """Middle of a bucket's value range"""
+    if index < SUB_BUCKETS:
+        return index
+    shift = (index - SUB_BUCKETS) // HALF_BUCKETS + 1
+    mantissa = (index - SUB_BUCKETS) % HALF_BUCKETS + HALF_BUCKETS
+    return (mantissa << shift) + ((1 << shift) >> 1)
+
+
+class LatencyHistogram:
+    """Log-linear histogram of nanosecond durations (one writer thread)"""
+
+    __slots__ = ('counts', 'count', 'total', 'min', 'max')
+
+    def __init__(self):
+        self.counts = [0] * N_BUCKETS
+        self.count = 0
+        self.total = 0
+        self.min = None
+        self.max = 0
+
+    def record(self, value: int):
+        if value < 0:
+            value = 0
+        self.counts[bucket_index(value)] += 1
+        self.count += 1
+        self.total += value
+        if self.min is None or value < self.min:
+            self.min = value
+        if value > self.max:
+            self.max = value
+
+    def merge(self, other: 'LatencyHistogram'):
+        counts = self.counts
+        for i, c in enumerate(other.counts):
+            if c:
+                counts[i] += c
+        self.count += other.count
+        self.total += other.total
+        if other.min is not None and (self.min is None or other.min < self.min):
+            self.min = other.min
+        self.max = max(self.max, other.max)
+
+    def percentile(self, q: float) -> Optional[int]:
+        """Value at percentile q (0-100), clamped to the exact min and max"""
+        if not self.count:
+            return None
+        rank = max(1, int(round(q / 100.0 * self.count)))
+        seen = 0
+        for i, c in enumerate(self.counts):
+            seen += c
+            if seen >= rank:
+                return min(max(bucket_value(i), self.min), self.max)
+        return self.max
+
+    def summary(self) -> Dict[str, float]:
+        """count, mean, min, percentiles and max in microseconds"""
+        if not self.count:
+            return {'count': 0}
+        out = {'count': self.count, 'mean_us': self.total / self.count / 1e3, 'min_us': self.min / 1e3}
+        for q in PERCENTILES:
+            out[f'p{q:g}_us'] = self.percentile(q) / 1e3
+        out['max_us'] = self.max / 1e3
+        return out
+
+
+class LatencyRecorder:
+    """Per-thread stage histograms with a merged view"""
+
+    def __init__(self, enabled: bool = True):
+        self.enabled = enabled
+        self._local = threading.local()
+        self._lock = threading.Lock()  # registration and reset only
+        self._tables: List[Dict[str, LatencyHistogram]] = []
+        self._generation = 0
+        self._dumper: Optional[threading.Thread] = None
+        self._dump_stop = threading.Event()
+        self._server = None
+
+    def _table(self) -> Dict[str, LatencyHistogram]:
+        local = self._local
+        table = getattr(local, 'table', None)
+        if table is None or local.generation != self._generation:
+            table = {}
+            with self._lock:
+                self._tables.append(table)
+                local.generation = self._generation
+            local.table = table
+        return table
+
+    def record(self, stage: str, elapsed_ns: int):
+        if not self.enabled:
+            return
+        table = self._table()
+        histogram = table.get(stage)
+        if histogram is None:
+            histogram = table[stage] = LatencyHistogram()
+        histogram.record(elapsed_ns)
+
+    def since(self, stage: str, start_ns: int) -> int:
+        """Record now - start_ns under stage; returns now"""
+        end = now_ns()
+        self.record(stage, end - start_ns)
+        return end
+
+    @contextmanager
+    def span(self, stage: str):
+        start = now_ns()
+        try:
+            yield
+        finally:
+            self.record(stage, now_ns() - start)
+
+    # Ticks
+
+    def begin_tick(self, stamp_ns: Optional[int] = None) -> int:
+        """Mark the calling thread's data arrival (now by default)"""
+        stamp = now_ns() if stamp_ns is None else stamp_ns
+        self._local.tick = stamp
+        return stamp
+
+    def current_tick(self) -> Optional[int]:
+        return getattr(self._local, 'tick', None)
+
+    def trade(self, stage: str = 'tick_to_trade'):
+        """Record the time since the calling thread's tick, if one is open"""
+        tick = getattr(self._local, 'tick', None)
+        if tick is not None:
+            self.record(stage, now_ns() - tick)
+
+    # Export
+
+    def histograms(self) -> Dict[str, LatencyHistogram]:
+        """Every thread's histograms merged per stage"""
+        with self._lock:
+            tables = list(self._tables)
+        merged: Dict[str, LatencyHistogram] = {}
+        for table in tables:
+            for stage, histogram in list(table.items()):
+                merged.setdefault(stage, LatencyHistogram()).merge(histogram)
+        return merged
+
+    def snapshot(self) -> Dict[str, Dict[str, float]]:
+        """Per-stage summaries in microseconds"""
+        return {stage: histogram.summary() for stage, histogram in sorted(self.histograms().items())}
+
+    def reset(self):
+        """Drop all samples; threads start fresh tables on their next sample"""
+        with self._lock:
+            self._tables = []
+            self._generation += 1
+
+    def format(self, stages=None) -> str:
+        """One line per stage: count, p50, p99 and max in milliseconds"""
+        lines = []
+        for stage, s in self.snapshot().items():
+            if (stages is None or stage in stages) and s['count']:
+                lines.append(f"{stage:<22} n={s['count']:<7} p50={s['p50_us'] / 1e3:9.3f}ms "
+                             f"p99={s['p99_us'] / 1e3:9.3f}ms max={s['max_us'] / 1e3:9.3f}ms")
+        return "\n".join(lines)
+
+    def dump(self, path: str):
+        """Append one JSON line {time, stages} to path"""
+        directory = os.path.dirname(path)
+        if directory:
+            os.makedirs(directory, exist_ok=True)
+        with open(path, 'a') as f:
+            f.write(json.dumps({'time': time.time(), 'stages': self.snapshot()}) + "\n")
+
+    def start_dump(self, path: str, interval: float = 60.0):
+        """Dump to path every interval seconds from a daemon thread"""
+        self.stop_dump()
+        self._dump_stop.clear()
+
+        def loop():
+            while not self._dump_stop.wait(interval):
+                try:
+                    self.dump(path)
+                except OSError as e:
+                    print(f"Latency dump failed: {e}")
+            self.dump(path)
+
+        self._dumper = threading.Thread(target=loop, name="latency-dump", daemon=True)
+        self._dumper.start()
+
+    def stop_dump(self):
+        if self._dumper is not None:
+            self._dump_stop.set()
+            self._dumper.join(timeout=5)
+            self._dumper = None
+
+    def serve(self, port: int = 9108, host: str = "127.0.0.1"):
+        """
+        Serve snapshot() as JSON at http://host:port/ from a daemon thread
+
+        GET /reset drops the samples after returning them.
+        """
+        from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+        recorder = self
+
+        class Handler(BaseHTTPRequestHandler):
+            def do_GET(self):
+                body = json.dumps(recorder.snapshot()).encode()
+                if self.path.rstrip('/') == '/reset':
+                    recorder.reset()
+                self.send_response(200)
+                self.send_header('Content-Type', 'application/json')
+                self.send_header('Content-Length', str(len(body)))
+                self.end_headers()
+                self.wfile.write(body)
+
+            def log_message(self, *args):
+                pass
+
+        self.stop_serving()
+        self._server = ThreadingHTTPServer((host, port), Handler)
+        threading.Thread(target=self._server.serve_forever, name="latency-http", daemon=True).start()
+        return self._server.server_address
+
+    def stop_serving(self):
+        if self._server is not None:
+            self._server.shutdown()
+            self._server.server_close()
+            self._server = None
+
+
+# Shared by the engines and the order gateway unless they are given their own
+LATENCY = LatencyRecorder(enabled=os.environ.get('BAT_LATENCY', '1') != '0')
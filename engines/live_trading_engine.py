@@ -1,7 +1,10 @@
+import queue
+import threading
 import time
 import pandas as pd
 from typing import Dict, Any, Optional, Callable, List
 from data_providers.base_provider import BaseDataProvider
+from engines.latency import LATENCY, LatencyRecorder, now_ns
 from datetime import datetime
 import logging
 
@@ -14,13 +17,16 @@ class LiveTradingEngine:
                  broker_interface: Optional[object] = None,
                  initial_balance: float = 10000,
                  trading_mode: str = "long_only",
-                 position_percentage: float = 100.0):
+                 position_percentage: float = 100.0,
+                 latency: Optional[LatencyRecorder] = None):
         self.data_provider = data_provider
+        self.latency = latency if latency is not None else LATENCY
         self.broker_interface = broker_interface
         self.initial_balance = initial_balance
         self.trading_mode = trading_mode
         self.position_percentage = position_percentage / 100.0  # Convert to decimal
         self.reset()
+        self._attach_order_events()
 
         # Setup logging
         logging.basicConfig(level=logging.INFO)
@@ -46,6 +52,17 @@ class LiveTradingEngine:
         self.pending_orders = {}  # Track pending limit orders by order_id
         self.order_timestamps = {}  # Track order placement times
 
+        # Gateway orders queued but not finished: booked as trades on their fill
+        self._order_lock = threading.Lock()
+        self.working_orders = {}  # order id -> the trade it will record
+        self._finished_early = {}  # completions that arrived before the id was registered
+        self._order_symbols = set()  # symbols this engine sent orders for (a shared gateway reports all)
+
+        # Streaming (strategy.on_bar) state per symbol
+        self._stream_bars = {}  # Bars fed through on_bar
+        self._stream_last_ts = {}  # Timestamp of the last streamed bar
+        self._last_stream_row = {}  # Latest on_bar row
+
     def _print_trade_msg(self, message: str, quiet_alternative: str = None):
         """Print trade message with quiet mode support"""
         if not self.quiet_mode:
@@ -56,9 +73,82 @@ class LiveTradingEngine:
     def set_broker_interface(self, broker_interface):
         """Set the broker interface for live trading"""
         self.broker_interface = broker_interface
+        self._attach_order_events()
+
+    def _attach_order_events(self):
+        """Ask an asynchronous gateway to report finished orders (AsyncOrderGateway)"""
+        self._async_orders = hasattr(self.broker_interface, 'add_completion_listener')
+        if self._async_orders and getattr(self, '_listening_to', None) is not self.broker_interface:
+            self.broker_interface.add_completion_listener(self._on_order_done)
+            self._listening_to = self.broker_interface
+
+    def _append_trade(self, timestamp, action: str, price: float, quantity: float, order_details: dict):
+        self.trades.append({
+            'timestamp': timestamp,
+            'action': action,
+            'price': price,
+            'quantity': quantity,
+            'order_details': order_details
+        })
+
+        # DEBUG: Backend trade logging
+        print(f"\n[BACKEND] Trade recorded:")
+        print(f"  Timestamp: {timestamp}")
+        print(f"  Action: {action}")
+        print(f"  Price: ${price:.2f}")
+        print(f"  Quantity: {quantity}")
+
+    def _record_trade(self, timestamp, action: str, price: float, quantity: float, result: dict) -> bool:
+        """
+        Book an accepted order as a trade
+
+        A synchronous broker has filled it by now. An order the gateway only
+        queued (pending_new and later working states) is booked when it fills,
+        at its fill price and filled quantity, and never if it is rejected.
+
+        Returns:
+            True when the trade was recorded now
+        """
+        order_id = result.get('id')
+        if not self._async_orders or result.get('status') == 'filled' or order_id is None:
+            self._append_trade(timestamp, action, price, quantity, result)
+            return True
+        with self._order_lock:
+            working = {'timestamp': timestamp, 'action': action, 'price': price, 'quantity': quantity}
+            finished = self._finished_early.pop(order_id, None)
+            if finished is None:
+                self.working_orders[order_id] = working
+        if finished is not None:
+            self._book_finished(working, finished)
+            return finished.get('status') == 'filled'
+        return False
+
+    def _on_order_done(self, order: dict):
+        """Gateway callback (its event or sender thread): an order filled, was rejected or canceled"""
+        with self._order_lock:
+            working = self.working_orders.pop(order['id'], None)
+            if working is None:
+                if order.get('symbol') not in self._order_symbols:
+                    return
+                self._finished_early[order['id']] = order
+                while len(self._finished_early) > 1000:
+                    self._finished_early.pop(next(iter(self._finished_early)))
+                return
+        self._book_finished(working, order)
+
+    def _book_finished(self, working: dict, order: dict):
+        filled_qty = float(order.get('filled_qty') or 0)
+        if filled_qty > 0:
+            self._append_trade(working['timestamp'], working['action'],
+                               float(order.get('avg_fill_price') or working['price']), filled_qty, order)
+        if order.get('status') != 'filled':
+            print(f" ORDER {str(order.get('status')).upper()} - {working['action']} {working['quantity']} "
+                  f"{order.get('symbol', '')}: {filled_qty} filled"
+                  + (f" ({order['error']})" if order.get('error') else ""))
     
     def execute_buy_order(self, symbol: str, quantity: float = 1, order_type: str = "market", limit_price: float = None, current_price: float = None) -> dict:
         """Execute buy order and return order details"""
+        self._order_symbols.add(symbol)
         try:
             # Debug logging
             if self.broker_interface:
@@ -67,11 +157,14 @@ class LiveTradingEngine:
                 print(f"[DEBUG] Executing BUY via {broker_type}")
 
             if self.broker_interface:
+                start = now_ns()
                 if order_type == "limit" and limit_price is not None:
                     # For limit orders, pass the limit price to the broker interface
                     result = self.broker_interface.buy(symbol, quantity, order_type="limit", limit_price=limit_price, current_price=current_price)
                 else:
                     result = self.broker_interface.buy(symbol, quantity, order_type=order_type, current_price=current_price)
+                self.latency.since('submit', start)
+                self.latency.trade()
 
                 # Track pending limit orders
                 if order_type == "limit" and isinstance(result, dict) and 'id' in result:
@@ -92,6 +185,7 @@ class LiveTradingEngine:
 
     def execute_sell_order(self, symbol: str, quantity: float = 1, order_type: str = "market", limit_price: float = None, current_price: float = None) -> dict:
         """Execute sell order and return order details"""
+        self._order_symbols.add(symbol)
         try:
             # Debug logging
             if self.broker_interface:
@@ -100,11 +194,14 @@ class LiveTradingEngine:
                 print(f"[DEBUG] Executing SELL via {broker_type}")
 
             if self.broker_interface:
+                start = now_ns()
                 if order_type == "limit" and limit_price is not None:
                     # For limit orders, pass the limit price to the broker interface
                     result = self.broker_interface.sell(symbol, quantity, order_type="limit", limit_price=limit_price, current_price=current_price)
                 else:
                     result = self.broker_interface.sell(symbol, quantity, order_type=order_type, current_price=current_price)
+                self.latency.since('submit', start)
+                self.latency.trade()
 
                 # Track pending limit orders
                 if order_type == "limit" and isinstance(result, dict) and 'id' in result:
@@ -125,9 +222,13 @@ class LiveTradingEngine:
 
     def close_position(self, symbol: str, current_price: float = None) -> dict:
         """Close position using Alpaca close position API - always use market orders"""
+        self._order_symbols.add(symbol)
         try:
             if self.broker_interface and hasattr(self.broker_interface, 'close_position'):
+                start = now_ns()
                 result = self.broker_interface.close_position(symbol, current_price=current_price)
+                self.latency.since('submit', start)
+                self.latency.trade()
                 return result if isinstance(result, dict) else {'status': 'executed', 'details': result}
             else:
                 return {'status': 'simulated', 'symbol': symbol, 'action': 'close_position'}
@@ -246,6 +347,24 @@ class LiveTradingEngine:
         except Exception:
             return False
 
+    def _validate_signal_row(self, row: Dict[str, Any], strategy, n_bars: int) -> bool:
+        """
+        _validate_signals for a streamed row; strategy.validate_signal_conditions
+        needs the full DataFrame and is only applied on the batch path
+        """
+        try:
+            if n_bars < strategy.get_required_lookback():
+                return False
+
+            signal_names = strategy.get_signal_names()
+            if row[signal_names['buy']] and row[signal_names['sell']]:
+                return False
+
+            return True
+
+        except Exception:
+            return False
+
     def _confirm_trade_execution(self, action: str, symbol: str, quantity: float,
                                current_price: float, position_data: dict) -> bool:
         """Final confirmation before executing trades - verify sufficient funds"""
@@ -293,11 +412,85 @@ class LiveTradingEngine:
             return
         
         # Get signals from strategy
+        start = now_ns()
         df_with_signals = strategy.generate_signals(df)
-        signal_names = strategy.get_signal_names()
-        
-        # Get latest signals
+        start = self.latency.since('signal', start)
+
+        # Act on the latest signals
         latest_row = df_with_signals.iloc[-1]
+        signals_valid = self._validate_signals(df_with_signals, strategy)
+        self.latency.since('validate', start)
+        self._act_on_signal_row(latest_row, strategy, symbol, quantity, signals_valid)
+
+    def process_bar(self,
+                    bar: Dict[str, Any],
+                    strategy,
+                    symbol: str,
+                    quantity: float = None) -> Dict[str, Any]:
+        """
+        Streaming counterpart of process_signals: feed one new bar through
+        strategy.on_bar and act on its signals, without recomputing the window
+
+        Returns:
+            The strategy's row for the bar (indicator and signal values)
+        """
+        start = now_ns()
+        row = strategy.on_bar(bar)
+        self.latency.since('signal', start)
+        n_bars = self._stream_bars.get(symbol, 0) + 1
+        self._stream_bars[symbol] = n_bars
+        self.process_signal_row(row, strategy, symbol, quantity, n_bars)
+        return row
+
+    def process_signal_row(self,
+                           row: Dict[str, Any],
+                           strategy,
+                           symbol: str,
+                           quantity: float = None,
+                           n_bars: int = None):
+        """
+        Act on a row the caller already produced with strategy.on_bar
+
+        Args:
+            n_bars: Bars streamed so far, checked against the strategy's lookback
+        """
+        self._last_stream_row[symbol] = row
+        if n_bars is None:
+            n_bars = self._stream_bars.get(symbol, 0)
+        start = now_ns()
+        signals_valid = self._validate_signal_row(row, strategy, n_bars)
+        self.latency.since('validate', start)
+        self._act_on_signal_row(row, strategy, symbol, quantity, signals_valid)
+
+    def _process_new_bars(self, df: pd.DataFrame, strategy, symbol: str, quantity: float = None):
+        """Stream the bars of a lookback window that have not been seen yet through the strategy"""
+        if len(df) == 0:
+            return
+
+        last_ts = self._stream_last_ts.get(symbol)
+        if last_ts is None:
+            # First window: start from a fresh indicator state and warm it up
+            strategy.reset_stream()
+            new_bars = df.to_dict('records')
+        else:
+            new_bars = df[pd.to_datetime(df['timestamp']) > last_ts].to_dict('records')
+
+        if not new_bars:
+            # No new bar yet: re-check the latest signals, as the batch path does every iteration
+            row = self._last_stream_row.get(symbol)
+            if row is not None:
+                self.process_signal_row(row, strategy, symbol, quantity)
+            return
+
+        for bar in new_bars[:-1]:
+            self._last_stream_row[symbol] = strategy.on_bar(bar)
+            self._stream_bars[symbol] = self._stream_bars.get(symbol, 0) + 1
+        self._stream_last_ts[symbol] = pd.to_datetime(new_bars[-1]['timestamp'])
+        self.process_bar(new_bars[-1], strategy, symbol, quantity)
+
+    def _act_on_signal_row(self, latest_row, strategy, symbol: str, quantity: float, signals_valid: bool):
+        """Execute the buy/sell signals of one strategy row"""
+        signal_names = strategy.get_signal_names()
         buy_signal = latest_row[signal_names['buy']]
         sell_signal = latest_row[signal_names['sell']]
         
@@ -305,6 +498,7 @@ class LiveTradingEngine:
         timestamp = latest_row['timestamp']
 
         # Calculate quantity based on position percentage if not provided
+        start = now_ns()
         if quantity is None:
             account_info = self.get_alpaca_account()
             account_balance = float(account_info.get('equity', self.initial_balance))
@@ -335,6 +529,7 @@ class LiveTradingEngine:
         # Get current position from broker (IB or Alpaca)
         alpaca_position = self.get_alpaca_position(symbol)
         current_qty = float(alpaca_position['qty'])
+        self.latency.since('position', start)
 
         # ALWAYS log position check for debugging
         if buy_signal or sell_signal:
@@ -361,7 +556,6 @@ class LiveTradingEngine:
             print(f"     Current Price: ${current_price:.2f}")
 
         # Validate signals before acting
-        signals_valid = self._validate_signals(df_with_signals, strategy)
         if not signals_valid:
             if buy_signal or sell_signal:
                 print(f"     SIGNAL VALIDATION FAILED - Signal rejected")
@@ -425,6 +619,7 @@ class LiveTradingEngine:
                 # Open long position with MARKET order for reliable execution
                 result = self.execute_buy_order(symbol, quantity, order_type="market", current_price=current_price)
                 if result.get('status') not in ['failed', 'pending']:
+                    filled = self._record_trade(timestamp, 'buy_long', current_price, quantity, result)
                     # Force position refresh for IB broker
                     if hasattr(self.broker_interface, 'refresh_positions'):
                         self.broker_interface.refresh_positions()
@@ -435,27 +630,12 @@ class LiveTradingEngine:
                     updated_session_pnl = updated_balance - self.initial_balance
 
                     if not getattr(self, 'quiet_mode', False):
-                        print(f" BUY ORDER FILLED - {quantity} {symbol} at market")
-                        print(f"     Fill Price: ${result.get('avg_fill_price', current_price):.5f}")
+                        print(f" BUY ORDER {'FILLED' if filled else 'SENT'} - {quantity} {symbol} at market")
+                        if filled:
+                            print(f"     Fill Price: ${result.get('avg_fill_price', current_price):.5f}")
                         print(f"     Updated Account: ${updated_balance:.2f} | Session P&L: ${updated_session_pnl:.2f}")
                     else:
                         print(f"\n[BUY] {quantity} {symbol} @ ${result.get('avg_fill_price', current_price):.5f}")
-
-                    self.trades.append({
-                        'timestamp': timestamp,
-                        'action': 'buy_long',
-                        'price': current_price,
-                        'quantity': quantity,
-                        'order_details': result
-                    })
-
-                    # DEBUG: Backend trade logging
-                    print(f"\n[BACKEND] Trade recorded:")
-                    print(f"  Timestamp: {timestamp}")
-                    print(f"  Action: buy_long")
-                    print(f"  Price: ${current_price:.2f}")
-                    print(f"  Fill Price: ${result.get('avg_fill_price', 0):.2f}")
-                    print(f"  Quantity: {quantity}")
                 else:
                     print(f" BUY ORDER FAILED - {result.get('error', 'Unknown error')}")
             else:
@@ -482,6 +662,7 @@ class LiveTradingEngine:
             # Close the existing long position
             result = self.close_position(symbol, current_price=current_price)
             if result.get('status') not in ['failed', 'pending']:
+                filled = self._record_trade(timestamp, 'close_position', current_price, current_qty, result)
                 # Force position refresh for IB broker
                 if hasattr(self.broker_interface, 'refresh_positions'):
                     self.broker_interface.refresh_positions()
@@ -492,27 +673,12 @@ class LiveTradingEngine:
                 updated_session_pnl = updated_balance - self.initial_balance
 
                 if not getattr(self, 'quiet_mode', False):
-                    print(f" POSITION CLOSED - {current_qty} {symbol} at market")
-                    print(f"     Exit Price: ${result.get('avg_fill_price', current_price):.5f}")
+                    print(f" POSITION {'CLOSED' if filled else 'CLOSE SENT'} - {current_qty} {symbol} at market")
+                    if filled:
+                        print(f"     Exit Price: ${result.get('avg_fill_price', current_price):.5f}")
                     print(f"     Updated Account: ${updated_balance:.2f} | Session P&L: ${updated_session_pnl:.2f}")
                 else:
                     print(f"\n[CLOSE] {current_qty} {symbol} @ ${result.get('avg_fill_price', current_price):.5f}")
-
-                self.trades.append({
-                    'timestamp': timestamp,
-                    'action': 'close_position',
-                    'price': current_price,
-                    'quantity': current_qty,
-                    'order_details': result
-                })
-
-                # DEBUG: Backend trade logging
-                print(f"\n[BACKEND] Trade recorded:")
-                print(f"  Timestamp: {timestamp}")
-                print(f"  Action: close_position")
-                print(f"  Price: ${current_price:.2f}")
-                print(f"  Fill Price: ${result.get('avg_fill_price', 0):.2f}")
-                print(f"  Quantity: {current_qty}")
             else:
                 print(f" CLOSE POSITION FAILED - {result.get('error', 'Unknown error')}")
 
@@ -549,21 +715,8 @@ class LiveTradingEngine:
 
                 result = self.close_position(symbol, current_price=current_price)
                 if result.get('status') != 'failed':
-                    print(f" SHORT POSITION CLOSED - {abs(current_qty)} {symbol}")
-                    self.trades.append({
-                        'timestamp': timestamp,
-                        'action': 'close_short',
-                        'price': current_price,
-                        'quantity': abs(current_qty),
-                        'order_details': result
-                    })
-
-                    # DEBUG: Backend trade logging
-                    print(f"\n[BACKEND] Trade recorded:")
-                    print(f"  Timestamp: {timestamp}")
-                    print(f"  Action: close_short")
-                    print(f"  Price: ${current_price:.2f}")
-                    print(f"  Quantity: {abs(current_qty)}")
+                    filled = self._record_trade(timestamp, 'close_short', current_price, abs(current_qty), result)
+                    print(f" SHORT POSITION {'CLOSED' if filled else 'CLOSE SENT'} - {abs(current_qty)} {symbol}")
 
                     # Now open long position after closing short
                     print(f"\n🔵 BUY SIGNAL - Opening long position for {symbol} at ${current_price:.2f}")
@@ -571,6 +724,7 @@ class LiveTradingEngine:
                     if self._confirm_trade_execution('BUY', symbol, quantity, current_price, alpaca_position):
                         long_result = self.execute_buy_order(symbol, quantity, order_type="market", current_price=current_price)
                         if long_result.get('status') not in ['failed', 'pending']:
+                            filled = self._record_trade(timestamp, 'buy_long', current_price, quantity, long_result)
                             # Force position refresh
                             if hasattr(self.broker_interface, 'refresh_positions'):
                                 self.broker_interface.refresh_positions()
@@ -579,25 +733,10 @@ class LiveTradingEngine:
                             updated_balance = float(updated_account.get('equity', account_balance))
                             updated_session_pnl = updated_balance - self.initial_balance
 
-                            print(f" BUY ORDER FILLED - {quantity} {symbol} at market")
-                            print(f"     Fill Price: ${long_result.get('avg_fill_price', current_price):.5f}")
+                            print(f" BUY ORDER {'FILLED' if filled else 'SENT'} - {quantity} {symbol} at market")
+                            if filled:
+                                print(f"     Fill Price: ${long_result.get('avg_fill_price', current_price):.5f}")
                             print(f"     Updated Account: ${updated_balance:.2f} | Session P&L: ${updated_session_pnl:.2f}")
-
-                            self.trades.append({
-                                'timestamp': timestamp,
-                                'action': 'buy_long',
-                                'price': current_price,
-                                'quantity': quantity,
-                                'order_details': long_result
-                            })
-
-                            # DEBUG: Backend trade logging
-                            print(f"\n[BACKEND] Trade recorded:")
-                            print(f"  Timestamp: {timestamp}")
-                            print(f"  Action: buy_long")
-                            print(f"  Price: ${current_price:.2f}")
-                            print(f"  Fill Price: ${long_result.get('avg_fill_price', 0):.2f}")
-                            print(f"  Quantity: {quantity}")
                         else:
                             print(f" BUY ORDER FAILED - {long_result.get('error', 'Unknown error')}")
                     else:
@@ -610,6 +749,7 @@ class LiveTradingEngine:
                 if self._confirm_trade_execution('BUY', symbol, quantity, current_price, alpaca_position):
                     result = self.execute_buy_order(symbol, quantity, order_type="market", current_price=current_price)
                     if result.get('status') not in ['failed', 'pending']:
+                        filled = self._record_trade(timestamp, 'buy_long', current_price, quantity, result)
                         # Force position refresh for IB broker
                         if hasattr(self.broker_interface, 'refresh_positions'):
                             self.broker_interface.refresh_positions()
@@ -618,25 +758,10 @@ class LiveTradingEngine:
                         updated_balance = float(updated_account.get('equity', account_balance))
                         updated_session_pnl = updated_balance - self.initial_balance
 
-                        print(f" BUY ORDER FILLED - {quantity} {symbol} at market")
-                        print(f"     Fill Price: ${result.get('avg_fill_price', current_price):.5f}")
+                        print(f" BUY ORDER {'FILLED' if filled else 'SENT'} - {quantity} {symbol} at market")
+                        if filled:
+                            print(f"     Fill Price: ${result.get('avg_fill_price', current_price):.5f}")
                         print(f"     Updated Account: ${updated_balance:.2f} | Session P&L: ${updated_session_pnl:.2f}")
-
-                        self.trades.append({
-                            'timestamp': timestamp,
-                            'action': 'buy_long',
-                            'price': current_price,
-                            'quantity': quantity,
-                            'order_details': result
-                        })
-
-                        # DEBUG: Backend trade logging
-                        print(f"\n[BACKEND] Trade recorded:")
-                        print(f"  Timestamp: {timestamp}")
-                        print(f"  Action: buy_long")
-                        print(f"  Price: ${current_price:.2f}")
-                        print(f"  Fill Price: ${result.get('avg_fill_price', 0):.2f}")
-                        print(f"  Quantity: {quantity}")
                     else:
                         print(f" BUY ORDER FAILED - {result.get('error', 'Unknown error')}")
                 else:
@@ -660,21 +785,8 @@ class LiveTradingEngine:
 
                 result = self.close_position(symbol, current_price=current_price)
                 if result.get('status') != 'failed':
-                    print(f" LONG POSITION CLOSED - {current_qty} {symbol}")
-                    self.trades.append({
-                        'timestamp': timestamp,
-                        'action': 'close_long',
-                        'price': current_price,
-                        'quantity': current_qty,
-                        'order_details': result
-                    })
-
-                    # DEBUG: Backend trade logging
-                    print(f"\n[BACKEND] Trade recorded:")
-                    print(f"  Timestamp: {timestamp}")
-                    print(f"  Action: close_long")
-                    print(f"  Price: ${current_price:.2f}")
-                    print(f"  Quantity: {current_qty}")
+                    filled = self._record_trade(timestamp, 'close_long', current_price, current_qty, result)
+                    print(f" LONG POSITION {'CLOSED' if filled else 'CLOSE SENT'} - {current_qty} {symbol}")
 
                     # Now open short position after closing long
                     print(f"\n🔴 SELL SIGNAL - Opening short position for {symbol} at ${current_price:.2f}")
@@ -682,6 +794,7 @@ class LiveTradingEngine:
                     if self._confirm_trade_execution('SELL', symbol, quantity, current_price, alpaca_position):
                         short_result = self.execute_sell_order(symbol, quantity, order_type="market", current_price=current_price)
                         if short_result.get('status') not in ['failed', 'pending']:
+                            filled = self._record_trade(timestamp, 'sell_short', current_price, quantity, short_result)
                             # Force position refresh
                             if hasattr(self.broker_interface, 'refresh_positions'):
                                 self.broker_interface.refresh_positions()
@@ -690,25 +803,10 @@ class LiveTradingEngine:
                             updated_balance = float(updated_account.get('equity', account_balance))
                             updated_session_pnl = updated_balance - self.initial_balance
 
-                            print(f" SHORT ORDER FILLED - {quantity} {symbol} at market")
-                            print(f"     Fill Price: ${short_result.get('avg_fill_price', current_price):.5f}")
+                            print(f" SHORT ORDER {'FILLED' if filled else 'SENT'} - {quantity} {symbol} at market")
+                            if filled:
+                                print(f"     Fill Price: ${short_result.get('avg_fill_price', current_price):.5f}")
                             print(f"     Updated Account: ${updated_balance:.2f} | Session P&L: ${updated_session_pnl:.2f}")
-
-                            self.trades.append({
-                                'timestamp': timestamp,
-                                'action': 'sell_short',
-                                'price': current_price,
-                                'quantity': quantity,
-                                'order_details': short_result
-                            })
-
-                            # DEBUG: Backend trade logging
-                            print(f"\n[BACKEND] Trade recorded:")
-                            print(f"  Timestamp: {timestamp}")
-                            print(f"  Action: sell_short")
-                            print(f"  Price: ${current_price:.2f}")
-                            print(f"  Fill Price: ${short_result.get('avg_fill_price', 0):.2f}")
-                            print(f"  Quantity: {quantity}")
                         else:
                             print(f" SHORT ORDER FAILED - {short_result.get('error', 'Unknown error')}")
                     else:
@@ -721,6 +819,7 @@ class LiveTradingEngine:
                 if self._confirm_trade_execution('SELL', symbol, quantity, current_price, alpaca_position):
                     result = self.execute_sell_order(symbol, quantity, order_type="market", current_price=current_price)
                     if result.get('status') not in ['failed', 'pending']:
+                        filled = self._record_trade(timestamp, 'sell_short', current_price, quantity, result)
                         # Force position refresh for IB broker
                         if hasattr(self.broker_interface, 'refresh_positions'):
                             self.broker_interface.refresh_positions()
@@ -729,25 +828,10 @@ class LiveTradingEngine:
                         updated_balance = float(updated_account.get('equity', account_balance))
                         updated_session_pnl = updated_balance - self.initial_balance
 
-                        print(f" SHORT ORDER FILLED - {quantity} {symbol} at market")
-                        print(f"     Fill Price: ${result.get('avg_fill_price', current_price):.5f}")
+                        print(f" SHORT ORDER {'FILLED' if filled else 'SENT'} - {quantity} {symbol} at market")
+                        if filled:
+                            print(f"     Fill Price: ${result.get('avg_fill_price', current_price):.5f}")
                         print(f"     Updated Account: ${updated_balance:.2f} | Session P&L: ${updated_session_pnl:.2f}")
-
-                        self.trades.append({
-                            'timestamp': timestamp,
-                            'action': 'sell_short',
-                            'price': current_price,
-                            'quantity': quantity,
-                            'order_details': result
-                        })
-
-                        # DEBUG: Backend trade logging
-                        print(f"\n[BACKEND] Trade recorded:")
-                        print(f"  Timestamp: {timestamp}")
-                        print(f"  Action: sell_short")
-                        print(f"  Price: ${current_price:.2f}")
-                        print(f"  Fill Price: ${result.get('avg_fill_price', 0):.2f}")
-                        print(f"  Quantity: {quantity}")
                     else:
                         print(f" SHORT ORDER FAILED - {result.get('error', 'Unknown error')}")
                 else:
@@ -770,7 +854,10 @@ class LiveTradingEngine:
                     sleep_interval: int = 60,
                     max_iterations: Optional[int] = None,
                     quiet_mode: bool = False,
-                    chart_callback: Optional[Callable] = None):
+                    chart_callback: Optional[Callable] = None,
+                    streaming: bool = True,
+                    push: bool = True,
+                    bar_interval: float = 60):
         """
         Run strategy continuously
 
@@ -778,18 +865,38 @@ class LiveTradingEngine:
             strategy: Strategy instance
             symbol: Trading symbol
             quantity: Position size
-            sleep_interval: Seconds between iterations
+            sleep_interval: Seconds between iterations (when polling)
             max_iterations: Maximum iterations (None for infinite)
             quiet_mode: If True, minimize terminal output
             chart_callback: Optional callback to update chart
+            streaming: Feed only new bars through strategy.on_bar (when the
+                strategy has it) instead of regenerating signals for the
+                whole window; the strategy instance then belongs to this symbol
+            push: Receive bars from the provider's persistent stream
+                (stream_bars) as they close instead of polling; the
+                lookback window is still polled once to warm up, and again
+                whenever no bar arrives within sleep_interval
+            bar_interval: Bar length in seconds for pushed bars
         """
         self.running = True
         iteration = 0
         self.quiet_mode = quiet_mode
+        use_on_bar = streaming and hasattr(strategy, 'on_bar')
 
         if not quiet_mode:
             self.logger.info(f"Starting live trading for {strategy.name} on {symbol}")
 
+        stream = None
+        bar_queue = queue.Queue()
+        if push and hasattr(self.data_provider, 'stream_bars'):
+            try:
+                stream = self.data_provider.stream_bars(symbol, lambda _symbol, bar: bar_queue.put((now_ns(), bar)),
+                                                        interval_seconds=bar_interval)
+            except Exception as e:
+                if not quiet_mode:
+                    self.logger.error(f"Could not open the data stream, polling instead: {e}")
+
+        window = None
         try:
             while self.running:
                 # Check max iterations
@@ -799,11 +906,31 @@ class LiveTradingEngine:
                     break
 
                 try:
-                    # Get latest data
-                    df = self.data_provider.get_live_data(symbol)
-
-                    # Process signals
-                    self.process_signals(df, strategy, symbol, quantity)
+                    bar = None
+                    if stream is not None and window is not None:
+                        try:
+                            arrived, bar = bar_queue.get(timeout=sleep_interval)
+                        except queue.Empty:
+                            pass
+
+                    if bar is not None:
+                        # Pushed bar: only the new bar goes through the strategy
+                        tick = self.latency.begin_tick(arrived)
+                        self.latency.since('bar_queue', arrived)
+                        window = self._process_pushed_bar(bar, window, strategy, symbol, quantity, use_on_bar)
+                    else:
+                        # Get latest data
+                        start = now_ns()
+                        df = self.data_provider.get_live_data(symbol)
+                        tick = self.latency.begin_tick(self.latency.since('fetch', start))
+                        window = df
+
+                        # Process signals
+                        if use_on_bar:
+                            self._process_new_bars(df, strategy, symbol, quantity)
+                        else:
+                            self.process_signals(df, strategy, symbol, quantity)
+                    self.latency.since('iteration', tick)
 
                     # Display trading stats
                     if quiet_mode:
@@ -821,15 +948,43 @@ class LiveTradingEngine:
 
                 iteration += 1
 
-                # Wait before next iteration
-                if self.running:
+                # Wait before next iteration (pushed bars wake the loop themselves)
+                if self.running and stream is None:
                     time.sleep(sleep_interval)
 
         except KeyboardInterrupt:
             if not quiet_mode:
                 self.logger.info("Received keyboard interrupt, stopping...")
             self.stop()
-    
+        finally:
+            if stream is not None:
+                stream.stop()
+
+    def _process_pushed_bar(self, bar: Dict[str, Any], window: pd.DataFrame, strategy, symbol: str,
+                            quantity: float, use_on_bar: bool) -> pd.DataFrame:
+        """Act on one bar from the data stream; returns the updated lookback window"""
+        ts = pd.to_datetime(bar['timestamp'])
+        if use_on_bar:
+            last_ts = self._stream_last_ts.get(symbol)
+            if last_ts is not None and ts <= last_ts:
+                return window  # already seen in the polled warm-up window
+            self._stream_last_ts[symbol] = ts
+            self.process_bar(bar, strategy, symbol, quantity)
+            return window
+
+        if window is not None and len(window) > 0:
+            if ts <= pd.to_datetime(window['timestamp']).iloc[-1]:
+                return window
+            window = pd.concat([window, pd.DataFrame([bar])], ignore_index=True).tail(len(window))
+        else:
+            window = pd.DataFrame([bar])
+        self.process_signals(window.reset_index(drop=True), strategy, symbol, quantity)
+        return window
+
+    def latency_summary(self) -> Dict[str, Dict[str, float]]:
+        """Per-stage latency percentiles (microseconds) recorded so far, see engines/latency.py"""
+        return self.latency.snapshot()
+
     def stop(self):
         """Stop the trading engine"""
         self.running = False
@@ -1043,6 +1198,10 @@ class LiveTradingEngine:
         print(f"Unrealized P&L: ${unrealized_pnl:.2f}")
         print(f"Total P&L: ${performance['total_return'] + unrealized_pnl:.2f}")
         print(f"Percent Return: {performance['percent_return']:.2f}%")
+        latency = self.latency.snapshot().get('tick_to_trade')
+        if latency and latency['count']:
+            print(f"Tick-to-Trade: p50 {latency['p50_us'] / 1e3:.1f} ms | p99 {latency['p99_us'] / 1e3:.1f} ms "
+                  f"({latency['count']} orders)")
         print(f"Timestamp: {datetime.now().strftime('%Y-%m-%d %H:%M:%S')}")
         print("=" * 60)
 
@@ -0,0 +1,104 @@
+"""
+Online performance metrics for the backtest engines
+
+native/metrics.h accumulates trade and equity statistics inside the native
+execution core. PyMetricsAccumulator is the same accumulator for the Python
+bar loop, so BacktestEngine.analyze_results reads one metrics dict
+whichever path ran instead of reducing the trade DataFrame.
+"""
+
+import math
+
+import numpy as np
+import pandas as pd
+
+SECONDS_PER_YEAR = 365.25 * 24 * 3600
+
+
+class PyMetricsAccumulator:
+    """Python version of native MetricsAccumulator (same updates and result fields)"""
+
+    def __init__(self):
+        self.trades = self.wins = self.losses = 0
+        self.total_wins = self.total_losses = 0.0
+        self.largest_win = self.largest_loss = 0.0
+        self._prev_equity = None
+        self._peak = 0.0
+        self.max_drawdown = self._max_drawdown_frac = 0.0
+        self.n_returns = 0
+        self._mean = self._m2 = self._downside_sq = 0.0
+
+    def on_trade_close(self, profit: float):
+        if self.trades == 0 or profit > self.largest_win:
+            self.largest_win = profit
+        if self.trades == 0 or profit < self.largest_loss:
+            self.largest_loss = profit
+        self.trades += 1
+        if profit > 0:
+            self.wins += 1
+            self.total_wins += profit
+        else:
+            self.losses += 1
+            self.total_losses += abs(profit)
+
+    def on_equity(self, equity: float):
+        """One mark-to-market value per bar; the first one only seeds the curve"""
+        if self._prev_equity is None:
+            self._peak = equity
+        elif self._prev_equity > 0:
+            r = equity / self._prev_equity - 1.0
+            self.n_returns += 1
+            delta = r - self._mean
+            self._mean += delta / self.n_returns
+            self._m2 += delta * (r - self._mean)
+            if r < 0:
+                self._downside_sq += r * r
+        self._prev_equity = equity
+        self._peak = max(self._peak, equity)
+        drawdown = self._peak - equity
+        self.max_drawdown = max(self.max_drawdown, drawdown)
+        if self._peak > 0:
+            self._max_drawdown_frac = max(self._max_drawdown_frac, drawdown / self._peak)
+
+    def result(self, periods_per_year: float = 1.0) -> dict:
+        m = {
+            'num_trades': self.trades, 'winning_trades': self.wins, 'losing_trades': self.losses,
+            'total_wins': self.total_wins, 'total_losses': self.total_losses,
+            'largest_win': 0.0, 'largest_loss': 0.0, 'win_rate': 0.0, 'avg_win': 0.0, 'avg_loss': 0.0,
+            'expectancy': 0.0, 'profit_factor': 0.0,
+            'max_drawdown': self.max_drawdown, 'max_drawdown_pct': self._max_drawdown_frac * 100.0,
+            'sharpe': 0.0, 'sortino': 0.0, 'n_returns': self.n_returns,
+        }
+        if self.trades > 0:
+            m['largest_win'] = self.largest_win
+            m['largest_loss'] = self.largest_loss
+            m['win_rate'] = self.wins / self.trades * 100.0
+            if self.wins > 0:
+                m['avg_win'] = self.total_wins / self.wins
+            if self.losses > 0:
+                m['avg_loss'] = self.total_losses / self.losses
+            loss_rate = self.losses / self.trades * 100.0
+            m['expectancy'] = (m['win_rate'] / 100.0 * m['avg_win']) - (loss_rate / 100.0 * m['avg_loss'])
+            if self.wins > 0 and self.losses > 0:
+                m['profit_factor'] = self.total_wins / self.total_losses
+            elif self.wins > 0:
+                m['profit_factor'] = 999.99
+        scale = math.sqrt(periods_per_year if periods_per_year > 0 else 1.0)
+        if self.n_returns > 1:
+            stdev = math.sqrt(self._m2 / (self.n_returns - 1))
+            if stdev > 0:
+                m['sharpe'] = self._mean / stdev * scale
+        if self.n_returns > 0 and self._downside_sq > 0:
+            m['sortino'] = self._mean / math.sqrt(self._downside_sq / self.n_returns) * scale
+        return m
+
+
+def periods_per_year(timestamps) -> float:
+    """Observed bars per year of a timestamp column (1.0 when it spans no time)"""
+    if timestamps is None or len(timestamps) < 2:
+        return 1.0
+    times = pd.to_datetime(pd.Series(timestamps))
+    span = (times.iloc[-1] - times.iloc[0]).total_seconds()
+    if not np.isfinite(span) or span <= 0:
+        return 1.0
+    return (len(times) - 1) / (span / SECONDS_PER_YEAR)
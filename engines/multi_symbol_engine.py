@@ -0,0 +1,322 @@
+"""
+Multi-symbol live trading in one process
+
+MultiSymbolEngine runs N symbol/strategy pairs side by side:
+
+- one data connection: a single provider stream (stream_bars) subscribed
+  to every symbol, or one polling loop when the provider has no stream
+- a work-stealing pool of worker threads evaluates signals; each symbol is
+  an actor with a mailbox, so its bars are processed in order and its
+  strategy/engine state is only ever touched by one worker at a time
+- one AsyncOrderGateway (engines/order_gateway.py) in front of the broker:
+  orders from every symbol are queued without blocking the worker and sent
+  by one thread under a request rate limit, and position / account reads
+  come from the gateway's fill-driven book. Each engine books its trades
+  when the gateway reports the fill
+
+Each pair keeps its own LiveTradingEngine (position, trade log, pending
+orders), so per-symbol behaviour is exactly the single-symbol engine's.
+"""
+
+import itertools
+import threading
+import time
+from collections import deque
+from typing import Any, Callable, Dict, List, Optional, Sequence, Tuple
+
+import pandas as pd
+
+from engines.latency import now_ns
+from engines.live_trading_engine import LiveTradingEngine
+from engines.order_gateway import AsyncOrderGateway
+
+
+class WorkStealingPool:
+    """
+    Fixed set of worker threads with one task deque each
+
+    Tasks submitted with an affinity key always start on the same worker
+    (warm caches for that symbol); a worker that runs dry steals the oldest
+    task from the most loaded worker, so one busy symbol group cannot stall
+    the others. Owners take their newest task first.
+    """
+
+    def __init__(self, n_workers: int = 4, name: str = "worker"):
+        if n_workers < 1:
+            raise ValueError("n_workers must be >= 1")
+        self.n_workers = n_workers
+        self.name = name
+        self._queues = [deque() for _ in range(n_workers)]
+        self._cond = threading.Condition()
+        self._round_robin = itertools.count()
+        self._threads: List[threading.Thread] = []
+        self._stopping = False
+        self.steals = 0
+
+    def start(self):
+        if self._threads:
+            return self
+        self._stopping = False
+        for i in range(self.n_workers):
+            thread = threading.Thread(target=self._work, args=(i,), name=f"{self.name}-{i}", daemon=True)
+            thread.start()
+            self._threads.append(thread)
+        return self
+
+    def stop(self, timeout: float = 5):
+        """Finish queued tasks, then stop the workers"""
+        with self._cond:
+            self._stopping = True
+            self._cond.notify_all()
+        for thread in self._threads:
+            thread.join(timeout=timeout)
+        self._threads = []
+
+    def submit(self, fn: Callable[[], Any], affinity=None):
+        if affinity is None:
+            i = next(self._round_robin) % self.n_workers
+        else:
+            i = hash(affinity) % self.n_workers
+        with self._cond:
+            self._queues[i].append(fn)
+            self._cond.notify_all()
+
+    def _take(self, i: int):
+        own = self._queues[i]
+        if own:
+            return own.pop()
+        victim = max(self._queues, key=len)
+        if victim:
+            self.steals += 1
+            return victim.popleft()
+        return None
+
+    def _work(self, i: int):
+        while True:
+            with self._cond:
+                task = self._take(i)
+                while task is None:
+                    if self._stopping:
+                        return
+                    self._cond.wait()
+                    task = self._take(i)
+            try:
+                task()
+            except Exception as e:
+                print(f"Error in {self.name} task: {e}")
+
+
+class _SymbolRunner:
+    """One symbol's strategy, engine and bar mailbox (processed by one worker at a time)"""
+
+    def __init__(self, symbol: str, strategy, quantity, engine: LiveTradingEngine, use_on_bar: bool):
+        self.symbol = symbol
+        self.strategy = strategy
+        self.quantity = quantity
+        self.engine = engine
+        self.use_on_bar = use_on_bar
+        self.window: Optional[pd.DataFrame] = None
+        self.mailbox = deque()
+        self.scheduled = False
+        self.lock = threading.Lock()
+        self.bars_processed = 0
+
+    def poll(self, data_provider):
+        """Fetch the lookback window and act on it (warm-up and polling mode)"""
+        latency = self.engine.latency
+        start = now_ns()
+        df = data_provider.get_live_data(self.symbol)
+        tick = latency.begin_tick(latency.since('fetch', start))
+        self.window = df
+        if self.use_on_bar:
+            self.engine._process_new_bars(df, self.strategy, self.symbol, self.quantity)
+        else:
+            self.engine.process_signals(df, self.strategy, self.symbol, self.quantity)
+        latency.since('iteration', tick)
+
+    def drain(self):
+        """Process queued tasks (pushed bars or polls) in arrival order"""
+        while True:
+            with self.lock:
+                if not self.mailbox:
+                    self.scheduled = False
+                    return
+                task = self.mailbox.popleft()
+            try:
+                task(self)
+            except Exception as e:
+                print(f"Error processing {self.symbol}: {e}")
+
+    def on_bar(self, bar, arrived: int = None):
+        latency = self.engine.latency
+        tick = latency.begin_tick(arrived)
+        if arrived is not None:
+            latency.since('bar_queue', arrived)
+        self.window = self.engine._process_pushed_bar(bar, self.window, self.strategy, self.symbol,
+                                                      self.quantity, self.use_on_bar)
+        latency.since('iteration', tick)
+        self.bars_processed += 1
+
+
+class MultiSymbolEngine:
+    """Run many symbol/strategy pairs in one process over shared data and order connections"""
+
+    def __init__(self,
+                 data_provider,
+                 broker_interface,
+                 pairs: Sequence[Tuple],
+                 initial_balance: float = 10000,
+                 trading_mode: str = "long_only",
+                 position_percentage: float = 100.0,
+                 n_workers: int = 4,
+                 streaming: bool = True,
+                 max_requests_per_second: Optional[float] = None,
+                 quiet_mode: bool = True):
+        """
+        Args:
+            pairs: (symbol, strategy) or (symbol, strategy, quantity) tuples,
+                one strategy instance per symbol; quantity None sizes by
+                position_percentage
+            position_percentage: Share of equity committed across all pairs,
+                split evenly between them
+            n_workers: Signal evaluation threads
+            streaming: Use strategy.on_bar when available
+            max_requests_per_second: Broker request limit for the gateway
+        """
+        if not pairs:
+            raise ValueError("pairs must not be empty")
+        self.data_provider = data_provider
+        if isinstance(broker_interface, AsyncOrderGateway):
+            self.gateway = broker_interface
+        else:
+            self.gateway = AsyncOrderGateway(broker_interface, synchronous=True,
+                                             max_requests_per_second=max_requests_per_second)
+        self.pool = WorkStealingPool(n_workers, name="signal-worker")
+        self.running = False
+        self._stream = None
+        self._done = threading.Event()
+
+        self.runners: Dict[str, _SymbolRunner] = {}
+        share = position_percentage / len(pairs)
+        for pair in pairs:
+            symbol, strategy = pair[0], pair[1]
+            quantity = pair[2] if len(pair) > 2 else None
+            if symbol in self.runners:
+                raise ValueError(f"Duplicate symbol: {symbol}")
+            engine = LiveTradingEngine(data_provider, self.gateway, initial_balance=initial_balance,
+                                       trading_mode=trading_mode, position_percentage=share)
+            engine.quiet_mode = quiet_mode
+            engine.running = True
+            use_on_bar = streaming and hasattr(strategy, 'on_bar')
+            self.runners[symbol] = _SymbolRunner(symbol, strategy, quantity, engine, use_on_bar)
+
+    @property
+    def symbols(self) -> List[str]:
+        return list(self.runners)
+
+    def _enqueue(self, symbol: str, task: Callable[[_SymbolRunner], None]):
+        runner = self.runners.get(symbol)
+        if runner is None:
+            return
+        with runner.lock:
+            runner.mailbox.append(task)
+            if runner.scheduled:
+                return
+            runner.scheduled = True
+        self.pool.submit(runner.drain, affinity=symbol)
+
+    def dispatch_bar(self, symbol: str, bar: Dict[str, Any]):
+        """Stream callback: queue a closed bar for its symbol"""
+        arrived = now_ns()
+        self._enqueue(symbol, lambda runner: runner.on_bar(bar, arrived))
+
+    def poll_all(self):
+        """Queue a lookback poll for every symbol that is not already busy"""
+        for symbol, runner in self.runners.items():
+            if not runner.scheduled:
+                self._enqueue(symbol, lambda r: r.poll(self.data_provider))
+
+    def run(self,
+            sleep_interval: float = 60,
+            bar_interval: float = 60,
+            duration: Optional[float] = None,
+            status_interval: float = 60):
+        """
+        Trade all pairs until stop(), KeyboardInterrupt or duration seconds
+
+        Every symbol is warmed up from its polled lookback window; then bars
+        arrive from one shared provider stream, or every sleep_interval
+        seconds from a poll of all symbols when there is no stream.
+        """
+        self.running = True
+        self._done.clear()
+        self.gateway.start()
+        self.pool.start()
+        print(f"Starting multi-symbol trading on {len(self.runners)} symbols with {self.pool.n_workers} workers")
+
+        self.poll_all()
+        if hasattr(self.data_provider, 'stream_bars'):
+            try:
+                self._stream = self.data_provider.stream_bars(self.symbols, self.dispatch_bar,
+                                                              interval_seconds=bar_interval)
+            except Exception as e:
+                print(f"Could not open the data stream, polling instead: {e}")
+
+        started = time.monotonic()
+        next_poll = started + sleep_interval
+        next_status = started + status_interval
+        try:
+            while self.running:
+                now = time.monotonic()
+                if duration is not None and now - started >= duration:
+                    break
+                if self._stream is None and now >= next_poll:
+                    self.poll_all()
+                    next_poll = now + sleep_interval
+                if now >= next_status:
+                    self._print_status()
+                    next_status = now + status_interval
+                self._done.wait(min(1.0, max(0.0, next_poll - now)) if self._stream is None else 1.0)
+        except KeyboardInterrupt:
+            print("Received keyboard interrupt, stopping...")
+        finally:
+            self.stop()
+
+    def stop(self):
+        """Disconnect the stream, finish queued work and stop the workers"""
+        if not self.running:
+            return
+        self.running = False
+        self._done.set()
+        if self._stream is not None:
+            self._stream.stop()
+            self._stream = None
+        self.pool.stop()
+        self.gateway.stop()
+        for runner in self.runners.values():
+            runner.engine.running = False
+        print("Multi-symbol trading stopped")
+
+    def get_performance_summary(self) -> Dict[str, Dict[str, Any]]:
+        """Per-symbol LiveTradingEngine summaries"""
+        return {symbol: runner.engine.get_performance_summary() for symbol, runner in self.runners.items()}
+
+    def get_trade_history(self) -> pd.DataFrame:
+        """All symbols' trade histories in one DataFrame"""
+        frames = [runner.engine.get_trade_history() for runner in self.runners.values()]
+        frames = [frame for frame in frames if not frame.empty]
+        if not frames:
+            return pd.DataFrame()
+        return pd.concat(frames, ignore_index=True)
+
+    def _print_status(self):
+        bars = sum(runner.bars_processed for runner in self.runners.values())
+        trades = sum(len(runner.engine.trades) for runner in self.runners.values())
+        print(f"[{time.strftime('%H:%M:%S')}] {len(self.runners)} symbols | {bars} bars | {trades} trades | "
+              f"{self.gateway.orders_sent} orders sent | {self.gateway.reconciliations} reconciles | "
+              f"{self.pool.steals} steals")
+        latency = next(iter(self.runners.values())).engine.latency.snapshot().get('tick_to_trade')
+        if latency and latency['count']:
+            print(f"  tick-to-trade p50 {latency['p50_us'] / 1e3:.1f} ms | p99 {latency['p99_us'] / 1e3:.1f} ms "
+                  f"over {latency['count']} orders")
+
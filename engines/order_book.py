@@ -0,0 +1,195 @@
+"""
+Limit-order matching for simulated execution
+
+A LimitOrderBook holds one symbol's resting limit orders in price-time
+priority and matches them against bars: buys fill when the bar's low
+reaches the limit, sells when the high does, best price first and oldest
+order first within a price. Orders can carry an expiry, handled by a timer
+wheel in the native book (native/order_book.h) and by a heap in
+PyLimitOrderBook, which has the same semantics. SimulatedBroker rests its
+pending limit orders here; simulate_limit_orders() runs a whole order list
+over a bar DataFrame for backtests.
+"""
+
+import bisect
+import heapq
+from collections import OrderedDict
+from typing import Tuple
+
+import numpy as np
+import pandas as pd
+
+try:
+    from native.order_book import LimitOrderBook, run_limit_orders
+except ImportError:  # extension not built, use the Python book
+    LimitOrderBook = None
+    run_limit_orders = None
+
+BUY, SELL = 1, -1
+NS_PER_SECOND = 1_000_000_000
+
+
+class PyLimitOrderBook:
+    """Python version of native.order_book.LimitOrderBook (same matching, fill and expiry rules)"""
+
+    def __init__(self, wheel_tick: int = NS_PER_SECOND, wheel_slots: int = 4096, gap_fills_at_open: bool = True):
+        # wheel_* only size the native timer wheel; kept for a matching signature
+        self.gap_fills_at_open = gap_fills_at_open
+        self._levels = {BUY: {}, SELL: {}}  # side -> price -> OrderedDict(id -> order)
+        self._prices = {BUY: [], SELL: []}  # ascending; bids are read from the end
+        self._orders = {}  # id -> (side, limit, quantity, time, expiry)
+        self._expiries = []  # (expiry, id) heap, stale entries skipped
+
+    def __len__(self):
+        return len(self._orders)
+
+    def __contains__(self, order_id):
+        return order_id in self._orders
+
+    @property
+    def best_bid(self):
+        prices = self._prices[BUY]
+        return prices[-1] if prices else None
+
+    @property
+    def best_ask(self):
+        prices = self._prices[SELL]
+        return prices[0] if prices else None
+
+    def add(self, order_id: int, side: int, limit: float, quantity: float, time: int, expiry: int = 0) -> bool:
+        """Rest an order; False if the id is already in the book"""
+        if order_id in self._orders:
+            return False
+        if not quantity > 0 or limit != limit:
+            raise ValueError("invalid order")
+        side = BUY if side > 0 else SELL
+        levels = self._levels[side]
+        if limit not in levels:
+            levels[limit] = OrderedDict()
+            bisect.insort(self._prices[side], limit)
+        levels[limit][order_id] = quantity
+        self._orders[order_id] = (side, limit, quantity, time, expiry)
+        if expiry > 0:
+            heapq.heappush(self._expiries, (expiry, order_id))
+        return True
+
+    def cancel(self, order_id: int) -> bool:
+        if order_id not in self._orders:
+            return False
+        self._remove(order_id)
+        return True
+
+    def expire(self, now: int) -> list:
+        expired = []
+        while self._expiries and self._expiries[0][0] <= now:
+            expiry, order_id = heapq.heappop(self._expiries)
+            order = self._orders.get(order_id)
+            if order is not None and order[4] == expiry:
+                expired.append(order_id)
+                self._remove(order_id)
+        return expired
+
+    def on_bar(self, time: int, open: float, high: float, low: float) -> Tuple[list, list]:
+        """Expire, then match one bar; returns (fills, expired ids)"""
+        expired = self.expire(time)
+        fills = []
+        bids, asks = self._prices[BUY], self._prices[SELL]
+        while bids and low <= bids[-1]:
+            limit = bids[-1]
+            price = open if self.gap_fills_at_open and open < limit else limit
+            self._fill_level(BUY, limit, price, time, fills)
+        while asks and high >= asks[0]:
+            limit = asks[0]
+            price = open if self.gap_fills_at_open and open > limit else limit
+            self._fill_level(SELL, limit, price, time, fills)
+        return fills, expired
+
+    def _fill_level(self, side, limit, price, time, fills):
+        for order_id, quantity in list(self._levels[side][limit].items()):
+            fills.append((order_id, side, limit, price, quantity, time))
+            self._remove(order_id)
+
+    def _remove(self, order_id):
+        side, limit = self._orders.pop(order_id)[:2]
+        level = self._levels[side][limit]
+        del level[order_id]
+        if not level:
+            del self._levels[side][limit]
+            prices = self._prices[side]
+            del prices[bisect.bisect_left(prices, limit)]
+
+
+def make_order_book(gap_fills_at_open: bool = True, wheel_tick: int = NS_PER_SECOND):
+    """Native order book when available, otherwise the Python one"""
+    book = LimitOrderBook if LimitOrderBook is not None else PyLimitOrderBook
+    return book(wheel_tick=wheel_tick, gap_fills_at_open=gap_fills_at_open)
+
+
+def _run_limit_orders_python(timestamps, open, high, low, order_bar, order_side, order_limit, order_qty,
+                             order_ttl=None, gap_fills_at_open=True):
+    """Python version of native.order_book.run_limit_orders"""
+    n_orders = len(order_bar)
+    order_ttl = np.zeros(n_orders, dtype=np.int64) if order_ttl is None else np.asarray(order_ttl, dtype=np.int64)
+    if n_orders > 1 and np.any(np.diff(order_bar) < 0):
+        raise ValueError("order_bar must be non-decreasing")
+    fill_bar = np.full(n_orders, -1, dtype=np.int64)
+    fill_price = np.zeros(n_orders)
+    book = PyLimitOrderBook(gap_fills_at_open=gap_fills_at_open)
+    k = 0
+    for i in range(len(timestamps)):
+        fills, _ = book.on_bar(int(timestamps[i]), open[i], high[i], low[i])
+        for order_id, _side, _limit, price, _qty, _time in fills:
+            fill_bar[order_id] = i
+            fill_price[order_id] = price
+        # Orders placed on bar i start resting from bar i + 1
+        while k < n_orders and order_bar[k] <= i:
+            expiry = int(timestamps[i]) + int(order_ttl[k]) if order_ttl[k] > 0 else 0
+            book.add(k, int(order_side[k]), float(order_limit[k]), float(order_qty[k]), int(timestamps[i]), expiry)
+            k += 1
+    return fill_bar, fill_price
+
+
+def simulate_limit_orders(df: pd.DataFrame, orders: pd.DataFrame, gap_fills_at_open: bool = True,
+                          use_native: bool = True) -> pd.DataFrame:
+    """
+    Fill a list of limit orders against bar data
+
+    Args:
+        df: Bars with timestamp, Open, High, Low columns
+        orders: One row per order with 'Index' (bar position it is placed on;
+            it rests from the next bar), 'Side' (1/'buy' or -1/'sell'),
+            'Limit', optional 'Quantity' (default 1) and optional 'TTL'
+            (a timedelta or seconds; absent/0 = good till cancelled)
+        gap_fills_at_open: Fill at the open when a bar gaps through the limit
+        use_native: Use the native matcher when it is built
+
+    Returns:
+        orders sorted by Index with 'Filled', 'Fill_Index', 'Fill_Time'
+        and 'Fill_Price' columns added
+    """
+    orders = orders.sort_values('Index', kind='stable').reset_index(drop=True)
+    timestamps = pd.to_datetime(df['timestamp']).astype('int64').to_numpy()
+    side = orders['Side'].map(lambda s: BUY if s in (BUY, 'buy', 'BUY') else SELL).to_numpy(dtype=np.int8)
+    quantity = orders['Quantity'].to_numpy(dtype=np.float64) if 'Quantity' in orders else np.ones(len(orders))
+    ttl = None
+    if 'TTL' in orders:
+        values = orders['TTL']
+        ttl = (pd.to_timedelta(values).astype('int64').to_numpy() if not np.issubdtype(values.dtype, np.number)
+               else (values.to_numpy(dtype=np.float64) * NS_PER_SECOND).astype(np.int64))
+
+    run = run_limit_orders if use_native and run_limit_orders is not None else _run_limit_orders_python
+    fill_bar, fill_price = run(timestamps, df['Open'].to_numpy(dtype=np.float64),
+                               df['High'].to_numpy(dtype=np.float64), df['Low'].to_numpy(dtype=np.float64),
+                               orders['Index'].to_numpy(dtype=np.int64), side,
+                               orders['Limit'].to_numpy(dtype=np.float64), quantity,
+                               order_ttl=ttl, gap_fills_at_open=gap_fills_at_open)
+
+    result = orders.copy()
+    filled = fill_bar >= 0
+    result['Filled'] = filled
+    result['Fill_Index'] = fill_bar
+    # Unfilled orders (-1) find no bar and come back NaT
+    times = pd.to_datetime(df['timestamp']).reset_index(drop=True)
+    result['Fill_Time'] = times.reindex(fill_bar).reset_index(drop=True)
+    result['Fill_Price'] = np.where(filled, fill_price, np.nan)
+    return result
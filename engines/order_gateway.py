@@ -0,0 +1,746 @@
+"""
+Asynchronous order gateway for the live brokers (AlpacaBroker, IBBroker)
+and the shared order path of MultiSymbolEngine
+
+LiveTradingEngine sends each order as a blocking REST round trip and then
+reads the position and the account again (IBBroker polls callback state
+for the same answers), so every signal costs several network waits.
+AsyncOrderGateway stands in front of the broker with the same interface:
+
+  - buy / sell / close_position / cancel_order queue the request and return
+    at once; one sender thread submits in arrival order over the broker's
+    pooled connection (AlpacaBroker.submit_order, IBBroker.place_order);
+  - fills come from the broker's event stream (Alpaca trade_updates, IB
+    execDetails / orderStatus) and update a local position and cash book,
+    which get_position_for_symbol and get_account read without a network
+    call. Market orders still working count toward the position until they
+    fill or die, so the next bar cannot send a duplicate;
+  - a reconcile thread replaces the book with the broker's positions and
+    account every reconcile_interval seconds and after each stream
+    reconnect, whenever no event arrived while the snapshot was taken;
+  - every order carries monotonic timestamps (queued, sent, acknowledged,
+    first fill, filled); latency_summary() reports their percentiles, and
+    the stages also go to the engines' LatencyRecorder (order_queue, ack,
+    fill, and tick_to_fill from the tick that produced the order).
+
+Brokers with only blocking buy/sell calls (the SimulatedBrokers) can be
+driven with synchronous=True: the sender thread makes the call, its
+result becomes the fill event, and every call into the broker is
+serialised, since those brokers are not thread-safe. Resting limit orders
+of such a broker fill outside the gateway and reach the book on the next
+reconcile. max_requests_per_second spaces the sender's broker requests.
+
+buy() and sell() return status 'pending_new': the order is only queued.
+Listeners added with add_completion_listener() get the order's final dict
+(filled, partially filled then canceled, rejected) once it is done, which
+is when LiveTradingEngine books it as a trade. An order the broker rejects
+after buy() returned is reported on the console and drops out of the book,
+so the engine's next position check sees it never happened.
+"""
+
+import functools
+import inspect
+import threading
+import time
+import uuid
+from collections import deque
+from datetime import datetime
+from typing import Any, Callable, Dict, List, Optional, Tuple
+
+from engines.latency import LATENCY, LatencyRecorder
+
+FILL_EVENTS = frozenset({'fill', 'partial_fill'})
+# Alpaca events that end an order without (further) fills
+DONE_EVENTS = frozenset({'canceled', 'expired', 'rejected', 'done_for_day', 'replaced'})
+IB_DONE_STATUSES = frozenset({'Cancelled', 'ApiCancelled', 'Inactive'})
+
+LATENCY_STAGES = {
+    'queue': ('queued_ns', 'sent_ns'),
+    'ack': ('sent_ns', 'ack_ns'),
+    'first_fill': ('sent_ns', 'first_fill_ns'),
+    'fill': ('sent_ns', 'filled_ns'),
+    'order_to_fill': ('queued_ns', 'filled_ns'),
+}
+
+
+def _key(symbol: str) -> str:
+    """Book key shared by the engine's and the broker's spellings (BTC/USD, BTCUSD, EUR_USD)"""
+    return symbol.replace('/', '').replace('_', '').upper()
+
+
+class GatewayOrder:
+    """One order's state and latency timestamps (time.perf_counter_ns)"""
+
+    __slots__ = ('client_order_id', 'broker_order_id', 'symbol', 'side', 'quantity', 'order_type',
+                 'limit_price', 'current_price', 'status', 'filled_qty', 'avg_fill_price', 'error',
+                 'submitted_at', 'tick_ns', 'queued_ns', 'sent_ns', 'ack_ns', 'first_fill_ns', 'filled_ns', 'done_ns', 'exec_ids')
+
+    def __init__(self, symbol: str, side: str, quantity: float, order_type: str, limit_price: Optional[float],
+                 current_price: Optional[float] = None):
+        self.client_order_id = f"bat-{uuid.uuid4().hex[:24]}"
+        self.broker_order_id = None
+        self.symbol = symbol
+        self.side = side
+        self.quantity = float(quantity)
+        self.order_type = order_type
+        self.limit_price = limit_price
+        self.current_price = current_price
+        self.status = 'pending_new'
+        self.filled_qty = 0.0
+        self.avg_fill_price = None
+        self.error = None
+        self.submitted_at = datetime.now()
+        self.tick_ns = None
+        self.queued_ns = time.perf_counter_ns()
+        self.sent_ns = self.ack_ns = self.first_fill_ns = self.filled_ns = self.done_ns = None
+        self.exec_ids = set()
+
+    @property
+    def done(self) -> bool:
+        return self.done_ns is not None
+
+    @property
+    def signed_remaining(self) -> float:
+        remaining = max(self.quantity - self.filled_qty, 0.0)
+        return remaining if self.side == 'buy' else -remaining
+
+    def to_dict(self) -> dict:
+        result = {
+            'id': self.client_order_id,
+            'client_order_id': self.client_order_id,
+            'broker_order_id': self.broker_order_id,
+            'symbol': self.symbol,
+            'side': self.side,
+            'qty': self.quantity,
+            'order_type': self.order_type,
+            'status': self.status,
+            'filled_qty': self.filled_qty,
+            'submitted_at': str(self.submitted_at)
+        }
+        if self.avg_fill_price is not None:
+            result['avg_fill_price'] = self.avg_fill_price
+        if self.error:
+            result['error'] = self.error
+        return result
+
+    def latency_ms(self) -> Dict[str, float]:
+        """Elapsed milliseconds of each stage reached so far"""
+        out = {}
+        for stage, (start, end) in LATENCY_STAGES.items():
+            a, b = getattr(self, start), getattr(self, end)
+            if a is not None and b is not None:
+                out[stage] = (b - a) / 1e6
+        return out
+
+
+class _AlpacaAdapter:
+    """AlpacaBroker: REST submit on the pooled session, fills from trade_updates"""
+
+    def __init__(self, broker):
+        self.broker = broker
+        self._stream = None
+
+    def submit(self, order: GatewayOrder) -> Tuple[str, str]:
+        ack = self.broker.submit_order(order.symbol, order.quantity, order.side, order.order_type,
+                                       order.limit_price, client_order_id=order.client_order_id)
+        return ack.get('id'), ack.get('status', 'new')
+
+    def cancel(self, broker_order_id: str):
+        result = self.broker.cancel_order(broker_order_id)
+        if isinstance(result, dict) and result.get('status') == 'failed':
+            raise RuntimeError(result.get('error', 'cancel failed'))
+
+    def start_events(self, on_event: Callable[[dict], None], on_connect: Callable[[], None]):
+        self._stream = self.broker.stream_trade_updates(lambda data: on_event(self.normalize(data)),
+                                                        on_connect=on_connect)
+
+    def stop_events(self):
+        if self._stream is not None:
+            self._stream.stop()
+            self._stream = None
+
+    @staticmethod
+    def normalize(data: dict) -> dict:
+        order = data.get('order') or {}
+        kind = data.get('event')
+        event = {
+            'kind': 'fill' if kind in FILL_EVENTS else ('done' if kind in DONE_EVENTS else 'ack'),
+            'status': order.get('status', kind),
+            'client_order_id': order.get('client_order_id'),
+            'order_id': order.get('id'),
+            'symbol': order.get('symbol', ''),
+            'side': order.get('side'),
+        }
+        if kind in FILL_EVENTS:
+            event['qty'] = float(data.get('qty') or 0)
+            event['price'] = float(data.get('price') or order.get('filled_avg_price') or 0)
+            event['exec_id'] = data.get('execution_id')
+            if data.get('position_qty') is not None:
+                event['position_qty'] = float(data['position_qty'])
+        return event
+
+    def snapshot(self):
+        positions = {}
+        for position in self.broker.get_positions_api():
+            qty = float(position.get('qty', 0))
+            if position.get('side') == 'short' and qty > 0:
+                qty = -qty
+            positions[_key(position['symbol'])] = (qty, float(position.get('avg_entry_price', 0)),
+                                                   float(position.get('current_price') or 0) or None)
+        account = self.broker.get_account_api()
+        if not account:
+            raise ConnectionError("account request failed")
+        return positions, {name: float(account[name]) for name in ('equity', 'buying_power', 'cash')
+                           if account.get(name) is not None}
+
+
+class _IBAdapter:
+    """IBBroker: placeOrder without the acknowledgement wait, fills from execDetails"""
+
+    def __init__(self, broker):
+        self.broker = broker
+        self._on_event = None
+
+    def submit(self, order: GatewayOrder) -> Tuple[str, str]:
+        order_id = self.broker.place_order(order.symbol, order.quantity, order.side.upper(),
+                                           order.order_type, order.limit_price)
+        return str(order_id), 'Submitted'
+
+    def cancel(self, broker_order_id: str):
+        result = self.broker.cancel_order(broker_order_id)
+        if isinstance(result, dict) and result.get('status') == 'failed':
+            raise RuntimeError(result.get('error', 'cancel failed'))
+
+    def start_events(self, on_event: Callable[[dict], None], on_connect: Callable[[], None]):
+        if self._on_event is None:
+            self.broker.add_order_listener(self._listener)
+        self._on_event = on_event
+
+    def stop_events(self):
+        self._on_event = None
+
+    def _listener(self, event: dict):
+        if self._on_event is not None:
+            self._on_event(self.normalize(event))
+
+    @staticmethod
+    def normalize(event: dict) -> dict:
+        out = {'client_order_id': None, 'order_id': event['order_id'], 'symbol': event.get('symbol', ''),
+               'side': event.get('side')}
+        if event['event'] == 'fill':
+            # An execution only knows the cumulative quantity, not the order's: _apply
+            # marks the order filled once its quantity is reached
+            out.update(kind='fill', status='partially_filled', qty=event['qty'], price=event['price'],
+                       exec_id=event.get('exec_id'))
+        else:
+            status = event['status']
+            kind = 'done' if status in IB_DONE_STATUSES else 'ack'
+            if kind == 'ack' and event.get('filled_qty') and event.get('remaining'):
+                status = 'partially_filled'
+            out.update(kind=kind, status=status)
+        return out
+
+    def snapshot(self):
+        positions = {_key(symbol): (float(p['qty']), float(p['avg_entry_price']), None)
+                     for symbol, p in self.broker.get_positions_snapshot().items()}
+        account = self.broker.get_account()
+        if not account or not account.get('equity'):
+            raise ConnectionError("account summary request failed")
+        return positions, {'equity': float(account['equity']), 'buying_power': float(account['buying_power'])}
+
+
+class _SyncAdapter:
+    """Blocking buy/sell brokers: the call's result is the fill, positions are read back per symbol"""
+
+    def __init__(self, broker):
+        self.broker = broker
+        self._on_event = None
+        self._takes_price = 'current_price' in inspect.signature(broker.buy).parameters
+
+    def submit(self, order: GatewayOrder) -> Tuple[str, str]:
+        kwargs = {'order_type': order.order_type}
+        if order.limit_price is not None:
+            kwargs['limit_price'] = order.limit_price
+        if self._takes_price:
+            kwargs['current_price'] = order.current_price
+        send = self.broker.buy if order.side == 'buy' else self.broker.sell
+        result = send(order.symbol, order.quantity, **kwargs)
+        if not isinstance(result, dict) or result.get('status') == 'failed':
+            raise RuntimeError(result.get('error', 'order failed') if isinstance(result, dict) else result)
+        order_id = result.get('id') or order.client_order_id
+        if result.get('status') == 'filled' and self._on_event is not None:
+            price = (result.get('avg_fill_price') or result.get('filled_price') or result.get('price')
+                     or order.current_price or 0)
+            self._on_event({'kind': 'fill', 'status': 'filled', 'client_order_id': order.client_order_id,
+                            'order_id': order_id, 'symbol': order.symbol, 'side': order.side,
+                            'qty': float(result.get('qty') or order.quantity), 'price': float(price),
+                            'exec_id': order_id})
+        return order_id, result.get('status', 'new')
+
+    def cancel(self, broker_order_id: str):
+        result = self.broker.cancel_order(broker_order_id)
+        if isinstance(result, dict) and result.get('status') == 'failed':
+            raise RuntimeError(result.get('error', 'cancel failed'))
+        if self._on_event is not None:
+            self._on_event({'kind': 'done', 'status': 'canceled', 'client_order_id': None,
+                            'order_id': broker_order_id, 'symbol': '', 'side': None})
+
+    def start_events(self, on_event: Callable[[dict], None], on_connect: Callable[[], None]):
+        self._on_event = on_event
+
+    def stop_events(self):
+        self._on_event = None
+
+    def snapshot(self, symbols=()):
+        positions = {}
+        for symbol in set(getattr(self.broker, 'positions', {}) or ()) | set(symbols):
+            position = self.broker.get_position_for_symbol(symbol)
+            qty = float(position.get('qty', 0))
+            mark = float(position.get('market_value', 0)) / qty if qty else None
+            positions[_key(symbol)] = (qty, float(position.get('avg_entry_price', 0)), mark)
+        account = self.broker.get_account()
+        if not account or account.get('equity') is None:
+            raise ConnectionError("account request failed")
+        return positions, {name: float(account[name]) for name in ('equity', 'buying_power', 'cash')
+                           if account.get(name) is not None}
+
+
+class AsyncOrderGateway:
+    """
+    Non-blocking broker proxy with an event-driven position/account book
+
+    Exposes the wrapped broker's other methods unchanged, so the engine's
+    hasattr checks see the same interface plus refresh_positions.
+    """
+
+    def __init__(self, broker, reconcile_interval: float = 30.0, history: int = 10000,
+                 latency: Optional[LatencyRecorder] = None, synchronous: bool = False,
+                 max_requests_per_second: Optional[float] = None):
+        """
+        Args:
+            synchronous: Also accept brokers with only blocking buy/sell
+                (serialising every call into them)
+            max_requests_per_second: Limit on the sender's broker requests
+        """
+        self.broker = broker
+        self.latency = latency if latency is not None else LATENCY
+        self.adapter = self.adapter_for(broker, synchronous)
+        if self.adapter is None:
+            raise TypeError(f"{type(broker).__name__} has no asynchronous order interface")
+        self.reconcile_interval = reconcile_interval
+        self.min_request_gap = 1.0 / max_requests_per_second if max_requests_per_second else 0.0
+        self._last_request = 0.0
+        # Brokers driven synchronously are not thread-safe: one call at a time
+        self._broker_lock = threading.RLock() if isinstance(self.adapter, _SyncAdapter) else None
+
+        self._lock = threading.Lock()
+        self._orders: Dict[str, GatewayOrder] = {}            # client order id -> live order
+        self._by_broker_id: Dict[str, GatewayOrder] = {}
+        self._orphan_events: Dict[str, List[dict]] = {}        # events that beat the submit response
+        self.completed = deque(maxlen=history)
+        self._listeners: List[Callable[[dict], None]] = []
+        self._completions: List[dict] = []  # finished orders not yet passed to the listeners
+
+        # Book: filled quantity and average price per key, cash and the account at the last snapshot
+        self._positions: Dict[str, List[float]] = {}
+        self._marks: Dict[str, float] = {}
+        self._symbols: Dict[str, str] = {}
+        self._cash = 0.0
+        self._cash_at_snapshot = 0.0
+        self._buying_power_at_snapshot = 0.0
+        self._generation = 0  # bumped by every event, so a racing snapshot is discarded
+
+        self._queue = deque()
+        self._queue_cond = threading.Condition()
+        self._stop = threading.Event()
+        self._reconcile_now = threading.Event()
+        self._threads: List[threading.Thread] = []
+
+        self.reconciliations = 0
+        self.reconcile_drift = 0  # reconciliations that changed a position
+        self.events = 0
+        self.orders_sent = 0
+
+    @staticmethod
+    def adapter_for(broker, synchronous: bool = False):
+        """The gateway adapter for broker, or None when it cannot be driven asynchronously"""
+        if hasattr(broker, 'submit_order') and hasattr(broker, 'stream_trade_updates'):
+            return _AlpacaAdapter(broker)
+        if hasattr(broker, 'place_order') and hasattr(broker, 'add_order_listener'):
+            return _IBAdapter(broker)
+        if synchronous and hasattr(broker, 'buy') and hasattr(broker, 'sell'):
+            return _SyncAdapter(broker)
+        return None
+
+    @classmethod
+    def supports(cls, broker, synchronous: bool = False) -> bool:
+        return cls.adapter_for(broker, synchronous) is not None
+
+    def _broker_call(self, fn, *args, **kwargs):
+        """Run fn under the serialising lock of a synchronous broker"""
+        if self._broker_lock is None:
+            return fn(*args, **kwargs)
+        with self._broker_lock:
+            return fn(*args, **kwargs)
+
+    def _throttle(self):
+        if self.min_request_gap:
+            wait = self._last_request + self.min_request_gap - time.monotonic()
+            if wait > 0:
+                time.sleep(wait)
+        self._last_request = time.monotonic()
+
+    def start(self):
+        """Load the book from the broker, open the event stream and start the sender"""
+        if self._threads:
+            return self
+        self._stop.clear()
+        for _ in range(3):
+            if self.reconcile():
+                break
+        self.adapter.start_events(self._on_event, self._reconcile_now.set)
+        for target, name in ((self._send_loop, 'order-sender'), (self._reconcile_loop, 'order-reconcile')):
+            thread = threading.Thread(target=target, name=name, daemon=True)
+            thread.start()
+            self._threads.append(thread)
+        return self
+
+    def stop(self, timeout: float = 5):
+        """Send what is queued, then close the stream and stop the threads"""
+        with self._queue_cond:
+            self._stop.set()
+            self._queue_cond.notify_all()
+        self._reconcile_now.set()
+        for thread in self._threads:
+            thread.join(timeout=timeout)
+        self._threads = []
+        self.adapter.stop_events()
+
+    def __getattr__(self, name):
+        if name in ('broker', 'adapter', 'latency', '_broker_lock'):  # not set yet (during __init__)
+            raise AttributeError(name)
+        target = getattr(self.broker, name)  # AttributeError keeps hasattr() truthful
+        if self._broker_lock is not None and callable(target):
+            return functools.partial(self._broker_call, target)
+        return target
+
+    # Orders
+
+    def buy(self, symbol: str, quantity: float, order_type: str = "market", limit_price: float = None,
+            current_price: float = None) -> dict:
+        return self._enqueue(symbol, 'buy', quantity, order_type, limit_price, current_price)
+
+    def sell(self, symbol: str, quantity: float, order_type: str = "market", limit_price: float = None,
+             current_price: float = None) -> dict:
+        return self._enqueue(symbol, 'sell', quantity, order_type, limit_price, current_price)
+
+    def close_position(self, symbol: str, current_price: float = None, **_) -> dict:
+        """Flatten the booked position (filled and working) with a market order"""
+        qty = self._position_qty(_key(symbol))
+        if qty == 0:
+            return {'status': 'failed', 'error': 'No position to close'}
+        side = 'sell' if qty > 0 else 'buy'
+        return self._enqueue(symbol, side, abs(qty), 'market', None, current_price)
+
+    def cancel_order(self, order_id: str) -> dict:
+        """Queue a cancel behind the order's submission; the stream confirms it"""
+        with self._lock:
+            order = self._orders.get(order_id) or self._by_broker_id.get(order_id)
+        if order is None:
+            return {'status': 'failed', 'error': f'Unknown or finished order {order_id}'}
+        self._put(('cancel', order))
+        return {'status': 'pending_cancel', 'order_id': order_id}
+
+    def add_completion_listener(self, callback: Callable[[dict], None]):
+        """Call callback(order dict) once for every order that finishes, outside the gateway's lock"""
+        self._listeners.append(callback)
+
+    def _notify_completions(self):
+        with self._lock:
+            done, self._completions = self._completions, []
+        for order in done:
+            for callback in self._listeners:
+                try:
+                    callback(order)
+                except Exception as e:
+                    print(f"Error in order completion listener: {e}")
+
+    def refresh_positions(self):
+        """The book follows fills by itself; this only asks for an early reconcile"""
+        self._reconcile_now.set()
+
+    def _enqueue(self, symbol, side, quantity, order_type, limit_price, current_price) -> dict:
+        if quantity is None or quantity <= 0:
+            return {'status': 'failed', 'error': 'Quantity must be positive'}
+        order = GatewayOrder(symbol, side, quantity, order_type, limit_price, current_price)
+        order.tick_ns = self.latency.current_tick()
+        key = _key(symbol)
+        with self._lock:
+            self._orders[order.client_order_id] = order
+            self._symbols.setdefault(key, symbol)
+            if current_price:
+                self._marks[key] = float(current_price)
+            self._generation += 1
+        self._put(('submit', order))
+        return order.to_dict()
+
+    def _put(self, request):
+        with self._queue_cond:
+            self._queue.append(request)
+            self._queue_cond.notify_all()
+
+    def _send_loop(self):
+        while True:
+            with self._queue_cond:
+                while not self._queue:
+                    if self._stop.is_set():
+                        return
+                    self._queue_cond.wait()
+                action, order = self._queue.popleft()
+            if action == 'submit':
+                self._submit(order)
+            elif order.broker_order_id is not None and not order.done:
+                try:
+                    self._throttle()
+                    self._broker_call(self.adapter.cancel, order.broker_order_id)
+                except Exception as e:
+                    print(f" CANCEL FAILED - {order.side.upper()} {order.symbol} ({order.client_order_id}): {e}")
+
+    def _submit(self, order: GatewayOrder):
+        self._throttle()
+        order.sent_ns = time.perf_counter_ns()
+        self.orders_sent += 1
+        try:
+            broker_order_id, status = self._broker_call(self.adapter.submit, order)
+        except Exception as e:
+            order.ack_ns = time.perf_counter_ns()
+            with self._lock:
+                order.error = str(e)
+                self._finish(order, 'rejected')
+            print(f" ORDER REJECTED - {order.side.upper()} {order.quantity} {order.symbol}: {e}")
+            self._notify_completions()
+            return
+        order.ack_ns = time.perf_counter_ns()
+        self.latency.record('order_queue', order.sent_ns - order.queued_ns)
+        self.latency.record('ack', order.ack_ns - order.sent_ns)
+        with self._lock:
+            order.broker_order_id = broker_order_id
+            if order.status == 'pending_new':
+                order.status = status
+            if broker_order_id is not None and not order.done:  # a synchronous fill is already done
+                self._by_broker_id[broker_order_id] = order
+                orphans = self._orphan_events.pop(broker_order_id, [])
+            else:
+                orphans = []
+            for event in orphans:
+                self._apply(order, event)
+        self._notify_completions()
+
+    # Events
+
+    def _on_event(self, event: dict):
+        with self._lock:
+            self.events += 1
+            self._generation += 1
+            order = self._orders.get(event.get('client_order_id')) or self._by_broker_id.get(event.get('order_id'))
+            if order is None:
+                if event.get('order_id') is not None and event['kind'] != 'ack':
+                    # Not acknowledged yet (IB callbacks can beat placeOrder's return) or placed elsewhere
+                    pending = self._orphan_events.setdefault(event['order_id'], [])
+                    pending.append(event)
+                    if len(self._orphan_events) > 1000:
+                        self._orphan_events.pop(next(iter(self._orphan_events)))
+                return
+            self._apply(order, event)
+        self._notify_completions()
+
+    def _apply(self, order: GatewayOrder, event: dict):
+        """Fold one event into the order and the book (lock held)"""
+        if event['kind'] == 'fill':
+            exec_id = event.get('exec_id')
+            if exec_id is not None:
+                if exec_id in order.exec_ids:
+                    return
+                order.exec_ids.add(exec_id)
+            qty, price = event['qty'], event['price']
+            now = time.perf_counter_ns()
+            if order.first_fill_ns is None:
+                order.first_fill_ns = now
+            previous = order.filled_qty
+            order.filled_qty = min(order.quantity, previous + qty)
+            order.avg_fill_price = (price if not previous or order.avg_fill_price is None else
+                                    (order.avg_fill_price * previous + price * qty) / (previous + qty))
+            self._book_fill(_key(order.symbol), qty if order.side == 'buy' else -qty, price,
+                            event.get('position_qty'))
+            if order.filled_qty >= order.quantity - 1e-12:
+                order.filled_ns = now
+                self._finish(order, 'filled')
+                if order.sent_ns is not None:
+                    self.latency.record('fill', now - order.sent_ns)
+                if order.tick_ns is not None:
+                    self.latency.record('tick_to_fill', now - order.tick_ns)
+            else:
+                order.status = 'partially_filled'
+        elif event['kind'] == 'done':
+            self._finish(order, event.get('status') or 'canceled')
+            if order.status in ('rejected', 'Inactive'):
+                print(f" ORDER REJECTED - {order.side.upper()} {order.quantity} {order.symbol}")
+        elif order.status in ('pending_new', 'new', 'accepted', 'Submitted', 'PreSubmitted'):
+            order.status = event.get('status') or order.status
+
+    def _finish(self, order: GatewayOrder, status: str):
+        """Move an order out of the live set (lock held)"""
+        order.status = status
+        order.done_ns = time.perf_counter_ns()
+        self._orders.pop(order.client_order_id, None)
+        if order.broker_order_id is not None:
+            self._by_broker_id.pop(order.broker_order_id, None)
+        self.completed.append(order)
+        self._completions.append(order.to_dict())
+
+    def _book_fill(self, key: str, signed_qty: float, price: float, position_qty: Optional[float]):
+        position = self._positions.setdefault(key, [0.0, 0.0])
+        qty, avg = position
+        new_qty = qty + signed_qty
+        if qty == 0 or (qty > 0) != (new_qty > 0) and new_qty != 0:
+            avg = price  # opened or flipped
+        elif abs(new_qty) > abs(qty):
+            avg = (avg * abs(qty) + price * abs(signed_qty)) / abs(new_qty)
+        if position_qty is not None:
+            new_qty = position_qty  # the broker's running position wins
+        position[0], position[1] = new_qty, (avg if new_qty != 0 else 0.0)
+        self._cash -= signed_qty * price
+        self._marks[key] = price
+
+    # Reconciliation
+
+    def reconcile(self) -> bool:
+        """
+        Replace the book with the broker's positions and account
+
+        Returns:
+            False when an event arrived during the snapshot (the book is kept)
+        """
+        with self._lock:
+            generation = self._generation
+            symbols = list(self._symbols.values())
+        try:
+            if isinstance(self.adapter, _SyncAdapter):
+                positions, account = self._broker_call(self.adapter.snapshot, symbols)
+            else:
+                positions, account = self.adapter.snapshot()
+        except Exception as e:
+            print(f"Order gateway reconcile failed: {e}")
+            return False
+        with self._lock:
+            if generation != self._generation:
+                return False
+            changed = any(abs(self._positions.get(key, [0.0])[0] - qty) > 1e-9
+                          for key, (qty, _, _) in positions.items())
+            changed = changed or any(qty != 0 and key not in positions for key, (qty, _) in self._positions.items())
+            self._positions = {key: [qty, avg] for key, (qty, avg, _) in positions.items()}
+            for key, (_, avg, mark) in positions.items():
+                if mark:
+                    self._marks[key] = mark
+                else:
+                    self._marks.setdefault(key, avg)
+            if 'cash' in account:
+                cash = account['cash']
+            else:
+                cash = account['equity'] - sum(qty * self._marks.get(key, avg)
+                                               for key, (qty, avg) in self._positions.items())
+            self._cash = self._cash_at_snapshot = cash
+            self._buying_power_at_snapshot = account.get('buying_power', account['equity'])
+            self.reconciliations += 1
+            self.reconcile_drift += int(changed and self.reconciliations > 1)
+        return True
+
+    def _reconcile_loop(self):
+        while not self._stop.is_set():
+            self._reconcile_now.wait(self.reconcile_interval)
+            if self._stop.is_set():
+                return
+            self._reconcile_now.clear()
+            if not self.reconcile():
+                # Busy book: try again shortly
+                if self._stop.wait(0.5):
+                    return
+                self._reconcile_now.set()
+
+    # Reads served from the book
+
+    def _position_qty(self, key: str) -> float:
+        with self._lock:
+            filled = self._positions.get(key, [0.0, 0.0])[0]
+            working = sum(order.signed_remaining for order in self._orders.values()
+                          if order.order_type == 'market' and _key(order.symbol) == key)
+        return filled + working
+
+    def get_position_for_symbol(self, symbol: str) -> dict:
+        """Booked position: fills so far plus working market orders, without a broker request"""
+        key = _key(symbol)
+        qty = self._position_qty(key)
+        with self._lock:
+            filled, avg = self._positions.get(key, [0.0, 0.0])
+            mark = self._marks.get(key, avg)
+        return {
+            'symbol': symbol,
+            'qty': str(qty),
+            'filled_qty': str(filled),
+            'side': 'long' if qty > 0 else ('short' if qty < 0 else 'flat'),
+            'avg_entry_price': str(avg),
+            'market_value': str(filled * mark),
+            'unrealized_pl': str((mark - avg) * filled if filled else 0.0)
+        }
+
+    def get_account(self) -> dict:
+        """Account marked to the latest prices, from the last snapshot plus fills since"""
+        with self._lock:
+            equity = self._cash + sum(qty * self._marks.get(key, avg) for key, (qty, avg) in self._positions.items())
+            buying_power = self._buying_power_at_snapshot + (self._cash - self._cash_at_snapshot)
+            return {
+                'equity': equity,
+                'portfolio_value': equity,
+                'cash': self._cash,
+                'buying_power': buying_power
+            }
+
+    def get_account_api(self) -> dict:
+        return self.get_account()
+
+    def mark(self, symbol: str, price: float):
+        """Update the price the book values symbol at"""
+        with self._lock:
+            self._marks[_key(symbol)] = float(price)
+
+    # Latency
+
+    def open_orders(self) -> List[dict]:
+        with self._lock:
+            return [order.to_dict() for order in self._orders.values()]
+
+    def order_latencies(self) -> List[Dict[str, Any]]:
+        """Per completed order: ids, status and the milliseconds of each stage"""
+        with self._lock:
+            orders = list(self.completed)
+        return [{'id': order.client_order_id, 'symbol': order.symbol, 'side': order.side,
+                 'status': order.status, **order.latency_ms()} for order in orders]
+
+    def latency_summary(self) -> Dict[str, Dict[str, float]]:
+        """count / p50 / p90 / p99 / max milliseconds of each stage over the completed orders"""
+        samples: Dict[str, List[float]] = {stage: [] for stage in LATENCY_STAGES}
+        for record in self.order_latencies():
+            for stage in LATENCY_STAGES:
+                if stage in record:
+                    samples[stage].append(record[stage])
+        summary = {}
+        for stage, values in samples.items():
+            if not values:
+                continue
+            values.sort()
+
+            def rank(q):
+                return values[min(len(values) - 1, int(q * len(values)))]
+            summary[stage] = {'count': len(values), 'p50_ms': rank(0.5), 'p90_ms': rank(0.9),
+                              'p99_ms': rank(0.99), 'max_ms': values[-1]}
+        return summary
@@ -0,0 +1,273 @@
+import pandas as pd
+import numpy as np
+from typing import Dict, Any, Mapping, Union
+
+from engines.latency import LATENCY, now_ns
+
+try:
+    from native import portfolio as native_portfolio
+except ImportError:  # extension not built, use the Python loop
+    native_portfolio = None
+
+ACTION_NAMES = np.array(['BUY', 'CLOSE', 'CLOSE_SHORT', 'CLOSE_LONG', 'SELL_SHORT'], dtype=object)
+_BUY, _CLOSE, _CLOSE_SHORT, _CLOSE_LONG, _SELL_SHORT = range(5)
+
+
+class PortfolioBacktestEngine:
+    """
+    Backtest several symbols together on one cash balance
+
+    Every symbol's signals are aligned on the merged (sorted union) timestamp
+    index and the execution rules run in a single pass over it (natively when
+    native/portfolio.h is built). Per-symbol rules match BacktestEngine:
+    position_percentage of the current cash per entry, spread on forex pairs,
+    short proceeds credited to cash. On each timestamp every exit runs before
+    any entry, so freed cash is available to the same bar's entries.
+    """
+
+    def __init__(self, initial_balance: float = 10000, trading_mode: str = "long_only",
+                 position_percentage: float = 100.0, spread_pips: float = 0.0, use_native: bool = True,
+                 latency=None):
+        self.initial_balance = initial_balance
+        self.latency = latency if latency is not None else LATENCY  # engines/latency.py recorder
+        self.trading_mode = trading_mode
+        self.position_percentage = position_percentage / 100.0
+        self.spread_pips = spread_pips
+        self.use_native = use_native and native_portfolio is not None
+        self.reset()
+
+    def reset(self):
+        """Reset engine state"""
+        self.symbols = []
+        self.timestamps = pd.DatetimeIndex([])
+        self.equity_curve = pd.Series(dtype=float)
+        self.positions = {}
+        self.realized_gains = {}
+        self.current_balance = self.initial_balance
+        self.signals = {}
+
+    def _spread_cost(self, symbol: str) -> float:
+        """Spread as a price offset (forex only, JPY pairs quote in 0.01 pips)"""
+        if symbol.startswith('C:') and self.spread_pips > 0:
+            pip_value = 0.0001 if 'JPY' not in symbol else 0.01
+            return self.spread_pips * pip_value
+        return 0.0
+
+    def align(self, data: Mapping[str, pd.DataFrame], strategies) -> Dict[str, np.ndarray]:
+        """
+        Generate each symbol's signals and align them on the merged timestamp index
+
+        Returns:
+            dict with time-major 'close', 'buy', 'sell' matrices [n_times, n_symbols]
+        """
+        self.symbols = list(data)
+        frames = {}
+        for symbol in self.symbols:
+            strategy = strategies[symbol] if isinstance(strategies, Mapping) else strategies
+            start = now_ns()
+            df = strategy.generate_signals(data[symbol].copy())
+            self.latency.since('backtest.signal', start)
+            names = strategy.get_signal_names()
+            frame = pd.DataFrame({
+                'Close': df['Close'].to_numpy(dtype=np.float64),
+                'buy': df[names['buy']].fillna(False).astype(bool).to_numpy(),
+                'sell': df[names['sell']].fillna(False).astype(bool).to_numpy(),
+            }, index=pd.to_datetime(df['timestamp']))
+            # One row per timestamp: a duplicated bar keeps its last values
+            frames[symbol] = frame[~frame.index.duplicated(keep='last')]
+            self.signals[symbol] = df
+
+        index = frames[self.symbols[0]].index
+        for symbol in self.symbols[1:]:
+            index = index.union(frames[symbol].index)
+        self.timestamps = index.sort_values()
+
+        shape = (len(self.timestamps), len(self.symbols))
+        close = np.full(shape, np.nan)
+        buy = np.zeros(shape, dtype=bool)
+        sell = np.zeros(shape, dtype=bool)
+        for j, symbol in enumerate(self.symbols):
+            rows = self.timestamps.get_indexer(frames[symbol].index)
+            close[rows, j] = frames[symbol]['Close'].to_numpy()
+            buy[rows, j] = frames[symbol]['buy'].to_numpy()
+            sell[rows, j] = frames[symbol]['sell'].to_numpy()
+        return {'close': close, 'buy': buy, 'sell': sell}
+
+    def backtest(self, data: Mapping[str, pd.DataFrame],
+                 strategies: Union[object, Mapping[str, object]]) -> pd.DataFrame:
+        """
+        Run a shared-capital backtest
+
+        Args:
+            data: symbol -> DataFrame with OHLCV data and timestamp
+            strategies: One strategy for every symbol, or symbol -> strategy
+
+        Returns:
+            DataFrame with one row per trade (Time, Symbol, Action, ...)
+        """
+        self.reset()
+        if not data:
+            return pd.DataFrame()
+        matrices = self.align(data, strategies)
+        spreads = np.array([self._spread_cost(symbol) for symbol in self.symbols])
+
+        run = native_portfolio.run_portfolio if self.use_native else _run_portfolio_python
+        start = now_ns()
+        result = run(matrices['close'], matrices['buy'], matrices['sell'], spreads,
+                     long_short=self.trading_mode != "long_only",
+                     initial_balance=self.initial_balance,
+                     position_fraction=self.position_percentage)
+        self.latency.since('backtest.portfolio', start)
+
+        self.current_balance = result['cash_balance']
+        self.equity_curve = pd.Series(result['equity'], index=self.timestamps, name='Equity')
+        self.positions = {symbol: {'position': int(result['positions'][j]),
+                                   'shares': float(result['shares_held'][j]),
+                                   'entry_price': float(result['entry_prices'][j])}
+                          for j, symbol in enumerate(self.symbols)}
+        self.realized_gains = dict(zip(self.symbols, result['realized'].tolist()))
+
+        if len(result['time_index']) == 0:
+            return pd.DataFrame()
+        t = result['time_index']
+        return pd.DataFrame({
+            'Time': self.timestamps[t],
+            'Symbol': np.asarray(self.symbols, dtype=object)[result['asset']],
+            'Index': t,
+            'Action': ACTION_NAMES[result['action']],
+            'Price': result['price'],
+            'Position': result['position'].astype(np.int64),
+            'Shares': result['shares'],
+            'Value': result['value'],
+            'Profit': result['profit'],
+            'Balance': result['cash'],
+            'Total_Account_Worth': self.equity_curve.to_numpy()[t],
+        })
+
+    def analyze_results(self, trade_df: pd.DataFrame) -> Dict[str, Any]:
+        """Portfolio totals, drawdown and per-symbol realized profit"""
+        if self.equity_curve.empty:
+            return {}
+        equity = self.equity_curve.to_numpy()
+        peak = np.maximum.accumulate(equity)
+        drawdown = (equity - peak) / peak
+        closes = trade_df[trade_df['Action'].isin(['CLOSE', 'CLOSE_LONG', 'CLOSE_SHORT'])] if not trade_df.empty else trade_df
+        wins = int((closes['Profit'] > 0).sum()) if not closes.empty else 0
+        final_equity = float(equity[-1])
+        return {
+            'initial_balance': self.initial_balance,
+            'final_equity': final_equity,
+            'total_return': final_equity - self.initial_balance,
+            'total_return_pct': (final_equity / self.initial_balance - 1) * 100,
+            'max_drawdown_pct': float(drawdown.min() * 100),
+            'total_trades': len(trade_df),
+            'closed_trades': len(closes),
+            'win_rate': wins / len(closes) * 100 if len(closes) else 0.0,
+            'realized_by_symbol': dict(self.realized_gains),
+        }
+
+    def print_analysis(self, trade_df: pd.DataFrame):
+        """Print portfolio analysis"""
+        analysis = self.analyze_results(trade_df)
+        if not analysis:
+            print("No results to analyze")
+            return
+        print("\n" + "=" * 50)
+        print("PORTFOLIO BACKTEST RESULTS")
+        print("=" * 50)
+        print(f"Symbols: {', '.join(self.symbols)}")
+        print(f"Initial Balance: ${analysis['initial_balance']:,.2f}")
+        print(f"Final Equity: ${analysis['final_equity']:,.2f}")
+        print(f"Total Return: ${analysis['total_return']:,.2f} ({analysis['total_return_pct']:.2f}%)")
+        print(f"Max Drawdown: {analysis['max_drawdown_pct']:.2f}%")
+        print(f"Trades: {analysis['total_trades']} ({analysis['closed_trades']} closed, "
+              f"{analysis['win_rate']:.1f}% winners)")
+        for symbol, realized in analysis['realized_by_symbol'].items():
+            print(f"  {symbol}: ${realized:,.2f} realized")
+
+
+def _run_portfolio_python(close, buy, sell, spreads, long_short=False, initial_balance=10000.0,
+                          position_fraction=1.0):
+    """Python version of native.portfolio.run_portfolio (same rules and outputs)"""
+    n_times, n_assets = close.shape
+    position = np.zeros(n_assets, dtype=np.int32)
+    shares = np.zeros(n_assets)
+    entry = np.zeros(n_assets)
+    last_price = np.zeros(n_assets)
+    realized = np.zeros(n_assets)
+    equity = np.full(n_times, float(initial_balance))
+    log = {name: [] for name in ('time_index', 'asset', 'action', 'price', 'position', 'shares',
+                                 'value', 'profit', 'cash')}
+    cash = float(initial_balance)
+
+    def record(t, a, action, price, pos, sh, value, profit):
+        for name, v in zip(log, (t, a, action, price, pos, sh, value, profit, cash)):
+            log[name].append(v)
+
+    for t in range(n_times):
+        row = close[t]
+        present = ~np.isnan(row)
+        last_price[present] = row[present]
+        if t > 0:
+            pending = np.zeros(n_assets, dtype=np.int8)
+            # Exits (and entry decisions from the pre-trade position)
+            for a in np.flatnonzero(present):
+                price, b, s, spread = row[a], buy[t, a], sell[t, a], spreads[a]
+                if not long_short:
+                    if b and position[a] == 0:
+                        pending[a] = 1
+                    elif s and position[a] == 1:
+                        proceeds = shares[a] * (price - spread)
+                        profit = proceeds - shares[a] * entry[a]
+                        cash += proceeds
+                        realized[a] += profit
+                        record(t, a, _CLOSE, price - spread, 0, shares[a], proceeds, profit)
+                        position[a], entry[a], shares[a] = 0, 0.0, 0.0
+                    continue
+                if b and position[a] != 1:
+                    if position[a] == -1 and shares[a] > 0:
+                        cover = price + spread
+                        cost = shares[a] * cover
+                        profit = shares[a] * (entry[a] - cover)
+                        cash -= cost
+                        realized[a] += profit
+                        record(t, a, _CLOSE_SHORT, cover, 0, shares[a], cost, profit)
+                        position[a], shares[a] = 0, 0.0
+                    pending[a] = 1
+                elif s and position[a] != -1:
+                    if position[a] == 1 and shares[a] > 0:
+                        proceeds = shares[a] * (price - spread)
+                        profit = proceeds - shares[a] * entry[a]
+                        cash += proceeds
+                        realized[a] += profit
+                        record(t, a, _CLOSE_LONG, price - spread, 0, shares[a], proceeds, profit)
+                        position[a], entry[a], shares[a] = 0, 0.0, 0.0
+                    pending[a] = -1
+            # Entries
+            for a in np.flatnonzero(present & (pending != 0)):
+                if cash <= 0:
+                    continue
+                if pending[a] == 1:
+                    ask = row[a] + spreads[a]
+                    amount = min(cash * position_fraction, cash)
+                    n_shares = amount / ask
+                    cost = n_shares * ask
+                    if cost > 0 and cash >= cost:
+                        cash -= cost
+                        record(t, a, _BUY, ask, 1, n_shares, cost, 0.0)
+                        position[a], entry[a], shares[a] = 1, ask, n_shares
+                else:
+                    bid = row[a] - spreads[a]
+                    n_shares = cash * position_fraction / bid
+                    if n_shares > 0:
+                        proceeds = n_shares * bid
+                        cash += proceeds
+                        record(t, a, _SELL_SHORT, bid, -1, n_shares, proceeds, 0.0)
+                        position[a], entry[a], shares[a] = -1, bid, n_shares
+        equity[t] = cash + float(np.sum(position * shares * last_price))
+
+    dtypes = {'time_index': np.int64, 'asset': np.int32, 'action': np.int32, 'position': np.int32}
+    result = {name: np.asarray(values, dtype=dtypes.get(name, np.float64)) for name, values in log.items()}
+    result.update(equity=equity, positions=position, shares_held=shares, entry_prices=entry,
+                  realized=realized, cash_balance=cash)
+    return result
@@ -0,0 +1,364 @@
+"""
+Streaming (incremental) versions of the technical indicators
+
+Each indicator keeps its window state and takes one new value per update()
+in O(1), returning the same value the batch function in
+technical_indicators.py gives for the last row of the full history. The
+rolling kernels use the same compensated add/remove updates as pandas and
+the native kernels (native/indicators.h), so live values agree with a
+backtest over the same bars to rounding. NaN is returned until a window is
+full, matching the batch functions.
+"""
+
+import math
+from collections import deque
+
+NAN = float('nan')
+
+
+class StreamingSMA:
+    """rolling(window=period).mean(), one value at a time"""
+
+    def __init__(self, period: int):
+        if period < 1:
+            raise ValueError("period must be >= 1")
+        self.period = period
+        self.reset()
+
+    def reset(self):
+        self._window = deque()
+        self._nobs = 0
+        self._neg_count = 0
+        self._same_run = 0
+        self._prev = NAN
+        self._sum = 0.0
+        self._add_comp = 0.0
+        self._remove_comp = 0.0
+        self.value = NAN
+
+    @property
+    def ready(self) -> bool:
+        return self.value == self.value
+
+    def _add(self, x: float):
+        if x != x:
+            return
+        self._nobs += 1
+        y = x - self._add_comp
+        t = self._sum + y
+        self._add_comp = t - self._sum - y
+        self._sum = t
+        if math.copysign(1.0, x) < 0:
+            self._neg_count += 1
+        self._same_run = self._same_run + 1 if x == self._prev else 1
+        self._prev = x
+
+    def _remove(self, x: float):
+        if x != x:
+            return
+        self._nobs -= 1
+        y = -x - self._remove_comp
+        t = self._sum + y
+        self._remove_comp = t - self._sum - y
+        self._sum = t
+        if math.copysign(1.0, x) < 0:
+            self._neg_count -= 1
+
+    def update(self, x: float) -> float:
+        x = float(x)
+        if len(self._window) == self.period:
+            self._remove(self._window.popleft())
+        self._add(x)
+        self._window.append(x)
+
+        nobs = self._nobs
+        if nobs < self.period or nobs == 0:
+            self.value = NAN
+        elif self._same_run >= nobs:
+            self.value = self._prev
+        else:
+            result = self._sum / nobs
+            if (self._neg_count == 0 and result < 0) or (self._neg_count == nobs and result > 0):
+                result = 0.0
+            self.value = result
+        return self.value
+
+
+class StreamingStd:
+    """rolling(window=period).std(ddof), one value at a time (Welford add/remove)"""
+
+    def __init__(self, period: int, ddof: int = 1):
+        if period < 1:
+            raise ValueError("period must be >= 1")
+        self.period = period
+        self.ddof = ddof
+        self.reset()
+
+    def reset(self):
+        self._window = deque()
+        self._nobs = 0
+        self._same_run = 0
+        self._prev = NAN
+        self._mean = 0.0
+        self._ssqdm = 0.0
+        self._add_comp = 0.0
+        self._remove_comp = 0.0
+        self.value = NAN
+
+    @property
+    def ready(self) -> bool:
+        return self.value == self.value
+
+    def _add(self, x: float):
+        if x != x:
+            return
+        self._same_run = self._same_run + 1 if x == self._prev else 1
+        self._prev = x
+        self._nobs += 1
+        prev_mean = self._mean - self._add_comp
+        y = x - self._add_comp
+        t = y - self._mean
+        self._add_comp = t + self._mean - y
+        self._mean += t / self._nobs
+        self._ssqdm += (x - prev_mean) * (x - self._mean)
+
+    def _remove(self, x: float):
+        if x != x:
+            return
+        self._nobs -= 1
+        if self._nobs == 0:
+            self._mean = 0.0
+            self._ssqdm = 0.0
+            return
+        prev_mean = self._mean - self._remove_comp
+        y = x - self._remove_comp
+        t = y - self._mean
+        self._remove_comp = t + self._mean - y
+        self._mean -= t / self._nobs
+        self._ssqdm -= (x - prev_mean) * (x - self._mean)
+
+    def update(self, x: float) -> float:
+        x = float(x)
+        if len(self._window) == self.period:
+            self._remove(self._window.popleft())
+        self._add(x)
+        self._window.append(x)
+
+        nobs = self._nobs
+        if nobs < self.period or nobs <= self.ddof:
+            self.value = NAN
+        elif nobs == 1 or self._same_run >= nobs:
+            self.value = 0.0
+        else:
+            self.value = math.sqrt(max(self._ssqdm / (nobs - self.ddof), 0.0))
+        return self.value
+
+
+class StreamingEMA:
+    """ewm(span=span).mean() (adjust=True), one value at a time"""
+
+    def __init__(self, span: float):
+        if span < 1:
+            raise ValueError("span must be >= 1")
+        self.span = span
+        # Same span -> com -> alpha derivation as pandas
+        self._decay = 1.0 - 1.0 / (1.0 + (span - 1.0) / 2.0)
+        self.reset()
+
+    def reset(self):
+        self._started = False
+        self._nobs = 0
+        self._old_weight = 1.0
+        self.value = NAN
+
+    @property
+    def ready(self) -> bool:
+        return self.value == self.value
+
+    def update(self, x: float) -> float:
+        x = float(x)
+        observed = x == x
+        if not self._started:
+            self._started = True
+            self._weighted = x
+            self._nobs = int(observed)
+        else:
+            self._nobs += int(observed)
+            if self._weighted == self._weighted:
+                self._old_weight *= self._decay
+                if observed:
+                    if self._weighted != x:
+                        self._weighted = (self._old_weight * self._weighted + x) / (self._old_weight + 1.0)
+                    self._old_weight += 1.0
+            elif observed:
+                self._weighted = x
+        self.value = self._weighted if self._nobs >= 1 else NAN
+        return self.value
+
+
+def _rsi_from_averages(avg_gain: float, avg_loss: float) -> float:
+    """100 - 100 / (1 + gain / loss) with NumPy's division semantics"""
+    if avg_gain != avg_gain or avg_loss != avg_loss:
+        return NAN
+    if avg_loss == 0:
+        if avg_gain == 0:
+            return NAN
+        return 100.0
+    return 100.0 - 100.0 / (1.0 + avg_gain / avg_loss)
+
+
+class StreamingRSI:
+    """
+    Relative Strength Index, one close at a time
+
+    method='simple' matches technical_indicators.rsi (rolling means of gains
+    and losses); method='wilder' uses Wilder's smoothing, seeded with the
+    simple average of the first `period` changes.
+    """
+
+    def __init__(self, period: int = 14, method: str = 'simple'):
+        if period < 1:
+            raise ValueError("period must be >= 1")
+        if method not in ('simple', 'wilder'):
+            raise ValueError("method must be 'simple' or 'wilder'")
+        self.period = period
+        self.method = method
+        self.reset()
+
+    def reset(self):
+        self._prev_close = None
+        self._gain = StreamingSMA(self.period)
+        self._loss = StreamingSMA(self.period)
+        self._avg_gain = NAN
+        self._avg_loss = NAN
+        self._changes = 0
+        self.value = NAN
+
+    @property
+    def ready(self) -> bool:
+        return self.value == self.value
+
+    def update(self, close: float) -> float:
+        close = float(close)
+        # The first bar's undefined change counts as 0, as in the batch version
+        delta = close - self._prev_close if self._prev_close is not None else NAN
+        self._prev_close = close
+        gain = delta if delta > 0 else 0.0
+        loss = -delta if delta < 0 else 0.0
+
+        if self.method == 'simple':
+            self.value = _rsi_from_averages(self._gain.update(gain), self._loss.update(loss))
+            return self.value
+
+        if delta != delta and self._changes == 0:
+            return self.value  # no change yet
+        self._changes += 1
+        if self._changes <= self.period:
+            self._gain.update(gain)
+            self._loss.update(loss)
+            if self._changes == self.period:
+                self._avg_gain = self._gain.value
+                self._avg_loss = self._loss.value
+        else:
+            self._avg_gain = (self._avg_gain * (self.period - 1) + gain) / self.period
+            self._avg_loss = (self._avg_loss * (self.period - 1) + loss) / self.period
+        self.value = _rsi_from_averages(self._avg_gain, self._avg_loss)
+        return self.value
+
+
+class StreamingMACD:
+    """MACD line, signal and histogram, one close at a time"""
+
+    def __init__(self, fast_period: int = 12, slow_period: int = 26, signal_period: int = 9):
+        self.fast_period = fast_period
+        self.slow_period = slow_period
+        self.signal_period = signal_period
+        self.reset()
+
+    def reset(self):
+        self._fast = StreamingEMA(self.fast_period)
+        self._slow = StreamingEMA(self.slow_period)
+        self._signal = StreamingEMA(self.signal_period)
+        self.macd = NAN
+        self.signal = NAN
+        self.histogram = NAN
+
+    @property
+    def ready(self) -> bool:
+        return self.signal == self.signal
+
+    def update(self, close: float):
+        """Returns (macd, signal, histogram)"""
+        self.macd = self._fast.update(close) - self._slow.update(close)
+        self.signal = self._signal.update(self.macd)
+        self.histogram = self.macd - self.signal
+        return self.macd, self.signal, self.histogram
+
+
+class StreamingBollinger:
+    """Bollinger bands (rolling mean +/- num_std sample stds), one close at a time"""
+
+    def __init__(self, period: int = 20, num_std: float = 2.0):
+        self.period = period
+        self.num_std = num_std
+        self.reset()
+
+    def reset(self):
+        self._mean = StreamingSMA(self.period)
+        self._std = StreamingStd(self.period)
+        self.upper = NAN
+        self.middle = NAN
+        self.lower = NAN
+        self.std = NAN
+
+    @property
+    def ready(self) -> bool:
+        return self.middle == self.middle
+
+    def update(self, close: float):
+        """Returns (upper, middle, lower)"""
+        self.middle = self._mean.update(close)
+        self.std = self._std.update(close)
+        self.upper = self.middle + self.std * self.num_std
+        self.lower = self.middle - self.std * self.num_std
+        return self.upper, self.middle, self.lower
+
+
+def candlestick_pattern(open_price: float, high: float, low: float, close: float) -> str:
+    """Single-bar version of detect_candlestick_patterns: 'hammer', 'shooting_star' or 'none'"""
+    body = abs(close - open_price)
+    upper_shadow = high - max(open_price, close)
+    lower_shadow = min(open_price, close) - low
+    if body < lower_shadow * 2 and upper_shadow > body * 2 and lower_shadow < body * 0.5:
+        return 'shooting_star'
+    if body < upper_shadow * 2 and lower_shadow > body * 2 and upper_shadow < body * 0.5:
+        return 'hammer'
+    return 'none'
+
+
+class StreamingCandlestickPatterns:
+    """candlestick_signal_patterns for the latest bar, keeping the two previous bars"""
+
+    def __init__(self):
+        self.reset()
+
+    def reset(self):
+        self._prev_open = NAN
+        self._prev_close = NAN
+        self._prev2_close = NAN
+
+    def update(self, open_price: float, high: float, low: float, close: float) -> dict:
+        shape = candlestick_pattern(open_price, high, low, close)
+        prev_open, prev_close = self._prev_open, self._prev_close
+        rising = prev_close > self._prev2_close  # False while either is NaN
+        patterns = {
+            'hammer': shape == 'hammer' and not rising,
+            'hanging_man': shape == 'hammer' and rising,
+            'shooting_star': shape == 'shooting_star',
+            'bullish_engulfing': (prev_close < prev_open and close > open_price and
+                                  open_price <= prev_close and close >= prev_open),
+            'bearish_engulfing': (prev_close > prev_open and close < open_price and
+                                  open_price >= prev_close and close <= prev_open),
+        }
+        self._prev2_close, self._prev_close, self._prev_open = prev_close, close, open_price
+        return patterns
@@ -1,16 +1,46 @@
 import pandas as pd
 import numpy as np
 
+try:
+    from native import indicators as _native
+except ImportError:  # extension not built, use the pandas implementations
+    _native = None
+
+
+def _native_input(data, *periods):
+    """True when data/periods can go through the native kernels (numeric Series, positive int periods)"""
+    if _native is None or not isinstance(data, pd.Series) or data.dtype.kind not in 'biuf':
+        return False
+    return all(isinstance(p, (int, np.integer)) and not isinstance(p, bool) and p >= 1 for p in periods)
+
+
+def _like(values, data):
+    """Wrap a kernel output as a Series aligned with data"""
+    return pd.Series(values, index=data.index, name=data.name)
+
+
 def sma(data, period):
     """Simple Moving Average"""
+    if _native_input(data, period):
+        return _like(_native.rolling_mean(data.to_numpy(), period), data)
     return data.rolling(window=period).mean()
 
 def ema(data, period):
     """Exponential Moving Average"""
+    if _native_input(data) and isinstance(period, (int, float, np.number)) and period >= 1:
+        return _like(_native.ewm_mean(data.to_numpy(), period), data)
     return data.ewm(span=period).mean()
 
 def bollinger_bands(data, period=20, std_dev=2):
     """Bollinger Bands indicator"""
+    if _native_input(data, period) and isinstance(std_dev, (int, float, np.number)):
+        upper, middle, lower = _native.bollinger(data.to_numpy(), period, std_dev)
+        return {
+            'upper': _like(upper, data),
+            'middle': _like(middle, data),
+            'lower': _like(lower, data)
+        }
+
     sma_values = sma(data, period)
     rolling_std = data.rolling(window=period).std()
 
@@ -25,6 +55,9 @@ def bollinger_bands(data, period=20, std_dev=2):
 
 def rsi(data, period=14):
     """Relative Strength Index"""
+    if _native_input(data, period):
+        return _like(_native.rsi(data.to_numpy(), period), data)
+
     delta = data.diff()
     gain = (delta.where(delta > 0, 0)).rolling(window=period).mean()
     loss = (-delta.where(delta < 0, 0)).rolling(window=period).mean()
@@ -36,6 +69,14 @@ def rsi(data, period=14):
 
 def macd(data, fast_period=12, slow_period=26, signal_period=9):
     """MACD indicator"""
+    if _native_input(data, fast_period, slow_period, signal_period):
+        line, signal, histogram = _native.macd(data.to_numpy(), fast_period, slow_period, signal_period)
+        return {
+            'macd': _like(line, data),
+            'signal': _like(signal, data),
+            'histogram': _like(histogram, data)
+        }
+
     ema_fast = ema(data, fast_period)
     ema_slow = ema(data, slow_period)
 
@@ -49,8 +90,16 @@ def macd(data, fast_period=12, slow_period=26, signal_period=9):
         'histogram': histogram
     }
 
+_PATTERN_NAMES = np.array(['none', 'hammer', 'shooting_star'], dtype=object)
+
 def detect_candlestick_patterns(open_prices, high_prices, low_prices, close_prices):
     """Detect basic candlestick patterns"""
+    columns = (open_prices, high_prices, low_prices, close_prices)
+    if all(_native_input(s) and s.index.equals(close_prices.index) for s in columns):
+        codes = _native.candlestick_patterns(open_prices.to_numpy(), high_prices.to_numpy(),
+                                             low_prices.to_numpy(), close_prices.to_numpy())
+        return pd.Series(_PATTERN_NAMES[codes], index=close_prices.index)
+
     patterns = pd.Series(index=close_prices.index, dtype=str)
 
     # Calculate body and shadows
@@ -74,4 +123,27 @@ def detect_candlestick_patterns(open_prices, high_prices, low_prices, close_pric
     )
     patterns[shooting_star_condition] = 'shooting_star'
 
-    return patterns.fillna('none')
\ No newline at end of file
+    return patterns.fillna('none')
+
+def candlestick_signal_patterns(open_prices, high_prices, low_prices, close_prices):
+    """
+    The patterns CandlestickPatternsStrategy trades, one boolean column each
+
+    A hammer-shaped bar is a hanging man after a rising close (close[t-1] >
+    close[t-2]) and a hammer otherwise. Engulfing bars reverse the previous
+    bar's direction and their open/close span its open/close.
+    """
+    shape = detect_candlestick_patterns(open_prices, high_prices, low_prices, close_prices)
+    prev_open, prev_close = open_prices.shift(1), close_prices.shift(1)
+    rising = prev_close > close_prices.shift(2)
+    hammer_shape = shape == 'hammer'
+
+    return pd.DataFrame({
+        'hammer': hammer_shape & ~rising,
+        'hanging_man': hammer_shape & rising,
+        'shooting_star': shape == 'shooting_star',
+        'bullish_engulfing': ((prev_close < prev_open) & (close_prices > open_prices) &
+                              (open_prices <= prev_close) & (close_prices >= prev_open)),
+        'bearish_engulfing': ((prev_close > prev_open) & (close_prices < open_prices) &
+                              (open_prices >= prev_close) & (close_prices <= prev_open)),
+    }, index=close_prices.index)
@@ -0,0 +1,9 @@
+"""
+Native (C++/Cython) cores for the trading engines
+
+Build the extensions in place before use:
+    cd native && python setup.py build_ext --inplace
+
+Every module here is optional: callers fall back to their pure Python
+implementation when an extension has not been built.
+"""
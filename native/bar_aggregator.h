@@ -0,0 +1,100 @@
+// Tick-to-bar aggregation for the push streams in data_providers/streaming.py.
+//
+// Trades (or quote mid prices) arrive one at a time from a persistent
+// WebSocket / chunked HTTP connection and are folded into fixed-interval
+// OHLCV bars aligned to the epoch (so 1-minute bars start on the minute, as
+// the providers' own bars do). A bar is emitted when the first tick of a
+// later interval arrives, or from flush() once the interval has elapsed on
+// the wall clock, so a quiet market still closes its bars. Ticks older than
+// the open bar (or in an interval already emitted) are dropped rather than
+// rewriting a bar the engine has seen.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace bat {
+
+struct AggregatedBar {
+    int64_t start = 0;  // interval start, epoch nanoseconds UTC
+    double open = 0.0;
+    double high = 0.0;
+    double low = 0.0;
+    double close = 0.0;
+    double volume = 0.0;
+    uint64_t ticks = 0;
+};
+
+class BarAggregator {
+public:
+    explicit BarAggregator(int64_t interval_ns) : interval_(interval_ns) {
+        if (interval_ns <= 0) throw std::invalid_argument("interval must be positive");
+    }
+
+    int64_t interval() const { return interval_; }
+    bool has_open() const { return open_; }
+    uint64_t dropped() const { return dropped_; }
+
+    // Fold a tick in; returns true and fills out when it closes the open bar
+    bool on_tick(int64_t ts, double price, double size, AggregatedBar& out) {
+        if (price != price) return false;
+        const int64_t start = floor_interval(ts);
+        if ((open_ && start < bar_.start) || (emitted_ && start <= last_emitted_)) {
+            ++dropped_;
+            return false;
+        }
+
+        bool closed = false;
+        if (open_ && start > bar_.start) {
+            emit(out);
+            closed = true;
+        }
+
+        if (!open_) {
+            bar_.start = start;
+            bar_.open = bar_.high = bar_.low = bar_.close = price;
+            bar_.volume = size;
+            bar_.ticks = 1;
+            open_ = true;
+        } else {
+            if (price > bar_.high) bar_.high = price;
+            if (price < bar_.low) bar_.low = price;
+            bar_.close = price;
+            bar_.volume += size;
+            ++bar_.ticks;
+        }
+        return closed;
+    }
+
+    // Close the open bar once now (epoch ns) has passed its end
+    bool flush(int64_t now, AggregatedBar& out) {
+        if (!open_ || now < bar_.start + interval_) return false;
+        emit(out);
+        return true;
+    }
+
+private:
+    void emit(AggregatedBar& out) {
+        out = bar_;
+        open_ = false;
+        emitted_ = true;
+        last_emitted_ = bar_.start;
+    }
+
+    int64_t floor_interval(int64_t ts) const {
+        int64_t q = ts / interval_;
+        if (ts % interval_ < 0) --q;  // floor for pre-epoch timestamps
+        return q * interval_;
+    }
+
+    int64_t interval_;
+    AggregatedBar bar_;
+    bool open_ = false;
+    bool emitted_ = false;
+    int64_t last_emitted_ = 0;
+    uint64_t dropped_ = 0;
+};
+
+}  // namespace bat
@@ -0,0 +1,68 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int64_t, uint64_t
+
+
+cdef extern from "bar_aggregator.h" namespace "bat":
+    cdef cppclass AggregatedBar:
+        int64_t start
+        double open
+        double high
+        double low
+        double close
+        double volume
+        uint64_t ticks
+
+    cdef cppclass BarAggregator:
+        BarAggregator(int64_t interval_ns) except +
+        int64_t interval()
+        bint has_open()
+        uint64_t dropped()
+        bint on_tick(int64_t ts, double price, double size, AggregatedBar& out) nogil
+        bint flush(int64_t now, AggregatedBar& out) nogil
+
+
+cdef tuple _bar_tuple(const AggregatedBar& bar):
+    return (bar.start, bar.open, bar.high, bar.low, bar.close, bar.volume)
+
+
+cdef class TickBarAggregator:
+    """
+    Fixed-interval OHLCV bars from ticks (see bar_aggregator.h)
+
+    on_tick() and flush() return a closed bar as
+    (start_ns, open, high, low, close, volume), or None.
+    """
+    cdef BarAggregator* agg
+
+    def __cinit__(self, int64_t interval_ns):
+        self.agg = new BarAggregator(interval_ns)
+
+    def __dealloc__(self):
+        del self.agg
+
+    @property
+    def interval_ns(self):
+        return self.agg.interval()
+
+    @property
+    def has_open(self):
+        return self.agg.has_open()
+
+    @property
+    def dropped(self):
+        """Late ticks discarded because their bar was already emitted"""
+        return self.agg.dropped()
+
+    def on_tick(self, int64_t ts, double price, double size=0.0):
+        cdef AggregatedBar out
+        if self.agg.on_tick(ts, price, size, out):
+            return _bar_tuple(out)
+        return None
+
+    def flush(self, int64_t now):
+        cdef AggregatedBar out
+        if self.agg.flush(now, out):
+            return _bar_tuple(out)
+        return None
@@ -0,0 +1,329 @@
+// Scanner for the bar pages of the Polygon aggregates and Alpaca bars APIs.
+//
+// The historical fetcher downloads many pages at once; decoding a 50k-bar
+// page with json.loads builds 400k Python objects while holding the GIL,
+// which stalls the other downloads. parse_bar_page walks the page once,
+// without building a document, and writes the bars straight into column
+// vectors:
+//
+//   Polygon  {"results": [{"o":..,"h":..,"l":..,"c":..,"v":..,"t": ms}, ..],
+//             "next_url": "..", "status": "OK"}
+//   Alpaca   {"bars": {"SYM": [{"t": "RFC 3339", "o":.., ..}, ..]} or
+//             "bars": [..], "next_page_token": ".."}
+//
+// Timestamps come out as epoch nanoseconds (the .bars cache unit), numbers
+// are read with std::from_chars, keys are compared in place without
+// allocating and unknown values are skipped by bracket matching. Malformed input throws
+// std::invalid_argument with the byte offset.
+
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bat {
+
+struct BarPage {
+    std::vector<int64_t> timestamp;  // epoch ns
+    std::vector<double> open, high, low, close, volume;
+    std::string next;    // next_url (Polygon) or next_page_token (Alpaca), empty on the last page
+    std::string status;  // "status" when present
+    std::string error;   // "error" or "message" when present
+};
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+inline int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+class BarPageParser {
+public:
+    BarPageParser(const char* data, size_t size) : p_(data), begin_(data), end_(data + size) {}
+
+    void parse(BarPage& page) {
+        skip_ws();
+        expect('{');
+        if (peek() == '}') {
+            ++p_;
+            return;
+        }
+        for (;;) {
+            const std::string_view key = read_key();
+            skip_ws();
+            expect(':');
+            skip_ws();
+            if (key == "results") {
+                read_bar_list(page);
+            } else if (key == "bars") {
+                if (peek() == '[') {
+                    read_bar_list(page);
+                } else {
+                    read_symbol_bars(page);
+                }
+            } else if (key == "next_url" || key == "next_page_token") {
+                read_optional_string(page.next);
+            } else if (key == "status") {
+                read_optional_string(page.status);
+            } else if ((key == "error" || key == "message") && peek() == '"') {
+                page.error = read_string();
+            } else {
+                skip_value();
+            }
+            skip_ws();
+            if (peek() == ',') {
+                ++p_;
+                skip_ws();
+                continue;
+            }
+            expect('}');
+            return;
+        }
+    }
+
+private:
+    [[noreturn]] void fail(const char* what) const {
+        throw std::invalid_argument(std::string(what) + " at byte " + std::to_string(p_ - begin_));
+    }
+
+    char peek() const { return p_ < end_ ? *p_ : '\0'; }
+
+    void expect(char c) {
+        if (peek() != c) fail("malformed JSON");
+        ++p_;
+    }
+
+    void skip_ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) ++p_;
+    }
+
+    bool consume_literal(const char* word) {
+        const size_t n = std::strlen(word);
+        if (static_cast<size_t>(end_ - p_) < n || std::memcmp(p_, word, n) != 0) return false;
+        p_ += n;
+        return true;
+    }
+
+    // Keys and skipped strings, as the raw bytes between the quotes (no allocation)
+    std::string_view read_key() {
+        expect('"');
+        const char* start = p_;
+        while (p_ < end_ && *p_ != '"') p_ += *p_ == '\\' && end_ - p_ > 1 ? 2 : 1;
+        if (p_ >= end_) fail("unterminated string");
+        const std::string_view key(start, static_cast<size_t>(p_ - start));
+        ++p_;
+        return key;
+    }
+
+    // String values; escapes are kept verbatim except \/, \" and \\ (the URLs and tokens are ASCII)
+    std::string read_string() {
+        expect('"');
+        std::string out;
+        while (p_ < end_ && *p_ != '"') {
+            if (*p_ == '\\') {
+                if (++p_ == end_) break;
+                if (*p_ == '/' || *p_ == '"' || *p_ == '\\') {
+                    out.push_back(*p_++);
+                    continue;
+                }
+                out.push_back('\\');
+            }
+            out.push_back(*p_++);
+        }
+        expect('"');
+        return out;
+    }
+
+    void read_optional_string(std::string& out) {
+        if (consume_literal("null")) {
+            out.clear();
+            return;
+        }
+        out = read_string();
+    }
+
+    double read_number() {
+        double value = 0.0;
+        const char* start = p_;
+        if (p_ < end_ && *p_ == '+') ++start;  // from_chars rejects a leading '+'
+        const std::from_chars_result r = std::from_chars(start, end_, value);
+        if (r.ec != std::errc() || r.ptr == start) {
+            if (consume_literal("null")) return std::numeric_limits<double>::quiet_NaN();
+            fail("expected a number");
+        }
+        p_ = r.ptr;
+        return value;
+    }
+
+    // Epoch milliseconds (Polygon) as epoch ns; null, NaN and values past the
+    // int64 ns range are malformed rather than cast (undefined behaviour)
+    int64_t read_epoch_ms() {
+        const double ms = read_number();
+        constexpr double limit = static_cast<double>(std::numeric_limits<int64_t>::max() / 1000000);
+        if (!std::isfinite(ms) || std::fabs(ms) > limit) fail("malformed timestamp");
+        return static_cast<int64_t>(ms) * 1000000;
+    }
+
+    // "2024-01-02T15:04:05[.fraction](Z|+hh:mm|-hh:mm)" as epoch ns
+    int64_t read_rfc3339() {
+        const std::string s = read_string();
+        auto digits = [&s, this](size_t pos, size_t count) {
+            if (pos + count > s.size()) fail("malformed timestamp");
+            int64_t v = 0;
+            for (size_t i = pos; i < pos + count; ++i) {
+                if (s[i] < '0' || s[i] > '9') fail("malformed timestamp");
+                v = v * 10 + (s[i] - '0');
+            }
+            return v;
+        };
+        const int64_t days = days_from_civil(digits(0, 4), static_cast<unsigned>(digits(5, 2)),
+                                             static_cast<unsigned>(digits(8, 2)));
+        int64_t seconds = days * 86400 + digits(11, 2) * 3600 + digits(14, 2) * 60 + digits(17, 2);
+        int64_t nanos = 0;
+        size_t pos = 19;
+        if (pos < s.size() && s[pos] == '.') {
+            int64_t scale = 100000000;
+            for (++pos; pos < s.size() && s[pos] >= '0' && s[pos] <= '9'; ++pos) {
+                nanos += (s[pos] - '0') * scale;
+                scale /= 10;
+            }
+        }
+        if (pos < s.size() && (s[pos] == '+' || s[pos] == '-')) {
+            const int64_t offset = digits(pos + 1, 2) * 3600 + digits(pos + 4, 2) * 60;
+            seconds -= s[pos] == '+' ? offset : -offset;
+        }
+        return seconds * 1000000000 + nanos;
+    }
+
+    void read_bar(BarPage& page) {
+        constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+        int64_t t = 0;
+        bool has_t = false;
+        double o = nan, h = nan, l = nan, c = nan, v = 0.0;
+        expect('{');
+        skip_ws();
+        if (peek() != '}') {
+            for (;;) {
+                const std::string_view key = read_key();
+                skip_ws();
+                expect(':');
+                skip_ws();
+                if (key == "t") {
+                    t = peek() == '"' ? read_rfc3339() : read_epoch_ms();
+                    has_t = true;
+                } else if (key == "o") {
+                    o = read_number();
+                } else if (key == "h") {
+                    h = read_number();
+                } else if (key == "l") {
+                    l = read_number();
+                } else if (key == "c") {
+                    c = read_number();
+                } else if (key == "v") {
+                    v = read_number();
+                } else {
+                    skip_value();
+                }
+                skip_ws();
+                if (peek() != ',') break;
+                ++p_;
+                skip_ws();
+            }
+        }
+        expect('}');
+        if (!has_t) fail("bar without a timestamp");
+        page.timestamp.push_back(t);
+        page.open.push_back(o);
+        page.high.push_back(h);
+        page.low.push_back(l);
+        page.close.push_back(c);
+        page.volume.push_back(v);
+    }
+
+    void read_bar_list(BarPage& page) {
+        if (consume_literal("null")) return;
+        expect('[');
+        skip_ws();
+        if (peek() == ']') {
+            ++p_;
+            return;
+        }
+        for (;;) {
+            skip_ws();
+            read_bar(page);
+            skip_ws();
+            if (peek() != ',') break;
+            ++p_;
+        }
+        expect(']');
+    }
+
+    // Alpaca's {"SYMBOL": [bars], ...}; the fetcher asks for one symbol per request
+    void read_symbol_bars(BarPage& page) {
+        if (consume_literal("null")) return;
+        expect('{');
+        skip_ws();
+        if (peek() == '}') {
+            ++p_;
+            return;
+        }
+        for (;;) {
+            skip_ws();
+            read_key();
+            skip_ws();
+            expect(':');
+            skip_ws();
+            read_bar_list(page);
+            skip_ws();
+            if (peek() != ',') break;
+            ++p_;
+        }
+        expect('}');
+    }
+
+    void skip_value() {
+        const char c = peek();
+        if (c == '"') {
+            read_key();
+        } else if (c == '{' || c == '[') {
+            int depth = 0;
+            while (p_ < end_) {
+                const char ch = *p_;
+                if (ch == '"') {
+                    read_key();
+                    continue;
+                }
+                ++p_;
+                if (ch == '{' || ch == '[') ++depth;
+                if ((ch == '}' || ch == ']') && --depth == 0) return;
+            }
+            fail("unterminated value");
+        } else if (consume_literal("null") || consume_literal("true") || consume_literal("false")) {
+            return;
+        } else {
+            read_number();
+        }
+    }
+
+    const char* p_;
+    const char* begin_;
+    const char* end_;
+};
+
+inline void parse_bar_page(const char* data, size_t size, BarPage& page) {
+    BarPageParser(data, size).parse(page);
+}
+
+}  // namespace bat
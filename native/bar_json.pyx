@@ -0,0 +1,70 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int64_t
+from libc.string cimport memcpy
+from libcpp.string cimport string
+from libcpp.vector cimport vector
+
+cimport numpy as cnp
+import numpy as np
+
+cnp.import_array()
+
+
+cdef extern from "bar_json.h" namespace "bat":
+    cdef cppclass BarPage:
+        vector[int64_t] timestamp
+        vector[double] open, high, low, close, volume
+        string next
+        string status
+        string error
+
+    void parse_bar_page(const char* data, size_t size, BarPage& page) nogil except +
+
+
+cdef object _int64_column(vector[int64_t]& v):
+    out = np.empty(v.size(), dtype=np.int64)
+    cdef int64_t[::1] view = out
+    if v.size() > 0:
+        memcpy(&view[0], v.data(), v.size() * sizeof(int64_t))
+    return out
+
+
+cdef object _float64_column(vector[double]& v):
+    out = np.empty(v.size(), dtype=np.float64)
+    cdef double[::1] view = out
+    if v.size() > 0:
+        memcpy(&view[0], v.data(), v.size() * sizeof(double))
+    return out
+
+
+def parse_bars(const unsigned char[::1] payload):
+    """
+    Decode one Polygon aggregates or Alpaca bars response body
+
+    The scan runs without the GIL, so other fetch threads keep downloading.
+
+    Returns:
+        dict with 'timestamp' (int64 epoch ns), 'open', 'high', 'low',
+        'close', 'volume' (float64), and 'next' (next_url or
+        next_page_token), 'status' and 'error' (None when absent)
+    """
+    cdef BarPage page
+    cdef size_t n = payload.shape[0]
+    if n == 0:
+        raise ValueError("empty response body")
+    cdef const char* data = <const char*>&payload[0]
+    with nogil:
+        parse_bar_page(data, n, page)
+    return {
+        'timestamp': _int64_column(page.timestamp),
+        'open': _float64_column(page.open),
+        'high': _float64_column(page.high),
+        'low': _float64_column(page.low),
+        'close': _float64_column(page.close),
+        'volume': _float64_column(page.volume),
+        'next': page.next.decode() if not page.next.empty() else None,
+        'status': page.status.decode() if not page.status.empty() else None,
+        'error': page.error.decode() if not page.error.empty() else None,
+    }
@@ -0,0 +1,299 @@
+// Streaming pairwise correlation behind research/similarity.py.
+//
+// calculate_similarity_metrics outer-joins every returns series into one
+// DataFrame and calls .corr(), which needs the whole aligned matrix in
+// memory. StreamingCorrelation takes each series as sorted timestamped
+// chunks, in any interleaving, and keeps:
+//
+//   - an alignment join: per-series queues, from which a row is emitted for
+//     the smallest pending timestamp as soon as every unfinished series has
+//     data past it (missing series are NaN in that row), so only the
+//     not-yet-aligned tail of each series is buffered;
+//   - pairwise sums over pairwise-complete rows, as pandas' min_periods=1
+//     .corr(): count, sum and sum of squares of each side and the cross
+//     sum, for the upper triangle only. Values are shifted by each series'
+//     first observation to keep the sums well conditioned.
+//
+// Rows are applied in blocks: for a block of B rows the sums see a tile of
+// 8 first series x 64 second series at a time, so the tile's accumulators
+// stay in cache while the block streams past, and tiles of first series are
+// shared across threads. With window > 0 the last window rows are kept in a
+// ring and leave the sums again (the same kernel with weight -1); a
+// correlation snapshot is recorded every block_rows rows once the window is
+// full.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "worker_threads.h"
+
+namespace bat {
+
+constexpr size_t CORRELATION_TILE_I = 8;
+constexpr size_t CORRELATION_TILE_J = 64;
+
+class StreamingCorrelation {
+public:
+    // block_rows is the rolling step when window > 0 (at most window)
+    StreamingCorrelation(size_t n_series, size_t window = 0, size_t block_rows = 1024, unsigned n_threads = 0)
+        : k_(n_series),
+          window_(window),
+          block_rows_(block_rows),
+          n_threads_(n_threads ? n_threads : std::max(1u, std::thread::hardware_concurrency())),
+          queues_(n_series),
+          finished_(n_series, false),
+          shift_(n_series, std::numeric_limits<double>::quiet_NaN()),
+          sums_(SUM_COUNT * n_series * n_series, 0.0) {
+        if (n_series == 0) throw std::invalid_argument("need at least one series");
+        if (block_rows == 0) throw std::invalid_argument("block_rows must be at least 1");
+        if (window > 0 && block_rows > window) {
+            throw std::invalid_argument("block_rows (the rolling step) must not exceed window");
+        }
+        if (window_ > 0) ring_.resize(window_ * k_);
+        block_.reserve(block_rows_ * k_);
+    }
+
+    // Append sorted (timestamp, value) observations of one series; NaN values are missing
+    void push(size_t series, const int64_t* timestamps, const double* values, size_t n) {
+        check_series(series);
+        if (finished_[series]) throw std::invalid_argument("series already finished");
+        std::deque<std::pair<int64_t, double>>& q = queues_[series];
+        for (size_t i = 0; i < n; ++i) q.emplace_back(timestamps[i], values[i]);
+        drain();
+    }
+
+    // No more data for series; rows it was holding back are aligned
+    void finish(size_t series) {
+        check_series(series);
+        finished_[series] = true;
+        drain();
+    }
+
+    void finish_all() {
+        std::fill(finished_.begin(), finished_.end(), true);
+        drain();
+        flush();
+    }
+
+    // Apply the buffered partial block
+    void flush() {
+        if (!block_timestamps_.empty()) apply_block();
+    }
+
+    // K x K pairwise Pearson correlations of the applied rows (the window
+    // when rolling); NaN below two pairwise-complete rows or at zero variance
+    void correlation(double* out) const {
+        for (size_t i = 0; i < k_; ++i) {
+            for (size_t j = i; j < k_; ++j) {
+                const double r = pair_correlation(i, j);
+                out[i * k_ + j] = r;
+                out[j * k_ + i] = r;
+            }
+        }
+    }
+
+    // Pairwise-complete row counts, K x K
+    void counts(int64_t* out) const {
+        for (size_t i = 0; i < k_; ++i) {
+            for (size_t j = i; j < k_; ++j) {
+                const int64_t c = static_cast<int64_t>(std::llround(sum(SUM_N, i, j)));
+                out[i * k_ + j] = c;
+                out[j * k_ + i] = c;
+            }
+        }
+    }
+
+    // Per-series count, mean and sample std of the applied values
+    void series_stats(double* count, double* mean, double* stdev) const {
+        for (size_t i = 0; i < k_; ++i) {
+            const double n = sum(SUM_N, i, i);
+            const double m = n > 0 ? sum(SUM_X, i, i) / n : std::numeric_limits<double>::quiet_NaN();
+            const double ss = sum(SUM_XX, i, i) - n * m * m;
+            count[i] = n;
+            mean[i] = m + shift_[i];
+            stdev[i] = n > 1 ? std::sqrt(std::max(ss, 0.0) / (n - 1)) : std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    size_t n_series() const { return k_; }
+    size_t window() const { return window_; }
+    int64_t rows() const { return rows_; }
+
+    // Rolling snapshots: timestamp of the last row in each, and K x K each
+    const std::vector<int64_t>& snapshot_timestamps() const { return snapshot_timestamps_; }
+    const std::vector<double>& snapshots() const { return snapshots_; }
+    void clear_snapshots() {
+        snapshot_timestamps_.clear();
+        snapshots_.clear();
+    }
+
+private:
+    // Upper-triangle sums, each K x K row-major, over rows where both i and j are present
+    enum Sum { SUM_N = 0, SUM_X, SUM_Y, SUM_XX, SUM_YY, SUM_XY, SUM_COUNT };
+
+    double sum(int which, size_t i, size_t j) const { return sums_[(static_cast<size_t>(which) * k_ + i) * k_ + j]; }
+
+    double pair_correlation(size_t i, size_t j) const {
+        constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+        const double n = sum(SUM_N, i, j);
+        if (n < 2) return nan;
+        const double mx = sum(SUM_X, i, j) / n;
+        const double my = sum(SUM_Y, i, j) / n;
+        const double cxx = sum(SUM_XX, i, j) - n * mx * mx;
+        const double cyy = sum(SUM_YY, i, j) - n * my * my;
+        const double cxy = sum(SUM_XY, i, j) - n * mx * my;
+        if (!(cxx > 0) || !(cyy > 0)) return nan;
+        return cxy / std::sqrt(cxx * cyy);
+    }
+
+    void check_series(size_t series) const {
+        if (series >= k_) throw std::out_of_range("series index out of range");
+    }
+
+    // Emit aligned rows while no unfinished series can still add to the smallest pending timestamp
+    void drain() {
+        for (;;) {
+            bool any = false;
+            int64_t t = std::numeric_limits<int64_t>::max();
+            for (size_t s = 0; s < k_; ++s) {
+                if (queues_[s].empty()) {
+                    if (!finished_[s]) return;
+                    continue;
+                }
+                any = true;
+                t = std::min(t, queues_[s].front().first);
+            }
+            if (!any) return;
+
+            for (size_t s = 0; s < k_; ++s) {
+                double v = std::numeric_limits<double>::quiet_NaN();
+                if (!queues_[s].empty() && queues_[s].front().first == t) {
+                    v = queues_[s].front().second;
+                    queues_[s].pop_front();
+                }
+                if (v == v && shift_[s] != shift_[s]) shift_[s] = v;
+                block_.push_back(v == v ? v - shift_[s] : v);
+            }
+            block_timestamps_.push_back(t);
+            if (block_timestamps_.size() == block_rows_) apply_block();
+        }
+    }
+
+    void apply_block() {
+        const size_t n_rows = block_timestamps_.size();
+        if (window_ > 0) {
+            // Rows leaving the window, oldest first, then the new rows into the ring
+            const size_t leaving = ring_size_ + n_rows > window_ ? ring_size_ + n_rows - window_ : 0;
+            if (leaving) {
+                departing_.resize(leaving * k_);
+                for (size_t r = 0; r < leaving; ++r) {
+                    const double* src = ring_.data() + ((ring_head_ + r) % window_) * k_;
+                    std::copy(src, src + k_, departing_.begin() + r * k_);
+                }
+                ring_head_ = (ring_head_ + leaving) % window_;
+                ring_size_ -= leaving;
+                update(departing_.data(), leaving, -1.0);
+            }
+            for (size_t r = 0; r < n_rows; ++r) {
+                const double* src = block_.data() + r * k_;
+                std::copy(src, src + k_, ring_.begin() + ((ring_head_ + ring_size_) % window_) * k_);
+                ++ring_size_;
+            }
+        }
+        update(block_.data(), n_rows, 1.0);
+        rows_ += static_cast<int64_t>(n_rows);
+
+        if (window_ > 0 && ring_size_ == window_) {
+            snapshot_timestamps_.push_back(block_timestamps_.back());
+            const size_t offset = snapshots_.size();
+            snapshots_.resize(offset + k_ * k_);
+            correlation(snapshots_.data() + offset);
+        }
+        block_.clear();
+        block_timestamps_.clear();
+    }
+
+    // Add weight * every pairwise-complete product of rows (n_rows x K, NaN = missing)
+    void update(const double* rows, size_t n_rows, double weight) {
+        // Per-row weighted presence, value and square; missing values contribute 0
+        present_.resize(n_rows * k_);
+        value_.resize(n_rows * k_);
+        square_.resize(n_rows * k_);
+        for (size_t e = 0; e < n_rows * k_; ++e) {
+            const double v = rows[e];
+            const bool ok = v == v;
+            present_[e] = ok ? weight : 0.0;
+            value_[e] = ok ? weight * v : 0.0;
+            square_[e] = ok ? weight * v * v : 0.0;
+        }
+
+        const size_t n_tiles = (k_ + CORRELATION_TILE_I - 1) / CORRELATION_TILE_I;
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t tile; (tile = next.fetch_add(1, std::memory_order_relaxed)) < n_tiles;) {
+                update_tile(rows, n_rows, tile * CORRELATION_TILE_I, std::min(k_, (tile + 1) * CORRELATION_TILE_I));
+            }
+        };
+        const unsigned n = static_cast<unsigned>(std::min<size_t>(n_threads_, n_tiles));
+        run_workers(n, worker);
+    }
+
+    void update_tile(const double* rows, size_t n_rows, size_t i0, size_t i1) {
+        const size_t kk = k_ * k_;
+        for (size_t j0 = i0; j0 < k_; j0 += CORRELATION_TILE_J) {
+            const size_t j_end = std::min(k_, j0 + CORRELATION_TILE_J);
+            for (size_t t = 0; t < n_rows; ++t) {
+                const double* row = rows + t * k_;
+                const double* present = present_.data() + t * k_;
+                const double* value = value_.data() + t * k_;
+                const double* square = square_.data() + t * k_;
+                for (size_t i = i0; i < i1; ++i) {
+                    const double x = row[i];
+                    if (x != x) continue;
+                    const double x2 = x * x;
+                    const size_t begin = std::max(i, j0);
+                    double* base = sums_.data() + i * k_;
+#pragma omp simd
+                    for (size_t j = begin; j < j_end; ++j) {
+                        base[SUM_N * kk + j] += present[j];
+                        base[SUM_X * kk + j] += x * present[j];
+                        base[SUM_Y * kk + j] += value[j];
+                        base[SUM_XX * kk + j] += x2 * present[j];
+                        base[SUM_YY * kk + j] += square[j];
+                        base[SUM_XY * kk + j] += x * value[j];
+                    }
+                }
+            }
+        }
+    }
+
+    size_t k_;
+    size_t window_;
+    size_t block_rows_;
+    unsigned n_threads_;
+    std::vector<std::deque<std::pair<int64_t, double>>> queues_;
+    std::vector<bool> finished_;
+    std::vector<double> shift_;
+    std::vector<double> sums_;
+    std::vector<double> block_;
+    std::vector<int64_t> block_timestamps_;
+    std::vector<double> present_, value_, square_, departing_;
+    std::vector<double> ring_;
+    size_t ring_head_ = 0, ring_size_ = 0;
+    int64_t rows_ = 0;
+    std::vector<int64_t> snapshot_timestamps_;
+    std::vector<double> snapshots_;
+};
+
+}  // namespace bat
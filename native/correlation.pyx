@@ -0,0 +1,130 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int64_t
+from libc.string cimport memcpy
+from libcpp.vector cimport vector
+
+cimport numpy as cnp
+import numpy as np
+
+cnp.import_array()
+
+
+cdef extern from "correlation.h" namespace "bat":
+    cdef cppclass CorrelationEngine "bat::StreamingCorrelation":
+        CorrelationEngine(size_t n_series, size_t window, size_t block_rows, unsigned n_threads) except +
+        void push(size_t series, const int64_t* timestamps, const double* values, size_t n) nogil except +
+        void finish(size_t series) nogil except +
+        void finish_all() nogil
+        void flush() nogil
+        void correlation(double* out) nogil
+        void counts(int64_t* out) nogil
+        void series_stats(double* count, double* mean, double* stdev) nogil
+        size_t n_series()
+        size_t window()
+        int64_t rows()
+        const vector[int64_t]& snapshot_timestamps()
+        const vector[double]& snapshots()
+        void clear_snapshots()
+
+
+cdef class StreamingCorrelation:
+    """
+    One-pass pairwise correlation of timestamped series
+
+    Push each series' observations (sorted by timestamp, NaN = missing) in
+    chunks, in any order across series; rows are aligned on timestamps as
+    an outer join would and folded into pairwise sums, so memory is
+    O(n_series^2) plus the not-yet-aligned chunks. correlation() matches
+    DataFrame.corr() of the joined frame. With window > 0 the sums cover the
+    last window aligned rows and a snapshot is kept every block_rows rows.
+    """
+    cdef CorrelationEngine* engine
+
+    def __cinit__(self, size_t n_series, size_t window=0, size_t block_rows=1024, unsigned int n_threads=0):
+        self.engine = new CorrelationEngine(n_series, window, block_rows, n_threads)
+
+    def __dealloc__(self):
+        del self.engine
+
+    def push(self, size_t series, timestamps, values):
+        cdef const int64_t[::1] t = np.ascontiguousarray(timestamps, dtype=np.int64)
+        cdef const double[::1] v = np.ascontiguousarray(values, dtype=np.float64)
+        if t.shape[0] != v.shape[0]:
+            raise ValueError("timestamps and values must have the same length")
+        cdef size_t n = t.shape[0]
+        if n == 0:
+            return
+        with nogil:
+            self.engine.push(series, &t[0], &v[0], n)
+
+    def finish(self, size_t series):
+        """No more data for series"""
+        with nogil:
+            self.engine.finish(series)
+
+    def finish_all(self):
+        """Finish every series and apply the remaining rows"""
+        with nogil:
+            self.engine.finish_all()
+
+    def correlation(self):
+        """[n_series, n_series] correlations of the rows applied so far (the window when rolling)"""
+        cdef size_t k = self.engine.n_series()
+        cdef double[:, ::1] out = np.empty((k, k))
+        with nogil:
+            self.engine.correlation(&out[0, 0])
+        return np.asarray(out)
+
+    def counts(self):
+        """[n_series, n_series] pairwise-complete row counts"""
+        cdef size_t k = self.engine.n_series()
+        cdef int64_t[:, ::1] out = np.empty((k, k), dtype=np.int64)
+        with nogil:
+            self.engine.counts(&out[0, 0])
+        return np.asarray(out)
+
+    def series_stats(self):
+        """(count, mean, sample std) of each series' values"""
+        cdef size_t k = self.engine.n_series()
+        cdef double[::1] count = np.empty(k)
+        cdef double[::1] mean = np.empty(k)
+        cdef double[::1] stdev = np.empty(k)
+        with nogil:
+            self.engine.series_stats(&count[0], &mean[0], &stdev[0])
+        return np.asarray(count), np.asarray(mean), np.asarray(stdev)
+
+    def snapshots(self, bint clear=True):
+        """
+        Rolling correlations recorded so far
+
+        Returns:
+            (timestamps int64 [S], correlations [S, n_series, n_series]); with
+            clear the engine drops them, bounding memory on long streams
+        """
+        cdef size_t k = self.engine.n_series()
+        cdef const vector[int64_t]* ts = &self.engine.snapshot_timestamps()
+        cdef const vector[double]* values = &self.engine.snapshots()
+        cdef size_t s = ts.size()
+        timestamps = np.empty(s, dtype=np.int64)
+        matrices = np.empty((s, k, k))
+        if s:
+            memcpy(cnp.PyArray_DATA(timestamps), ts.data(), s * sizeof(int64_t))
+            memcpy(cnp.PyArray_DATA(matrices), values.data(), s * k * k * sizeof(double))
+        if clear:
+            self.engine.clear_snapshots()
+        return timestamps, matrices
+
+    @property
+    def rows(self):
+        """Aligned rows applied so far"""
+        return self.engine.rows()
+
+    @property
+    def n_series(self):
+        return self.engine.n_series()
+
+    @property
+    def window(self):
+        return self.engine.window()
@@ -0,0 +1,164 @@
+// Screen-resolution decimation for the backtest and live charts.
+//
+// A multi-month minute backtest has ~350k bars, a hundred times more than
+// a chart has pixels across, and Plotly ships every point to the browser.
+// These reduce a series to B horizontal buckets, bucket b covering bars
+// [b*n/B, (b+1)*n/B):
+//
+//   ohlc_buckets   candles: each bucket becomes one candle (first open,
+//                  highest high, lowest low, last close, summed volume), so
+//                  ranges and wicks are exact at the bucket's width;
+//   m4_indices     lines: the first, minimum, maximum and last sample of
+//                  each bucket (M4), in bar order, which rasterises to the
+//                  same pixels as the full line at B pixels wide;
+//   lttb_indices   lines where shape matters more than extremes: Largest
+//                  Triangle Three Buckets, one sample per bucket.
+//
+// NaN samples (indicator warm-up) are skipped for extremes; a bucket with
+// no finite sample keeps its first one, so warm-up gaps stay gaps. Series
+// already within the limit come back unchanged (every index).
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace bat {
+
+struct OhlcBuckets {
+    std::vector<int64_t> index;  // first bar of the bucket
+    std::vector<int64_t> count;  // bars in the bucket
+    std::vector<double> open, high, low, close, volume;
+
+    void reserve(size_t n) {
+        index.reserve(n);
+        count.reserve(n);
+        open.reserve(n);
+        high.reserve(n);
+        low.reserve(n);
+        close.reserve(n);
+        volume.reserve(n);
+    }
+};
+
+inline size_t bucket_begin(size_t b, size_t n, size_t buckets) {
+    return static_cast<size_t>(static_cast<unsigned long long>(b) * n / buckets);
+}
+
+// volume may be null (zeros)
+inline void ohlc_buckets(const double* open, const double* high, const double* low, const double* close,
+                         const double* volume, size_t n, size_t buckets, OhlcBuckets& out) {
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    out = OhlcBuckets();
+    if (n == 0) return;
+    if (buckets == 0 || buckets > n) buckets = n;
+    out.reserve(buckets);
+    for (size_t b = 0; b < buckets; ++b) {
+        const size_t begin = bucket_begin(b, n, buckets);
+        const size_t end = bucket_begin(b + 1, n, buckets);
+        double hi = nan, lo = nan, vol = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            // fmax/fmin return the other operand when one is NaN
+            hi = std::fmax(hi, high[i]);
+            lo = std::fmin(lo, low[i]);
+            if (volume != nullptr && volume[i] == volume[i]) vol += volume[i];
+        }
+        out.index.push_back(static_cast<int64_t>(begin));
+        out.count.push_back(static_cast<int64_t>(end - begin));
+        out.open.push_back(open[begin]);
+        out.high.push_back(hi);
+        out.low.push_back(lo);
+        out.close.push_back(close[end - 1]);
+        out.volume.push_back(vol);
+    }
+}
+
+inline void identity_indices(size_t n, std::vector<int64_t>& keep) {
+    keep.resize(n);
+    for (size_t i = 0; i < n; ++i) keep[i] = static_cast<int64_t>(i);
+}
+
+// At most 4 * buckets indices, ascending
+inline void m4_indices(const double* y, size_t n, size_t buckets, std::vector<int64_t>& keep) {
+    keep.clear();
+    if (buckets == 0 || n <= 4 * buckets) {
+        identity_indices(n, keep);
+        return;
+    }
+    keep.reserve(4 * buckets);
+    for (size_t b = 0; b < buckets; ++b) {
+        const size_t begin = bucket_begin(b, n, buckets);
+        const size_t end = bucket_begin(b + 1, n, buckets);
+        size_t lo = end, hi = end;
+        for (size_t i = begin; i < end; ++i) {
+            const double v = y[i];
+            if (v != v) continue;
+            if (lo == end || v < y[lo]) lo = i;
+            if (hi == end || v > y[hi]) hi = i;
+        }
+        if (lo == end) lo = hi = begin;
+        size_t picks[4] = {begin, lo, hi, end - 1};
+        std::sort(picks, picks + 4);
+        for (size_t k = 0; k < 4; ++k) {
+            if (k == 0 || picks[k] != picks[k - 1]) keep.push_back(static_cast<int64_t>(picks[k]));
+        }
+    }
+}
+
+// n_out indices (the first and last sample plus one per inner bucket);
+// x may be null (sample positions)
+inline void lttb_indices(const double* x, const double* y, size_t n, size_t n_out, std::vector<int64_t>& keep) {
+    keep.clear();
+    if (n_out < 3 || n <= n_out) {
+        identity_indices(n, keep);
+        return;
+    }
+    auto xs = [x](size_t i) { return x != nullptr ? x[i] : static_cast<double>(i); };
+    keep.reserve(n_out);
+    keep.push_back(0);
+    const size_t inner = n - 2, buckets = n_out - 2;
+    size_t a = 0;  // previously selected sample
+    for (size_t b = 0; b < buckets; ++b) {
+        const size_t begin = 1 + bucket_begin(b, inner, buckets);
+        const size_t end = 1 + bucket_begin(b + 1, inner, buckets);
+
+        // Third triangle vertex: mean of the next bucket's finite samples (the last sample at the end)
+        const size_t next_begin = end;
+        const size_t next_end = b + 1 < buckets ? 1 + bucket_begin(b + 2, inner, buckets) : n;
+        double cx = 0.0, cy = 0.0;
+        size_t m = 0;
+        for (size_t i = next_begin; i < next_end; ++i) {
+            if (y[i] != y[i]) continue;
+            cx += xs(i);
+            cy += y[i];
+            ++m;
+        }
+        if (m > 0) {
+            cx /= static_cast<double>(m);
+            cy /= static_cast<double>(m);
+        } else {
+            cx = xs(next_end - 1);
+            cy = y[next_end - 1];
+        }
+
+        const double ax = xs(a), ay = y[a];
+        size_t best = begin;
+        double best_area = -1.0;
+        for (size_t i = begin; i < end; ++i) {
+            const double area = std::fabs((ax - cx) * (y[i] - ay) - (ax - xs(i)) * (cy - ay));
+            if (area > best_area) {  // false for NaN
+                best_area = area;
+                best = i;
+            }
+        }
+        keep.push_back(static_cast<int64_t>(best));
+        a = best;
+    }
+    keep.push_back(static_cast<int64_t>(n - 1));
+}
+
+}  // namespace bat
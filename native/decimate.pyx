@@ -0,0 +1,105 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int64_t
+from libc.string cimport memcpy
+from libcpp.vector cimport vector
+
+cimport numpy as cnp
+import numpy as np
+
+cnp.import_array()
+
+
+cdef extern from "decimate.h" namespace "bat":
+    cdef cppclass OhlcBuckets:
+        vector[int64_t] index
+        vector[int64_t] count
+        vector[double] open
+        vector[double] high
+        vector[double] low
+        vector[double] close
+        vector[double] volume
+
+    void ohlc_buckets(const double* open, const double* high, const double* low, const double* close,
+                      const double* volume, size_t n, size_t buckets, OhlcBuckets& out) nogil
+    void m4_indices(const double* y, size_t n, size_t buckets, vector[int64_t]& keep) nogil
+    void lttb_indices(const double* x, const double* y, size_t n, size_t n_out, vector[int64_t]& keep) nogil
+
+
+cdef object _copy_vector(const void* data, size_t size, int typenum, size_t itemsize):
+    """Copy a std::vector's contents into a new NumPy array"""
+    cdef cnp.npy_intp n = <cnp.npy_intp>size
+    cdef cnp.ndarray arr = cnp.PyArray_EMPTY(1, &n, typenum, 0)
+    if size > 0:
+        memcpy(cnp.PyArray_DATA(arr), data, size * itemsize)
+    return arr
+
+
+def ohlc(open, high, low, close, volume=None, size_t n_buckets=2000):
+    """
+    Aggregate bars into n_buckets candles of equal bar counts (see decimate.h)
+
+    Returns:
+        dict of 'index' (first bar of each candle), 'count', 'open', 'high',
+        'low', 'close' and 'volume' arrays
+    """
+    cdef const double[::1] o = np.ascontiguousarray(open, dtype=np.float64)
+    cdef const double[::1] h = np.ascontiguousarray(high, dtype=np.float64)
+    cdef const double[::1] l = np.ascontiguousarray(low, dtype=np.float64)
+    cdef const double[::1] c = np.ascontiguousarray(close, dtype=np.float64)
+    cdef const double[::1] v
+    cdef const double* vp = NULL
+    cdef size_t n = o.shape[0]
+    if h.shape[0] != n or l.shape[0] != n or c.shape[0] != n:
+        raise ValueError("open, high, low and close must have the same length")
+    if volume is not None:
+        v = np.ascontiguousarray(volume, dtype=np.float64)
+        if v.shape[0] != n:
+            raise ValueError("volume must have the same length as close")
+        if n > 0:
+            vp = &v[0]
+
+    cdef OhlcBuckets out
+    if n > 0:
+        with nogil:
+            ohlc_buckets(&o[0], &h[0], &l[0], &c[0], vp, n, n_buckets, out)
+    return {
+        'index': _copy_vector(out.index.data(), out.index.size(), cnp.NPY_INT64, 8),
+        'count': _copy_vector(out.count.data(), out.count.size(), cnp.NPY_INT64, 8),
+        'open': _copy_vector(out.open.data(), out.open.size(), cnp.NPY_DOUBLE, 8),
+        'high': _copy_vector(out.high.data(), out.high.size(), cnp.NPY_DOUBLE, 8),
+        'low': _copy_vector(out.low.data(), out.low.size(), cnp.NPY_DOUBLE, 8),
+        'close': _copy_vector(out.close.data(), out.close.size(), cnp.NPY_DOUBLE, 8),
+        'volume': _copy_vector(out.volume.data(), out.volume.size(), cnp.NPY_DOUBLE, 8),
+    }
+
+
+def m4(values, size_t n_buckets=2000):
+    """Indices of each bucket's first, minimum, maximum and last sample, ascending"""
+    cdef const double[::1] y = np.ascontiguousarray(values, dtype=np.float64)
+    cdef size_t n = y.shape[0]
+    cdef vector[int64_t] keep
+    if n > 0:
+        with nogil:
+            m4_indices(&y[0], n, n_buckets, keep)
+    return _copy_vector(keep.data(), keep.size(), cnp.NPY_INT64, 8)
+
+
+def lttb(values, size_t n_out=2000, x=None):
+    """Indices of n_out samples picked by Largest Triangle Three Buckets, ascending"""
+    cdef const double[::1] y = np.ascontiguousarray(values, dtype=np.float64)
+    cdef const double[::1] xs
+    cdef const double* xp = NULL
+    cdef size_t n = y.shape[0]
+    cdef vector[int64_t] keep
+    if x is not None:
+        xs = np.ascontiguousarray(x, dtype=np.float64)
+        if xs.shape[0] != n:
+            raise ValueError("x must have the same length as values")
+        if n > 0:
+            xp = &xs[0]
+    if n > 0:
+        with nogil:
+            lttb_indices(xp, &y[0], n, n_out, keep)
+    return _copy_vector(keep.data(), keep.size(), cnp.NPY_INT64, 8)
@@ -0,0 +1,21 @@
+// Equity curve helpers for risk reporting. Charts reduce the curve with
+// m4_indices (decimate.h) like any other line.
+//
+// drawdown_series writes the running peak-to-trough loss of every bar,
+// as a fraction of the running peak.
+
+#pragma once
+
+#include <cstddef>
+
+namespace bat {
+
+inline void drawdown_series(const double* equity, size_t n, double* out) {
+    double peak = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        if (i == 0 || equity[i] > peak) peak = equity[i];
+        out[i] = peak > 0 ? (peak - equity[i]) / peak : 0.0;
+    }
+}
+
+}  // namespace bat
@@ -0,0 +1,252 @@
+// Signal execution core for BacktestEngine.backtest.
+//
+// Walks precomputed close / buy / sell columns once and applies the same
+// rules as BacktestEngine._process_long_only_signals and
+// _process_long_short_signals: percentage-of-balance sizing, a fixed spread
+// added on buys and subtracted on sells (the caller converts spread_pips to
+// a price offset, including the JPY pip size), and account worth tracked on
+// realized gains only. Trades are appended to a columnar log that
+// execution.pyx turns into the engine's trade DataFrame; the log is optional
+// (record_trades) and is reserved up front from the signal count, so it
+// never reallocates mid-run. Performance metrics are accumulated online
+// (metrics.h) from closed trades and the per-bar mark-to-market equity, so
+// runs that only need metrics skip the log entirely. With record_equity the
+// mark-to-market value of every bar is also kept in one contiguous series
+// (bar 0 included) for plotting and intrabar drawdown.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "metrics.h"
+
+namespace bat {
+
+enum ExecutionAction {
+    EXEC_BUY = 0,         // open long
+    EXEC_CLOSE = 1,       // close long (long_only mode)
+    EXEC_CLOSE_SHORT = 2,
+    EXEC_CLOSE_LONG = 3,  // close long (long_short mode)
+    EXEC_SELL_SHORT = 4,
+};
+
+struct ExecutionConfig {
+    bool long_short = false;
+    double initial_balance = 10000.0;
+    double position_fraction = 1.0;  // share of the balance used per trade
+    double spread = 0.0;             // price offset, 0 when no spread applies
+    bool record_trades = true;       // false: metrics only, no trade log
+    bool record_equity = false;      // keep the per-bar mark-to-market series
+};
+
+// Mirrors the BacktestEngine attributes the Python loop mutates
+struct ExecutionState {
+    int position = 0;  // 0 = flat, 1 = long, -1 = short
+    double entry_price = 0.0;
+    double realized_gains = 0.0;
+    double current_balance = 0.0;
+    double shares_held = 0.0;
+};
+
+// One row per trade; fields that do not apply to an action are 0
+// (execution.pyx maps them back to missing values)
+struct TradeLog {
+    std::vector<int64_t> index;
+    std::vector<int32_t> action;
+    std::vector<double> price;
+    std::vector<int32_t> position;
+    std::vector<double> shares;
+    std::vector<double> cost;
+    std::vector<double> proceeds;
+    std::vector<double> profit;
+    std::vector<double> balance;
+    std::vector<double> account_worth;
+
+    size_t size() const { return index.size(); }
+
+    void reserve(size_t n) {
+        index.reserve(n);
+        action.reserve(n);
+        price.reserve(n);
+        position.reserve(n);
+        shares.reserve(n);
+        cost.reserve(n);
+        proceeds.reserve(n);
+        profit.reserve(n);
+        balance.reserve(n);
+        account_worth.reserve(n);
+    }
+
+    void push_back(size_t i, int act, double px, int pos, double sh, double c, double pr, double pnl,
+                   double bal, double worth) {
+        index.push_back(static_cast<int64_t>(i));
+        action.push_back(act);
+        price.push_back(px);
+        position.push_back(pos);
+        shares.push_back(sh);
+        cost.push_back(c);
+        proceeds.push_back(pr);
+        profit.push_back(pnl);
+        balance.push_back(bal);
+        account_worth.push_back(worth);
+    }
+};
+
+class SignalExecutor {
+public:
+    explicit SignalExecutor(const ExecutionConfig& config) : config_(config) {
+        state_.current_balance = config.initial_balance;
+    }
+
+    const ExecutionState& state() const { return state_; }
+    const TradeLog& log() const { return log_; }
+    const MetricsAccumulator& metrics() const { return metrics_; }
+    size_t events() const { return events_; }  // trades executed, logged or not
+    const std::vector<double>& equity() const { return equity_; }
+
+    // Process bars [1, n), the first bar only seeds the strategy as in Python
+    void run(const double* close, const uint8_t* buy, const uint8_t* sell, size_t n) {
+        if (config_.record_trades) {
+            // A bar logs at most one entry, or two when long_short reverses
+            size_t signals = 0;
+            for (size_t i = 1; i < n; ++i) signals += (buy[i] | sell[i]) != 0;
+            log_.reserve(log_.size() + (config_.long_short ? 2 * signals : signals));
+        }
+        if (config_.record_equity) equity_.reserve(equity_.size() + n);
+        if (n > 0) mark(close[0]);
+        for (size_t i = 1; i < n; ++i) bar(i, close[i], buy[i] != 0, sell[i] != 0);
+    }
+
+    void bar(size_t i, double close, bool buy_signal, bool sell_signal) {
+        if (config_.long_short) {
+            long_short(i, close, buy_signal, sell_signal);
+        } else {
+            long_only(i, close, buy_signal, sell_signal);
+        }
+        mark(close);
+    }
+
+    // BacktestEngine._calculate_account_worth: cash plus the open position at close
+    double mark_to_market(double close) const {
+        if (state_.position == 1) return state_.current_balance + state_.shares_held * close;
+        if (state_.position == -1) return state_.current_balance - state_.shares_held * close;
+        return state_.current_balance;
+    }
+
+private:
+    double worth() const { return config_.initial_balance + state_.realized_gains; }
+
+    void mark(double close) {
+        const double equity = mark_to_market(close);
+        metrics_.on_equity(equity);
+        if (config_.record_equity) equity_.push_back(equity);
+    }
+
+    // Every trade goes through here: counted, fed to the metrics when it
+    // closes a position and logged when the log is on
+    void record(size_t i, int act, double px, int pos, double sh, double c, double pr, double pnl) {
+        ++events_;
+        if (act == EXEC_CLOSE || act == EXEC_CLOSE_SHORT || act == EXEC_CLOSE_LONG) metrics_.on_trade_close(pnl);
+        if (config_.record_trades) {
+            log_.push_back(i, act, px, pos, sh, c, pr, pnl, state_.current_balance, worth());
+        }
+    }
+
+    void long_only(size_t i, double close, bool buy_signal, bool sell_signal) {
+        ExecutionState& s = state_;
+        if (buy_signal && s.position == 0 && s.current_balance > 0) {
+            double trade_amount = s.current_balance * config_.position_fraction;
+            const double price = close + config_.spread;  // buy at ask
+            if (trade_amount > s.current_balance) trade_amount = s.current_balance;
+
+            const double shares = trade_amount / price;
+            const double cost = shares * price;
+            if (cost > 0 && s.current_balance >= cost) {
+                s.current_balance -= cost;
+                record(i, EXEC_BUY, price, 1, shares, cost, 0.0, 0.0);
+                s.position = 1;
+                s.entry_price = price;
+                s.shares_held = shares;
+            }
+        } else if (sell_signal && s.position == 1) {
+            const double price = close - config_.spread;  // sell at bid
+            const double proceeds = s.shares_held * price;
+            const double profit = proceeds - s.shares_held * s.entry_price;
+            s.current_balance += proceeds;
+            s.realized_gains += profit;
+            record(i, EXEC_CLOSE, price, 0, s.shares_held, 0.0, proceeds, profit);
+            s.position = 0;
+            s.entry_price = 0.0;
+            s.shares_held = 0.0;
+        }
+    }
+
+    void long_short(size_t i, double price, bool buy_signal, bool sell_signal) {
+        ExecutionState& s = state_;
+        if (buy_signal && s.position != 1) {
+            if (s.position == -1 && s.shares_held > 0) {
+                const double close_price = price + config_.spread;  // buy back at ask
+                const double cost_to_close = s.shares_held * close_price;
+                const double profit = s.shares_held * (s.entry_price - close_price);
+                s.current_balance -= cost_to_close;
+                s.realized_gains += profit;
+                record(i, EXEC_CLOSE_SHORT, close_price, 0, s.shares_held, 0.0, 0.0, profit);
+                s.position = 0;
+                s.shares_held = 0.0;
+            }
+
+            if (s.current_balance > 0) {
+                const double buy_price = price + config_.spread;
+                double trade_amount = s.current_balance * config_.position_fraction;
+                if (trade_amount > s.current_balance) trade_amount = s.current_balance;
+
+                const double shares = trade_amount / buy_price;
+                const double cost = shares * buy_price;
+                if (cost > 0 && s.current_balance >= cost) {
+                    s.current_balance -= cost;
+                    record(i, EXEC_BUY, buy_price, 1, shares, cost, 0.0, 0.0);
+                    s.position = 1;
+                    s.entry_price = buy_price;
+                    s.shares_held = shares;
+                }
+            }
+        } else if (sell_signal && s.position != -1) {
+            if (s.position == 1 && s.shares_held > 0) {
+                const double sell_price = price - config_.spread;  // sell at bid
+                const double proceeds = s.shares_held * sell_price;
+                const double profit = proceeds - s.shares_held * s.entry_price;
+                s.current_balance += proceeds;
+                s.realized_gains += profit;
+                record(i, EXEC_CLOSE_LONG, sell_price, 0, s.shares_held, 0.0, proceeds, profit);
+                s.position = 0;
+                s.shares_held = 0.0;
+            }
+
+            if (s.current_balance > 0) {
+                const double short_price = price - config_.spread;
+                const double trade_amount = s.current_balance * config_.position_fraction;
+                const double shares = trade_amount / short_price;
+                if (shares > 0) {
+                    const double proceeds = shares * short_price;
+                    s.current_balance += proceeds;
+                    s.position = -1;
+                    s.entry_price = short_price;
+                    s.shares_held = shares;
+                    // The Python engine logs the pre-spread price for short entries
+                    record(i, EXEC_SELL_SHORT, price, -1, shares, 0.0, proceeds, 0.0);
+                }
+            }
+        }
+    }
+
+    ExecutionConfig config_;
+    ExecutionState state_;
+    TradeLog log_;
+    MetricsAccumulator metrics_;
+    std::vector<double> equity_;
+    size_t events_ = 0;
+};
+
+}  // namespace bat
@@ -0,0 +1,294 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int32_t, int64_t, uint8_t
+from libc.string cimport memcpy
+from libcpp cimport bool as cbool
+from libcpp.vector cimport vector
+
+cimport numpy as cnp
+import numpy as np
+import pandas as pd
+
+cnp.import_array()
+
+
+cdef extern from "metrics.h" namespace "bat":
+    cdef cppclass PerformanceMetrics:
+        int64_t num_trades
+        int64_t winning_trades
+        int64_t losing_trades
+        double total_wins
+        double total_losses
+        double largest_win
+        double largest_loss
+        double win_rate
+        double avg_win
+        double avg_loss
+        double expectancy
+        double profit_factor
+        double max_drawdown
+        double max_drawdown_pct
+        double sharpe
+        double sortino
+        int64_t n_returns
+
+    cdef cppclass MetricsAccumulator:
+        PerformanceMetrics result(double periods_per_year)
+
+
+cdef extern from "equity.h" namespace "bat":
+    void drawdown_series(const double* equity, size_t n, double* out) nogil
+
+
+cdef extern from "execution.h" namespace "bat":
+    cdef enum ExecutionAction:
+        EXEC_BUY
+        EXEC_CLOSE
+        EXEC_CLOSE_SHORT
+        EXEC_CLOSE_LONG
+        EXEC_SELL_SHORT
+
+    cdef cppclass ExecutionConfig:
+        cbool long_short
+        double initial_balance
+        double position_fraction
+        double spread
+        cbool record_trades
+        cbool record_equity
+
+    cdef cppclass ExecutionState:
+        int position
+        double entry_price
+        double realized_gains
+        double current_balance
+        double shares_held
+
+    cdef cppclass TradeLog:
+        vector[int64_t] index
+        vector[int32_t] action
+        vector[double] price
+        vector[int32_t] position
+        vector[double] shares
+        vector[double] cost
+        vector[double] proceeds
+        vector[double] profit
+        vector[double] balance
+        vector[double] account_worth
+        size_t size()
+
+    cdef cppclass SignalExecutor:
+        SignalExecutor(const ExecutionConfig& config)
+        const ExecutionState& state()
+        const TradeLog& log()
+        const MetricsAccumulator& metrics()
+        size_t events()
+        const vector[double]& equity()
+        void run(const double* close, const uint8_t* buy, const uint8_t* sell, size_t n) nogil except +
+
+
+ACTION_NAMES = ('BUY', 'CLOSE', 'CLOSE_SHORT', 'CLOSE_LONG', 'SELL_SHORT')
+
+# Keys of the trade dicts BacktestEngine builds for each action, in insertion
+# order; pandas orders DataFrame columns by first appearance across rows
+_ACTION_FIELDS = (
+    ('Time', 'Price', 'Position', 'Index', 'Action', 'Shares', 'Cost', 'Last_Trade_Realized',
+     'Balance', 'Total_Account_Worth', 'Total_Profit', 'Trade_Result'),
+    ('Time', 'Price', 'Position', 'Index', 'Action', 'Shares', 'Proceeds', 'Profit', 'Last_Trade_Realized',
+     'Result', 'Balance', 'Total_Account_Worth', 'Total_Profit', 'Trade_Result'),
+    ('Time', 'Price', 'Position', 'Index', 'Action', 'Shares', 'Profit', 'Last_Trade_Realized',
+     'Result', 'Balance', 'Total_Account_Worth', 'Total_Profit', 'Trade_Result'),
+    ('Time', 'Price', 'Position', 'Index', 'Action', 'Shares', 'Proceeds', 'Profit', 'Last_Trade_Realized',
+     'Result', 'Balance', 'Total_Account_Worth', 'Total_Profit', 'Trade_Result'),
+    ('Time', 'Price', 'Position', 'Index', 'Action', 'Shares', 'Proceeds', 'Last_Trade_Realized',
+     'Balance', 'Total_Account_Worth', 'Total_Profit', 'Trade_Result'),
+)
+
+
+cdef object _copy_vector(const void* data, size_t size, int typenum, size_t itemsize):
+    """Copy a std::vector's contents into a new NumPy array"""
+    cdef cnp.npy_intp n = <cnp.npy_intp>size
+    cdef cnp.ndarray arr = cnp.PyArray_EMPTY(1, &n, typenum, 0)
+    if size > 0:
+        memcpy(cnp.PyArray_DATA(arr), data, size * itemsize)
+    return arr
+
+
+cdef dict _metrics_to_dict(const PerformanceMetrics& m):
+    return {
+        'num_trades': m.num_trades,
+        'winning_trades': m.winning_trades,
+        'losing_trades': m.losing_trades,
+        'total_wins': m.total_wins,
+        'total_losses': m.total_losses,
+        'largest_win': m.largest_win,
+        'largest_loss': m.largest_loss,
+        'win_rate': m.win_rate,
+        'avg_win': m.avg_win,
+        'avg_loss': m.avg_loss,
+        'expectancy': m.expectancy,
+        'profit_factor': m.profit_factor,
+        'max_drawdown': m.max_drawdown,
+        'max_drawdown_pct': m.max_drawdown_pct,
+        'sharpe': m.sharpe,
+        'sortino': m.sortino,
+        'n_returns': m.n_returns,
+    }
+
+
+cdef class ExecutionResult:
+    """
+    Columnar trade log (empty when the run did not record one), the final
+    account state and the online metrics of one run
+    """
+    cdef readonly double initial_balance
+    cdef readonly int position
+    cdef readonly double entry_price
+    cdef readonly double realized_gains
+    cdef readonly double current_balance
+    cdef readonly double shares_held
+    cdef readonly object index
+    cdef readonly object action
+    cdef readonly object price
+    cdef readonly object trade_position
+    cdef readonly object shares
+    cdef readonly object cost
+    cdef readonly object proceeds
+    cdef readonly object profit
+    cdef readonly object balance
+    cdef readonly object account_worth
+    cdef readonly size_t events
+    cdef readonly dict metrics
+    cdef readonly object equity
+
+    def __len__(self):
+        return len(self.index)
+
+    def to_frame(self, time_values):
+        """
+        Build the trade DataFrame BacktestEngine.backtest returns
+
+        Args:
+            time_values: The bars' timestamp column; 'Time' takes its values
+                at each trade's bar index (keeping its dtype)
+
+        Returns:
+            DataFrame with the same columns, order and dtypes as the Python loop
+        """
+        if len(self.index) == 0:
+            return pd.DataFrame([])
+
+        action = np.asarray(self.action)
+        is_open = (action == EXEC_BUY) | (action == EXEC_SELL_SHORT)
+        is_close = ~is_open
+        win = self.profit > 0
+        result = np.where(win, 'Win', 'Loss').astype(object)
+
+        columns = {}
+        columns['Time'] = pd.Series(time_values).iloc[self.index].reset_index(drop=True)
+        columns['Price'] = self.price
+        columns['Position'] = self.trade_position.astype(np.int64)
+        columns['Index'] = self.index
+        columns['Action'] = np.asarray(ACTION_NAMES, dtype=object)[action]
+        columns['Shares'] = self.shares
+        columns['Cost'] = np.where(action == EXEC_BUY, self.cost, np.nan)
+        columns['Proceeds'] = np.where((action == EXEC_BUY) | (action == EXEC_CLOSE_SHORT), np.nan, self.proceeds)
+        columns['Profit'] = np.where(is_close, self.profit, np.nan)
+        # Opens record an integer 0, so the column stays integer until a close appears
+        columns['Last_Trade_Realized'] = (np.where(is_close, self.profit, 0.0) if is_close.any()
+                                          else np.zeros(len(action), dtype=np.int64))
+        columns['Result'] = np.where(is_close, result, np.nan)
+        columns['Balance'] = self.balance
+        columns['Total_Account_Worth'] = self.account_worth
+        columns['Total_Profit'] = self.account_worth - self.initial_balance
+        columns['Trade_Result'] = np.where(is_close, result, 'OPEN').astype(object)
+
+        order = []
+        for code in pd.unique(action):
+            for name in _ACTION_FIELDS[code]:
+                if name not in order:
+                    order.append(name)
+        return pd.DataFrame({name: columns[name] for name in order})
+
+
+def execute_signals(close, buy, sell, bint long_short=False, double initial_balance=10000.0,
+                    double position_fraction=1.0, double spread=0.0, bint record_trades=True,
+                    double periods_per_year=1.0, bint record_equity=False):
+    """
+    Run BacktestEngine's execution rules over signal columns natively
+
+    Args:
+        close: Close prices
+        buy, sell: Signal columns (anything truthy counts, as in the Python loop)
+        long_short: False for long_only, True for long_short
+        initial_balance: Starting cash
+        position_fraction: Share of the balance used per trade (0-1)
+        spread: Spread as a price offset (spread_pips * pip size), 0 for none
+        record_trades: Keep the trade log; False returns metrics only
+        periods_per_year: Bars per year, to annualize Sharpe / Sortino
+        record_equity: Keep the per-bar mark-to-market equity as result.equity
+            (None otherwise)
+
+    Returns:
+        ExecutionResult whose metrics dict holds the metrics.h fields
+    """
+    cdef const double[:] c = np.ascontiguousarray(close, dtype=np.float64)
+    cdef const uint8_t[:] b = np.ascontiguousarray(np.asarray(buy).astype(bool)).view(np.uint8)
+    cdef const uint8_t[:] s = np.ascontiguousarray(np.asarray(sell).astype(bool)).view(np.uint8)
+    cdef size_t n = c.shape[0]
+    if b.shape[0] != c.shape[0] or s.shape[0] != c.shape[0]:
+        raise ValueError("close, buy and sell must have the same length")
+
+    cdef ExecutionConfig config
+    config.long_short = long_short
+    config.initial_balance = initial_balance
+    config.position_fraction = position_fraction
+    config.spread = spread
+    config.record_trades = record_trades
+    config.record_equity = record_equity
+
+    cdef SignalExecutor* executor = new SignalExecutor(config)
+    cdef const TradeLog* log
+    cdef ExecutionResult out = ExecutionResult.__new__(ExecutionResult)
+    try:
+        if n > 0:
+            with nogil:
+                executor.run(&c[0], &b[0], &s[0], n)
+
+        out.initial_balance = initial_balance
+        out.position = executor.state().position
+        out.entry_price = executor.state().entry_price
+        out.realized_gains = executor.state().realized_gains
+        out.current_balance = executor.state().current_balance
+        out.shares_held = executor.state().shares_held
+        out.events = executor.events()
+        out.metrics = _metrics_to_dict(executor.metrics().result(periods_per_year))
+        out.equity = (_copy_vector(executor.equity().data(), executor.equity().size(), cnp.NPY_DOUBLE, 8)
+                      if record_equity else None)
+
+        log = &executor.log()
+        out.index = _copy_vector(log.index.data(), log.size(), cnp.NPY_INT64, 8)
+        out.action = _copy_vector(log.action.data(), log.size(), cnp.NPY_INT32, 4)
+        out.price = _copy_vector(log.price.data(), log.size(), cnp.NPY_DOUBLE, 8)
+        out.trade_position = _copy_vector(log.position.data(), log.size(), cnp.NPY_INT32, 4)
+        out.shares = _copy_vector(log.shares.data(), log.size(), cnp.NPY_DOUBLE, 8)
+        out.cost = _copy_vector(log.cost.data(), log.size(), cnp.NPY_DOUBLE, 8)
+        out.proceeds = _copy_vector(log.proceeds.data(), log.size(), cnp.NPY_DOUBLE, 8)
+        out.profit = _copy_vector(log.profit.data(), log.size(), cnp.NPY_DOUBLE, 8)
+        out.balance = _copy_vector(log.balance.data(), log.size(), cnp.NPY_DOUBLE, 8)
+        out.account_worth = _copy_vector(log.account_worth.data(), log.size(), cnp.NPY_DOUBLE, 8)
+    finally:
+        del executor
+    return out
+
+
+def drawdown(equity):
+    """Running drawdown of an equity series as a fraction of its running peak"""
+    cdef const double[::1] x = np.ascontiguousarray(equity, dtype=np.float64)
+    cdef size_t n = x.shape[0]
+    out = np.zeros(n, dtype=np.float64)
+    cdef double[::1] o = out
+    if n > 0:
+        with nogil:
+            drawdown_series(&x[0], n, &o[0])
+    return out
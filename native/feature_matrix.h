@@ -0,0 +1,117 @@
+// Fused feature pass behind MarketDataLoader.feature_matrix.
+//
+// prepare_features builds returns, rolling volatility and momentum as three
+// pandas Series and drops incomplete rows at the end. feature_rows computes
+// all three in one loop over the closes and writes only the complete rows,
+// as float32, into a caller-allocated [n, FEATURE_COUNT] matrix, ready for
+// the strided windows of create_sequences without another copy. Values
+// follow the pandas expressions (RollingVariance with min_periods = 1 for
+// the volatility); a return leaving the volatility window is recomputed from
+// its two closes, so the pass keeps no history. normalize_columns then
+// scales the matrix in place with one statistics pass and one scaling pass.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "indicators.h"
+
+namespace bat {
+
+// Columns: returns, volatility, momentum
+constexpr size_t FEATURE_COUNT = 3;
+
+enum ReturnsMethod {
+    RETURNS_LOG = 0,
+    RETURNS_SIMPLE = 1,
+};
+
+enum NormalizeMethod {
+    NORMALIZE_STANDARDIZE = 0,
+    NORMALIZE_MINMAX = 1,
+};
+
+// compute_returns for one bar: infinite results become NaN
+inline double period_return(double price, double prev, int method) {
+    const double ratio = price / prev;
+    const double r = method == RETURNS_LOG ? std::log(ratio) : ratio - 1.0;
+    return std::isinf(r) ? INDICATOR_NAN : r;
+}
+
+// Complete rows of [returns, volatility, momentum] into out (room for n
+// rows) and their bar indices into rows; returns the number of rows written.
+// vol_window must be at least 1.
+inline size_t feature_rows(const double* close, size_t n, int method, size_t vol_window, size_t mom_window,
+                           float* out, int64_t* rows) {
+    RollingVariance var;
+    size_t count = 0;
+    for (size_t t = 0; t < n; ++t) {
+        const double r = t ? period_return(close[t], close[t - 1], method) : INDICATOR_NAN;
+        if (t >= vol_window) {
+            const size_t old = t - vol_window;
+            var.remove(old ? period_return(close[old], close[old - 1], method) : INDICATOR_NAN);
+        }
+        var.add(r);
+        const double vol = std::sqrt(var.value(1, 1));
+        const double mom = t >= mom_window ? (close[t] - close[t - mom_window]) / close[t - mom_window] : INDICATOR_NAN;
+        if (r != r || vol != vol || mom != mom) continue;
+        float* row = out + count * FEATURE_COUNT;
+        row[0] = static_cast<float>(r);
+        row[1] = static_cast<float>(vol);
+        row[2] = static_cast<float>(mom);
+        rows[count++] = static_cast<int64_t>(t);
+    }
+    return count;
+}
+
+// normalize_data on a row-major [n, k] matrix, in place. center/scale get
+// the per-column mean/std (standardize; a zero or undefined std counts as 1)
+// or min/max (minmax; constant columns become 0).
+inline void normalize_columns(float* m, size_t n, size_t k, int method, double* center, double* scale) {
+    if (method == NORMALIZE_STANDARDIZE) {
+        std::fill(center, center + k, 0.0);
+        std::fill(scale, scale + k, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            const float* row = m + i * k;
+            const double inv = 1.0 / static_cast<double>(i + 1);
+            for (size_t j = 0; j < k; ++j) {
+                const double delta = row[j] - center[j];
+                center[j] += delta * inv;
+                scale[j] += delta * (row[j] - center[j]);
+            }
+        }
+        for (size_t j = 0; j < k; ++j) {
+            const double sd = n > 1 ? std::sqrt(scale[j] / static_cast<double>(n - 1)) : INDICATOR_NAN;
+            scale[j] = (sd == 0.0 || sd != sd) ? 1.0 : sd;
+            if (n == 0) center[j] = INDICATOR_NAN;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            float* row = m + i * k;
+            for (size_t j = 0; j < k; ++j) row[j] = static_cast<float>((row[j] - center[j]) / scale[j]);
+        }
+        return;
+    }
+
+    std::fill(center, center + k, n ? std::numeric_limits<double>::infinity() : INDICATOR_NAN);
+    std::fill(scale, scale + k, n ? -std::numeric_limits<double>::infinity() : INDICATOR_NAN);
+    for (size_t i = 0; i < n; ++i) {
+        const float* row = m + i * k;
+        for (size_t j = 0; j < k; ++j) {
+            center[j] = std::min(center[j], static_cast<double>(row[j]));
+            scale[j] = std::max(scale[j], static_cast<double>(row[j]));
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        float* row = m + i * k;
+        for (size_t j = 0; j < k; ++j) {
+            const double range = scale[j] - center[j];
+            row[j] = range == 0.0 ? 0.0f : static_cast<float>((row[j] - center[j]) / range);
+        }
+    }
+}
+
+}  // namespace bat
@@ -0,0 +1,65 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int64_t
+
+cimport numpy as cnp
+import numpy as np
+
+cnp.import_array()
+
+
+cdef extern from "feature_matrix.h" namespace "bat":
+    size_t FEATURE_COUNT
+    size_t c_feature_rows "bat::feature_rows"(const double* close, size_t n, int method, size_t vol_window,
+                                              size_t mom_window, float* out, int64_t* rows) nogil
+    void c_normalize_columns "bat::normalize_columns"(float* m, size_t n, size_t k, int method,
+                                                      double* center, double* scale) nogil
+
+
+FEATURE_NAMES = ('returns', 'volatility', 'momentum')
+RETURNS_METHODS = {'log': 0, 'simple': 1}
+NORMALIZE_METHODS = {'standardize': 0, 'minmax': 1}
+
+
+def feature_rows(close, method='log', size_t volatility_window=20, size_t momentum_window=10):
+    """
+    prepare_features' returns, volatility and momentum in one pass
+
+    Returns:
+        (matrix float32 [n_rows, 3] of the complete rows, rows int64 [n_rows]
+        with their positions in close)
+    """
+    if method not in RETURNS_METHODS:
+        raise ValueError(f"Unknown method: {method}. Use 'log' or 'simple'.")
+    if volatility_window < 1:
+        raise ValueError("volatility_window must be at least 1")
+    cdef const double[::1] c = np.ascontiguousarray(close, dtype=np.float64)
+    cdef size_t n = c.shape[0], count = 0
+    cdef int code = RETURNS_METHODS[method]
+    cdef float[:, ::1] matrix = np.empty((n, FEATURE_COUNT), dtype=np.float32)
+    cdef int64_t[::1] rows = np.empty(n, dtype=np.int64)
+    if n > 0:
+        with nogil:
+            count = c_feature_rows(&c[0], n, code, volatility_window, momentum_window, &matrix[0, 0], &rows[0])
+    # Slices of the preallocated buffers; only the warm-up rows go unused
+    return np.asarray(matrix)[:count], np.asarray(rows)[:count]
+
+
+def normalize_columns(float[:, ::1] matrix, method='standardize'):
+    """
+    normalize_data on a C-contiguous float32 matrix, in place
+
+    Returns:
+        (center, scale) per column: (mean, std) or (min, max)
+    """
+    if method not in NORMALIZE_METHODS:
+        raise ValueError(f"Unknown normalization method: {method}. Use 'standardize' or 'minmax'.")
+    cdef size_t n = matrix.shape[0], k = matrix.shape[1]
+    cdef int code = NORMALIZE_METHODS[method]
+    cdef double[::1] center = np.empty(k)
+    cdef double[::1] scale = np.empty(k)
+    if k > 0:
+        with nogil:
+            c_normalize_columns(&matrix[0, 0] if n > 0 else NULL, n, k, code, &center[0], &scale[0])
+    return np.asarray(center), np.asarray(scale)
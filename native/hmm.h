@@ -0,0 +1,473 @@
+// Gaussian hidden Markov model kernels behind MLearning/model.py.
+//
+// BayesianRegimeSwitchingModel ran forward/backward/xi/Viterbi as Python
+// loops over T x n_states x n_states with one scipy pdf call per
+// (observation, state). Here:
+//
+//   - emissions are evaluated for all states of a bar at once in log space,
+//     with the model's floor pdf >= 1e-300;
+//   - forward/backward use the classic scaled recursion. Each bar's
+//     emissions are shifted by their maximum so exp() cannot underflow, then
+//     alpha is renormalized every step; the log scale factors sum to the
+//     log-likelihood. Each step is then K*K multiply-adds with no
+//     log/exp, and the unnormalized log alpha / log beta the Python API
+//     returns are recovered from the cumulative scales;
+//   - a Baum-Welch step accumulates the expected transition counts bar by
+//     bar instead of materializing xi, so memory is O(T*K);
+//   - hmm_fit_batch fits independent (series, initial parameters) jobs
+//     across threads, for many symbols or for random restarts;
+//   - HmmFilter is the forward pass one observation at a time for live
+//     bars: O(K^2) per update, with an optional fixed-lag smoother that
+//     revises the bar `lag` steps back with the evidence since (O(lag*K^2)).
+//
+// The M-step is the one baum_welch_step implements in Python: transitions
+// from expected counts (uniform when a state is never occupied, then rows
+// renormalized), weighted mean and two-pass weighted variance with
+// std >= 1e-6, and the initial distribution from gamma[0].
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "worker_threads.h"
+
+namespace bat {
+
+constexpr double HMM_MIN_LOG_PDF = -690.7755278982137;  // log(1e-300)
+constexpr double HMM_MIN_STD = 1e-6;
+constexpr double HMM_HALF_LOG_2PI = 0.9189385332046727;
+
+struct HmmParams {
+    size_t n_states = 0;
+    std::vector<double> mean;
+    std::vector<double> stdev;
+    std::vector<double> transition;  // n_states x n_states, row = from state
+    std::vector<double> initial;
+};
+
+struct HmmFitResult {
+    std::vector<double> log_likelihoods;  // one per EM iteration, before its update
+    bool converged = false;
+};
+
+// log N(x[t] | mean[j], stdev[j]) for all t, j into out[t * K + j]
+inline void gaussian_log_emissions(const double* x, size_t n, const HmmParams& p, double* out) {
+    const size_t k = p.n_states;
+    std::vector<double> offset(k), inv_std(k);
+    for (size_t j = 0; j < k; ++j) {
+        offset[j] = -std::log(p.stdev[j]) - HMM_HALF_LOG_2PI;
+        inv_std[j] = 1.0 / p.stdev[j];
+    }
+    for (size_t t = 0; t < n; ++t) {
+        double* row = out + t * k;
+        const double xt = x[t];
+#pragma omp simd
+        for (size_t j = 0; j < k; ++j) {
+            const double z = (xt - p.mean[j]) * inv_std[j];
+            const double lp = offset[j] - 0.5 * z * z;
+            row[j] = lp > HMM_MIN_LOG_PDF ? lp : HMM_MIN_LOG_PDF;
+        }
+    }
+}
+
+// Buffers of one forward-backward pass, reused across EM iterations
+struct HmmWorkspace {
+    std::vector<double> log_b;      // T x K log emissions
+    std::vector<double> b;          // T x K emissions / exp(max over states)
+    std::vector<double> alpha;      // T x K, each row normalized
+    std::vector<double> beta;       // T x K, scaled like alpha
+    std::vector<double> scale;      // T, sum of the unnormalized alpha row
+    std::vector<double> log_scale;  // T, log(scale) + emission shift
+
+    void resize(size_t n, size_t k) {
+        log_b.resize(n * k);
+        b.resize(n * k);
+        alpha.resize(n * k);
+        beta.resize(n * k);
+        scale.resize(n);
+        log_scale.resize(n);
+    }
+};
+
+// Emissions and the scaled forward pass; returns the log-likelihood
+inline double hmm_forward(const double* x, size_t n, const HmmParams& p, HmmWorkspace& w) {
+    const size_t k = p.n_states;
+    w.resize(n, k);
+    if (n == 0) return 0.0;
+    gaussian_log_emissions(x, n, p, w.log_b.data());
+    const double* a = p.transition.data();
+    double log_likelihood = 0.0;
+    for (size_t t = 0; t < n; ++t) {
+        const double* lb = w.log_b.data() + t * k;
+        double* bt = w.b.data() + t * k;
+        double* at = w.alpha.data() + t * k;
+        double shift = lb[0];
+        for (size_t j = 1; j < k; ++j) shift = std::max(shift, lb[j]);
+        for (size_t j = 0; j < k; ++j) bt[j] = std::exp(lb[j] - shift);
+
+        if (t == 0) {
+            for (size_t j = 0; j < k; ++j) at[j] = p.initial[j] * bt[j];
+        } else {
+            const double* prev = at - k;
+            std::fill(at, at + k, 0.0);
+            for (size_t i = 0; i < k; ++i) {
+                const double ai = prev[i];
+                const double* row = a + i * k;
+#pragma omp simd
+                for (size_t j = 0; j < k; ++j) at[j] += ai * row[j];
+            }
+            for (size_t j = 0; j < k; ++j) at[j] *= bt[j];
+        }
+        double c = 0.0;
+        for (size_t j = 0; j < k; ++j) c += at[j];
+        w.scale[t] = c;
+        w.log_scale[t] = std::log(c) + shift;
+        if (c > 0) {
+            const double inv = 1.0 / c;
+            for (size_t j = 0; j < k; ++j) at[j] *= inv;
+        }
+        log_likelihood += w.log_scale[t];
+    }
+    return log_likelihood;
+}
+
+// Scaled backward pass over the emissions and scales of hmm_forward
+inline void hmm_backward(size_t n, const HmmParams& p, HmmWorkspace& w) {
+    const size_t k = p.n_states;
+    if (n == 0) return;
+    const double* a = p.transition.data();
+    std::fill(w.beta.begin() + (n - 1) * k, w.beta.begin() + n * k, 1.0);
+    std::vector<double> weighted(k);
+    for (size_t t = n - 1; t-- > 0;) {
+        const double* next = w.beta.data() + (t + 1) * k;
+        const double* bn = w.b.data() + (t + 1) * k;
+        const double c = w.scale[t + 1];
+        const double inv = c > 0 ? 1.0 / c : 0.0;
+        for (size_t j = 0; j < k; ++j) weighted[j] = bn[j] * next[j];
+        double* bt = w.beta.data() + t * k;
+        for (size_t i = 0; i < k; ++i) {
+            const double* row = a + i * k;
+            double sum = 0.0;
+#pragma omp simd reduction(+ : sum)
+            for (size_t j = 0; j < k; ++j) sum += row[j] * weighted[j];
+            bt[i] = sum * inv;
+        }
+    }
+}
+
+// gamma[t * K + i] = P(state t = i | x)
+inline void hmm_gamma(size_t n, size_t k, const HmmWorkspace& w, double* gamma) {
+    for (size_t t = 0; t < n; ++t) {
+        const double* at = w.alpha.data() + t * k;
+        const double* bt = w.beta.data() + t * k;
+        double* g = gamma + t * k;
+        double sum = 0.0;
+        for (size_t i = 0; i < k; ++i) {
+            g[i] = at[i] * bt[i];
+            sum += g[i];
+        }
+        const double inv = sum > 0 ? 1.0 / sum : 0.0;
+        for (size_t i = 0; i < k; ++i) g[i] *= inv;
+    }
+}
+
+// xi for the transition into bar t + 1, normalized, into out (K x K)
+inline void hmm_xi_step(size_t t, const HmmParams& p, const HmmWorkspace& w, double* out) {
+    const size_t k = p.n_states;
+    const double* at = w.alpha.data() + t * k;
+    const double* bn = w.b.data() + (t + 1) * k;
+    const double* next = w.beta.data() + (t + 1) * k;
+    double sum = 0.0;
+    for (size_t i = 0; i < k; ++i) {
+        const double* row = p.transition.data() + i * k;
+        double* xi = out + i * k;
+        for (size_t j = 0; j < k; ++j) {
+            xi[j] = at[i] * row[j] * bn[j] * next[j];
+            sum += xi[j];
+        }
+    }
+    const double inv = sum > 0 ? 1.0 / sum : 0.0;
+    for (size_t m = 0; m < k * k; ++m) out[m] *= inv;
+}
+
+// Unnormalized log alpha / log beta, as the Python forward_algorithm and
+// backward_algorithm return them
+inline void hmm_log_alpha(size_t n, size_t k, const HmmWorkspace& w, double* out) {
+    double cumulative = 0.0;
+    for (size_t t = 0; t < n; ++t) {
+        cumulative += w.log_scale[t];
+        for (size_t i = 0; i < k; ++i) out[t * k + i] = std::log(w.alpha[t * k + i]) + cumulative;
+    }
+}
+
+inline void hmm_log_beta(size_t n, size_t k, const HmmWorkspace& w, double* out) {
+    double cumulative = 0.0;
+    for (size_t t = n; t-- > 0;) {
+        for (size_t i = 0; i < k; ++i) out[t * k + i] = std::log(w.beta[t * k + i]) + cumulative;
+        cumulative += w.log_scale[t];
+    }
+}
+
+// One EM iteration: updates p in place and returns the log-likelihood of
+// the parameters it started from
+inline double hmm_baum_welch_step(const double* x, size_t n, HmmParams& p, HmmWorkspace& w,
+                                  std::vector<double>& gamma) {
+    const size_t k = p.n_states;
+    const double log_likelihood = hmm_forward(x, n, p, w);
+    if (n == 0) return log_likelihood;
+    hmm_backward(n, p, w);
+    gamma.resize(n * k);
+    hmm_gamma(n, k, w, gamma.data());
+
+    std::vector<double> expected(k * k, 0.0), xi(k * k);
+    for (size_t t = 0; t + 1 < n; ++t) {
+        hmm_xi_step(t, p, w, xi.data());
+        for (size_t m = 0; m < k * k; ++m) expected[m] += xi[m];
+    }
+    std::vector<double> occupancy(k, 0.0), weight(k, 0.0);
+    for (size_t t = 0; t < n; ++t) {
+        for (size_t i = 0; i < k; ++i) {
+            if (t + 1 < n) occupancy[i] += gamma[t * k + i];
+            weight[i] += gamma[t * k + i];
+        }
+    }
+
+    for (size_t i = 0; i < k; ++i) {
+        double* row = p.transition.data() + i * k;
+        for (size_t j = 0; j < k; ++j) {
+            row[j] = occupancy[i] > 0 ? expected[i * k + j] / occupancy[i] : 1.0 / static_cast<double>(k);
+        }
+        double row_sum = 0.0;
+        for (size_t j = 0; j < k; ++j) row_sum += row[j];
+        if (row_sum > 0) {
+            for (size_t j = 0; j < k; ++j) row[j] /= row_sum;
+        }
+    }
+
+    for (size_t i = 0; i < k; ++i) {
+        if (!(weight[i] > 0)) continue;
+        double weighted_sum = 0.0;
+        for (size_t t = 0; t < n; ++t) weighted_sum += gamma[t * k + i] * x[t];
+        const double mean = weighted_sum / weight[i];
+        double weighted_sq = 0.0;
+        for (size_t t = 0; t < n; ++t) {
+            const double d = x[t] - mean;
+            weighted_sq += gamma[t * k + i] * d * d;
+        }
+        p.mean[i] = mean;
+        p.stdev[i] = std::max(std::sqrt(weighted_sq / weight[i]), HMM_MIN_STD);
+    }
+
+    for (size_t i = 0; i < k; ++i) p.initial[i] = gamma[i];
+    return log_likelihood;
+}
+
+// Most likely state path into states; returns its log probability
+inline double hmm_viterbi(const double* x, size_t n, const HmmParams& p, int32_t* states) {
+    const size_t k = p.n_states;
+    if (n == 0) return 0.0;
+    std::vector<double> log_b(n * k), log_a(k * k), delta(k), next(k);
+    std::vector<int32_t> back(n * k);
+    gaussian_log_emissions(x, n, p, log_b.data());
+    for (size_t m = 0; m < k * k; ++m) log_a[m] = std::log(p.transition[m]);
+    for (size_t j = 0; j < k; ++j) delta[j] = std::log(p.initial[j]) + log_b[j];
+    for (size_t t = 1; t < n; ++t) {
+        for (size_t j = 0; j < k; ++j) {
+            // First maximum wins, as np.argmax
+            size_t best = 0;
+            double best_value = delta[0] + log_a[j];
+            for (size_t i = 1; i < k; ++i) {
+                const double v = delta[i] + log_a[i * k + j];
+                if (v > best_value) {
+                    best_value = v;
+                    best = i;
+                }
+            }
+            back[t * k + j] = static_cast<int32_t>(best);
+            next[j] = best_value + log_b[t * k + j];
+        }
+        delta.swap(next);
+    }
+    size_t last = 0;
+    for (size_t j = 1; j < k; ++j) {
+        if (delta[j] > delta[last]) last = j;
+    }
+    states[n - 1] = static_cast<int32_t>(last);
+    for (size_t t = n - 1; t > 0; --t) states[t - 1] = back[t * k + states[t]];
+    return delta[last];
+}
+
+// Iterate Baum-Welch until the log-likelihood moves less than tolerance
+inline HmmFitResult hmm_fit(const double* x, size_t n, HmmParams& p, size_t max_iterations, double tolerance) {
+    HmmFitResult result;
+    HmmWorkspace w;
+    std::vector<double> gamma;
+    double prev = -std::numeric_limits<double>::infinity();
+    for (size_t iteration = 0; iteration < max_iterations; ++iteration) {
+        const double log_likelihood = hmm_baum_welch_step(x, n, p, w, gamma);
+        result.log_likelihoods.push_back(log_likelihood);
+        if (iteration > 0 && std::fabs(log_likelihood - prev) < tolerance) {
+            result.converged = true;
+            break;
+        }
+        prev = log_likelihood;
+    }
+    return result;
+}
+
+// Fit n_jobs independent models: job j runs on series[j] (lengths[j] bars)
+// from params[j], which is updated in place, across n_threads workers
+// (0 = all cores)
+inline void hmm_fit_batch(const double* const* series, const size_t* lengths, HmmParams* params,
+                          HmmFitResult* results, size_t n_jobs, size_t max_iterations, double tolerance,
+                          unsigned n_threads) {
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t j; (j = next.fetch_add(1, std::memory_order_relaxed)) < n_jobs;) {
+            results[j] = hmm_fit(series[j], lengths[j], params[j], max_iterations, tolerance);
+        }
+    };
+    unsigned n = n_threads ? n_threads : std::max(1u, std::thread::hardware_concurrency());
+    n = static_cast<unsigned>(std::min<size_t>(n, std::max<size_t>(n_jobs, 1)));
+    run_workers(n, worker);
+}
+
+// Online forward filter with optional fixed-lag smoothing. filtered() is
+// P(state t | x[0..t]), exactly the normalized last row of hmm_forward over
+// the same observations; smoothed() is P(state t-lag | x[0..t]) once more
+// than lag observations have arrived.
+class HmmFilter {
+public:
+    explicit HmmFilter(const HmmParams& p, size_t lag = 0)
+        : p_(p), lag_(lag), alpha_(p.n_states), next_(p.n_states), b_(p.n_states), offset_(p.n_states),
+          inv_std_(p.n_states), smoothed_(p.n_states), beta_(p.n_states), beta_next_(p.n_states) {
+        for (size_t j = 0; j < p.n_states; ++j) {
+            offset_[j] = -std::log(p.stdev[j]) - HMM_HALF_LOG_2PI;
+            inv_std_[j] = 1.0 / p.stdev[j];
+        }
+        if (lag_ > 0) {
+            history_alpha_.resize((lag_ + 1) * p.n_states);
+            history_b_.resize((lag_ + 1) * p.n_states);
+        }
+        reset();
+    }
+
+    void reset() {
+        count_ = 0;
+        log_likelihood_ = 0.0;
+        std::fill(alpha_.begin(), alpha_.end(), 0.0);
+        std::fill(smoothed_.begin(), smoothed_.end(), 0.0);
+    }
+
+    void update(double x) {
+        const size_t k = p_.n_states;
+        // Log emissions as gaussian_log_emissions, then shifted and exponentiated
+        double shift = -std::numeric_limits<double>::infinity();
+        for (size_t j = 0; j < k; ++j) {
+            const double z = (x - p_.mean[j]) * inv_std_[j];
+            const double lp = offset_[j] - 0.5 * z * z;
+            b_[j] = lp > HMM_MIN_LOG_PDF ? lp : HMM_MIN_LOG_PDF;
+            shift = std::max(shift, b_[j]);
+        }
+        for (size_t j = 0; j < k; ++j) b_[j] = std::exp(b_[j] - shift);
+
+        if (count_ == 0) {
+            for (size_t j = 0; j < k; ++j) next_[j] = p_.initial[j];
+        } else {
+            predict(next_.data());
+        }
+        double c = 0.0;
+        for (size_t j = 0; j < k; ++j) {
+            next_[j] *= b_[j];
+            c += next_[j];
+        }
+        if (c > 0) {
+            const double inv = 1.0 / c;
+            for (size_t j = 0; j < k; ++j) alpha_[j] = next_[j] * inv;
+        } else {
+            std::copy(next_.begin(), next_.end(), alpha_.begin());
+        }
+        log_likelihood_ += std::log(c) + shift;
+
+        if (lag_ > 0) {
+            const size_t slot = count_ % (lag_ + 1);
+            std::copy(alpha_.begin(), alpha_.end(), history_alpha_.begin() + slot * k);
+            std::copy(b_.begin(), b_.end(), history_b_.begin() + slot * k);
+        }
+        ++count_;
+        if (lag_ == 0) {
+            smoothed_ = alpha_;
+        } else if (count_ > lag_) {
+            smooth();
+        }
+    }
+
+    // P(state t+1 | x[0..t]) into out
+    void predict(double* out) const {
+        const size_t k = p_.n_states;
+        std::fill(out, out + k, 0.0);
+        for (size_t i = 0; i < k; ++i) {
+            const double ai = alpha_[i];
+            const double* row = p_.transition.data() + i * k;
+#pragma omp simd
+            for (size_t j = 0; j < k; ++j) out[j] += ai * row[j];
+        }
+    }
+
+    const std::vector<double>& filtered() const { return alpha_; }
+    const std::vector<double>& smoothed() const { return smoothed_; }
+    bool has_smoothed() const { return count_ > lag_; }
+    size_t lag() const { return lag_; }
+    size_t count() const { return count_; }
+    size_t n_states() const { return p_.n_states; }
+    double log_likelihood() const { return log_likelihood_; }
+
+private:
+    // Backward pass over the last lag observations, from beta = 1 at the
+    // newest one down to the bar lag steps back
+    void smooth() {
+        const size_t k = p_.n_states;
+        const size_t window = lag_ + 1;
+        const size_t newest = count_ - 1;
+        std::fill(beta_.begin(), beta_.end(), 1.0);
+        for (size_t s = newest; s > newest - lag_; --s) {
+            const size_t slot = s % window;
+            const double* b = history_b_.data() + slot * k;
+            double sum = 0.0;
+            for (size_t i = 0; i < k; ++i) {
+                const double* row = p_.transition.data() + i * k;
+                double v = 0.0;
+                for (size_t j = 0; j < k; ++j) v += row[j] * b[j] * beta_[j];
+                beta_next_[i] = v;
+                sum += v;
+            }
+            // Any positive scale works for beta; use its sum to keep it in range
+            const double inv = sum > 0 ? 1.0 / sum : 0.0;
+            for (size_t i = 0; i < k; ++i) beta_[i] = beta_next_[i] * inv;
+        }
+        const double* a = history_alpha_.data() + ((newest - lag_) % window) * k;
+        double sum = 0.0;
+        for (size_t i = 0; i < k; ++i) {
+            smoothed_[i] = a[i] * beta_[i];
+            sum += smoothed_[i];
+        }
+        const double inv = sum > 0 ? 1.0 / sum : 0.0;
+        for (size_t i = 0; i < k; ++i) smoothed_[i] *= inv;
+    }
+
+    HmmParams p_;
+    size_t lag_;
+    size_t count_ = 0;
+    double log_likelihood_ = 0.0;
+    std::vector<double> alpha_, next_, b_, offset_, inv_std_, smoothed_, beta_, beta_next_;
+    std::vector<double> history_alpha_, history_b_;  // last lag + 1 bars, ring-indexed by count
+};
+
+}  // namespace bat
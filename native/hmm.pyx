@@ -0,0 +1,318 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int32_t
+from libcpp cimport bool as cbool
+from libcpp.vector cimport vector
+
+cimport numpy as cnp
+import numpy as np
+
+cnp.import_array()
+
+
+cdef extern from "hmm.h" namespace "bat":
+    cdef cppclass HmmParams:
+        size_t n_states
+        vector[double] mean
+        vector[double] stdev
+        vector[double] transition
+        vector[double] initial
+
+    cdef cppclass HmmFitResult:
+        vector[double] log_likelihoods
+        cbool converged
+
+    cdef cppclass HmmWorkspace:
+        vector[double] alpha
+        vector[double] beta
+
+    void gaussian_log_emissions(const double* x, size_t n, const HmmParams& p, double* out) nogil
+    double hmm_forward(const double* x, size_t n, const HmmParams& p, HmmWorkspace& w) nogil
+    void hmm_backward(size_t n, const HmmParams& p, HmmWorkspace& w) nogil
+    void hmm_gamma(size_t n, size_t k, const HmmWorkspace& w, double* gamma) nogil
+    void hmm_xi_step(size_t t, const HmmParams& p, const HmmWorkspace& w, double* out) nogil
+    void hmm_log_alpha(size_t n, size_t k, const HmmWorkspace& w, double* out) nogil
+    void hmm_log_beta(size_t n, size_t k, const HmmWorkspace& w, double* out) nogil
+    double hmm_baum_welch_step(const double* x, size_t n, HmmParams& p, HmmWorkspace& w,
+                               vector[double]& gamma) nogil
+    double hmm_viterbi(const double* x, size_t n, const HmmParams& p, int32_t* states) nogil
+    HmmFitResult hmm_fit(const double* x, size_t n, HmmParams& p, size_t max_iterations, double tolerance) nogil
+    void hmm_fit_batch(const double* const* series, const size_t* lengths, HmmParams* params,
+                       HmmFitResult* results, size_t n_jobs, size_t max_iterations, double tolerance,
+                       unsigned int n_threads) nogil except +
+
+    cdef cppclass HmmFilter:
+        HmmFilter(const HmmParams& p, size_t lag) except +
+        void reset() nogil
+        void update(double x) nogil
+        void predict(double* out) nogil
+        const vector[double]& filtered() nogil
+        const vector[double]& smoothed() nogil
+        cbool has_smoothed() nogil
+        size_t lag() nogil
+        size_t count() nogil
+        size_t n_states() nogil
+        double log_likelihood() nogil
+
+
+cdef const double[::1] _as_doubles(values):
+    return np.ascontiguousarray(values, dtype=np.float64).ravel()
+
+
+cdef HmmParams _params(means, stds, transition, initial) except *:
+    """Check and copy (means, stds, transition, initial) into HmmParams"""
+    cdef HmmParams p
+    cdef const double[::1] m = _as_doubles(means)
+    cdef const double[::1] s = _as_doubles(stds)
+    cdef const double[::1] a = _as_doubles(transition)
+    cdef const double[::1] pi = _as_doubles(initial)
+    cdef size_t k = m.shape[0], i
+    if k == 0 or s.shape[0] != k or pi.shape[0] != k or a.shape[0] != k * k:
+        raise ValueError("means, stds and initial need n_states values and transition n_states x n_states")
+    if np.any(np.asarray(s) <= 0):
+        raise ValueError("stds must be positive")
+    p.n_states = k
+    for i in range(k):
+        p.mean.push_back(m[i])
+        p.stdev.push_back(s[i])
+        p.initial.push_back(pi[i])
+    for i in range(k * k):
+        p.transition.push_back(a[i])
+    return p
+
+
+cdef tuple _params_to_arrays(const HmmParams& p):
+    k = p.n_states
+    return (np.array(p.mean), np.array(p.stdev), np.array(p.transition).reshape(k, k), np.array(p.initial))
+
+
+def log_emissions(observations, means, stds):
+    """log N(observations[t] | means[j], stds[j]) as a [T, n_states] array, floored at log(1e-300)"""
+    k = len(means)
+    cdef HmmParams p = _params(means, stds, np.eye(k), np.ones(k) / k)
+    cdef const double[::1] x = _as_doubles(observations)
+    cdef size_t n = x.shape[0]
+    cdef double[:, ::1] out = np.empty((n, p.n_states))
+    if n > 0:
+        with nogil:
+            gaussian_log_emissions(&x[0], n, p, &out[0, 0])
+    return np.asarray(out)
+
+
+def forward(observations, means, stds, transition, initial):
+    """Scaled forward pass; returns (log_alpha [T, n_states], log_likelihood)"""
+    cdef HmmParams p = _params(means, stds, transition, initial)
+    cdef const double[::1] x = _as_doubles(observations)
+    cdef size_t n = x.shape[0], k = p.n_states
+    cdef HmmWorkspace w
+    cdef double log_likelihood = 0.0
+    cdef double[:, ::1] log_alpha = np.empty((n, k))
+    if n > 0:
+        with nogil:
+            log_likelihood = hmm_forward(&x[0], n, p, w)
+            hmm_log_alpha(n, k, w, &log_alpha[0, 0])
+    return np.asarray(log_alpha), log_likelihood
+
+
+def backward(observations, means, stds, transition, initial):
+    """Scaled backward pass; returns log_beta [T, n_states]"""
+    cdef HmmParams p = _params(means, stds, transition, initial)
+    cdef const double[::1] x = _as_doubles(observations)
+    cdef size_t n = x.shape[0], k = p.n_states
+    cdef HmmWorkspace w
+    cdef double[:, ::1] log_beta = np.empty((n, k))
+    if n > 0:
+        with nogil:
+            hmm_forward(&x[0], n, p, w)
+            hmm_backward(n, p, w)
+            hmm_log_beta(n, k, w, &log_beta[0, 0])
+    return np.asarray(log_beta)
+
+
+def posteriors(observations, means, stds, transition, initial, bint transitions=False):
+    """
+    Smoothed state probabilities
+
+    Returns:
+        (gamma [T, n_states], log_likelihood), with xi [T-1, n_states,
+        n_states] appended when transitions is True
+    """
+    cdef HmmParams p = _params(means, stds, transition, initial)
+    cdef const double[::1] x = _as_doubles(observations)
+    cdef size_t n = x.shape[0], k = p.n_states, t
+    cdef HmmWorkspace w
+    cdef double log_likelihood = 0.0
+    cdef double[:, ::1] gamma = np.empty((n, k))
+    cdef double[:, :, ::1] xi = np.empty((n - 1 if n > 0 else 0, k, k))
+    if n > 0:
+        with nogil:
+            log_likelihood = hmm_forward(&x[0], n, p, w)
+            hmm_backward(n, p, w)
+            hmm_gamma(n, k, w, &gamma[0, 0])
+            if transitions:
+                for t in range(n - 1):
+                    hmm_xi_step(t, p, w, &xi[t, 0, 0])
+    if transitions:
+        return np.asarray(gamma), log_likelihood, np.asarray(xi)
+    return np.asarray(gamma), log_likelihood
+
+
+def baum_welch_step(observations, means, stds, transition, initial):
+    """
+    One EM iteration
+
+    Returns:
+        (log_likelihood before the update, (means, stds, transition, initial) after it)
+    """
+    cdef HmmParams p = _params(means, stds, transition, initial)
+    cdef const double[::1] x = _as_doubles(observations)
+    cdef size_t n = x.shape[0]
+    cdef HmmWorkspace w
+    cdef vector[double] gamma
+    cdef double log_likelihood = 0.0
+    if n > 0:
+        with nogil:
+            log_likelihood = hmm_baum_welch_step(&x[0], n, p, w, gamma)
+    return log_likelihood, _params_to_arrays(p)
+
+
+def viterbi(observations, means, stds, transition, initial):
+    """Most likely state path; returns (states int32 [T], log probability)"""
+    cdef HmmParams p = _params(means, stds, transition, initial)
+    cdef const double[::1] x = _as_doubles(observations)
+    cdef size_t n = x.shape[0]
+    cdef int32_t[::1] states = np.zeros(n, dtype=np.int32)
+    cdef double log_prob = 0.0
+    if n > 0:
+        with nogil:
+            log_prob = hmm_viterbi(&x[0], n, p, &states[0])
+    return np.asarray(states), log_prob
+
+
+cdef dict _fit_result(const HmmParams& p, HmmFitResult& r):
+    means, stds, transition, initial = _params_to_arrays(p)
+    return {
+        'means': means, 'stds': stds, 'transition': transition, 'initial': initial,
+        'log_likelihoods': np.array(r.log_likelihoods), 'converged': r.converged,
+    }
+
+
+def fit(observations, means, stds, transition, initial, size_t max_iterations=100, double tolerance=1e-4):
+    """
+    Baum-Welch from the given parameters until the log-likelihood changes by
+    less than tolerance
+
+    Returns:
+        dict with the fitted 'means', 'stds', 'transition', 'initial', the
+        per-iteration 'log_likelihoods' and 'converged'
+    """
+    cdef HmmParams p = _params(means, stds, transition, initial)
+    cdef const double[::1] x = _as_doubles(observations)
+    cdef size_t n = x.shape[0]
+    cdef HmmFitResult r
+    if n > 0:
+        with nogil:
+            r = hmm_fit(&x[0], n, p, max_iterations, tolerance)
+    return _fit_result(p, r)
+
+
+def fit_batch(series, inits, size_t max_iterations=100, double tolerance=1e-4, unsigned int n_threads=0):
+    """
+    fit() for many independent jobs in parallel
+
+    Args:
+        series: One observation array per job (the same array may repeat,
+            e.g. for random restarts)
+        inits: One (means, stds, transition, initial) tuple per job
+        n_threads: Worker threads (0 = all cores)
+
+    Returns:
+        List of fit() dicts, in job order
+    """
+    if len(series) != len(inits):
+        raise ValueError("series and inits must have the same length")
+    cdef size_t n_jobs = len(series), j
+    arrays = [np.ascontiguousarray(s, dtype=np.float64).ravel() for s in series]
+    cdef vector[const double*] pointers
+    cdef vector[size_t] lengths
+    cdef vector[HmmParams] params
+    cdef vector[HmmFitResult] results
+    cdef const double[::1] view
+    for j in range(n_jobs):
+        view = arrays[j]
+        pointers.push_back(&view[0] if view.shape[0] else NULL)
+        lengths.push_back(view.shape[0])
+        params.push_back(_params(*inits[j]))
+    results.resize(n_jobs)
+    with nogil:
+        hmm_fit_batch(pointers.data(), lengths.data(), params.data(), results.data(), n_jobs, max_iterations,
+                      tolerance, n_threads)
+    return [_fit_result(params[j], results[j]) for j in range(n_jobs)]
+
+
+cdef class RegimeFilter:
+    """
+    Online forward filter: one O(n_states^2) update per observation
+
+    probabilities is P(state t | x[0..t]), the normalized last row of
+    forward() over the same observations. With lag > 0, smoothed is
+    P(state t-lag | x[0..t]) (None until more than lag observations).
+    """
+    cdef HmmFilter* f
+
+    def __cinit__(self, means, stds, transition, initial, size_t lag=0):
+        self.f = new HmmFilter(_params(means, stds, transition, initial), lag)
+
+    def __dealloc__(self):
+        del self.f
+
+    def reset(self):
+        self.f.reset()
+
+    def update(self, double x):
+        """Add one observation; returns the filtered probabilities"""
+        self.f.update(x)
+        return self.probabilities
+
+    def update_many(self, observations):
+        """update() for each observation; returns the filtered probabilities as [T, n_states]"""
+        cdef const double[::1] x = _as_doubles(observations)
+        cdef size_t n = x.shape[0], k = self.f.n_states(), t, j
+        cdef double[:, ::1] out = np.empty((n, k))
+        with nogil:
+            for t in range(n):
+                self.f.update(x[t])
+                for j in range(k):
+                    out[t, j] = self.f.filtered()[j]
+        return np.asarray(out)
+
+    def predict(self):
+        """P(state t+1 | x[0..t])"""
+        cdef double[::1] out = np.empty(self.f.n_states())
+        self.f.predict(&out[0])
+        return np.asarray(out)
+
+    @property
+    def probabilities(self):
+        return np.array(self.f.filtered())
+
+    @property
+    def smoothed(self):
+        return np.array(self.f.smoothed()) if self.f.has_smoothed() else None
+
+    @property
+    def log_likelihood(self):
+        return self.f.log_likelihood()
+
+    @property
+    def count(self):
+        return self.f.count()
+
+    @property
+    def lag(self):
+        return self.f.lag()
+
+    @property
+    def n_states(self):
+        return self.f.n_states()
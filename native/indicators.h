@@ -0,0 +1,242 @@
+// Single-pass indicator kernels behind indicators/technical_indicators.py.
+//
+// The rolling and exponential kernels follow the pandas algorithms they
+// replace (window/aggregations.pyx and ewm.pyx): Kahan-compensated rolling
+// sums, Welford add/remove for the rolling variance, exact results for
+// windows of identical values, NaN handling with min_periods = window, and
+// the adjust=True EWM recurrence. Output agrees with pandas to rounding.
+// Every kernel writes into caller-provided arrays and allocates nothing, so
+// fused indicators (Bollinger mean+std, MACD line+signal+histogram) are one
+// loop over the input.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace bat {
+
+constexpr double INDICATOR_NAN = std::numeric_limits<double>::quiet_NaN();
+
+// pandas rolling(window).mean() state
+class RollingMean {
+public:
+    void add(double x) {
+        if (x != x) return;
+        ++nobs_;
+        kahan(x, sum_, add_comp_);
+        if (std::signbit(x)) ++neg_count_;
+        same_run_ = (x == prev_) ? same_run_ + 1 : 1;
+        prev_ = x;
+    }
+
+    void remove(double x) {
+        if (x != x) return;
+        --nobs_;
+        kahan(-x, sum_, remove_comp_);
+        if (std::signbit(x)) --neg_count_;
+    }
+
+    double value(size_t min_periods) const {
+        if (nobs_ < min_periods || nobs_ == 0) return INDICATOR_NAN;
+        if (same_run_ >= nobs_) return prev_;
+        const double result = sum_ / static_cast<double>(nobs_);
+        if (neg_count_ == 0 && result < 0) return 0.0;
+        if (neg_count_ == nobs_ && result > 0) return 0.0;
+        return result;
+    }
+
+private:
+    static void kahan(double x, double& sum, double& comp) {
+        const double y = x - comp;
+        const double t = sum + y;
+        comp = t - sum - y;
+        sum = t;
+    }
+
+    size_t nobs_ = 0;
+    size_t neg_count_ = 0;
+    size_t same_run_ = 0;
+    double sum_ = 0.0;
+    double add_comp_ = 0.0;
+    double remove_comp_ = 0.0;
+    double prev_ = INDICATOR_NAN;
+};
+
+// pandas rolling(window).var(ddof) state (Welford add/remove)
+class RollingVariance {
+public:
+    void add(double x) {
+        if (x != x) return;
+        same_run_ = (x == prev_) ? same_run_ + 1 : 1;
+        prev_ = x;
+        ++nobs_;
+        const double prev_mean = mean_ - add_comp_;
+        const double y = x - add_comp_;
+        const double t = y - mean_;
+        add_comp_ = t + mean_ - y;
+        mean_ += t / static_cast<double>(nobs_);
+        ssqdm_ += (x - prev_mean) * (x - mean_);
+    }
+
+    void remove(double x) {
+        if (x != x) return;
+        --nobs_;
+        if (nobs_ == 0) {
+            mean_ = 0.0;
+            ssqdm_ = 0.0;
+            return;
+        }
+        const double prev_mean = mean_ - remove_comp_;
+        const double y = x - remove_comp_;
+        const double t = y - mean_;
+        remove_comp_ = t + mean_ - y;
+        mean_ -= t / static_cast<double>(nobs_);
+        ssqdm_ -= (x - prev_mean) * (x - mean_);
+    }
+
+    double value(size_t min_periods, size_t ddof) const {
+        if (nobs_ < min_periods || nobs_ <= ddof) return INDICATOR_NAN;
+        if (nobs_ == 1 || same_run_ >= nobs_) return 0.0;
+        const double result = ssqdm_ / static_cast<double>(nobs_ - ddof);
+        return result < 0 ? 0.0 : result;
+    }
+
+private:
+    size_t nobs_ = 0;
+    size_t same_run_ = 0;
+    double mean_ = 0.0;
+    double ssqdm_ = 0.0;
+    double add_comp_ = 0.0;
+    double remove_comp_ = 0.0;
+    double prev_ = INDICATOR_NAN;
+};
+
+// pandas ewm(span=...).mean() with adjust=True, ignore_na=False, min_periods=0
+class EwmMean {
+public:
+    // Same alpha derivation as pandas (span -> com -> alpha) so weights match bitwise
+    explicit EwmMean(double span) : decay_(1.0 - 1.0 / (1.0 + (span - 1.0) / 2.0)) {}
+
+    double update(double x) {
+        const bool observed = x == x;
+        if (!started_) {
+            started_ = true;
+            weighted_ = x;
+            nobs_ = observed ? 1 : 0;
+        } else {
+            nobs_ += observed ? 1 : 0;
+            if (weighted_ == weighted_) {
+                old_weight_ *= decay_;
+                if (observed) {
+                    if (weighted_ != x) weighted_ = (old_weight_ * weighted_ + x) / (old_weight_ + 1.0);
+                    old_weight_ += 1.0;
+                }
+            } else if (observed) {
+                weighted_ = x;
+            }
+        }
+        return nobs_ >= 1 ? weighted_ : INDICATOR_NAN;
+    }
+
+private:
+    double decay_;
+    double weighted_ = INDICATOR_NAN;
+    double old_weight_ = 1.0;
+    size_t nobs_ = 0;
+    bool started_ = false;
+};
+
+inline void rolling_mean(const double* x, size_t n, size_t window, double* out) {
+    RollingMean mean;
+    for (size_t i = 0; i < n; ++i) {
+        // pandas removes the leaving value before adding the new one
+        if (i >= window) mean.remove(x[i - window]);
+        mean.add(x[i]);
+        out[i] = mean.value(window);
+    }
+}
+
+inline void ewm_mean(const double* x, size_t n, double span, double* out) {
+    EwmMean ewm(span);
+    for (size_t i = 0; i < n; ++i) out[i] = ewm.update(x[i]);
+}
+
+// Fused Bollinger bands: middle = rolling mean, bands at +/- k sample stds
+inline void bollinger(const double* x, size_t n, size_t window, double k,
+                      double* upper, double* middle, double* lower) {
+    RollingMean mean;
+    RollingVariance var;
+    for (size_t i = 0; i < n; ++i) {
+        if (i >= window) {
+            mean.remove(x[i - window]);
+            var.remove(x[i - window]);
+        }
+        mean.add(x[i]);
+        var.add(x[i]);
+        const double m = mean.value(window);
+        const double sd = std::sqrt(var.value(window, 1));
+        middle[i] = m;
+        upper[i] = m + sd * k;
+        lower[i] = m - sd * k;
+    }
+}
+
+// RSI from rolling means of gains and losses (not Wilder smoothing), as in
+// the pandas version: the first bar's undefined change counts as 0
+inline void rsi(const double* x, size_t n, size_t window, double* out) {
+    RollingMean gain, loss;
+    auto gain_at = [x](size_t i) {
+        const double d = i ? x[i] - x[i - 1] : INDICATOR_NAN;
+        return d > 0 ? d : 0.0;
+    };
+    auto loss_at = [x](size_t i) {
+        const double d = i ? x[i] - x[i - 1] : INDICATOR_NAN;
+        return d < 0 ? -d : 0.0;
+    };
+    for (size_t i = 0; i < n; ++i) {
+        if (i >= window) {
+            gain.remove(gain_at(i - window));
+            loss.remove(loss_at(i - window));
+        }
+        gain.add(gain_at(i));
+        loss.add(loss_at(i));
+        const double rs = gain.value(window) / loss.value(window);
+        out[i] = 100.0 - 100.0 / (1.0 + rs);
+    }
+}
+
+// MACD line, signal and histogram in one pass over the input
+inline void macd(const double* x, size_t n, double fast, double slow, double signal_span,
+                 double* line, double* signal, double* histogram) {
+    EwmMean fast_ewm(fast), slow_ewm(slow), signal_ewm(signal_span);
+    for (size_t i = 0; i < n; ++i) {
+        const double m = fast_ewm.update(x[i]) - slow_ewm.update(x[i]);
+        const double s = signal_ewm.update(m);
+        line[i] = m;
+        signal[i] = s;
+        histogram[i] = m - s;
+    }
+}
+
+enum CandlestickPattern : int8_t { PATTERN_NONE = 0, PATTERN_HAMMER = 1, PATTERN_SHOOTING_STAR = 2 };
+
+// Branch-free per-bar predicates; a shooting star overrides a hammer, matching
+// the order the pandas version assigns them
+inline void candlestick_patterns(const double* open, const double* high, const double* low, const double* close,
+                                 size_t n, int8_t* out) {
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        const double o = open[i], c = close[i];
+        const double body = std::fabs(c - o);
+        const double upper_shadow = high[i] - (o > c ? o : c);
+        const double lower_shadow = (o < c ? o : c) - low[i];
+        const bool hammer = body < upper_shadow * 2 && lower_shadow > body * 2 && upper_shadow < body * 0.5;
+        const bool star = body < lower_shadow * 2 && upper_shadow > body * 2 && lower_shadow < body * 0.5;
+        out[i] = star ? PATTERN_SHOOTING_STAR : (hammer ? PATTERN_HAMMER : PATTERN_NONE);
+    }
+}
+
+}  // namespace bat
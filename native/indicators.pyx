@@ -0,0 +1,95 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int8_t
+
+cimport numpy as cnp
+import numpy as np
+
+cnp.import_array()
+
+
+cdef extern from "indicators.h" namespace "bat":
+    void c_rolling_mean "bat::rolling_mean"(const double* x, size_t n, size_t window, double* out) nogil
+    void c_ewm_mean "bat::ewm_mean"(const double* x, size_t n, double span, double* out) nogil
+    void c_bollinger "bat::bollinger"(const double* x, size_t n, size_t window, double k,
+                                      double* upper, double* middle, double* lower) nogil
+    void c_rsi "bat::rsi"(const double* x, size_t n, size_t window, double* out) nogil
+    void c_macd "bat::macd"(const double* x, size_t n, double fast, double slow, double signal_span,
+                            double* line, double* signal, double* histogram) nogil
+    void c_candlestick_patterns "bat::candlestick_patterns"(const double* open, const double* high,
+                                                           const double* low, const double* close,
+                                                           size_t n, int8_t* out) nogil
+
+
+cdef const double[::1] _as_doubles(values):
+    return np.ascontiguousarray(values, dtype=np.float64)
+
+
+def rolling_mean(values, size_t window):
+    """rolling(window).mean() as a float64 array"""
+    cdef const double[::1] x = _as_doubles(values)
+    cdef double[::1] out = np.empty(x.shape[0])
+    if x.shape[0] > 0:
+        with nogil:
+            c_rolling_mean(&x[0], x.shape[0], window, &out[0])
+    return np.asarray(out)
+
+
+def ewm_mean(values, double span):
+    """ewm(span=span).mean() (adjust=True) as a float64 array"""
+    cdef const double[::1] x = _as_doubles(values)
+    cdef double[::1] out = np.empty(x.shape[0])
+    if x.shape[0] > 0:
+        with nogil:
+            c_ewm_mean(&x[0], x.shape[0], span, &out[0])
+    return np.asarray(out)
+
+
+def bollinger(values, size_t window, double k):
+    """Fused Bollinger bands; returns (upper, middle, lower) float64 arrays"""
+    cdef const double[::1] x = _as_doubles(values)
+    cdef double[::1] upper = np.empty(x.shape[0])
+    cdef double[::1] middle = np.empty(x.shape[0])
+    cdef double[::1] lower = np.empty(x.shape[0])
+    if x.shape[0] > 0:
+        with nogil:
+            c_bollinger(&x[0], x.shape[0], window, k, &upper[0], &middle[0], &lower[0])
+    return np.asarray(upper), np.asarray(middle), np.asarray(lower)
+
+
+def rsi(values, size_t window):
+    """RSI from rolling mean gains/losses as a float64 array"""
+    cdef const double[::1] x = _as_doubles(values)
+    cdef double[::1] out = np.empty(x.shape[0])
+    if x.shape[0] > 0:
+        with nogil:
+            c_rsi(&x[0], x.shape[0], window, &out[0])
+    return np.asarray(out)
+
+
+def macd(values, double fast, double slow, double signal_span):
+    """One-pass MACD; returns (line, signal, histogram) float64 arrays"""
+    cdef const double[::1] x = _as_doubles(values)
+    cdef double[::1] line = np.empty(x.shape[0])
+    cdef double[::1] signal = np.empty(x.shape[0])
+    cdef double[::1] histogram = np.empty(x.shape[0])
+    if x.shape[0] > 0:
+        with nogil:
+            c_macd(&x[0], x.shape[0], fast, slow, signal_span, &line[0], &signal[0], &histogram[0])
+    return np.asarray(line), np.asarray(signal), np.asarray(histogram)
+
+
+def candlestick_patterns(open, high, low, close):
+    """Pattern codes per bar: 0 none, 1 hammer, 2 shooting star (int8 array)"""
+    cdef const double[::1] o = _as_doubles(open)
+    cdef const double[::1] h = _as_doubles(high)
+    cdef const double[::1] l = _as_doubles(low)
+    cdef const double[::1] c = _as_doubles(close)
+    if not (o.shape[0] == h.shape[0] == l.shape[0] == c.shape[0]):
+        raise ValueError("All price columns must have the same length")
+    cdef int8_t[::1] out = np.empty(c.shape[0], dtype=np.int8)
+    if c.shape[0] > 0:
+        with nogil:
+            c_candlestick_patterns(&o[0], &h[0], &l[0], &c[0], c.shape[0], &out[0])
+    return np.asarray(out)
@@ -0,0 +1,132 @@
+// Online performance metrics for the execution cores.
+//
+// MetricsAccumulator is fed while a run executes instead of reducing the
+// trade DataFrame afterwards: closed-trade profits (win rate, average
+// win/loss, expectancy, profit factor, largest win/loss) and one
+// mark-to-market equity value per bar (max drawdown, Sharpe and Sortino of
+// the per-bar returns). Every update is O(1) and nothing is stored, so a
+// parameter sweep pays no per-trade allocation.
+//
+// Trade statistics follow BacktestEngine.analyze_results: a trade with
+// profit > 0 is a win, anything else a loss, and the largest win / loss are
+// the maximum / minimum profit over all closed trades. Returns use Welford's
+// update for the mean and variance; Sortino's downside deviation is the
+// root mean square of the negative returns.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace bat {
+
+struct PerformanceMetrics {
+    int64_t num_trades = 0;
+    int64_t winning_trades = 0;
+    int64_t losing_trades = 0;
+    double total_wins = 0.0;
+    double total_losses = 0.0;  // absolute
+    double largest_win = 0.0;
+    double largest_loss = 0.0;
+    double win_rate = 0.0;  // percent
+    double avg_win = 0.0;
+    double avg_loss = 0.0;  // absolute
+    double expectancy = 0.0;
+    double profit_factor = 0.0;
+    double max_drawdown = 0.0;      // peak-to-trough equity, price units
+    double max_drawdown_pct = 0.0;  // percent of the peak
+    double sharpe = 0.0;            // mean / std of bar returns, annualized by the caller's factor
+    double sortino = 0.0;
+    int64_t n_returns = 0;
+};
+
+class MetricsAccumulator {
+public:
+    void on_trade_close(double profit) {
+        if (trades_ == 0 || profit > largest_win_) largest_win_ = profit;
+        if (trades_ == 0 || profit < largest_loss_) largest_loss_ = profit;
+        ++trades_;
+        if (profit > 0) {
+            ++wins_;
+            total_wins_ += profit;
+        } else {
+            ++losses_;
+            total_losses_ += std::fabs(profit);
+        }
+    }
+
+    // One mark-to-market value per bar; the first one only seeds the curve
+    void on_equity(double equity) {
+        if (has_equity_) {
+            if (prev_equity_ > 0) {
+                const double r = equity / prev_equity_ - 1.0;
+                ++n_returns_;
+                const double delta = r - mean_;
+                mean_ += delta / static_cast<double>(n_returns_);
+                m2_ += delta * (r - mean_);
+                if (r < 0) downside_sq_ += r * r;
+            }
+        } else {
+            peak_ = equity;
+            has_equity_ = true;
+        }
+        prev_equity_ = equity;
+        if (equity > peak_) peak_ = equity;
+        const double drawdown = peak_ - equity;
+        if (drawdown > max_drawdown_) max_drawdown_ = drawdown;
+        if (peak_ > 0 && drawdown / peak_ > max_drawdown_frac_) max_drawdown_frac_ = drawdown / peak_;
+    }
+
+    int64_t num_trades() const { return trades_; }
+
+    // periods_per_year scales the per-bar ratios (1 leaves them per bar)
+    PerformanceMetrics result(double periods_per_year = 1.0) const {
+        PerformanceMetrics m;
+        m.num_trades = trades_;
+        m.winning_trades = wins_;
+        m.losing_trades = losses_;
+        m.total_wins = total_wins_;
+        m.total_losses = total_losses_;
+        m.max_drawdown = max_drawdown_;
+        m.max_drawdown_pct = max_drawdown_frac_ * 100.0;
+        m.n_returns = n_returns_;
+        if (trades_ > 0) {
+            const double trades = static_cast<double>(trades_);
+            m.largest_win = largest_win_;
+            m.largest_loss = largest_loss_;
+            m.win_rate = wins_ / trades * 100.0;
+            if (wins_ > 0) m.avg_win = total_wins_ / wins_;
+            if (losses_ > 0) m.avg_loss = total_losses_ / losses_;
+            const double loss_rate = losses_ / trades * 100.0;
+            m.expectancy = (m.win_rate / 100.0 * m.avg_win) - (loss_rate / 100.0 * m.avg_loss);
+            if (wins_ > 0 && losses_ > 0) {
+                m.profit_factor = total_wins_ / total_losses_;
+            } else if (wins_ > 0) {
+                m.profit_factor = 999.99;  // no losses, as compute_metrics reports it
+            }
+        }
+        const double scale = std::sqrt(periods_per_year > 0 ? periods_per_year : 1.0);
+        if (n_returns_ > 1) {
+            const double stdev = std::sqrt(m2_ / static_cast<double>(n_returns_ - 1));
+            if (stdev > 0) m.sharpe = mean_ / stdev * scale;
+        }
+        if (n_returns_ > 0 && downside_sq_ > 0) {
+            m.sortino = mean_ / std::sqrt(downside_sq_ / static_cast<double>(n_returns_)) * scale;
+        }
+        return m;
+    }
+
+private:
+    int64_t trades_ = 0, wins_ = 0, losses_ = 0;
+    double total_wins_ = 0.0, total_losses_ = 0.0;
+    double largest_win_ = 0.0, largest_loss_ = 0.0;
+
+    bool has_equity_ = false;
+    double prev_equity_ = 0.0, peak_ = 0.0;
+    double max_drawdown_ = 0.0, max_drawdown_frac_ = 0.0;
+    int64_t n_returns_ = 0;
+    double mean_ = 0.0, m2_ = 0.0, downside_sq_ = 0.0;
+};
+
+}  // namespace bat
@@ -0,0 +1,314 @@
+// Resting limit-order book for simulated fills (SimulatedBroker and
+// limit-order backtests).
+//
+// Orders rest on sorted price levels (bids best-first descending, asks
+// ascending). Each level is an intrusive FIFO list threaded through a
+// pooled node array, so the order with time priority sits at the front and
+// add/cancel/fill are O(1) apart from the level lookup. Expiries go into a
+// hashed timer wheel: every order with an expiry is linked into the slot of
+// its expiry tick, so advancing the clock only visits slots that have come
+// due, not every order.
+//
+// Bars are matched with OHLC only. A buy fills when the bar's low reaches
+// its limit and a sell when the high does. Each fill is for the full
+// quantity at the limit price, or at the open when the bar gaps through the
+// limit and gap_fills_at_open is set. Levels fill in price-time order, best
+// price first.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace bat {
+
+enum OrderSide : int8_t { SIDE_BUY = 1, SIDE_SELL = -1 };
+
+struct BookFill {
+    uint64_t id = 0;
+    int8_t side = SIDE_BUY;
+    double limit = 0.0;
+    double price = 0.0;
+    double quantity = 0.0;
+    int64_t time = 0;
+};
+
+struct BookConfig {
+    int64_t wheel_tick = 1'000'000'000;  // expiry resolution, ns
+    size_t wheel_slots = 4096;
+    bool gap_fills_at_open = true;
+};
+
+class OrderBook {
+public:
+    explicit OrderBook(const BookConfig& config = BookConfig())
+        : config_(config), wheel_(config.wheel_slots, NIL) {
+        if (config.wheel_tick <= 0 || config.wheel_slots == 0) throw std::invalid_argument("bad timer wheel");
+    }
+
+    size_t size() const { return index_.size(); }
+    bool contains(uint64_t id) const { return index_.count(id) != 0; }
+
+    bool best_bid(double& price) const {
+        if (bids_.empty()) return false;
+        price = bids_.begin()->first;
+        return true;
+    }
+
+    bool best_ask(double& price) const {
+        if (asks_.empty()) return false;
+        price = asks_.begin()->first;
+        return true;
+    }
+
+    // expiry 0 = good till cancelled; returns false for a duplicate id
+    bool add(uint64_t id, int side, double limit, double quantity, int64_t time, int64_t expiry = 0) {
+        if (index_.count(id)) return false;
+        if (!(quantity > 0) || limit != limit) throw std::invalid_argument("invalid order");
+        const uint32_t n = allocate();
+        Node& node = nodes_[n];
+        node.id = id;
+        node.side = side > 0 ? SIDE_BUY : SIDE_SELL;
+        node.limit = limit;
+        node.quantity = quantity;
+        node.time = time;
+        node.expiry = expiry;
+        start_clock(time);
+
+        Level& level = node.side == SIDE_BUY ? bids_[limit] : asks_[limit];
+        link_back(level, n);
+        if (expiry > 0) wheel_link(n);
+        index_.emplace(id, n);
+        return true;
+    }
+
+    bool cancel(uint64_t id) {
+        auto it = index_.find(id);
+        if (it == index_.end()) return false;
+        remove(it->second);
+        return true;
+    }
+
+    // Remove orders whose expiry <= now, appending their ids to expired.
+    // Times passed to add/expire/on_bar are expected to be non-decreasing.
+    size_t expire(int64_t now, std::vector<uint64_t>& expired) {
+        const size_t before = expired.size();
+        start_clock(now);
+        const int64_t tick = now / config_.wheel_tick;
+        if (tick < clock_) return 0;
+        // Visit each due slot once; a full rotation covers every slot
+        int64_t from = clock_;
+        if (tick - from >= static_cast<int64_t>(wheel_.size())) from = tick - static_cast<int64_t>(wheel_.size()) + 1;
+        for (int64_t t = from; t <= tick; ++t) {
+            uint32_t n = wheel_[slot(t)];
+            while (n != NIL) {
+                const uint32_t next = nodes_[n].timer_next;
+                if (nodes_[n].expiry <= now) {
+                    expired.push_back(nodes_[n].id);
+                    remove(n);
+                }
+                n = next;
+            }
+        }
+        clock_ = tick;
+        return expired.size() - before;
+    }
+
+    // Expire, then match one bar; fills are appended in execution order
+    size_t on_bar(int64_t time, double open, double high, double low, std::vector<BookFill>& fills,
+                  std::vector<uint64_t>* expired = nullptr) {
+        if (expired) {
+            expire(time, *expired);
+        } else {
+            scratch_.clear();
+            expire(time, scratch_);
+        }
+        const size_t before = fills.size();
+        // Bids: best (highest) price first while the bar's low reaches the level
+        while (!bids_.empty() && low <= bids_.begin()->first) {
+            const double limit = bids_.begin()->first;
+            const double price = config_.gap_fills_at_open && open < limit ? open : limit;
+            fill_level(bids_.begin()->second, price, time, fills);
+        }
+        // Asks: best (lowest) price first while the bar's high reaches the level
+        while (!asks_.empty() && high >= asks_.begin()->first) {
+            const double limit = asks_.begin()->first;
+            const double price = config_.gap_fills_at_open && open > limit ? open : limit;
+            fill_level(asks_.begin()->second, price, time, fills);
+        }
+        return fills.size() - before;
+    }
+
+private:
+    static constexpr uint32_t NIL = 0xffffffffu;
+
+    struct Node {
+        uint64_t id = 0;
+        int8_t side = SIDE_BUY;
+        double limit = 0.0;
+        double quantity = 0.0;
+        int64_t time = 0;
+        int64_t expiry = 0;
+        uint32_t prev = NIL, next = NIL;              // level FIFO
+        uint32_t timer_prev = NIL, timer_next = NIL;  // wheel slot
+        uint32_t timer_slot = NIL;
+    };
+
+    struct Level {
+        uint32_t head = NIL, tail = NIL;
+    };
+
+    using BidLevels = std::map<double, Level, std::greater<double>>;
+    using AskLevels = std::map<double, Level>;
+
+    uint32_t allocate() {
+        if (!free_.empty()) {
+            const uint32_t n = free_.back();
+            free_.pop_back();
+            nodes_[n] = Node();
+            return n;
+        }
+        nodes_.emplace_back();
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    void start_clock(int64_t time) {
+        if (clock_started_) return;
+        clock_started_ = true;
+        clock_ = time / config_.wheel_tick;
+    }
+
+    size_t slot(int64_t tick) const {
+        const int64_t m = tick % static_cast<int64_t>(wheel_.size());
+        return static_cast<size_t>(m < 0 ? m + static_cast<int64_t>(wheel_.size()) : m);
+    }
+
+    void link_back(Level& level, uint32_t n) {
+        nodes_[n].prev = level.tail;
+        nodes_[n].next = NIL;
+        if (level.tail != NIL) nodes_[level.tail].next = n;
+        else level.head = n;
+        level.tail = n;
+    }
+
+    void wheel_link(uint32_t n) {
+        Node& node = nodes_[n];
+        // An expiry already behind the clock goes in the current slot, which
+        // the next expire() visits first
+        int64_t tick = node.expiry / config_.wheel_tick;
+        if (tick < clock_) tick = clock_;
+        node.timer_slot = static_cast<uint32_t>(slot(tick));
+        uint32_t& head = wheel_[node.timer_slot];
+        node.timer_prev = NIL;
+        node.timer_next = head;
+        if (head != NIL) nodes_[head].timer_prev = n;
+        head = n;
+    }
+
+    void wheel_unlink(uint32_t n) {
+        Node& node = nodes_[n];
+        if (node.timer_slot == NIL) return;
+        if (node.timer_prev != NIL) nodes_[node.timer_prev].timer_next = node.timer_next;
+        else wheel_[node.timer_slot] = node.timer_next;
+        if (node.timer_next != NIL) nodes_[node.timer_next].timer_prev = node.timer_prev;
+        node.timer_slot = NIL;
+    }
+
+    template <typename Levels>
+    void unlink_from(Levels& levels, uint32_t n) {
+        Node& node = nodes_[n];
+        auto it = levels.find(node.limit);
+        Level& level = it->second;
+        if (node.prev != NIL) nodes_[node.prev].next = node.next;
+        else level.head = node.next;
+        if (node.next != NIL) nodes_[node.next].prev = node.prev;
+        else level.tail = node.prev;
+        if (level.head == NIL) levels.erase(it);
+    }
+
+    void remove(uint32_t n) {
+        Node& node = nodes_[n];
+        if (node.side == SIDE_BUY) unlink_from(bids_, n);
+        else unlink_from(asks_, n);
+        wheel_unlink(n);
+        index_.erase(node.id);
+        free_.push_back(n);
+    }
+
+    void fill_level(Level& level, double price, int64_t time, std::vector<BookFill>& fills) {
+        // FIFO: the level is erased by remove() once its last order fills
+        uint32_t n = level.head;
+        while (n != NIL) {
+            const uint32_t next = nodes_[n].next;
+            const Node& node = nodes_[n];
+            BookFill fill;
+            fill.id = node.id;
+            fill.side = node.side;
+            fill.limit = node.limit;
+            fill.price = price;
+            fill.quantity = node.quantity;
+            fill.time = time;
+            fills.push_back(fill);
+            remove(n);
+            n = next;
+        }
+    }
+
+    BookConfig config_;
+    BidLevels bids_;
+    AskLevels asks_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_;
+    std::unordered_map<uint64_t, uint32_t> index_;
+    std::vector<uint32_t> wheel_;
+    int64_t clock_ = 0;
+    bool clock_started_ = false;
+    std::vector<uint64_t> scratch_;
+};
+
+// Backtest driver: orders arrive at bar indices (sorted), each with an
+// optional time-to-live, and are matched from the bar after submission on.
+// fill_bar receives the bar index of each order's fill, -1 when it expired
+// or never filled; fill_price its price.
+inline void simulate_limit_orders(const int64_t* bar_time, const double* open, const double* high,
+                                  const double* low, size_t n_bars,
+                                  const int64_t* order_bar, const int8_t* order_side, const double* order_limit,
+                                  const double* order_qty, const int64_t* order_ttl, size_t n_orders,
+                                  bool gap_fills_at_open, int64_t* fill_bar, double* fill_price) {
+    BookConfig config;
+    config.gap_fills_at_open = gap_fills_at_open;
+    // Size the wheel tick from the bar spacing so each bar advances about one slot
+    if (n_bars > 1 && bar_time[n_bars - 1] > bar_time[0]) {
+        const int64_t spacing = (bar_time[n_bars - 1] - bar_time[0]) / static_cast<int64_t>(n_bars - 1);
+        if (spacing > 0) config.wheel_tick = spacing;
+    }
+    OrderBook book(config);
+    std::vector<BookFill> fills;
+    for (size_t k = 0; k < n_orders; ++k) {
+        fill_bar[k] = -1;
+        fill_price[k] = 0.0;
+    }
+
+    size_t next_order = 0;
+    for (size_t i = 0; i < n_bars; ++i) {
+        fills.clear();
+        book.on_bar(bar_time[i], open[i], high[i], low[i], fills);
+        for (const BookFill& f : fills) {
+            fill_bar[f.id] = static_cast<int64_t>(i);
+            fill_price[f.id] = f.price;
+        }
+        // Orders placed on bar i start resting from bar i + 1
+        while (next_order < n_orders && order_bar[next_order] <= static_cast<int64_t>(i)) {
+            const size_t k = next_order++;
+            const int64_t expiry = order_ttl[k] > 0 ? bar_time[i] + order_ttl[k] : 0;
+            book.add(k, order_side[k], order_limit[k], order_qty[k], bar_time[i], expiry);
+        }
+    }
+}
+
+}  // namespace bat
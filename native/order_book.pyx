@@ -0,0 +1,152 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int8_t, int64_t, uint64_t
+from libcpp cimport bool as cbool
+from libcpp.vector cimport vector
+
+cimport numpy as cnp
+import numpy as np
+
+cnp.import_array()
+
+
+cdef extern from "order_book.h" namespace "bat":
+    cdef cppclass BookFill:
+        uint64_t id
+        int8_t side
+        double limit
+        double price
+        double quantity
+        int64_t time
+
+    cdef cppclass BookConfig:
+        int64_t wheel_tick
+        size_t wheel_slots
+        cbool gap_fills_at_open
+
+    cdef cppclass OrderBook:
+        OrderBook(const BookConfig& config) except +
+        size_t size()
+        cbool contains(uint64_t id)
+        cbool best_bid(double& price)
+        cbool best_ask(double& price)
+        cbool add(uint64_t id, int side, double limit, double quantity, int64_t time, int64_t expiry) except +
+        cbool cancel(uint64_t id)
+        size_t expire(int64_t now, vector[uint64_t]& expired) nogil
+        size_t on_bar(int64_t time, double open, double high, double low, vector[BookFill]& fills,
+                      vector[uint64_t]* expired) nogil
+
+    void simulate_limit_orders(
+        const int64_t* bar_time, const double* open, const double* high, const double* low, size_t n_bars,
+        const int64_t* order_bar, const int8_t* order_side, const double* order_limit,
+        const double* order_qty, const int64_t* order_ttl, size_t n_orders,
+        cbool gap_fills_at_open, int64_t* fill_bar, double* fill_price) nogil except +
+
+
+cdef class LimitOrderBook:
+    """
+    Resting limit orders for one symbol (see order_book.h)
+
+    Order ids are caller-chosen non-negative integers. Side is 1 for buy and
+    -1 for sell; expiry 0 means good till cancelled. on_bar() returns
+    (fills, expired): fills as (id, side, limit, price, quantity, time)
+    tuples in execution order, expired as a list of ids.
+    """
+    cdef OrderBook* book
+
+    def __cinit__(self, int64_t wheel_tick=1_000_000_000, size_t wheel_slots=4096, bint gap_fills_at_open=True):
+        cdef BookConfig config
+        config.wheel_tick = wheel_tick
+        config.wheel_slots = wheel_slots
+        config.gap_fills_at_open = gap_fills_at_open
+        self.book = new OrderBook(config)
+
+    def __dealloc__(self):
+        del self.book
+
+    def __len__(self):
+        return self.book.size()
+
+    def __contains__(self, uint64_t order_id):
+        return self.book.contains(order_id)
+
+    @property
+    def best_bid(self):
+        cdef double price
+        return price if self.book.best_bid(price) else None
+
+    @property
+    def best_ask(self):
+        cdef double price
+        return price if self.book.best_ask(price) else None
+
+    def add(self, uint64_t order_id, int side, double limit, double quantity, int64_t time, int64_t expiry=0):
+        """Rest an order; False if the id is already in the book"""
+        return self.book.add(order_id, side, limit, quantity, time, expiry)
+
+    def cancel(self, uint64_t order_id):
+        return self.book.cancel(order_id)
+
+    def expire(self, int64_t now):
+        cdef vector[uint64_t] expired
+        self.book.expire(now, expired)
+        return [expired[i] for i in range(expired.size())]
+
+    def on_bar(self, int64_t time, double open, double high, double low):
+        cdef vector[BookFill] fills
+        cdef vector[uint64_t] expired
+        self.book.on_bar(time, open, high, low, fills, &expired)
+        return ([(f.id, f.side, f.limit, f.price, f.quantity, f.time) for f in fills],
+                [expired[i] for i in range(expired.size())])
+
+
+def run_limit_orders(timestamps, open, high, low, order_bar, order_side, order_limit, order_qty,
+                     order_ttl=None, bint gap_fills_at_open=True):
+    """
+    Match a batch of limit orders against bar arrays
+
+    Args:
+        timestamps: int64 bar times (ns)
+        open, high, low: Bar prices
+        order_bar: Bar index each order is placed on (non-decreasing); it
+            rests from the next bar
+        order_side: 1 buy, -1 sell
+        order_limit, order_qty: Limit price and quantity per order
+        order_ttl: Optional time-to-live per order in ns, 0 = good till cancelled
+        gap_fills_at_open: Fill at the open when a bar gaps through the limit
+
+    Returns:
+        (fill_bar, fill_price): bar index of each order's fill (-1 if it
+        expired or never filled) and the fill price
+    """
+    cdef const int64_t[::1] t = np.ascontiguousarray(timestamps, dtype=np.int64)
+    cdef const double[::1] o = np.ascontiguousarray(open, dtype=np.float64)
+    cdef const double[::1] h = np.ascontiguousarray(high, dtype=np.float64)
+    cdef const double[::1] l = np.ascontiguousarray(low, dtype=np.float64)
+    cdef const int64_t[::1] ob = np.ascontiguousarray(order_bar, dtype=np.int64)
+    cdef const int8_t[::1] side = np.ascontiguousarray(order_side, dtype=np.int8)
+    cdef const double[::1] lim = np.ascontiguousarray(order_limit, dtype=np.float64)
+    cdef const double[::1] qty = np.ascontiguousarray(order_qty, dtype=np.float64)
+    cdef size_t n_bars = t.shape[0]
+    cdef size_t n_orders = ob.shape[0]
+    if order_ttl is None:
+        order_ttl = np.zeros(n_orders, dtype=np.int64)
+    cdef const int64_t[::1] ttl = np.ascontiguousarray(order_ttl, dtype=np.int64)
+    if o.shape[0] != n_bars or h.shape[0] != n_bars or l.shape[0] != n_bars:
+        raise ValueError("bar arrays must have the same length")
+    if side.shape[0] != n_orders or lim.shape[0] != n_orders or qty.shape[0] != n_orders or ttl.shape[0] != n_orders:
+        raise ValueError("order arrays must have the same length")
+    if n_orders > 1 and np.any(np.diff(ob) < 0):
+        raise ValueError("order_bar must be non-decreasing")
+
+    fill_bar = np.full(n_orders, -1, dtype=np.int64)
+    fill_price = np.zeros(n_orders, dtype=np.float64)
+    if n_bars == 0 or n_orders == 0:
+        return fill_bar, fill_price
+    cdef int64_t[::1] fb = fill_bar
+    cdef double[::1] fp = fill_price
+    with nogil:
+        simulate_limit_orders(&t[0], &o[0], &h[0], &l[0], n_bars, &ob[0], &side[0], &lim[0], &qty[0],
+                              &ttl[0], n_orders, gap_fills_at_open, &fb[0], &fp[0])
+    return fill_bar, fill_price
@@ -0,0 +1,197 @@
+// Multi-asset portfolio execution core for PortfolioBacktestEngine.
+//
+// Inputs are time-major matrices over a merged timestamp index - row t
+// holds every asset's close / buy / sell at that timestamp, NaN close when
+// an asset has no bar - so each step reads one contiguous row. All assets
+// draw on one cash balance. Per-asset state (position, shares, entry, last
+// price) lives in contiguous arrays indexed by asset.
+//
+// The per-asset rules are BacktestEngine's (see execution.h): sizing is
+// position_fraction of the current cash, spreads are added on buys and
+// subtracted on sells, and short proceeds are credited to cash. Each
+// timestamp is two passes over the assets. Exits run first and entries
+// second, so cash freed by a sale is available to entries on the same bar
+// regardless of asset order. Equity is marked to market at every timestamp
+// from each asset's last known price.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "execution.h"
+
+namespace bat {
+
+struct PortfolioConfig {
+    bool long_short = false;
+    double initial_balance = 10000.0;
+    double position_fraction = 1.0;  // share of the cash used per entry
+};
+
+struct PortfolioTradeLog {
+    std::vector<int64_t> time_index;
+    std::vector<int32_t> asset;
+    std::vector<int32_t> action;  // ExecutionAction
+    std::vector<double> price;
+    std::vector<int32_t> position;
+    std::vector<double> shares;
+    std::vector<double> value;   // cost of a buy / cover, proceeds of a sale / short
+    std::vector<double> profit;  // realized, 0 for entries
+    std::vector<double> cash;
+
+    size_t size() const { return time_index.size(); }
+
+    void push_back(size_t t, size_t a, int act, double px, int pos, double sh, double val, double pnl,
+                   double balance) {
+        time_index.push_back(static_cast<int64_t>(t));
+        asset.push_back(static_cast<int32_t>(a));
+        action.push_back(act);
+        price.push_back(px);
+        position.push_back(pos);
+        shares.push_back(sh);
+        value.push_back(val);
+        profit.push_back(pnl);
+        cash.push_back(balance);
+    }
+};
+
+class PortfolioExecutor {
+public:
+    PortfolioExecutor(const PortfolioConfig& config, size_t n_assets, const double* spreads)
+        : config_(config),
+          n_assets_(n_assets),
+          spread_(spreads, spreads + n_assets),
+          position_(n_assets, 0),
+          pending_(n_assets, 0),
+          shares_(n_assets, 0.0),
+          entry_(n_assets, 0.0),
+          last_price_(n_assets, 0.0),
+          realized_(n_assets, 0.0),
+          cash_(config.initial_balance) {}
+
+    double cash() const { return cash_; }
+    const std::vector<int32_t>& positions() const { return position_; }
+    const std::vector<double>& shares() const { return shares_; }
+    const std::vector<double>& entry_prices() const { return entry_; }
+    const std::vector<double>& realized() const { return realized_; }
+    const PortfolioTradeLog& log() const { return log_; }
+    const std::vector<double>& equity() const { return equity_; }
+
+    // close/buy/sell are [n_times x n_assets] row-major; bar 0 only seeds prices
+    void run(const double* close, const uint8_t* buy, const uint8_t* sell, size_t n_times) {
+        equity_.assign(n_times, config_.initial_balance);
+        const size_t A = n_assets_;
+        for (size_t t = 0; t < n_times; ++t) {
+            const double* px = close + t * A;
+            const uint8_t* b = buy + t * A;
+            const uint8_t* s = sell + t * A;
+            for (size_t a = 0; a < A; ++a) {
+                if (px[a] == px[a]) last_price_[a] = px[a];
+            }
+            if (t > 0) {
+                for (size_t a = 0; a < A; ++a) {
+                    if (px[a] == px[a]) exits(t, a, px[a], b[a] != 0, s[a] != 0);
+                }
+                for (size_t a = 0; a < A; ++a) {
+                    if (px[a] == px[a]) entries(t, a, px[a]);
+                }
+            }
+            equity_[t] = mark_to_market();
+        }
+    }
+
+private:
+    double mark_to_market() const {
+        double worth = cash_;
+        for (size_t a = 0; a < n_assets_; ++a) worth += position_[a] * shares_[a] * last_price_[a];
+        return worth;
+    }
+
+    // Decide the bar's action from the pre-trade position (BacktestEngine's
+    // if/elif precedence), close what it requires and remember the entry
+    void exits(size_t t, size_t a, double price, bool buy_signal, bool sell_signal) {
+        const double spread = spread_[a];
+        pending_[a] = 0;
+        if (!config_.long_short) {
+            if (buy_signal && position_[a] == 0) {
+                pending_[a] = 1;
+            } else if (sell_signal && position_[a] == 1) {
+                close_long(t, a, price - spread, EXEC_CLOSE);
+            }
+            return;
+        }
+        if (buy_signal && position_[a] != 1) {
+            if (position_[a] == -1 && shares_[a] > 0) {
+                const double cover = price + spread;  // buy back at ask
+                const double cost = shares_[a] * cover;
+                const double profit = shares_[a] * (entry_[a] - cover);
+                cash_ -= cost;
+                realized_[a] += profit;
+                log_.push_back(t, a, EXEC_CLOSE_SHORT, cover, 0, shares_[a], cost, profit, cash_);
+                position_[a] = 0;
+                shares_[a] = 0.0;
+            }
+            pending_[a] = 1;
+        } else if (sell_signal && position_[a] != -1) {
+            if (position_[a] == 1 && shares_[a] > 0) close_long(t, a, price - spread, EXEC_CLOSE_LONG);
+            pending_[a] = -1;
+        }
+    }
+
+    void entries(size_t t, size_t a, double price) {
+        const double spread = spread_[a];
+        if (pending_[a] == 1 && cash_ > 0) {
+            const double ask = price + spread;
+            double amount = cash_ * config_.position_fraction;
+            if (amount > cash_) amount = cash_;
+            const double shares = amount / ask;
+            const double cost = shares * ask;
+            if (cost > 0 && cash_ >= cost) {
+                cash_ -= cost;
+                log_.push_back(t, a, EXEC_BUY, ask, 1, shares, cost, 0.0, cash_);
+                position_[a] = 1;
+                entry_[a] = ask;
+                shares_[a] = shares;
+            }
+        } else if (pending_[a] == -1 && cash_ > 0) {
+            const double bid = price - spread;
+            const double shares = cash_ * config_.position_fraction / bid;
+            if (shares > 0) {
+                const double proceeds = shares * bid;
+                cash_ += proceeds;
+                log_.push_back(t, a, EXEC_SELL_SHORT, bid, -1, shares, proceeds, 0.0, cash_);
+                position_[a] = -1;
+                entry_[a] = bid;
+                shares_[a] = shares;
+            }
+        }
+    }
+
+    void close_long(size_t t, size_t a, double bid, ExecutionAction action) {
+        const double proceeds = shares_[a] * bid;
+        const double profit = proceeds - shares_[a] * entry_[a];
+        cash_ += proceeds;
+        realized_[a] += profit;
+        log_.push_back(t, a, action, bid, 0, shares_[a], proceeds, profit, cash_);
+        position_[a] = 0;
+        entry_[a] = 0.0;
+        shares_[a] = 0.0;
+    }
+
+    PortfolioConfig config_;
+    size_t n_assets_;
+    std::vector<double> spread_;
+    std::vector<int32_t> position_;
+    std::vector<int8_t> pending_;  // entry decided in the exit pass: 1 long, -1 short
+    std::vector<double> shares_;
+    std::vector<double> entry_;
+    std::vector<double> last_price_;
+    std::vector<double> realized_;
+    double cash_;
+    PortfolioTradeLog log_;
+    std::vector<double> equity_;
+};
+
+}  // namespace bat
@@ -0,0 +1,119 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int32_t, int64_t, uint8_t
+from libc.string cimport memcpy
+from libcpp cimport bool as cbool
+from libcpp.vector cimport vector
+
+cimport numpy as cnp
+import numpy as np
+
+cnp.import_array()
+
+
+cdef extern from "portfolio.h" namespace "bat":
+    cdef cppclass PortfolioConfig:
+        cbool long_short
+        double initial_balance
+        double position_fraction
+
+    cdef cppclass PortfolioTradeLog:
+        vector[int64_t] time_index
+        vector[int32_t] asset
+        vector[int32_t] action
+        vector[double] price
+        vector[int32_t] position
+        vector[double] shares
+        vector[double] value
+        vector[double] profit
+        vector[double] cash
+        size_t size()
+
+    cdef cppclass PortfolioExecutor:
+        PortfolioExecutor(const PortfolioConfig& config, size_t n_assets, const double* spreads)
+        double cash()
+        const vector[int32_t]& positions()
+        const vector[double]& shares()
+        const vector[double]& entry_prices()
+        const vector[double]& realized()
+        const PortfolioTradeLog& log()
+        const vector[double]& equity()
+        void run(const double* close, const uint8_t* buy, const uint8_t* sell, size_t n_times) nogil except +
+
+
+cdef object _copy_vector(const void* data, size_t size, int typenum, size_t itemsize):
+    """Copy a std::vector's contents into a new NumPy array"""
+    cdef cnp.npy_intp n = <cnp.npy_intp>size
+    cdef cnp.ndarray arr = cnp.PyArray_EMPTY(1, &n, typenum, 0)
+    if size > 0:
+        memcpy(cnp.PyArray_DATA(arr), data, size * itemsize)
+    return arr
+
+
+def run_portfolio(close, buy, sell, spreads, bint long_short=False, double initial_balance=10000.0,
+                  double position_fraction=1.0):
+    """
+    Run the shared-cash portfolio rules over time-major matrices
+
+    Args:
+        close: [n_times, n_assets] closes on the merged index, NaN where an asset has no bar
+        buy, sell: [n_times, n_assets] signal matrices (anything truthy counts)
+        spreads: Per-asset spread as a price offset
+        long_short: False for long_only, True for long_short
+        initial_balance: Starting cash shared by all assets
+        position_fraction: Share of the cash used per entry (0-1)
+
+    Returns:
+        dict of NumPy arrays: the trade log columns ('time_index', 'asset',
+        'action', 'price', 'position', 'shares', 'value', 'profit', 'cash'),
+        'equity' per timestamp, final per-asset 'positions', 'shares_held',
+        'entry_prices', 'realized', and the final 'cash_balance'
+    """
+    cdef const double[:, ::1] c = np.ascontiguousarray(close, dtype=np.float64)
+    cdef const uint8_t[:, ::1] b = np.ascontiguousarray(np.asarray(buy).astype(bool)).view(np.uint8)
+    cdef const uint8_t[:, ::1] s = np.ascontiguousarray(np.asarray(sell).astype(bool)).view(np.uint8)
+    cdef const double[::1] sp = np.ascontiguousarray(spreads, dtype=np.float64)
+    cdef size_t n_times = c.shape[0]
+    cdef size_t n_assets = c.shape[1]
+    if b.shape[0] != c.shape[0] or s.shape[0] != c.shape[0] or b.shape[1] != c.shape[1] or s.shape[1] != c.shape[1]:
+        raise ValueError("close, buy and sell must have the same shape")
+    if sp.shape[0] != c.shape[1]:
+        raise ValueError("spreads must have one entry per asset")
+    if n_assets == 0:
+        raise ValueError("at least one asset is required")
+
+    cdef PortfolioConfig config
+    config.long_short = long_short
+    config.initial_balance = initial_balance
+    config.position_fraction = position_fraction
+
+    cdef PortfolioExecutor* executor = new PortfolioExecutor(config, n_assets, &sp[0])
+    cdef const PortfolioTradeLog* log
+    cdef size_t n
+    try:
+        if n_times > 0:
+            with nogil:
+                executor.run(&c[0, 0], &b[0, 0], &s[0, 0], n_times)
+
+        log = &executor.log()
+        n = log.size()
+        return {
+            'time_index': _copy_vector(log.time_index.data(), n, cnp.NPY_INT64, 8),
+            'asset': _copy_vector(log.asset.data(), n, cnp.NPY_INT32, 4),
+            'action': _copy_vector(log.action.data(), n, cnp.NPY_INT32, 4),
+            'price': _copy_vector(log.price.data(), n, cnp.NPY_DOUBLE, 8),
+            'position': _copy_vector(log.position.data(), n, cnp.NPY_INT32, 4),
+            'shares': _copy_vector(log.shares.data(), n, cnp.NPY_DOUBLE, 8),
+            'value': _copy_vector(log.value.data(), n, cnp.NPY_DOUBLE, 8),
+            'profit': _copy_vector(log.profit.data(), n, cnp.NPY_DOUBLE, 8),
+            'cash': _copy_vector(log.cash.data(), n, cnp.NPY_DOUBLE, 8),
+            'equity': _copy_vector(executor.equity().data(), executor.equity().size(), cnp.NPY_DOUBLE, 8),
+            'positions': _copy_vector(executor.positions().data(), n_assets, cnp.NPY_INT32, 4),
+            'shares_held': _copy_vector(executor.shares().data(), n_assets, cnp.NPY_DOUBLE, 8),
+            'entry_prices': _copy_vector(executor.entry_prices().data(), n_assets, cnp.NPY_DOUBLE, 8),
+            'realized': _copy_vector(executor.realized().data(), n_assets, cnp.NPY_DOUBLE, 8),
+            'cash_balance': executor.cash(),
+        }
+    finally:
+        del executor
@@ -0,0 +1,168 @@
+// Single-producer / single-consumer ring of OHLCV bars for the live chart.
+//
+// The data-fetch thread pushes bars and the strategy/chart thread pops them,
+// synchronised only by an acquire/release pair on two cache-line-separated
+// cursors (each side also caches the other's cursor so the common case
+// touches no shared line). Columns are stored mirrored - slot i is written at
+// i and i + capacity - so the most recent `window` consumed bars are always
+// one contiguous run per column and can be handed to NumPy without a copy.
+// The producer never overwrites those bars: a push fails while
+// capacity - window bars are pending, so views stay valid until the consumer
+// pops again.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+namespace bat {
+
+constexpr size_t RING_CACHE_LINE = 64;
+
+struct RingBar {
+    int64_t timestamp = 0;  // epoch nanoseconds, UTC
+    double open = 0.0;
+    double high = 0.0;
+    double low = 0.0;
+    double close = 0.0;
+    double volume = 0.0;
+};
+
+// Cache-line aligned array that allocates once and never grows
+template <typename T>
+class AlignedColumn {
+public:
+    explicit AlignedColumn(size_t n)
+        : data_(static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(RING_CACHE_LINE)))) {}
+
+    T* data() { return data_.get(); }
+    const T* data() const { return data_.get(); }
+    T& operator[](size_t i) { return data_.get()[i]; }
+    const T& operator[](size_t i) const { return data_.get()[i]; }
+
+private:
+    struct Free {
+        void operator()(T* p) const { ::operator delete(p, std::align_val_t(RING_CACHE_LINE)); }
+    };
+    std::unique_ptr<T, Free> data_;
+};
+
+class BarRing {
+public:
+    // capacity is rounded up to a power of two greater than window
+    BarRing(size_t capacity, size_t window)
+        : capacity_(round_up(capacity > window ? capacity : window + 1)),
+          mask_(capacity_ - 1),
+          window_(window),
+          timestamp_(2 * capacity_),
+          open_(2 * capacity_),
+          high_(2 * capacity_),
+          low_(2 * capacity_),
+          close_(2 * capacity_),
+          volume_(2 * capacity_) {
+        if (window == 0) throw std::invalid_argument("window must be >= 1");
+    }
+
+    BarRing(const BarRing&) = delete;
+    BarRing& operator=(const BarRing&) = delete;
+
+    size_t capacity() const { return capacity_; }
+    size_t window() const { return window_; }
+
+    // Producer side. Returns false when the ring is full (the bar is not stored).
+    bool push(const RingBar& bar) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_cache_ >= capacity_ - window_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head - tail_cache_ >= capacity_ - window_) return false;
+        }
+        const size_t slot = static_cast<size_t>(head & mask_);
+        store(slot, bar);
+        store(slot + capacity_, bar);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: bars pushed but not popped yet
+    size_t pending() const {
+        return static_cast<size_t>(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed));
+    }
+
+    bool pop(RingBar& bar) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_cache_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail == head_cache_) return false;
+        }
+        const size_t slot = static_cast<size_t>(tail & mask_);
+        bar.timestamp = timestamp_[slot];
+        bar.open = open_[slot];
+        bar.high = high_[slot];
+        bar.low = low_[slot];
+        bar.close = close_[slot];
+        bar.volume = volume_[slot];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: total bars popped so far
+    uint64_t consumed() const { return tail_.load(std::memory_order_relaxed); }
+
+    // Consumer side: number of popped bars that can still be viewed
+    size_t visible() const {
+        const uint64_t tail = consumed();
+        return tail < window_ ? static_cast<size_t>(tail) : window_;
+    }
+
+    // Offset of the oldest of the last k (<= visible()) popped bars in the
+    // mirrored columns; [offset, offset + k) is contiguous
+    size_t view_offset(size_t k) const { return static_cast<size_t>((consumed() - k) & mask_); }
+
+    const int64_t* timestamps() const { return timestamp_.data(); }
+    const double* opens() const { return open_.data(); }
+    const double* highs() const { return high_.data(); }
+    const double* lows() const { return low_.data(); }
+    const double* closes() const { return close_.data(); }
+    const double* volumes() const { return volume_.data(); }
+
+private:
+    static size_t round_up(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    void store(size_t i, const RingBar& bar) {
+        timestamp_[i] = bar.timestamp;
+        open_[i] = bar.open;
+        high_[i] = bar.high;
+        low_[i] = bar.low;
+        close_[i] = bar.close;
+        volume_[i] = bar.volume;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    const size_t window_;
+
+    AlignedColumn<int64_t> timestamp_;
+    AlignedColumn<double> open_;
+    AlignedColumn<double> high_;
+    AlignedColumn<double> low_;
+    AlignedColumn<double> close_;
+    AlignedColumn<double> volume_;
+
+    // Producer-owned line: its cursor plus its cached view of the consumer's
+    alignas(RING_CACHE_LINE) std::atomic<uint64_t> head_{0};
+    uint64_t tail_cache_ = 0;
+
+    // Consumer-owned line
+    alignas(RING_CACHE_LINE) std::atomic<uint64_t> tail_{0};
+    uint64_t head_cache_ = 0;
+};
+
+}  // namespace bat
@@ -0,0 +1,125 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int64_t, uint64_t
+
+cimport numpy as cnp
+import numpy as np
+
+cnp.import_array()
+
+
+cdef extern from "ring_buffer.h" namespace "bat":
+    cdef cppclass RingBar:
+        int64_t timestamp
+        double open
+        double high
+        double low
+        double close
+        double volume
+
+    cdef cppclass BarRing:
+        BarRing(size_t capacity, size_t window) except +
+        size_t capacity()
+        size_t window()
+        bint push(const RingBar& bar) nogil
+        size_t pending() nogil
+        bint pop(RingBar& bar) nogil
+        uint64_t consumed() nogil
+        size_t visible() nogil
+        size_t view_offset(size_t k) nogil
+        const int64_t* timestamps()
+        const double* opens()
+        const double* highs()
+        const double* lows()
+        const double* closes()
+        const double* volumes()
+
+
+cdef object _column_view(object owner, const void* data, size_t size, int typenum):
+    """Wrap a ring column run as a read-only NumPy array that keeps the ring alive"""
+    cdef cnp.npy_intp n = <cnp.npy_intp>size
+    cdef cnp.ndarray arr = cnp.PyArray_SimpleNewFromData(1, &n, typenum, <void*>data)
+    cnp.PyArray_CLEARFLAGS(arr, cnp.NPY_ARRAY_WRITEABLE)
+    cnp.set_array_base(arr, owner)
+    return arr
+
+
+cdef class BarRingBuffer:
+    """
+    Fixed-capacity SPSC ring of OHLCV bars (see ring_buffer.h)
+
+    One thread calls push(); another calls pop()/columns(). columns() returns
+    zero-copy views of the last popped bars, valid until the next pop().
+    """
+    cdef BarRing* ring
+
+    def __cinit__(self, size_t capacity=1024, size_t window=100):
+        self.ring = new BarRing(capacity, window)
+
+    def __dealloc__(self):
+        del self.ring
+
+    @property
+    def capacity(self):
+        return self.ring.capacity()
+
+    @property
+    def window(self):
+        return self.ring.window()
+
+    @property
+    def consumed(self):
+        """Total bars popped so far"""
+        return self.ring.consumed()
+
+    def push(self, int64_t timestamp, double open, double high, double low, double close, double volume):
+        """Producer side; returns False when the ring is full"""
+        cdef RingBar bar
+        cdef bint stored
+        bar.timestamp = timestamp
+        bar.open = open
+        bar.high = high
+        bar.low = low
+        bar.close = close
+        bar.volume = volume
+        with nogil:
+            stored = self.ring.push(bar)
+        return stored
+
+    def pending(self):
+        """Consumer side: bars pushed but not popped yet"""
+        return self.ring.pending()
+
+    def pop(self):
+        """Consumer side: (timestamp_ns, open, high, low, close, volume) or None when empty"""
+        cdef RingBar bar
+        cdef bint got
+        with nogil:
+            got = self.ring.pop(bar)
+        if not got:
+            return None
+        return (bar.timestamp, bar.open, bar.high, bar.low, bar.close, bar.volume)
+
+    def __len__(self):
+        return self.ring.visible()
+
+    def columns(self, k=None):
+        """
+        Zero-copy views of the last k popped bars (all visible bars by default)
+
+        Returns:
+            dict with 'timestamp' (int64 epoch ns) and 'Open'/'High'/'Low'/'Close'/'Volume'
+        """
+        cdef size_t n = self.ring.visible()
+        if k is not None and k < n:
+            n = k
+        cdef size_t off = self.ring.view_offset(n)
+        return {
+            'timestamp': _column_view(self, self.ring.timestamps() + off, n, cnp.NPY_INT64),
+            'Open': _column_view(self, self.ring.opens() + off, n, cnp.NPY_DOUBLE),
+            'High': _column_view(self, self.ring.highs() + off, n, cnp.NPY_DOUBLE),
+            'Low': _column_view(self, self.ring.lows() + off, n, cnp.NPY_DOUBLE),
+            'Close': _column_view(self, self.ring.closes() + off, n, cnp.NPY_DOUBLE),
+            'Volume': _column_view(self, self.ring.volumes() + off, n, cnp.NPY_DOUBLE),
+        }
@@ -0,0 +1,45 @@
+from setuptools import setup, Extension
+from Cython.Build import cythonize
+import numpy as np
+
+
+def native_extension(name, threaded=False):
+    thread_flags = ["-pthread"] if threaded else []
+    return Extension(
+        name,
+        [f"{name}.pyx"],
+        include_dirs=[np.get_include(), "."],
+        extra_compile_args=["-O3", "-std=c++17", "-fopenmp-simd"] + thread_flags,
+        extra_link_args=thread_flags,
+        define_macros=[("NPY_NO_DEPRECATED_API", "NPY_1_7_API_VERSION")],
+    )
+
+
+extensions = [
+    native_extension("execution"),
+    native_extension("indicators"),
+    native_extension("ring_buffer"),
+    native_extension("bar_aggregator"),
+    native_extension("portfolio"),
+    native_extension("order_book"),
+    native_extension("hmm", threaded=True),
+    native_extension("feature_matrix"),
+    native_extension("zone_stats", threaded=True),
+    native_extension("correlation", threaded=True),
+    native_extension("bar_json"),
+    native_extension("decimate"),
+]
+
+setup(
+    name="bat-native",
+    ext_modules=cythonize(
+        extensions,
+        compiler_directives={
+            'language_level': "3",
+            'boundscheck': False,
+            'wraparound': False,
+            'initializedcheck': False,
+            'cdivision': True,
+        }
+    ),
+)
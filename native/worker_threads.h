@@ -0,0 +1,39 @@
+// Worker-thread launch shared by the threaded kernels.
+//
+// An exception escaping a std::thread body calls std::terminate, which the
+// extensions' `except +` declarations cannot turn into a Python error. Each
+// worker's exception is caught and, once every thread has joined, the first
+// one is rethrown on the calling thread.
+
+#pragma once
+
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bat {
+
+// Run worker() on n threads, the calling thread included, and join them
+template <typename Worker>
+void run_workers(unsigned n, Worker&& worker) {
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto guarded = [&]() {
+        try {
+            worker();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    if (n > 1) threads.reserve(n - 1);
+    for (unsigned t = 1; t < n; ++t) threads.emplace_back(guarded);
+    guarded();
+    for (std::thread& th : threads) th.join();
+    if (error) std::rethrow_exception(error);
+}
+
+}  // namespace bat
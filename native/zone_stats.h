@@ -0,0 +1,328 @@
+// Single-pass intraday zone statistics behind TradingZoneAnalyzer.
+//
+// analyze_zones in Python filters the whole frame once per zone and then
+// runs pct_change, scipy skew/kurtosis and linregress on each subset. Here a
+// zone (minute-of-day / duration) owns a ZoneAccumulator and every bar is
+// folded into its zone once:
+//
+//   - Moments keeps count, mean and central moments M2..M4 of the zone's
+//     close-to-close returns and of its volume (Welford/Terriberry updates);
+//   - CoMoments keeps the means and co-moments of (position in zone, close)
+//     for the least-squares trend;
+//   - plain sums cover the range, range %, body size and bullish bars.
+//
+// All three merge exactly (Pebay's pairwise formulas), so a series is split
+// into chunks that threads accumulate independently and the chunk results
+// are merged in order; the return and positions that straddle a chunk
+// boundary are restored in ZoneAccumulator::merge. analyze_zone_jobs runs
+// many (series, zone duration) jobs at once, e.g. several symbols with every
+// duration from 5 to 120 minutes.
+//
+// Features match calculate_zone_features: sample std (ddof = 1), biased
+// skew and excess kurtosis as scipy.stats (0 below 3 and 4 returns, NaN for
+// constant returns), |slope|, sign(slope) and r^2 of linregress.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "worker_threads.h"
+
+namespace bat {
+
+constexpr int MINUTES_PER_DAY = 1440;
+constexpr size_t ZONE_MIN_CHUNK = 16384;  // bars per thread chunk before splitting a job pays off
+
+// Count, mean and central moment sums of a sample
+struct Moments {
+    double n = 0.0, mean = 0.0, m2 = 0.0, m3 = 0.0, m4 = 0.0;
+
+    void add(double x) {
+        const double n1 = n;
+        n += 1.0;
+        const double delta = x - mean;
+        const double dn = delta / n;
+        const double dn2 = dn * dn;
+        const double term = delta * dn * n1;
+        mean += dn;
+        m4 += term * dn2 * (n * n - 3.0 * n + 3.0) + 6.0 * dn2 * m2 - 4.0 * dn * m3;
+        m3 += term * dn * (n - 2.0) - 3.0 * dn * m2;
+        m2 += term;
+    }
+
+    void merge(const Moments& o) {
+        if (o.n == 0.0) return;
+        if (n == 0.0) {
+            *this = o;
+            return;
+        }
+        const double na = n, nb = o.n, total = na + nb;
+        const double delta = o.mean - mean;
+        const double d2 = delta * delta;
+        const double nab = na * nb;
+        const double merged_m4 = m4 + o.m4 + d2 * d2 * nab * (na * na - nab + nb * nb) / (total * total * total) +
+                                 6.0 * d2 * (na * na * o.m2 + nb * nb * m2) / (total * total) +
+                                 4.0 * delta * (na * o.m3 - nb * m3) / total;
+        const double merged_m3 = m3 + o.m3 + d2 * delta * nab * (na - nb) / (total * total) +
+                                 3.0 * delta * (na * o.m2 - nb * m2) / total;
+        m2 += o.m2 + d2 * nab / total;
+        m3 = merged_m3;
+        m4 = merged_m4;
+        mean += delta * nb / total;
+        n = total;
+    }
+
+    double sample_std() const {
+        return n > 1.0 ? std::sqrt(std::max(m2, 0.0) / (n - 1.0)) : std::numeric_limits<double>::quiet_NaN();
+    }
+};
+
+// Means and co-moment sums of (x, y) pairs
+struct CoMoments {
+    double n = 0.0, mean_x = 0.0, mean_y = 0.0, cxx = 0.0, cyy = 0.0, cxy = 0.0;
+
+    void add(double x, double y) {
+        n += 1.0;
+        const double dx = x - mean_x;
+        mean_x += dx / n;
+        const double dy = y - mean_y;
+        mean_y += dy / n;
+        cxx += dx * (x - mean_x);
+        cyy += dy * (y - mean_y);
+        cxy += dx * (y - mean_y);
+    }
+
+    // o's x values shifted by x_offset
+    void merge(const CoMoments& o, double x_offset) {
+        if (o.n == 0.0) return;
+        if (n == 0.0) {
+            *this = o;
+            mean_x += x_offset;
+            return;
+        }
+        const double total = n + o.n;
+        const double dx = o.mean_x + x_offset - mean_x;
+        const double dy = o.mean_y - mean_y;
+        const double w = n * o.n / total;
+        cxx += o.cxx + dx * dx * w;
+        cyy += o.cyy + dy * dy * w;
+        cxy += o.cxy + dx * dy * w;
+        mean_x += dx * o.n / total;
+        mean_y += dy * o.n / total;
+        n = total;
+    }
+};
+
+struct ZoneAccumulator {
+    int64_t count = 0;
+    int64_t bullish = 0;
+    int64_t first_row = -1;  // zones are reported in order of first appearance
+    int64_t min_row = -1, max_row = -1;
+    int64_t min_timestamp = 0, max_timestamp = 0;
+    double first_close = 0.0, last_close = 0.0;
+    double range_sum = 0.0, range_pct_sum = 0.0, body_sum = 0.0;
+    Moments returns, volume;
+    CoMoments trend;
+
+    void add(int64_t row, int64_t timestamp, double open, double high, double low, double close, double vol) {
+        if (count == 0) {
+            first_row = min_row = max_row = row;
+            min_timestamp = max_timestamp = timestamp;
+            first_close = close;
+        } else {
+            returns.add(close / last_close - 1.0);
+            if (timestamp < min_timestamp) {
+                min_timestamp = timestamp;
+                min_row = row;
+            }
+            if (timestamp > max_timestamp) {
+                max_timestamp = timestamp;
+                max_row = row;
+            }
+        }
+        trend.add(static_cast<double>(count), close);
+        volume.add(vol);
+        range_sum += high - low;
+        range_pct_sum += (high - low) / close;
+        body_sum += std::fabs(close - open);
+        if (close > open) ++bullish;
+        last_close = close;
+        ++count;
+    }
+
+    // Append the bars of o, which follow this accumulator's bars in the series
+    void merge(const ZoneAccumulator& o) {
+        if (o.count == 0) return;
+        if (count == 0) {
+            *this = o;
+            return;
+        }
+        returns.add(o.first_close / last_close - 1.0);
+        returns.merge(o.returns);
+        trend.merge(o.trend, static_cast<double>(count));
+        volume.merge(o.volume);
+        range_sum += o.range_sum;
+        range_pct_sum += o.range_pct_sum;
+        body_sum += o.body_sum;
+        bullish += o.bullish;
+        if (o.min_timestamp < min_timestamp) {
+            min_timestamp = o.min_timestamp;
+            min_row = o.min_row;
+        }
+        if (o.max_timestamp > max_timestamp) {
+            max_timestamp = o.max_timestamp;
+            max_row = o.max_row;
+        }
+        last_close = o.last_close;
+        count += o.count;
+    }
+};
+
+// One row of analyze_zones
+struct ZoneFeatures {
+    int64_t zone_id;
+    int64_t num_samples;
+    int64_t start_row;  // row of the zone's earliest timestamp
+    int64_t end_row;    // row of its latest timestamp
+    double volatility;
+    double avg_return;
+    double return_skewness;
+    double return_kurtosis;
+    double avg_range;
+    double avg_range_pct;
+    double trend_strength;
+    double trend_direction;
+    double trend_r_squared;
+    double avg_volume;
+    double volume_volatility;
+    double avg_body_size;
+    double bullish_ratio;
+};
+
+inline ZoneFeatures zone_features(int64_t zone_id, const ZoneAccumulator& a) {
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    const double n = static_cast<double>(a.count);
+    ZoneFeatures f;
+    f.zone_id = zone_id;
+    f.num_samples = a.count;
+    f.start_row = a.min_row;
+    f.end_row = a.max_row;
+
+    const Moments& r = a.returns;
+    f.volatility = r.sample_std();
+    f.avg_return = r.n > 0.0 ? r.mean : nan;
+    const double m2 = r.m2 / r.n;
+    f.return_skewness = r.n > 2.0 ? (m2 > 0.0 ? (r.m3 / r.n) / std::pow(m2, 1.5) : nan) : 0.0;
+    f.return_kurtosis = r.n > 3.0 ? (m2 > 0.0 ? (r.m4 / r.n) / (m2 * m2) - 3.0 : nan) : 0.0;
+
+    f.avg_range = a.range_sum / n;
+    f.avg_range_pct = a.range_pct_sum / n;
+
+    const CoMoments& t = a.trend;
+    if (a.count > 1) {
+        const double slope = t.cxy / t.cxx;
+        const double denominator = std::sqrt(t.cxx * t.cyy);
+        const double corr = denominator == 0.0 ? 0.0 : std::clamp(t.cxy / denominator, -1.0, 1.0);
+        f.trend_strength = std::fabs(slope);
+        f.trend_direction = static_cast<double>((slope > 0.0) - (slope < 0.0));
+        f.trend_r_squared = corr * corr;
+    } else {
+        f.trend_strength = f.trend_direction = f.trend_r_squared = 0.0;
+    }
+
+    f.avg_volume = a.volume.mean;
+    f.volume_volatility = a.volume.sample_std();
+    f.avg_body_size = a.body_sum / n;
+    f.bullish_ratio = static_cast<double>(a.bullish) / n;
+    return f;
+}
+
+// Column views of one series; minute[i] is the bar's minute of the day
+// (0..1439) and timestamp only orders bars for the zone start/end rows.
+struct ZoneBars {
+    const int64_t* timestamp;
+    const int32_t* minute;
+    const double* open;
+    const double* high;
+    const double* low;
+    const double* close;
+    const double* volume;
+    size_t size;
+};
+
+struct ZoneJob {
+    size_t series;
+    int duration;  // zone_duration_minutes, >= 1
+};
+
+inline size_t zone_count(int duration) { return static_cast<size_t>((MINUTES_PER_DAY - 1) / duration + 1); }
+
+inline void accumulate_zones(const ZoneBars& bars, size_t begin, size_t end, int duration, ZoneAccumulator* zones) {
+    for (size_t i = begin; i < end; ++i) {
+        zones[bars.minute[i] / duration].add(static_cast<int64_t>(i), bars.timestamp[i], bars.open[i], bars.high[i],
+                                             bars.low[i], bars.close[i], bars.volume[i]);
+    }
+}
+
+// Zone features of every job into out[j], zones in order of first
+// appearance, across n_threads workers (0 = all cores). Jobs are split into
+// chunks when there are fewer jobs than threads.
+inline void analyze_zone_jobs(const ZoneBars* series, const ZoneJob* jobs, size_t n_jobs, unsigned n_threads,
+                              std::vector<ZoneFeatures>* out) {
+    for (size_t j = 0; j < n_jobs; ++j) {
+        if (jobs[j].duration < 1) throw std::invalid_argument("zone duration must be at least 1 minute");
+    }
+    unsigned n = n_threads ? n_threads : std::max(1u, std::thread::hardware_concurrency());
+
+    // (job, chunk) tasks, each with its own accumulators
+    std::vector<size_t> chunk_begin{0};
+    for (size_t j = 0; j < n_jobs; ++j) {
+        const size_t size = series[jobs[j].series].size;
+        const size_t wanted = (n + n_jobs - 1) / n_jobs;
+        const size_t chunks = std::max<size_t>(1, std::min(wanted, size / ZONE_MIN_CHUNK));
+        chunk_begin.push_back(chunk_begin.back() + chunks);
+    }
+    const size_t n_tasks = chunk_begin.back();
+    std::vector<std::vector<ZoneAccumulator>> partial(n_tasks);
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t task; (task = next.fetch_add(1, std::memory_order_relaxed)) < n_tasks;) {
+            const size_t j = static_cast<size_t>(
+                std::upper_bound(chunk_begin.begin(), chunk_begin.end(), task) - chunk_begin.begin() - 1);
+            const ZoneBars& bars = series[jobs[j].series];
+            const size_t chunks = chunk_begin[j + 1] - chunk_begin[j];
+            const size_t c = task - chunk_begin[j];
+            partial[task].resize(zone_count(jobs[j].duration));
+            accumulate_zones(bars, bars.size * c / chunks, bars.size * (c + 1) / chunks, jobs[j].duration,
+                             partial[task].data());
+        }
+    };
+    n = static_cast<unsigned>(std::min<size_t>(n, std::max<size_t>(n_tasks, 1)));
+    run_workers(n, worker);
+
+    for (size_t j = 0; j < n_jobs; ++j) {
+        std::vector<ZoneAccumulator>& zones = partial[chunk_begin[j]];
+        for (size_t task = chunk_begin[j] + 1; task < chunk_begin[j + 1]; ++task) {
+            for (size_t z = 0; z < zones.size(); ++z) zones[z].merge(partial[task][z]);
+        }
+        std::vector<size_t> order;
+        for (size_t z = 0; z < zones.size(); ++z) {
+            if (zones[z].count) order.push_back(z);
+        }
+        std::sort(order.begin(), order.end(),
+                  [&zones](size_t a, size_t b) { return zones[a].first_row < zones[b].first_row; });
+        out[j].clear();
+        for (const size_t z : order) out[j].push_back(zone_features(static_cast<int64_t>(z), zones[z]));
+    }
+}
+
+}  // namespace bat
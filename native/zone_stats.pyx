@@ -0,0 +1,135 @@
+# cython: language_level=3
+# distutils: language = c++
+
+from libc.stdint cimport int32_t, int64_t
+from libc.string cimport memcpy
+from libcpp.vector cimport vector
+
+cimport numpy as cnp
+import numpy as np
+
+cnp.import_array()
+
+
+cdef extern from "zone_stats.h" namespace "bat":
+    cdef cppclass ZoneFeatures:
+        pass
+
+    cdef cppclass ZoneBars:
+        const int64_t* timestamp
+        const int32_t* minute
+        const double* open
+        const double* high
+        const double* low
+        const double* close
+        const double* volume
+        size_t size
+
+    cdef cppclass ZoneJob:
+        size_t series
+        int duration
+
+    void analyze_zone_jobs(const ZoneBars* series, const ZoneJob* jobs, size_t n_jobs, unsigned n_threads,
+                           vector[ZoneFeatures]* out) nogil except +
+
+
+# Field for field the layout of bat::ZoneFeatures
+ZONE_DTYPE = np.dtype([
+    ('zone_id', np.int64),
+    ('num_samples', np.int64),
+    ('start_row', np.int64),
+    ('end_row', np.int64),
+    ('volatility', np.float64),
+    ('avg_return', np.float64),
+    ('return_skewness', np.float64),
+    ('return_kurtosis', np.float64),
+    ('avg_range', np.float64),
+    ('avg_range_pct', np.float64),
+    ('trend_strength', np.float64),
+    ('trend_direction', np.float64),
+    ('trend_r_squared', np.float64),
+    ('avg_volume', np.float64),
+    ('volume_volatility', np.float64),
+    ('avg_body_size', np.float64),
+    ('bullish_ratio', np.float64),
+])
+assert ZONE_DTYPE.itemsize == sizeof(ZoneFeatures)
+
+COLUMNS = ('timestamp', 'minute', 'open', 'high', 'low', 'close', 'volume')
+
+
+def analyze(series, durations, unsigned int n_threads=0):
+    """
+    Zone features of every (series, zone duration) pair in one parallel run
+
+    Args:
+        series: One dict per series with equal-length 'timestamp' (int64),
+            'minute' (minute of day, 0..1439) and 'open', 'high', 'low',
+            'close', 'volume' arrays
+        durations: Zone durations in minutes
+        n_threads: Worker threads (0 = all cores)
+
+    Returns:
+        result[s][d]: ZONE_DTYPE array of series s with durations[d], zones
+        in order of first appearance; start_row/end_row index the series
+    """
+    durations = [int(d) for d in durations]
+    if any(d < 1 for d in durations):
+        raise ValueError("zone durations must be at least 1 minute")
+    if not durations:
+        return [[] for _ in series]
+    cdef list arrays = []
+    cdef vector[ZoneBars] bars
+    cdef ZoneBars b
+    cdef const int64_t[::1] timestamp
+    cdef const int32_t[::1] minute
+    cdef const double[::1] open_, high, low, close, volume
+    for s in series:
+        columns = {
+            'timestamp': np.ascontiguousarray(s['timestamp'], dtype=np.int64),
+            'minute': np.ascontiguousarray(s['minute'], dtype=np.int32),
+        }
+        for name in COLUMNS[2:]:
+            columns[name] = np.ascontiguousarray(s[name], dtype=np.float64)
+        n = len(columns['close'])
+        if any(len(columns[name]) != n for name in COLUMNS):
+            raise ValueError("series columns must have the same length")
+        if n and (columns['minute'].min() < 0 or columns['minute'].max() >= 1440):
+            raise ValueError("minute must be within 0..1439")
+        arrays.append(columns)
+        timestamp, minute = columns['timestamp'], columns['minute']
+        open_, high, low = columns['open'], columns['high'], columns['low']
+        close, volume = columns['close'], columns['volume']
+        b.size = n
+        b.timestamp = &timestamp[0] if n else NULL
+        b.minute = &minute[0] if n else NULL
+        b.open = &open_[0] if n else NULL
+        b.high = &high[0] if n else NULL
+        b.low = &low[0] if n else NULL
+        b.close = &close[0] if n else NULL
+        b.volume = &volume[0] if n else NULL
+        bars.push_back(b)
+
+    cdef vector[ZoneJob] jobs
+    cdef ZoneJob job
+    cdef size_t i
+    for i in range(bars.size()):
+        for d in durations:
+            job.series = i
+            job.duration = d
+            jobs.push_back(job)
+    cdef vector[vector[ZoneFeatures]] out
+    out.resize(jobs.size())
+    with nogil:
+        analyze_zone_jobs(bars.data(), jobs.data(), jobs.size(), n_threads, out.data())
+
+    cdef cnp.ndarray rows
+    result = []
+    for i in range(jobs.size()):
+        rows = np.empty(out[i].size(), dtype=ZONE_DTYPE)
+        if out[i].size():
+            memcpy(rows.data, out[i].data(), out[i].size() * sizeof(ZoneFeatures))
+        if i % len(durations) == 0:
+            result.append([])
+        result[-1].append(rows)
+    return result
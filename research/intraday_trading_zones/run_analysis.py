@@ -9,7 +9,7 @@ import pandas as pd
 import sys
 from pathlib import Path
 from datetime import datetime
-from zone_analyzer import TradingZoneAnalyzer
+from zone_analyzer import TradingZoneAnalyzer, sweep_zone_durations, DEFAULT_SWEEP_DURATIONS
 
 
 def load_data(file_path: str, date_column: str = None) -> pd.DataFrame:
@@ -192,6 +192,47 @@ def run_zone_analysis(
     return zone_features, summary
 
 
+def run_duration_sweep(data_path: str, durations=DEFAULT_SWEEP_DURATIONS, date_column: str = None,
+                       output_dir: str = None, symbol: str = "UNKNOWN", n_threads: int = 0) -> pd.DataFrame:
+    """
+    Zone features for every zone duration in one run.
+
+    Args:
+        data_path: Path to the data file
+        durations: zone_duration_minutes values (default every 5 minutes from 5 to 120)
+        date_column: Name of the date column (if CSV)
+        output_dir: Directory to save the sweep CSV (optional)
+        symbol: Trading symbol for labeling
+        n_threads: Worker threads for the native analyzer (0 = all cores)
+
+    Returns:
+        sweep_zone_durations DataFrame
+    """
+    df = load_data(data_path, date_column)
+    sweep = sweep_zone_durations({symbol: df}, durations, n_threads=n_threads)
+
+    overview = sweep.groupby('zone_duration_minutes').agg(
+        zones=('zone_id', 'count'),
+        volatility=('volatility', 'mean'),
+        trend_r_squared=('trend_r_squared', 'mean'),
+        avg_range_pct=('avg_range_pct', 'mean'),
+    )
+    print(f"\n{'='*60}")
+    print(f"ZONE DURATION SWEEP - {symbol}")
+    print(f"{'='*60}")
+    print(overview.to_string())
+
+    if output_dir:
+        output_path = Path(output_dir)
+        output_path.mkdir(parents=True, exist_ok=True)
+        timestamp = datetime.now().strftime("%Y%m%d_%H%M%S")
+        sweep_file = output_path / f"{symbol}_duration_sweep_{timestamp}.csv"
+        sweep.to_csv(sweep_file, index=False)
+        print(f"\nSweep saved to: {sweep_file}")
+
+    return sweep
+
+
 def main():
     """
     Main entry point for command-line execution.
@@ -242,5 +283,9 @@ if __name__ == "__main__":
     #     n_clusters=4,
     #     symbol="AAPL"
     # )
+    #
+    # Or every zone duration from 5 to 120 minutes at once:
+    # from run_analysis import run_duration_sweep
+    # sweep = run_duration_sweep("my_data.csv", symbol="AAPL")
 
     main()
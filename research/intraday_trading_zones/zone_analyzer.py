@@ -4,17 +4,63 @@ Intraday Trading Zone Analyzer
 This module analyzes different time zones of the trading day to identify their
 personality characteristics such as volatility, ranging behavior, trending, etc.
 using machine learning and statistical methods.
+
+With native/zone_stats built, analyze_zones buckets every bar into its zone
+in one pass (mergeable moment and regression accumulators, chunked across
+threads) instead of filtering the frame once per zone, and
+sweep_zone_durations runs many symbols and zone durations in one call.
 """
 
+import os
+import sys
 import pandas as pd
 import numpy as np
-from typing import Dict, List, Tuple, Optional
+from typing import Dict, List, Tuple, Optional, Iterable, Union
 from datetime import time, datetime
 from sklearn.preprocessing import StandardScaler
 from sklearn.cluster import KMeans
 from sklearn.ensemble import RandomForestClassifier
 from scipy import stats
 
+# native/ lives at the repository root
+sys.path.append(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__)))))
+try:
+    from native import zone_stats as _native_zones
+except ImportError:  # extension not built, use the pandas/scipy path
+    _native_zones = None
+
+OHLCV_COLUMNS = ['open', 'high', 'low', 'close', 'volume']
+FEATURE_COLUMNS = [
+    'volatility', 'avg_return', 'return_skewness', 'return_kurtosis',
+    'avg_range', 'avg_range_pct',
+    'trend_strength', 'trend_direction', 'trend_r_squared',
+    'avg_volume', 'volume_volatility',
+    'avg_body_size', 'bullish_ratio',
+]
+DEFAULT_SWEEP_DURATIONS = tuple(range(5, 121, 5))
+
+
+def _native_series(df: pd.DataFrame) -> Optional[Dict[str, np.ndarray]]:
+    """Columns for native.zone_stats.analyze, or None when the pandas path must run (missing columns or NaNs)"""
+    if _native_zones is None or not all(col in df.columns for col in OHLCV_COLUMNS):
+        return None
+    series = {col: df[col].to_numpy(dtype=np.float64) for col in OHLCV_COLUMNS}
+    if any(np.isnan(values).any() for values in series.values()):
+        return None
+    series['timestamp'] = df.index.asi8
+    series['minute'] = (df.index.hour * 60 + df.index.minute).to_numpy(dtype=np.int32)
+    return series
+
+
+def _zone_frame(df: pd.DataFrame, rows: np.ndarray) -> pd.DataFrame:
+    """analyze_zones' DataFrame from native ZONE_DTYPE rows of df"""
+    result = pd.DataFrame({col: rows[col] for col in FEATURE_COLUMNS})
+    result['zone_id'] = rows['zone_id']
+    result['start_time'] = [t.time() for t in df.index[rows['start_row']]]
+    result['end_time'] = [t.time() for t in df.index[rows['end_row']]]
+    result['num_samples'] = rows['num_samples']
+    return result
+
 
 class TradingZoneAnalyzer:
     """
@@ -117,12 +163,16 @@ class TradingZoneAnalyzer:
         Returns:
             DataFrame with zone analysis results
         """
+        series = _native_series(df)
+        if series is not None:
+            rows = _native_zones.analyze([series], [self.zone_duration_minutes], n_threads=0)[0][0]
+            return _zone_frame(df, rows)
+
         df_zones = self.create_time_zones(df)
 
         zone_analysis = []
 
-        for zone_id in df_zones['time_zone'].unique():
-            zone_data = df_zones[df_zones['time_zone'] == zone_id]
+        for zone_id, zone_data in df_zones.groupby('time_zone', sort=False):
 
             # Get time range for this zone
             start_time = zone_data.index.min().time()
@@ -249,3 +299,46 @@ class TradingZoneAnalyzer:
         summary = self.get_zone_summary(zone_features)
 
         return zone_features, summary
+
+
+def sweep_zone_durations(data: Union[pd.DataFrame, Dict[str, pd.DataFrame]],
+                         durations: Iterable[int] = DEFAULT_SWEEP_DURATIONS,
+                         n_threads: int = 0) -> pd.DataFrame:
+    """
+    analyze_zones for every symbol and zone duration in one run.
+
+    With native/zone_stats built all (symbol, duration) jobs run in parallel
+    across n_threads workers (0 = all cores); otherwise each runs through
+    TradingZoneAnalyzer in turn.
+
+    Args:
+        data: DataFrame with datetime index and OHLCV data, or a dict of them by symbol
+        durations: zone_duration_minutes values to analyze
+        n_threads: Worker threads for the native run
+
+    Returns:
+        analyze_zones rows with 'symbol' and 'zone_duration_minutes' columns in front
+    """
+    if isinstance(data, pd.DataFrame):
+        data = {None: data}
+    durations = [int(d) for d in durations]
+
+    native = {symbol: _native_series(df) for symbol, df in data.items()}
+    ready = [symbol for symbol, series in native.items() if series is not None]
+    native_rows = {}
+    if ready:
+        results = _native_zones.analyze([native[symbol] for symbol in ready], durations, n_threads=n_threads)
+        native_rows = dict(zip(ready, results))
+
+    frames = []
+    for symbol, df in data.items():
+        for d, duration in enumerate(durations):
+            if symbol in native_rows:
+                frame = _zone_frame(df, native_rows[symbol][d])
+            else:
+                frame = TradingZoneAnalyzer(duration).analyze_zones(df)
+            frame.insert(0, 'zone_duration_minutes', duration)
+            frame.insert(0, 'symbol', symbol)
+            frames.append(frame)
+
+    return pd.concat(frames, ignore_index=True) if frames else pd.DataFrame()
@@ -1,25 +1,310 @@
 # cython: language_level=3
 # distutils: language = c++
 
+import os
 import sys
+from datetime import datetime, timedelta
 from libc.math cimport sqrt
+from libc.stdint cimport int64_t, uint64_t
+from libcpp.memory cimport shared_ptr, make_shared
+from libcpp.vector cimport vector
+from libcpp.string cimport string
+from cython.operator cimport dereference as deref
+
+cimport numpy as cnp
+import numpy as np
+
+cnp.import_array()
+
+
+cdef extern from "bar_store.h" namespace "bat":
+    cdef cppclass BarColumns:
+        const int64_t* timestamp
+        const double* open
+        const double* high
+        const double* low
+        const double* close
+        const double* volume
+        size_t size
+        BarColumns slice(size_t begin, size_t end)
+
+    cdef cppclass CBarStore "bat::BarStore":
+        void reserve(size_t n)
+        void push_back(int64_t ts, double o, double h, double l, double c, double v)
+        size_t size()
+        BarColumns columns()
+
+
+cdef extern from "csv_loader.h" namespace "bat":
+    cdef enum LoadStatus:
+        LOAD_OK
+        LOAD_NOT_FOUND
+        LOAD_IO_ERROR
+        LOAD_BAD_HEADER
+        LOAD_BAD_FORMAT
+
+    cdef cppclass LoadReport:
+        int status
+        string message
+        size_t rows
+        size_t skipped
+        vector[string] bad_lines
+
+    LoadReport load_csv_bars(const string& path, CBarStore& store) nogil except +
+    void load_csv_bars_many(const vector[string]& paths, const vector[CBarStore*]& stores,
+                            vector[LoadReport]& reports, unsigned int n_threads) nogil except +
+
+
+cdef extern from "bar_file.h" namespace "bat":
+    cdef struct BarFileHeader:
+        unsigned long long rows
+        unsigned long long source_size
+        long long source_mtime_ns
+
+    int write_bar_file(const string& path, const BarColumns& bars, unsigned long long source_size,
+                       long long source_mtime_ns, string& message) nogil except +
+
+    cdef cppclass MappedBarFile:
+        int open(const string& path, string& message) nogil except +
+        BarFileHeader header()
+        BarColumns columns()
+
+
+cdef extern from "mean_reversion.h" namespace "bat":
+    cdef struct TradingStats:
+        int position
+        double entry_price
+        double total_pnl
+        double peak_equity
+        double max_drawdown
+        int64_t total_trades
+        int64_t winning_trades
+        int64_t losing_trades
+        double total_wins
+        double total_losses
+        double mtm_peak_equity
+        double mtm_max_drawdown
+
+    cdef enum TradeAction:
+        ACTION_BUY
+        ACTION_SHORT
+        ACTION_SELL
+        ACTION_COVER
+
+    cdef struct TradeEvent:
+        size_t index
+        int action
+        double price
+        double sma
+        double band
+        double entry_price
+        double pnl
+
+    cdef struct BacktestMetrics:
+        int sma_period
+        double std_multiplier
+        int64_t total_trades
+        int64_t winning_trades
+        int64_t losing_trades
+        double total_pnl
+        double max_drawdown
+        double max_drawdown_mtm
+        double win_rate
+        double avg_win
+        double avg_loss
+        double profit_factor
+        double expectancy
+
+    void run_mean_reversion(const BarColumns& bars, int sma_period, double std_multiplier,
+                            TradingStats& stats, vector[TradeEvent]* events) nogil
+    BacktestMetrics compute_metrics(const TradingStats& stats, int sma_period, double std_multiplier) nogil
+
+
+cdef extern from "rolling.h" namespace "bat":
+    void rolling_mean_std(const double* values, size_t size, size_t period, double* mean, double* stdev) nogil
+
+
+cdef extern from "sweep.h" namespace "bat":
+    void sweep_grid(const BarColumns& bars, const int* periods, size_t n_periods,
+                    const double* multipliers, size_t n_multipliers,
+                    BacktestMetrics* out, unsigned int n_threads) nogil except +
+
+
+cdef extern from "walk_forward.h" namespace "bat":
+    cdef struct WalkForwardFold:
+        size_t train_begin
+        size_t train_end
+        size_t test_begin
+        size_t test_end
+
+    cdef struct WalkForwardResult:
+        BacktestMetrics train
+        BacktestMetrics test
+        double test_min_equity
+        double test_peak_equity
+        int selected
+        size_t row
+
+    void walk_forward_folds "bat::walk_forward"(const BarColumns& bars, const WalkForwardFold* folds, size_t n_folds,
+                                                const int* periods, size_t n_periods,
+                                                const double* multipliers, size_t n_multipliers,
+                                                WalkForwardResult* out, BacktestMetrics* train_grid,
+                                                unsigned int n_threads) nogil except +
+
+
+cdef extern from "strategy.h" namespace "bat":
+    cdef enum StrategyKind:
+        STRATEGY_MOVING_AVERAGE
+        STRATEGY_RSI
+        STRATEGY_MACD
+        STRATEGY_BOLLINGER_BANDS
+        STRATEGY_MEAN_REVERSION_EXTREME
+        STRATEGY_CANDLESTICK
+
+    size_t strategy_param_count(int kind) except +
+    void sweep_strategy_rows "bat::sweep_strategy"(int kind, const BarColumns& bars, const double* params,
+                                                   size_t n_rows, bint long_short, BacktestMetrics* out,
+                                                   unsigned int n_threads) nogil except +
+    void walk_forward_strategy_folds "bat::walk_forward_strategy"(int kind, const BarColumns& bars,
+                                                                  const WalkForwardFold* folds, size_t n_folds,
+                                                                  const double* params, size_t n_rows,
+                                                                  bint long_short, WalkForwardResult* out,
+                                                                  BacktestMetrics* train_grid,
+                                                                  unsigned int n_threads) nogil except +
+
+
+cdef extern from "bootstrap.h" namespace "bat":
+    cdef enum ResampleMode:
+        RESAMPLE_BARS
+        RESAMPLE_TRADES_SHUFFLE
+        RESAMPLE_TRADES_BOOTSTRAP
+
+    void resample_mean_reversion(const BarColumns& bars, const int* periods, const double* multipliers,
+                                 size_t n_configs, int mode, size_t n_samples, size_t block_size, uint64_t seed,
+                                 BacktestMetrics* out, unsigned int n_threads) nogil except +
+    void resample_strategy_rows "bat::resample_strategy"(int kind, const BarColumns& bars, const double* params,
+                                                         size_t n_rows, bint long_short, int mode,
+                                                         size_t n_samples, size_t block_size, uint64_t seed,
+                                                         BacktestMetrics* out, unsigned int n_threads) nogil except +
+
+
+cdef object _column_view(object owner, const void* data, size_t size, int typenum):
+    """Wrap a store column as a read-only NumPy array that keeps its owner alive"""
+    cdef cnp.npy_intp n = <cnp.npy_intp>size
+    cdef cnp.ndarray arr = cnp.PyArray_SimpleNewFromData(1, &n, typenum, <void*>data)
+    cnp.PyArray_CLEARFLAGS(arr, cnp.NPY_ARRAY_WRITEABLE)
+    cnp.set_array_base(arr, owner)
+    return arr
+
+
+cdef str format_timestamp(int64_t ts_ns):
+    """Format an epoch-nanosecond timestamp for trade logs"""
+    return (datetime(1970, 1, 1) + timedelta(microseconds=ts_ns // 1000)).strftime('%Y-%m-%d %H:%M:%S')
+
+
+cdef class BarStore:
+    """
+    Columnar OHLCV bar container backed by contiguous C++ vectors
 
-cdef class Bar:
-    """Represents a single OHLCV bar"""
-    cdef public str timestamp
-    cdef public double open
-    cdef public double high
-    cdef public double low
-    cdef public double close
-    cdef public double volume
-
-    def __init__(self, str timestamp, double open, double high, double low, double close, double volume):
-        self.timestamp = timestamp
-        self.open = open
-        self.high = high
-        self.low = low
-        self.close = close
-        self.volume = volume
+    Columns are exposed as read-only NumPy views (no copies); timestamps are
+    int64 nanoseconds since the epoch, see `datetimes` for a datetime64 view.
+    A store either owns its vectors or views a memory-mapped bar file
+    (open_bar_file); slices share the parent's memory.
+    """
+    cdef shared_ptr[CBarStore] store
+    cdef shared_ptr[MappedBarFile] mapped
+    cdef BarColumns cols
+
+    def __cinit__(self):
+        self.store = make_shared[CBarStore]()
+        self.cols = self.store.get().columns()
+
+    cdef void append(self, int64_t ts, double o, double h, double l, double c, double v):
+        self.store.get().push_back(ts, o, h, l, c, v)
+
+    cdef void seal(self):
+        """Refresh the cached column view once loading has finished"""
+        self.cols = self.store.get().columns()
+
+    @staticmethod
+    def from_arrays(timestamp, open, high, low, close, volume):
+        """Build a store from array-likes (timestamps as datetime64 or epoch ns)"""
+        cdef const cnp.int64_t[:] ts = np.ascontiguousarray(np.asarray(timestamp).astype('datetime64[ns]').view(np.int64))
+        cdef const double[:] o = np.ascontiguousarray(open, dtype=np.float64)
+        cdef const double[:] h = np.ascontiguousarray(high, dtype=np.float64)
+        cdef const double[:] l = np.ascontiguousarray(low, dtype=np.float64)
+        cdef const double[:] c = np.ascontiguousarray(close, dtype=np.float64)
+        cdef const double[:] v = np.ascontiguousarray(volume, dtype=np.float64)
+        cdef Py_ssize_t i, n = c.shape[0]
+        if not (ts.shape[0] == o.shape[0] == h.shape[0] == l.shape[0] == v.shape[0] == n):
+            raise ValueError("All columns must have the same length")
+
+        cdef BarStore result = BarStore()
+        result.store.get().reserve(n)
+        for i in range(n):
+            result.append(ts[i], o[i], h[i], l[i], c[i], v[i])
+        result.seal()
+        return result
+
+    def __len__(self):
+        return self.cols.size
+
+    cdef BarColumns columns(self):
+        return self.cols
+
+    def slice(self, Py_ssize_t begin, Py_ssize_t end):
+        """Zero-copy view of bars [begin, end), clamped to the store"""
+        cdef Py_ssize_t n = <Py_ssize_t>self.cols.size
+        begin = min(max(begin, 0), n)
+        end = min(max(end, begin), n)
+        cdef BarStore view = BarStore.__new__(BarStore)
+        view.store = self.store
+        view.mapped = self.mapped
+        view.cols = self.cols.slice(<size_t>begin, <size_t>end)
+        return view
+
+    def save(self, str path, unsigned long long source_size=0, long long source_mtime_ns=0):
+        """
+        Write the bars as a binary bar file (bar_file.h)
+
+        source_size / source_mtime_ns fingerprint the CSV the bars came from,
+        so load_bars can tell when the cache is stale.
+        """
+        cdef string c_path = path.encode('utf-8')
+        cdef string message
+        cdef int status
+        with nogil:
+            status = write_bar_file(c_path, self.cols, source_size, source_mtime_ns, message)
+        if status != LOAD_OK:
+            raise OSError(f"Could not write {path}: {message.decode('utf-8', 'replace')}")
+
+    @property
+    def timestamp(self):
+        return _column_view(self, self.cols.timestamp, self.cols.size, cnp.NPY_INT64)
+
+    @property
+    def datetimes(self):
+        return self.timestamp.view('datetime64[ns]')
+
+    @property
+    def open(self):
+        return _column_view(self, self.cols.open, self.cols.size, cnp.NPY_DOUBLE)
+
+    @property
+    def high(self):
+        return _column_view(self, self.cols.high, self.cols.size, cnp.NPY_DOUBLE)
+
+    @property
+    def low(self):
+        return _column_view(self, self.cols.low, self.cols.size, cnp.NPY_DOUBLE)
+
+    @property
+    def close(self):
+        return _column_view(self, self.cols.close, self.cols.size, cnp.NPY_DOUBLE)
+
+    @property
+    def volume(self):
+        return _column_view(self, self.cols.volume, self.cols.size, cnp.NPY_DOUBLE)
 
 
 cdef class TradingState:
@@ -34,6 +319,8 @@ cdef class TradingState:
     cdef public int losing_trades
     cdef public double total_wins
     cdef public double total_losses
+    cdef public double mtm_peak_equity
+    cdef public double mtm_max_drawdown
 
     def __init__(self):
         self.position = 0
@@ -46,170 +333,594 @@ cdef class TradingState:
         self.losing_trades = 0
         self.total_wins = 0.0
         self.total_losses = 0.0
+        self.mtm_peak_equity = 0.0
+        self.mtm_max_drawdown = 0.0
+
+    cdef TradingStats to_stats(self):
+        cdef TradingStats stats
+        stats.position = self.position
+        stats.entry_price = self.entry_price
+        stats.total_pnl = self.total_pnl
+        stats.peak_equity = self.peak_equity
+        stats.max_drawdown = self.max_drawdown
+        stats.total_trades = self.total_trades
+        stats.winning_trades = self.winning_trades
+        stats.losing_trades = self.losing_trades
+        stats.total_wins = self.total_wins
+        stats.total_losses = self.total_losses
+        stats.mtm_peak_equity = self.mtm_peak_equity
+        stats.mtm_max_drawdown = self.mtm_max_drawdown
+        return stats
+
+    cdef void from_stats(self, const TradingStats& stats):
+        self.position = stats.position
+        self.entry_price = stats.entry_price
+        self.total_pnl = stats.total_pnl
+        self.peak_equity = stats.peak_equity
+        self.max_drawdown = stats.max_drawdown
+        self.total_trades = stats.total_trades
+        self.winning_trades = stats.winning_trades
+        self.losing_trades = stats.losing_trades
+        self.total_wins = stats.total_wins
+        self.total_losses = stats.total_losses
+        self.mtm_peak_equity = stats.mtm_peak_equity
+        self.mtm_max_drawdown = stats.mtm_max_drawdown
+
+
+cdef bint report_load(const LoadReport& report, str filename, bint verbose):
+    """Print loader diagnostics the way the Python loader did; True if rows were read"""
+    cdef size_t k
+    if report.status == LOAD_NOT_FOUND:
+        if verbose:
+            print(f"Error: File not found: {filename}", file=sys.stderr)
+        return False
+    if report.status != LOAD_OK:
+        if verbose:
+            print(f"Error reading file: {report.message.decode('utf-8', 'replace')}", file=sys.stderr)
+        return False
 
+    if verbose:
+        for k in range(report.bad_lines.size()):
+            print(f"Warning: Skipping malformed line: {report.bad_lines[k].decode('utf-8', 'replace')}", file=sys.stderr)
+        if report.skipped > report.bad_lines.size():
+            print(f"Warning: Skipped {report.skipped - report.bad_lines.size()} more malformed lines", file=sys.stderr)
+        print(f"Loaded {report.rows} bars from {filename}")
+    return True
+
+
+cpdef BarStore load_csv_data(str filename, bint verbose=True):
+    """
+    Load CSV data from file into a columnar bar store
+
+    The file is memory-mapped and parsed natively (csv_loader.h). Columns are
+    found by header name, so any order of timestamp/open/high/low/close
+    (and optional volume) works.
+    """
+    cdef BarStore bars = BarStore()
+    cdef string path = filename.encode('utf-8')
+    cdef LoadReport report
+
+    with nogil:
+        report = load_csv_bars(path, deref(bars.store.get()))
+
+    if not report_load(report, filename, verbose):
+        return BarStore()
+    bars.seal()
+    return bars
 
-cpdef list load_csv_data(str filename, bint verbose=True):
-    """Load CSV data from file"""
-    cdef list bars = []
-    cdef str line
-    cdef list fields
-    cdef str timestamp
-    cdef double open_val, high_val, low_val, close_val, volume_val
-    cdef bint header_skipped = False
 
+cpdef BarStore open_bar_file(str path):
+    """
+    Memory-map a binary bar file; the store's columns point into the mapping
+
+    Raises:
+        OSError: if the file is missing, unreadable or not a bar file
+    """
+    cdef BarStore bars = BarStore()
+    cdef string c_path = path.encode('utf-8')
+    cdef string message
+    cdef int status
+    bars.mapped = make_shared[MappedBarFile]()
+    with nogil:
+        status = bars.mapped.get().open(c_path, message)
+    if status != LOAD_OK:
+        raise OSError(f"Could not open bar file {path}: {message.decode('utf-8', 'replace')}")
+    bars.cols = bars.mapped.get().columns()
+    return bars
+
+
+cdef str cache_path_for(str filename):
+    return os.path.splitext(filename)[0] + '.bars'
+
+
+def load_bars(str filename, bint verbose=True, bint use_cache=True):
+    """
+    Load bars for a CSV file, going through its binary cache when possible
+
+    The cache lives next to the CSV (same name, ".bars" extension) and records
+    the CSV's size and mtime. If it matches, the file is just memory-mapped;
+    otherwise the CSV is parsed and the cache rewritten. Failing to write the
+    cache (e.g. a read-only directory) only costs the speedup.
+    """
+    cdef str cache = cache_path_for(filename)
+    cdef BarStore bars
+    cdef BarFileHeader header
     try:
-        with open(filename, 'r') as f:
-            for line in f:
-                # Skip header line
-                if not header_skipped:
-                    header_skipped = True
-                    continue
-
-                # Parse CSV line: timestamp,open,high,low,close,volume
-                fields = line.strip().split(',')
-
-                if len(fields) >= 5:
-                    try:
-                        timestamp = fields[5].strip()
-                        open_val = float(fields[1].strip())
-                        high_val = float(fields[3].strip())
-                        low_val = float(fields[4].strip())
-                        close_val = float(fields[2].strip())
-                        volume_val = float(fields[0].strip()) if len(fields) > 5 else 0.0
-
-                        bars.append(Bar(timestamp, open_val, high_val, low_val, close_val, volume_val))
-                    except (ValueError, IndexError):
-                        # Skip malformed lines
-                        if verbose:
-                            print(f"Warning: Skipping malformed line: {line.strip()}", file=sys.stderr)
+        info = os.stat(filename)
+    except OSError:
+        info = None
+
+    if use_cache and os.path.exists(cache):
+        try:
+            bars = open_bar_file(cache)
+            header = bars.mapped.get().header()
+            if info is None or (header.source_size == <unsigned long long>info.st_size and
+                                header.source_mtime_ns == <long long>info.st_mtime_ns):
+                if verbose:
+                    print(f"Loaded {len(bars)} bars from {cache}")
+                return bars
+        except OSError:
+            pass
+
+    bars = load_csv_data(filename, verbose)
+    if use_cache and bars and info is not None:
+        try:
+            bars.save(cache, info.st_size, info.st_mtime_ns)
+        except OSError as e:
+            if verbose:
+                print(f"Warning: {e}", file=sys.stderr)
+    return bars
+
+
+def load_csv_files(filenames, unsigned int n_threads=0, bint verbose=True):
+    """
+    Load several CSV files in parallel (one file per worker thread)
 
-        if verbose:
-            print(f"Loaded {len(bars)} bars from {filename}")
-        return bars
+    Args:
+        filenames: Iterable of CSV paths
+        n_threads: Worker threads (0 = all cores)
+        verbose: Print loader diagnostics
 
-    except FileNotFoundError:
-        if verbose:
-            print(f"Error: File not found: {filename}", file=sys.stderr)
-        return []
-    except IOError as e:
-        if verbose:
-            print(f"Error reading file: {e}", file=sys.stderr)
-        return []
+    Returns:
+        List of BarStore, in the order of filenames (empty stores for failures)
+    """
+    cdef list names = [str(name) for name in filenames]
+    cdef list stores = [BarStore() for _ in names]
+    cdef vector[string] paths
+    cdef vector[CBarStore*] targets
+    cdef vector[LoadReport] reports
+    cdef BarStore store
+    cdef size_t i
+
+    for i in range(len(names)):
+        store = stores[i]
+        paths.push_back(names[i].encode('utf-8'))
+        targets.push_back(store.store.get())
+
+    with nogil:
+        load_csv_bars_many(paths, targets, reports, n_threads)
+
+    for i in range(len(names)):
+        store = stores[i]
+        if report_load(reports[i], names[i], verbose):
+            store.seal()
+        else:
+            stores[i] = BarStore()
+    return stores
 
 
-cpdef double calculate_sma(list bars, int current_idx, int period):
-    """Calculate Simple Moving Average"""
+cpdef double calculate_sma(BarStore bars, int current_idx, int period):
+    """Calculate Simple Moving Average (two-pass reference for the rolling kernel)"""
     cdef double sum_val = 0.0
     cdef int i
-    cdef Bar bar
+    cdef const double* close = bars.cols.close
 
     if current_idx < period - 1:
         return 0.0
 
     for i in range(period):
-        bar = bars[current_idx - i]
-        sum_val += bar.close
+        sum_val += close[current_idx - i]
 
     return sum_val / period
 
 
-cpdef double calculate_std(list bars, int current_idx, int period, double mean):
-    """Calculate Standard Deviation"""
+cpdef double calculate_std(BarStore bars, int current_idx, int period, double mean):
+    """Calculate Standard Deviation (two-pass reference for the rolling kernel)"""
     cdef double sum_sq_diff = 0.0
     cdef double diff
     cdef int i
-    cdef Bar bar
+    cdef const double* close = bars.cols.close
 
     if current_idx < period - 1:
         return 0.0
 
     for i in range(period):
-        bar = bars[current_idx - i]
-        diff = bar.close - mean
+        diff = close[current_idx - i] - mean
         sum_sq_diff += diff * diff
 
     return sqrt(sum_sq_diff / period)
 
 
-cpdef void execute_strategy(list bars, TradingState state, int sma_period, double std_multiplier, bint verbose=True):
-    """Execute mean reversion strategy"""
-    cdef int i
-    cdef double sma, std, upper_band, lower_band, current_price, pnl, current_drawdown
+def rolling_bands(BarStore bars, int period):
+    """
+    Rolling mean and population std of the close at every bar, from the
+    kernel execute_strategy runs on (rolling.h); bars before the first full
+    window get 0.0, as from calculate_sma / calculate_std
+
+    Returns:
+        (mean, std) float64 arrays
+    """
+    if period < 1:
+        raise ValueError("period must be >= 1")
+    cdef size_t n = bars.cols.size
+    mean = np.zeros(n, dtype=np.float64)
+    stdev = np.zeros(n, dtype=np.float64)
+    cdef double[::1] m = mean
+    cdef double[::1] s = stdev
+    if n > 0:
+        with nogil:
+            rolling_mean_std(bars.cols.close, n, period, &m[0], &s[0])
+    return mean, stdev
+
+
+cpdef void execute_strategy(BarStore bars, TradingState state, int sma_period, double std_multiplier, bint verbose=True):
+    """Execute mean reversion strategy (state machine in mean_reversion.h)"""
+    cdef TradingStats stats = state.to_stats()
+    cdef vector[TradeEvent] events
+    cdef TradeEvent event
     cdef str timestamp
-    cdef Bar bar
-
-    for i in range(sma_period, len(bars)):
-        sma = calculate_sma(bars, i, sma_period)
-        std = calculate_std(bars, i, sma_period, sma)
-
-        if sma == 0.0 or std == 0.0:
-            continue
-
-        upper_band = sma + (std_multiplier * std)
-        lower_band = sma - (std_multiplier * std)
-        bar = bars[i]
-        current_price = bar.close
-        timestamp = bar.timestamp
-
-        # Entry signals
-        if state.position == 0:
-            # Buy signal: price crosses below lower band
-            if current_price < lower_band:
-                state.position = 1
-                state.entry_price = current_price
-                if verbose:
-                    print(f"BUY at {timestamp}: Price={current_price:.2f}, SMA={sma:.2f}, Lower Band={lower_band:.2f}")
-            # Short signal: price crosses above upper band
-            elif current_price > upper_band:
-                state.position = -1
-                state.entry_price = current_price
-                if verbose:
-                    print(f"SHORT at {timestamp}: Price={current_price:.2f}, SMA={sma:.2f}, Upper Band={upper_band:.2f}")
-
-        # Exit signals
-        elif state.position == 1:
-            # Exit long when price returns to mean
-            if current_price >= sma:
-                pnl = current_price - state.entry_price
-                state.total_pnl += pnl
-                state.total_trades += 1
-
-                if pnl > 0:
-                    state.winning_trades += 1
-                    state.total_wins += pnl
-                else:
-                    state.losing_trades += 1
-                    state.total_losses += abs(pnl)
 
-                if verbose:
-                    print(f"SELL at {timestamp}: Price={current_price:.2f}, Entry={state.entry_price:.2f}, PnL={pnl:.2f}")
-                state.position = 0
-
-        elif state.position == -1:
-            # Exit short when price returns to mean
-            if current_price <= sma:
-                pnl = state.entry_price - current_price
-                state.total_pnl += pnl
-                state.total_trades += 1
-
-                if pnl > 0:
-                    state.winning_trades += 1
-                    state.total_wins += pnl
-                else:
-                    state.losing_trades += 1
-                    state.total_losses += abs(pnl)
+    cdef vector[TradeEvent]* trade_log = NULL
+    if verbose:
+        trade_log = &events
+
+    with nogil:
+        run_mean_reversion(bars.cols, sma_period, std_multiplier, stats, trade_log)
+    state.from_stats(stats)
+
+    if not verbose:
+        return
+
+    for event in events:
+        timestamp = format_timestamp(bars.cols.timestamp[event.index])
+        if event.action == ACTION_BUY:
+            print(f"BUY at {timestamp}: Price={event.price:.2f}, SMA={event.sma:.2f}, Lower Band={event.band:.2f}")
+        elif event.action == ACTION_SHORT:
+            print(f"SHORT at {timestamp}: Price={event.price:.2f}, SMA={event.sma:.2f}, Upper Band={event.band:.2f}")
+        elif event.action == ACTION_SELL:
+            print(f"SELL at {timestamp}: Price={event.price:.2f}, Entry={event.entry_price:.2f}, PnL={event.pnl:.2f}")
+        else:
+            print(f"COVER at {timestamp}: Price={event.price:.2f}, Entry={event.entry_price:.2f}, PnL={event.pnl:.2f}")
+
+
+METRICS_DTYPE = np.dtype([
+    ('sma_period', np.int32),
+    ('std_multiplier', np.float64),
+    ('total_trades', np.int64),
+    ('winning_trades', np.int64),
+    ('losing_trades', np.int64),
+    ('total_pnl', np.float64),
+    ('max_drawdown', np.float64),
+    ('max_drawdown_mtm', np.float64),
+    ('win_rate', np.float64),
+    ('avg_win', np.float64),
+    ('avg_loss', np.float64),
+    ('profit_factor', np.float64),
+    ('expectancy', np.float64),
+])
+
+
+cdef dict metrics_to_dict(const BacktestMetrics& m):
+    return {
+        'sma_period': m.sma_period,
+        'std_multiplier': m.std_multiplier,
+        'total_trades': m.total_trades,
+        'winning_trades': m.winning_trades,
+        'losing_trades': m.losing_trades,
+        'total_pnl': m.total_pnl,
+        'max_drawdown': m.max_drawdown,
+        'max_drawdown_mtm': m.max_drawdown_mtm,
+        'win_rate': m.win_rate,
+        'avg_win': m.avg_win,
+        'avg_loss': m.avg_loss,
+        'profit_factor': m.profit_factor,
+        'expectancy': m.expectancy
+    }
+
+
+cdef object metrics_to_array(vector[BacktestMetrics]& rows):
+    """Copy metric rows into a NumPy structured array with METRICS_DTYPE"""
+    cdef Py_ssize_t k, n = rows.size()
+    result = np.zeros(n, dtype=METRICS_DTYPE)
+    cdef cnp.int32_t[:] sma_period = result['sma_period']
+    cdef double[:] std_multiplier = result['std_multiplier']
+    cdef cnp.int64_t[:] total_trades = result['total_trades']
+    cdef cnp.int64_t[:] winning_trades = result['winning_trades']
+    cdef cnp.int64_t[:] losing_trades = result['losing_trades']
+    cdef double[:] total_pnl = result['total_pnl']
+    cdef double[:] max_drawdown = result['max_drawdown']
+    cdef double[:] max_drawdown_mtm = result['max_drawdown_mtm']
+    cdef double[:] win_rate = result['win_rate']
+    cdef double[:] avg_win = result['avg_win']
+    cdef double[:] avg_loss = result['avg_loss']
+    cdef double[:] profit_factor = result['profit_factor']
+    cdef double[:] expectancy = result['expectancy']
+
+    for k in range(n):
+        sma_period[k] = rows[k].sma_period
+        std_multiplier[k] = rows[k].std_multiplier
+        total_trades[k] = rows[k].total_trades
+        winning_trades[k] = rows[k].winning_trades
+        losing_trades[k] = rows[k].losing_trades
+        total_pnl[k] = rows[k].total_pnl
+        max_drawdown[k] = rows[k].max_drawdown
+        max_drawdown_mtm[k] = rows[k].max_drawdown_mtm
+        win_rate[k] = rows[k].win_rate
+        avg_win[k] = rows[k].avg_win
+        avg_loss[k] = rows[k].avg_loss
+        profit_factor[k] = rows[k].profit_factor
+        expectancy[k] = rows[k].expectancy
+
+    return result
+
+
+def sweep(BarStore store, sma_periods, std_multipliers, unsigned int n_threads=0):
+    """
+    Run the mean reversion backtest for every (sma_period, std_multiplier) pair
+
+    The grid is evaluated natively across a thread pool with the GIL released.
+
+    Args:
+        store: Loaded BarStore (see load_csv_data)
+        sma_periods: Iterable of SMA periods
+        std_multipliers: Iterable of standard deviation multipliers
+        n_threads: Worker threads (0 = all cores)
+
+    Returns:
+        NumPy structured array (METRICS_DTYPE), one row per pair, period-major
+    """
+    cdef vector[int] periods = [int(p) for p in sma_periods]
+    cdef vector[double] multipliers = [float(m) for m in std_multipliers]
+    cdef vector[BacktestMetrics] rows
+    rows.resize(periods.size() * multipliers.size())
+
+    with nogil:
+        sweep_grid(store.cols, periods.data(), periods.size(), multipliers.data(), multipliers.size(),
+                   rows.data(), n_threads)
+
+    return metrics_to_array(rows)
+
+
+cdef vector[WalkForwardFold] _fold_ranges(BarStore store, folds) except *:
+    """Check and convert (train_begin, train_end, test_begin, test_end) tuples"""
+    cdef vector[WalkForwardFold] c_folds
+    cdef WalkForwardFold fold
+    for train_begin, train_end, test_begin, test_end in folds:
+        if not 0 <= train_begin <= train_end <= len(store) or not 0 <= test_begin <= test_end <= len(store):
+            raise ValueError(f"fold out of range: {(train_begin, train_end, test_begin, test_end)}")
+        fold.train_begin = train_begin
+        fold.train_end = train_end
+        fold.test_begin = test_begin
+        fold.test_end = test_end
+        c_folds.push_back(fold)
+    return c_folds
+
+
+def walk_forward(BarStore store, folds, sma_periods, std_multipliers, unsigned int n_threads=0):
+    """
+    Grid-search each fold's train range and run its best pair on the test range
+
+    All folds index into the one store; (fold, period) searches run natively
+    across a thread pool with the GIL released (see walk_forward.h).
+
+    Args:
+        store: Loaded BarStore
+        folds: Sequence of (train_begin, train_end, test_begin, test_end) index ranges
+        sma_periods: Iterable of SMA periods
+        std_multipliers: Iterable of standard deviation multipliers
+        n_threads: Worker threads (0 = all cores)
+
+    Returns:
+        List of dicts, one per fold: 'fold' (the index ranges), 'selected',
+        'train' and 'test' metric dicts, and the lowest / highest realized
+        test P&L as 'test_min_equity' / 'test_peak_equity'
+    """
+    cdef vector[WalkForwardFold] c_folds = _fold_ranges(store, folds)
+    cdef vector[int] periods = [int(p) for p in sma_periods]
+    cdef vector[double] multipliers = [float(m) for m in std_multipliers]
+    cdef vector[WalkForwardResult] results
+    results.resize(c_folds.size())
+    if c_folds.empty() or periods.empty() or multipliers.empty():
+        return []
+
+    with nogil:
+        walk_forward_folds(store.cols, c_folds.data(), c_folds.size(), periods.data(), periods.size(),
+                           multipliers.data(), multipliers.size(), results.data(), NULL, n_threads)
+
+    cdef size_t k
+    return [{
+        'fold': (c_folds[k].train_begin, c_folds[k].train_end, c_folds[k].test_begin, c_folds[k].test_end),
+        'selected': results[k].selected != 0,
+        'train': metrics_to_dict(results[k].train),
+        'test': metrics_to_dict(results[k].test),
+        'test_min_equity': results[k].test_min_equity,
+        'test_peak_equity': results[k].test_peak_equity,
+    } for k in range(c_folds.size())]
+
+
+# Compiled strategies (strategy.h) by name, with their parameters in row
+# order; the names are the strategies/ constructor arguments
+STRATEGIES = {
+    'moving_average': (STRATEGY_MOVING_AVERAGE, ('short_window', 'medium_window', 'long_window')),
+    'rsi': (STRATEGY_RSI, ('window', 'oversold_threshold', 'overbought_threshold')),
+    'macd': (STRATEGY_MACD, ('fast', 'slow', 'signal')),
+    'bollinger_bands': (STRATEGY_BOLLINGER_BANDS, ('window', 'num_std')),
+    'mean_reversion_extreme': (STRATEGY_MEAN_REVERSION_EXTREME, ('window', 'num_std')),
+    'candlestick': (STRATEGY_CANDLESTICK, ()),
+}
+
+
+cdef tuple _strategy_rows(str strategy, params):
+    """(kind, parameter names, row-major float64 matrix) for a list of dicts or sequences"""
+    if strategy not in STRATEGIES:
+        raise ValueError(f"unknown strategy: {strategy} (expected one of {', '.join(STRATEGIES)})")
+    kind, names = STRATEGIES[strategy]
+    assert strategy_param_count(kind) == len(names)
+    rows = [[row[name] for name in names] if isinstance(row, dict) else list(row) for row in params]
+    matrix = np.ascontiguousarray(rows, dtype=np.float64).reshape(len(rows), len(names))
+    return kind, names, matrix
+
+
+def sweep_strategy(BarStore store, str strategy, params, bint long_short=False, unsigned int n_threads=0):
+    """
+    Backtest a compiled strategy for every parameter row
+
+    Rows that share an indicator series (an RSI window, a band window) are
+    evaluated against one precomputed series, natively across a thread pool
+    with the GIL released. P&L is in price points for one unit, as in sweep().
+
+    Args:
+        store: Loaded BarStore
+        strategy: A STRATEGIES name
+        params: Parameter rows, as dicts keyed by the strategy's parameter
+            names or as sequences in that order
+        long_short: Reverse into shorts on sell signals instead of going flat
+        n_threads: Worker threads (0 = all cores)
+
+    Returns:
+        NumPy structured array, one row per parameter row: the parameters
+        followed by the METRICS_DTYPE metric fields
+    """
+    kind, names, matrix = _strategy_rows(strategy, params)
+    cdef const double[:, ::1] rows_view = matrix
+    cdef size_t n_rows = matrix.shape[0]
+    cdef vector[BacktestMetrics] rows
+    rows.resize(n_rows)
+    cdef const double* data = &rows_view[0, 0] if n_rows and len(names) else NULL
+    cdef int c_kind = kind
+    if n_rows:
+        with nogil:
+            sweep_strategy_rows(c_kind, store.cols, data, n_rows, long_short, rows.data(), n_threads)
+
+    metrics = metrics_to_array(rows)
+    fields = METRICS_DTYPE.names[2:]
+    result = np.zeros(n_rows, dtype=[(name, np.float64) for name in names] + [(f, METRICS_DTYPE[f]) for f in fields])
+    for k, name in enumerate(names):
+        result[name] = matrix[:, k]
+    for f in fields:
+        result[f] = metrics[f]
+    return result
+
+
+def walk_forward_strategy(BarStore store, str strategy, folds, params, bint long_short=False,
+                          unsigned int n_threads=0):
+    """
+    walk_forward() for a compiled strategy over a list of parameter rows
+
+    Returns:
+        List of dicts as from walk_forward(), with the selected row's
+        parameters as 'params' (None when no train row traded)
+    """
+    kind, names, matrix = _strategy_rows(strategy, params)
+    cdef vector[WalkForwardFold] c_folds = _fold_ranges(store, folds)
+    cdef const double[:, ::1] rows_view = matrix
+    cdef size_t n_rows = matrix.shape[0]
+    cdef vector[WalkForwardResult] results
+    results.resize(c_folds.size())
+    if c_folds.empty() or n_rows == 0:
+        return []
+    cdef const double* data = &rows_view[0, 0] if len(names) else NULL
+    cdef int c_kind = kind
+
+    with nogil:
+        walk_forward_strategy_folds(c_kind, store.cols, c_folds.data(), c_folds.size(), data, n_rows, long_short,
+                                    results.data(), NULL, n_threads)
+
+    cdef size_t k
+    return [{
+        'fold': (c_folds[k].train_begin, c_folds[k].train_end, c_folds[k].test_begin, c_folds[k].test_end),
+        'selected': results[k].selected != 0,
+        'params': dict(zip(names, matrix[results[k].row].tolist())) if results[k].selected else None,
+        'train': metrics_to_dict(results[k].train),
+        'test': metrics_to_dict(results[k].test),
+        'test_min_equity': results[k].test_min_equity,
+        'test_peak_equity': results[k].test_peak_equity,
+    } for k in range(c_folds.size())]
+
+
+# Resampling schemes of bootstrap.h by name
+RESAMPLE_MODES = {
+    'bars': RESAMPLE_BARS,
+    'shuffle': RESAMPLE_TRADES_SHUFFLE,
+    'bootstrap': RESAMPLE_TRADES_BOOTSTRAP,
+}
 
-                if verbose:
-                    print(f"COVER at {timestamp}: Price={current_price:.2f}, Entry={state.entry_price:.2f}, PnL={pnl:.2f}")
-                state.position = 0
 
-        # Track drawdown
-        if state.total_pnl > state.peak_equity:
-            state.peak_equity = state.total_pnl
+cdef int _resample_mode(str mode) except -1:
+    if mode not in RESAMPLE_MODES:
+        raise ValueError(f"unknown resample mode: {mode} (expected one of {', '.join(RESAMPLE_MODES)})")
+    return RESAMPLE_MODES[mode]
 
-        current_drawdown = state.peak_equity - state.total_pnl
-        if current_drawdown > state.max_drawdown:
-            state.max_drawdown = current_drawdown
+
+def resample(BarStore store, configs, str mode='bars', size_t n_samples=1000, size_t block_size=0,
+             uint64_t seed=0, unsigned int n_threads=0):
+    """
+    Monte Carlo re-runs of mean reversion configurations (see bootstrap.h)
+
+    Args:
+        store: Loaded BarStore the configurations were optimized on
+        configs: (sma_period, std_multiplier) pairs, or dicts with those keys
+            such as the rows returned by find_best.optimize_parameters
+        mode: 'bars' re-runs each configuration on block-bootstrapped bar
+            returns; 'shuffle' permutes and 'bootstrap' resamples its trades
+        n_samples: Samples per configuration
+        block_size: Bars per bootstrap block (0 = cube root of the bar count)
+        seed: Seed of the per-sample random streams
+        n_threads: Worker threads (0 = all cores)
+
+    Returns:
+        METRICS_DTYPE array of shape (len(configs), n_samples)
+    """
+    cdef int c_mode = _resample_mode(mode)
+    cdef vector[int] periods
+    cdef vector[double] multipliers
+    for config in configs:
+        period, multiplier = ((config['sma_period'], config['std_multiplier'])
+                              if isinstance(config, dict) else config)
+        periods.push_back(int(period))
+        multipliers.push_back(float(multiplier))
+    cdef vector[BacktestMetrics] rows
+    rows.resize(periods.size() * n_samples)
+
+    with nogil:
+        resample_mean_reversion(store.cols, periods.data(), multipliers.data(), periods.size(), c_mode,
+                                n_samples, block_size, seed, rows.data(), n_threads)
+
+    return metrics_to_array(rows).reshape(periods.size(), n_samples)
+
+
+def resample_strategy(BarStore store, str strategy, params, str mode='bars', bint long_short=False,
+                      size_t n_samples=1000, size_t block_size=0, uint64_t seed=0, unsigned int n_threads=0):
+    """
+    resample() for a compiled strategy over a list of parameter rows
+
+    Returns:
+        METRICS_DTYPE array of shape (len(params), n_samples)
+    """
+    cdef int c_mode = _resample_mode(mode)
+    kind, names, matrix = _strategy_rows(strategy, params)
+    cdef const double[:, ::1] rows_view = matrix
+    cdef size_t n_rows = matrix.shape[0]
+    cdef vector[BacktestMetrics] rows
+    rows.resize(n_rows * n_samples)
+    cdef const double* data = &rows_view[0, 0] if n_rows and len(names) else NULL
+    cdef int c_kind = kind
+    if n_rows:
+        with nogil:
+            resample_strategy_rows(c_kind, store.cols, data, n_rows, long_short, c_mode, n_samples, block_size,
+                                   seed, rows.data(), n_threads)
+
+    return metrics_to_array(rows).reshape(n_rows, n_samples)
 
 
 cpdef void print_results(TradingState state):
@@ -229,6 +940,7 @@ cpdef void print_results(TradingState state):
     print("Performance Metrics:")
     print(f"  Total P&L:         ${state.total_pnl:.2f}")
     print(f"  Max Drawdown:      ${state.max_drawdown:.2f}")
+    print(f"  Max Drawdown (MTM): ${state.mtm_max_drawdown:.2f}")
 
     if state.total_trades > 0:
         win_rate = (state.winning_trades / state.total_trades) * 100
@@ -265,68 +977,35 @@ cpdef void print_results(TradingState state):
     print("========================================")
 
 
-def run_backtest_silent(str filename, int sma_period, double std_multiplier):
+def run_backtest_silent(object data, int sma_period, double std_multiplier):
     """
     Run backtest silently and return metrics as a dictionary
 
     Args:
-        filename: Path to CSV file with OHLCV data
+        data: Path to CSV file with OHLCV data, or an already loaded BarStore
         sma_period: Period for Simple Moving Average
         std_multiplier: Standard deviation multiplier for bands
 
     Returns:
         Dictionary with backtest metrics, or None if error
     """
-    # Load data silently
-    bars = load_csv_data(filename, verbose=False)
+    # Load data silently (callers running many backtests pass a BarStore)
+    cdef BarStore bars
+    if isinstance(data, BarStore):
+        bars = data
+    else:
+        bars = load_csv_data(data, verbose=False)
 
     if not bars:
         return None
 
-    # Initialize trading state
-    state = TradingState()
-
     # Run backtest silently
-    execute_strategy(bars, state, sma_period, std_multiplier, verbose=False)
-
-    # Calculate metrics
-    cdef dict metrics = {
-        'sma_period': sma_period,
-        'std_multiplier': std_multiplier,
-        'total_trades': state.total_trades,
-        'winning_trades': state.winning_trades,
-        'losing_trades': state.losing_trades,
-        'total_pnl': state.total_pnl,
-        'max_drawdown': state.max_drawdown,
-        'win_rate': 0.0,
-        'avg_win': 0.0,
-        'avg_loss': 0.0,
-        'profit_factor': 0.0,
-        'expectancy': 0.0
-    }
-
-    # Calculate derived metrics
-    if state.total_trades > 0:
-        metrics['win_rate'] = (state.winning_trades / state.total_trades) * 100.0
-
-        if state.winning_trades > 0:
-            metrics['avg_win'] = state.total_wins / state.winning_trades
-
-        if state.losing_trades > 0:
-            metrics['avg_loss'] = state.total_losses / state.losing_trades
-
-        if state.winning_trades > 0 and state.losing_trades > 0:
-            metrics['profit_factor'] = state.total_wins / state.total_losses
-        elif state.winning_trades > 0 and state.losing_trades == 0:
-            metrics['profit_factor'] = 999.99  # Very high value to indicate perfect strategy
-
-        # Calculate Expectancy: (WinRate × AverageWin) - (LossRate × AverageLoss)
-        avg_win = metrics['avg_win']
-        avg_loss = metrics['avg_loss']
-        loss_rate = (state.losing_trades / state.total_trades) * 100.0
-        metrics['expectancy'] = (metrics['win_rate'] / 100.0 * avg_win) - (loss_rate / 100.0 * avg_loss)
+    cdef TradingStats stats
+    with nogil:
+        run_mean_reversion(bars.cols, sma_period, std_multiplier, stats, NULL)
 
-    return metrics
+    # Same derived metrics as the sweep (compute_metrics in mean_reversion.h)
+    return metrics_to_dict(compute_metrics(stats, sma_period, std_multiplier))
 
 
 def run_backtest(str filename, int sma_period=20, double std_multiplier=2.0):
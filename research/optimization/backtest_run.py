@@ -21,7 +21,8 @@ EXAMPLES:
   python backtest_run.py polygon_data.csv 30 2.5
 
 CSV FORMAT:
-  The CSV file must have a header row and the following columns:
+  The CSV file must have a header row naming the columns below; they may
+  appear in any order (column names are case-insensitive, volume is optional):
   timestamp,open,high,low,close,volume
 
   Example:
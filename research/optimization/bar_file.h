@@ -0,0 +1,154 @@
+// Versioned binary columnar bar file (".bars"), used as a cache next to CSVs.
+//
+// Layout (little-endian), version 1:
+//   0    char[8]   magic "BATBARS\0"
+//   8    uint32    version
+//   12   uint32    header size (128)
+//   16   uint64    number of rows
+//   24   uint64    size in bytes of the source CSV (0 if none)
+//   32   int64     mtime in ns of the source CSV (0 if none)
+//   40   uint64[6] byte offsets of the timestamp, open, high, low, close and
+//                  volume columns
+//   88   reserved (zero) up to the header size
+// Each column is a contiguous int64 (timestamp, epoch ns) or float64 array
+// starting on a 64-byte boundary, so a mapping of the file can be used in
+// place as BarColumns. data_providers/bar_file.py reads and writes the same format.
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <unistd.h>
+
+#include "bar_store.h"
+#include "mapped_file.h"
+
+namespace bat {
+
+constexpr char BAR_FILE_MAGIC[8] = {'B', 'A', 'T', 'B', 'A', 'R', 'S', '\0'};
+constexpr uint32_t BAR_FILE_VERSION = 1;
+constexpr uint32_t BAR_FILE_HEADER_SIZE = 128;
+constexpr size_t BAR_FILE_ALIGNMENT = 64;
+constexpr int BAR_FILE_COLUMNS = 6;
+
+struct BarFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t rows;
+    uint64_t source_size;
+    int64_t source_mtime_ns;
+    uint64_t column_offset[BAR_FILE_COLUMNS];
+    unsigned char reserved[BAR_FILE_HEADER_SIZE - 88];
+};
+static_assert(sizeof(BarFileHeader) == BAR_FILE_HEADER_SIZE, "bar file header must be 128 bytes");
+
+inline size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Write columns to path atomically (temp file + rename)
+inline int write_bar_file(const std::string& path, const BarColumns& bars, uint64_t source_size,
+                          int64_t source_mtime_ns, std::string& message) {
+    BarFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, BAR_FILE_MAGIC, sizeof(header.magic));
+    header.version = BAR_FILE_VERSION;
+    header.header_size = BAR_FILE_HEADER_SIZE;
+    header.rows = bars.size;
+    header.source_size = source_size;
+    header.source_mtime_ns = source_mtime_ns;
+
+    const void* columns[BAR_FILE_COLUMNS] = {bars.timestamp, bars.open, bars.high, bars.low, bars.close, bars.volume};
+    const size_t column_bytes = bars.size * 8;
+    size_t offset = align_up(BAR_FILE_HEADER_SIZE, BAR_FILE_ALIGNMENT);
+    for (int c = 0; c < BAR_FILE_COLUMNS; ++c) {
+        header.column_offset[c] = offset;
+        offset = align_up(offset + column_bytes, BAR_FILE_ALIGNMENT);
+    }
+
+    const std::string tmp_path = path + ".tmp." + std::to_string(static_cast<long long>(getpid()));
+    FILE* f = std::fopen(tmp_path.c_str(), "wb");
+    if (!f) {
+        message = std::strerror(errno);
+        return LOAD_IO_ERROR;
+    }
+
+    static const char zeros[BAR_FILE_ALIGNMENT] = {0};
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    size_t written = sizeof(header);
+    for (int c = 0; c < BAR_FILE_COLUMNS && ok; ++c) {
+        const size_t pad = header.column_offset[c] - written;
+        ok = std::fwrite(zeros, 1, pad, f) == pad;
+        written += pad;
+        if (ok && column_bytes > 0) ok = std::fwrite(columns[c], 1, column_bytes, f) == column_bytes;
+        written += column_bytes;
+    }
+    if (std::fclose(f) != 0) ok = false;
+
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        message = std::strerror(errno);
+        std::remove(tmp_path.c_str());
+        return LOAD_IO_ERROR;
+    }
+    return LOAD_OK;
+}
+
+// Memory-mapped, read-only bar file; columns point straight into the mapping
+class MappedBarFile {
+public:
+    int open(const std::string& path, std::string& message) {
+        const int status = file_.open(path, message, false);
+        if (status != LOAD_OK) return status;
+
+        if (file_.size() < sizeof(BarFileHeader)) return invalid("file is too small", message);
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        if (std::memcmp(header_.magic, BAR_FILE_MAGIC, sizeof(header_.magic)) != 0) {
+            return invalid("not a bar file", message);
+        }
+        if (header_.version != BAR_FILE_VERSION || header_.header_size != BAR_FILE_HEADER_SIZE) {
+            return invalid("unsupported bar file version", message);
+        }
+
+        const void* columns[BAR_FILE_COLUMNS];
+        for (int c = 0; c < BAR_FILE_COLUMNS; ++c) {
+            const uint64_t offset = header_.column_offset[c];
+            if (offset % 8 != 0 || offset < BAR_FILE_HEADER_SIZE || offset > file_.size() ||
+                header_.rows > (file_.size() - offset) / 8) {
+                return invalid("column extends past end of file", message);
+            }
+            columns[c] = file_.data() + offset;
+        }
+
+        cols_.timestamp = static_cast<const int64_t*>(columns[0]);
+        cols_.open = static_cast<const double*>(columns[1]);
+        cols_.high = static_cast<const double*>(columns[2]);
+        cols_.low = static_cast<const double*>(columns[3]);
+        cols_.close = static_cast<const double*>(columns[4]);
+        cols_.volume = static_cast<const double*>(columns[5]);
+        cols_.size = static_cast<size_t>(header_.rows);
+        return LOAD_OK;
+    }
+
+    const BarFileHeader& header() const { return header_; }
+    BarColumns columns() const { return cols_; }
+
+private:
+    int invalid(const char* reason, std::string& message) {
+        message = reason;
+        file_.close();
+        cols_ = BarColumns();
+        return LOAD_BAD_FORMAT;
+    }
+
+    MappedFile file_;
+    BarFileHeader header_{};
+    BarColumns cols_;
+};
+
+}  // namespace bat
@@ -0,0 +1,84 @@
+// Columnar (struct-of-arrays) bar storage for the Cython backtest.
+//
+// Each field lives in its own contiguous buffer so the strategy loops walk
+// plain double arrays instead of chasing pointers through Python objects.
+// Timestamps are int64 nanoseconds since the Unix epoch (UTC), which matches
+// NumPy's datetime64[ns] so the column can be viewed from Python without a copy.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bat {
+
+// Non-owning view over a range of bar columns
+struct BarColumns {
+    const int64_t* timestamp = nullptr;
+    const double* open = nullptr;
+    const double* high = nullptr;
+    const double* low = nullptr;
+    const double* close = nullptr;
+    const double* volume = nullptr;
+    size_t size = 0;
+
+    BarColumns slice(size_t begin, size_t end) const {
+        BarColumns out;
+        if (end > size) end = size;
+        if (begin > end) begin = end;
+        out.timestamp = timestamp + begin;
+        out.open = open + begin;
+        out.high = high + begin;
+        out.low = low + begin;
+        out.close = close + begin;
+        out.volume = volume + begin;
+        out.size = end - begin;
+        return out;
+    }
+};
+
+// Owning columnar container, filled once by a loader and then read-only
+class BarStore {
+public:
+    std::vector<int64_t> timestamp;
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<double> volume;
+
+    void reserve(size_t n) {
+        timestamp.reserve(n);
+        open.reserve(n);
+        high.reserve(n);
+        low.reserve(n);
+        close.reserve(n);
+        volume.reserve(n);
+    }
+
+    void push_back(int64_t ts, double o, double h, double l, double c, double v) {
+        timestamp.push_back(ts);
+        open.push_back(o);
+        high.push_back(h);
+        low.push_back(l);
+        close.push_back(c);
+        volume.push_back(v);
+    }
+
+    size_t size() const { return close.size(); }
+
+    BarColumns columns() const {
+        BarColumns out;
+        out.timestamp = timestamp.data();
+        out.open = open.data();
+        out.high = high.data();
+        out.low = low.data();
+        out.close = close.data();
+        out.volume = volume.data();
+        out.size = close.size();
+        return out;
+    }
+};
+
+}  // namespace bat
@@ -0,0 +1,348 @@
+#!/usr/bin/env python3
+"""
+Throughput benchmarks for the backtest, indicator, loading and sweep paths
+
+Runs on the bundled research/datasets files and writes one JSON document,
+so runs from two commits can be compared (--compare) and regressions in
+the native kernels, their memory layout or their allocations show up as a
+drop in bars per second.
+
+Groups (--only selects some):
+    load        CSV parse (native loader, pandas), binary .bars open (native,
+                NumPy memmap) and the parallel multi-file loader
+    execute     backtest.execute_strategy, the Cython mean reversion loop
+    indicators  every indicators/technical_indicators function, on the
+                native kernels and with them disabled (pandas)
+    engine      BacktestEngine.backtest for each strategies/ class on the
+                native execution core, plus one run of the Python bar loop
+    sweep       backtest.sweep over the find_best.py grid on 1, 2, 4 .. N
+                threads (bars/s counts bar evaluations: bars x configs)
+
+Every measurement is the best of --repeat timed runs after one untimed run
+(the Python bar loop gets a single timed run).
+
+Requirements:
+    - Cython backtest module for load/execute/sweep:
+      python setup.py build_ext --inplace
+    - native/ extensions for the native indicator and engine variants
+      (groups whose module is missing are recorded as skipped)
+
+Usage:
+    python benchmark.py [csv_file] [--output FILE] [--repeat N] [--max-threads N]
+                        [--only GROUP[,GROUP]] [--compare BASELINE.json] [--threshold F]
+
+Example:
+    python benchmark.py --output before.json
+    python benchmark.py --output after.json --compare before.json
+"""
+
+import argparse
+import glob
+import json
+import os
+import platform
+import statistics
+import subprocess
+import sys
+import time
+from datetime import datetime, timezone
+
+# strategies/, indicators/ and engines/ live at the repository root
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+sys.path.append(REPO_ROOT)
+
+DATASET_DIR = os.path.join(REPO_ROOT, 'research', 'datasets')
+DEFAULT_DATASET = os.path.join(DATASET_DIR, 'X_BTCUSD_minute_2025-01-01_to_2025-09-01.csv')
+GROUPS = ('load', 'execute', 'indicators', 'engine', 'sweep')
+
+
+def measure(fn, repeat: int, setup=None, warmup: bool = True):
+    """
+    Time fn(setup()) repeat times, after one untimed run when warmup is set
+
+    Returns:
+        (best, median) seconds
+    """
+    if warmup:
+        fn(setup() if setup else None)
+    times = []
+    for _ in range(repeat):
+        arg = setup() if setup else None
+        start = time.perf_counter()
+        fn(arg)
+        times.append(time.perf_counter() - start)
+    return min(times), statistics.median(times)
+
+
+class Benchmark:
+    """Collects results as flat records keyed by (group, name, variant, threads)"""
+
+    def __init__(self, repeat: int):
+        self.repeat = repeat
+        self.results = []
+
+    def run(self, group: str, name: str, bars: int, fn, variant: str = '', threads: int = None,
+            setup=None, repeat: int = None, warmup: bool = True, **extra):
+        record = {'group': group, 'name': name, 'variant': variant, 'threads': threads, 'bars': bars}
+        best, median = measure(fn, repeat or self.repeat, setup, warmup)
+        record.update(seconds=best, median_seconds=median, repeat=repeat or self.repeat,
+                      bars_per_second=bars / best if best > 0 else None, **extra)
+        label = f"{variant} x{threads}" if threads else variant
+        print(f"  {group:<10} {name:<32} {label:<8} {best * 1e3:10.2f} ms  {record['bars_per_second']:14,.0f} bars/s")
+        self.results.append(record)
+        return record
+
+    def skip(self, group: str, name: str, reason: str, variant: str = ''):
+        """Record a benchmark this build cannot run (missing extension or dependency)"""
+        self.results.append({'group': group, 'name': name, 'variant': variant, 'threads': None,
+                             'skipped': reason})
+        print(f"  {group:<10} {name:<32} {variant:<8} skipped: {reason}")
+
+
+def import_backtest():
+    try:
+        import backtest
+        return backtest
+    except ImportError:
+        return None
+
+
+def load_frame(csv_file: str):
+    from data_providers.bar_file import load_dataset_frame
+    return load_dataset_frame(csv_file).reset_index(drop=True)
+
+
+def bench_load(bench: Benchmark, csv_file: str, n_bars: int):
+    import numpy as np
+    import pandas as pd
+    from data_providers.bar_file import cache_path, read_bar_file
+
+    backtest = import_backtest()
+    if backtest is None:
+        bench.skip('load', 'load_csv_data', 'backtest extension not built', 'native')
+        bench.skip('load', 'open_bar_file', 'backtest extension not built', 'native')
+        bench.skip('load', 'load_csv_files', 'backtest extension not built', 'native')
+    else:
+        bench.run('load', 'load_csv_data', n_bars, lambda _: backtest.load_csv_data(csv_file, verbose=False),
+                  'native')
+        backtest.load_bars(csv_file, verbose=False)  # make sure the .bars cache is fresh
+        cache = cache_path(csv_file)
+        # Touch every column, so the mapping is paged in as it would be for a run
+        bench.run('load', 'open_bar_file', n_bars, lambda _: float(np.asarray(backtest.open_bar_file(cache).close).sum()),
+                  'native')
+        files = sorted(glob.glob(os.path.join(DATASET_DIR, '*.csv')))
+        total = sum(len(store) for store in backtest.load_csv_files(files, verbose=False))
+        bench.run('load', 'load_csv_files', total, lambda _: backtest.load_csv_files(files, verbose=False),
+                  'native', files=len(files))
+
+    def read_csv(_):
+        df = pd.read_csv(csv_file)
+        df['timestamp'] = pd.to_datetime(df['timestamp'])
+
+    bench.run('load', 'read_csv', n_bars, read_csv, 'pandas')
+    load_frame(csv_file)  # writes the cache if it is missing or stale
+    bench.run('load', 'read_bar_file', n_bars,
+              lambda _: float(read_bar_file(cache_path(csv_file))[1]['close'].sum()), 'numpy')
+
+
+def bench_execute(bench: Benchmark, csv_file: str):
+    backtest = import_backtest()
+    if backtest is None:
+        bench.skip('execute', 'execute_strategy', 'backtest extension not built', 'native')
+        return
+    store = backtest.load_bars(csv_file, verbose=False)
+    for sma_period, std_multiplier in ((20, 2.0), (100, 1.0)):
+        bench.run('execute', f'execute_strategy/sma{sma_period}_std{std_multiplier:g}', len(store),
+                  lambda state: backtest.execute_strategy(store, state, sma_period, std_multiplier, False),
+                  'native', setup=backtest.TradingState, sma_period=sma_period, std_multiplier=std_multiplier)
+
+
+def bench_indicators(bench: Benchmark, df):
+    from indicators import technical_indicators as ti
+
+    close = df['Close']
+    cases = (
+        ('sma', lambda: ti.sma(close, 20)),
+        ('ema', lambda: ti.ema(close, 20)),
+        ('bollinger_bands', lambda: ti.bollinger_bands(close, 20, 2)),
+        ('rsi', lambda: ti.rsi(close, 14)),
+        ('macd', lambda: ti.macd(close, 12, 26, 9)),
+        ('detect_candlestick_patterns',
+         lambda: ti.detect_candlestick_patterns(df['Open'], df['High'], df['Low'], df['Close'])),
+    )
+    native = ti._native
+    for variant, kernels in (('native', native), ('pandas', None)):
+        if variant == 'native' and native is None:
+            for name, _ in cases:
+                bench.skip('indicators', name, 'native.indicators not built', variant)
+            continue
+        ti._native = kernels
+        try:
+            for name, fn in cases:
+                bench.run('indicators', name, len(df), lambda _, fn=fn: fn(), variant)
+        finally:
+            ti._native = native
+
+
+def bench_engine(bench: Benchmark, df, symbol: str):
+    try:
+        from engines.backtest_engine import BacktestEngine, native_execution
+        from strategies.bollinger_bands_strategy import BollingerBandsStrategy
+        from strategies.candlestick_strategy import CandlestickPatternsStrategy
+        from strategies.macd_strategy import MACDStrategy
+        from strategies.mean_reversion import MeanReversionExtremeStrategy
+        from strategies.moving_average import MovingAverageStrategy
+        from strategies.rsi_strategy import RSIStrategy
+    except ImportError as e:
+        bench.skip('engine', 'BacktestEngine.backtest', f'import failed: {e}')
+        return
+
+    strategies = (MovingAverageStrategy, MACDStrategy, RSIStrategy, BollingerBandsStrategy,
+                  MeanReversionExtremeStrategy, CandlestickPatternsStrategy)
+    for mode in ('long_only', 'long_short'):
+        for cls in strategies:
+            name = f"{cls.__name__}/{mode}"
+            if native_execution is None:
+                bench.skip('engine', name, 'native.execution not built', 'native')
+                continue
+            engine = BacktestEngine(trading_mode=mode, symbol=symbol, use_native=True)
+            bench.run('engine', name, len(df), lambda _, cls=cls: engine.backtest(df, cls()), 'native')
+
+    # The Python bar loop is two orders of magnitude slower: one strategy, one timed run
+    engine = BacktestEngine(symbol=symbol, use_native=False)
+    bench.run('engine', 'MovingAverageStrategy/long_only', len(df),
+              lambda _: engine.backtest(df, MovingAverageStrategy()), 'python', repeat=1, warmup=False)
+
+
+def thread_counts(max_threads: int):
+    counts, n = [], 1
+    while n < max_threads:
+        counts.append(n)
+        n *= 2
+    return counts + [max_threads]
+
+
+def bench_sweep(bench: Benchmark, csv_file: str, max_threads: int):
+    backtest = import_backtest()
+    if backtest is None:
+        bench.skip('sweep', 'sweep', 'backtest extension not built', 'native')
+        return
+    from find_best import parameter_grid
+
+    store = backtest.load_bars(csv_file, verbose=False)
+    sma_periods, std_multipliers = parameter_grid()
+    configs = len(sma_periods) * len(std_multipliers)
+    single = None
+    for threads in thread_counts(max_threads):
+        record = bench.run('sweep', 'sweep', len(store) * configs,
+                           lambda _, n=threads: backtest.sweep(store, sma_periods, std_multipliers, n),
+                           'native', threads=threads, configs=configs)
+        single = single or record['seconds']
+        record['speedup'] = single / record['seconds']
+        record['efficiency'] = record['speedup'] / threads
+
+
+def git_revision():
+    def git(*args):
+        return subprocess.run(['git', *args], cwd=REPO_ROOT, capture_output=True, text=True,
+                              timeout=30).stdout.strip()
+    try:
+        return {'commit': git('rev-parse', 'HEAD') or None,
+                'dirty': bool(git('status', '--porcelain', '--untracked-files=no'))}
+    except (OSError, subprocess.SubprocessError):
+        return {'commit': None, 'dirty': None}
+
+
+def environment(csv_file: str, n_bars: int, args) -> dict:
+    import numpy as np
+    import pandas as pd
+    return {
+        **git_revision(),
+        'time': datetime.now(timezone.utc).isoformat(),
+        'python': platform.python_version(),
+        'platform': platform.platform(),
+        'machine': platform.machine(),
+        'cpu_count': os.cpu_count(),
+        'numpy': np.__version__,
+        'pandas': pd.__version__,
+        'dataset': os.path.relpath(csv_file, REPO_ROOT),
+        'bars': n_bars,
+        'repeat': args.repeat,
+    }
+
+
+def result_key(record: dict):
+    return record['group'], record['name'], record['variant'], record['threads']
+
+
+def compare(results, baseline_path: str, threshold: float) -> int:
+    """Print throughput ratios against a baseline run; returns the number of regressions"""
+    with open(baseline_path) as f:
+        baseline = {result_key(r): r for r in json.load(f)['results'] if r.get('bars_per_second')}
+    print(f"\nCompared with {baseline_path} (regression: more than {threshold:.0%} slower)")
+    regressions = 0
+    for record in results:
+        old = baseline.get(result_key(record))
+        if old is None or not record.get('bars_per_second'):
+            continue
+        ratio = record['bars_per_second'] / old['bars_per_second']
+        record['baseline_ratio'] = ratio
+        flag = ''
+        if ratio < 1 - threshold:
+            flag = '  REGRESSION'
+            regressions += 1
+        label = f"{record['variant']} x{record['threads']}" if record['threads'] else record['variant']
+        print(f"  {record['group']:<10} {record['name']:<32} {label:<8} {ratio:6.2f}x{flag}")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(usage=__doc__)
+    parser.add_argument('csv_file', nargs='?', default=DEFAULT_DATASET)
+    parser.add_argument('--output', default=None, help="JSON file (default: benchmark_<commit>.json)")
+    parser.add_argument('--repeat', type=int, default=5)
+    parser.add_argument('--max-threads', type=int, default=os.cpu_count() or 1)
+    parser.add_argument('--only', default=','.join(GROUPS))
+    parser.add_argument('--compare', default=None, help="baseline JSON from an earlier run")
+    parser.add_argument('--threshold', type=float, default=0.10)
+    args = parser.parse_args()
+
+    groups = [g.strip() for g in args.only.split(',') if g.strip()]
+    unknown = set(groups) - set(GROUPS)
+    if unknown:
+        parser.error(f"unknown group(s): {', '.join(sorted(unknown))}")
+    if not os.path.exists(args.csv_file):
+        parser.error(f"dataset not found: {args.csv_file}")
+
+    df = load_frame(args.csv_file)
+    symbol = os.path.basename(args.csv_file).split('_')[1] if '_' in os.path.basename(args.csv_file) else ''
+    print(f"Benchmarking on {args.csv_file} ({len(df):,} bars, best of {args.repeat})\n")
+
+    bench = Benchmark(args.repeat)
+    if 'load' in groups:
+        bench_load(bench, args.csv_file, len(df))
+    if 'execute' in groups:
+        bench_execute(bench, args.csv_file)
+    if 'indicators' in groups:
+        bench_indicators(bench, df)
+    if 'engine' in groups:
+        bench_engine(bench, df, symbol)
+    if 'sweep' in groups:
+        bench_sweep(bench, args.csv_file, max(1, args.max_threads))
+
+    regressions = compare(bench.results, args.compare, args.threshold) if args.compare else 0
+
+    document = {'environment': environment(args.csv_file, len(df), args), 'results': bench.results}
+    output = args.output
+    if output is None:
+        commit = document['environment']['commit']
+        output = f"benchmark_{commit[:10] if commit else 'unknown'}.json"
+    with open(output, 'w') as f:
+        json.dump(document, f, indent=2)
+    print(f"\nResults written to {output}")
+    if regressions:
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,306 @@
+// Monte Carlo robustness checks for optimized parameter sets.
+//
+// A sweep gives one point estimate per configuration. resample() re-runs a
+// list of configurations on n_samples perturbed histories and returns one
+// BacktestMetrics row per (configuration, sample), so callers can read
+// confidence intervals for P&L, drawdown and expectancy off the samples.
+//
+//   RESAMPLE_BARS              circular block bootstrap of the bar-to-bar
+//                              close ratios: blocks of block_size consecutive
+//                              returns are drawn with replacement and chained
+//                              from the first close. Open/high/low are scaled
+//                              with their source bar's close and volume is
+//                              copied, so every strategy sees a full bar.
+//                              The strategy is re-run on every synthetic path.
+//   RESAMPLE_TRADES_SHUFFLE    the configuration's closed-trade P&L sequence
+//                              on the real bars, permuted: total P&L and
+//                              expectancy are fixed, drawdown varies.
+//   RESAMPLE_TRADES_BOOTSTRAP  the same trades drawn with replacement.
+//
+// Every sample owns its random stream, derived from (seed, configuration,
+// sample) with splitmix64, so results are reproducible whatever the thread
+// count. Bar samples are shared by all configurations (sample k is the same
+// path for each of them), which makes their intervals directly comparable.
+// Bar mode runs one task per sample; trade modes one task per configuration.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "bar_store.h"
+#include "mean_reversion.h"
+#include "parallel.h"
+#include "rolling.h"
+#include "strategy.h"
+#include "sweep.h"
+
+namespace bat {
+
+enum ResampleMode {
+    RESAMPLE_BARS = 0,
+    RESAMPLE_TRADES_SHUFFLE = 1,
+    RESAMPLE_TRADES_BOOTSTRAP = 2,
+};
+
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** seeded from (seed, stream)
+class RandomStream {
+public:
+    RandomStream(uint64_t seed, uint64_t stream) {
+        uint64_t state = seed ^ splitmix64(stream);
+        for (uint64_t& word : s_) word = splitmix64(state);
+    }
+
+    uint64_t next() {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, n), unbiased. Below 2^32 (every bar or trade count) this
+    // is Lemire's multiply-shift on the high 32 bits of a draw, rejecting the
+    // (2^32 mod n) low products that would over-weight some results; larger n
+    // falls back to a modulo with the same rejection over 64 bits.
+    size_t below(size_t n) {
+        const uint64_t bound = n;
+        if (bound <= UINT32_MAX) {
+            uint64_t m = (next() >> 32) * bound;
+            if (static_cast<uint32_t>(m) < bound) {
+                const uint32_t threshold = static_cast<uint32_t>(-static_cast<uint32_t>(bound)) %
+                                           static_cast<uint32_t>(bound);
+                while (static_cast<uint32_t>(m) < threshold) m = (next() >> 32) * bound;
+            }
+            return static_cast<size_t>(m >> 32);
+        }
+        const uint64_t threshold = (0 - bound) % bound;  // 2^64 mod n
+        uint64_t x = next();
+        while (x < threshold) x = next();
+        return static_cast<size_t>(x % bound);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    uint64_t s_[4];
+};
+
+// Rule-of-thumb block length for a series of n returns
+inline size_t default_block_size(size_t n) {
+    return std::max<size_t>(1, static_cast<size_t>(std::lround(std::cbrt(static_cast<double>(n)))));
+}
+
+// One block-bootstrapped copy of bars into out (resized to bars.size)
+inline void block_bootstrap(const BarColumns& bars, size_t block_size, RandomStream& rng, BarStore& out) {
+    const size_t n = bars.size;
+    out.timestamp.resize(n);
+    out.open.resize(n);
+    out.high.resize(n);
+    out.low.resize(n);
+    out.close.resize(n);
+    out.volume.resize(n);
+    if (n == 0) return;
+    out.timestamp[0] = bars.timestamp[0];
+    out.open[0] = bars.open[0];
+    out.high[0] = bars.high[0];
+    out.low[0] = bars.low[0];
+    out.close[0] = bars.close[0];
+    out.volume[0] = bars.volume[0];
+
+    // Returns are indexed by their bar, 1..n-1, and blocks wrap around them
+    const size_t n_returns = n - 1;
+    size_t start = 0, offset = block_size;
+    for (size_t j = 1; j < n; ++j) {
+        if (offset == block_size) {
+            start = rng.below(n_returns);
+            offset = 0;
+        }
+        const size_t src = 1 + (start + offset++) % n_returns;
+        const double prev = bars.close[src - 1];
+        const double ratio = prev != 0.0 ? bars.close[src] / prev : 1.0;
+        const double close = out.close[j - 1] * ratio;
+        const double scale = bars.close[src] != 0.0 ? close / bars.close[src] : 0.0;
+        out.timestamp[j] = bars.timestamp[j];
+        out.open[j] = bars.open[src] * scale;
+        out.high[j] = bars.high[src] * scale;
+        out.low[j] = bars.low[src] * scale;
+        out.close[j] = close;
+        out.volume[j] = bars.volume[src];
+    }
+}
+
+// Metrics of a closed-trade P&L sequence replayed in the given order; with no
+// open positions the marked equity is the realized one
+inline BacktestMetrics replay_trades(const double* pnls, size_t n, int sma_period, double std_multiplier) {
+    TradingStats s;
+    for (size_t t = 0; t < n; ++t) {
+        close_trade(s, pnls[t]);
+        if (s.total_pnl > s.peak_equity) s.peak_equity = s.total_pnl;
+        const double current_drawdown = s.peak_equity - s.total_pnl;
+        if (current_drawdown > s.max_drawdown) s.max_drawdown = current_drawdown;
+        mark_to_market(s, 0.0);
+    }
+    return compute_metrics(s, sma_period, std_multiplier);
+}
+
+// Mean reversion configurations as (periods[c], multipliers[c]) pairs
+struct MeanReversionRunner {
+    const int* periods;
+    const double* multipliers;
+    size_t n_configs;
+
+    // Every configuration on one series. Configurations sharing a period
+    // share its rolling mean/std, as in sweep_grid.
+    void run_all(const BarColumns& bars, BacktestMetrics* out) const {
+        std::vector<size_t> order(n_configs);
+        for (size_t c = 0; c < n_configs; ++c) order[c] = c;
+        std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return periods[a] < periods[b]; });
+
+        std::vector<double> mean(bars.size), stdev(bars.size), group_multipliers;
+        std::vector<BacktestMetrics> rows;
+        for (size_t begin = 0; begin < n_configs;) {
+            const int period = periods[order[begin]];
+            size_t end = begin;
+            group_multipliers.clear();
+            while (end < n_configs && periods[order[end]] == period) group_multipliers.push_back(multipliers[order[end++]]);
+            rows.resize(end - begin);
+            if (period < 1) {
+                for (size_t k = 0; k < rows.size(); ++k) rows[k] = compute_metrics(TradingStats(), period, group_multipliers[k]);
+            } else {
+                rolling_mean_std(bars.close, bars.size, static_cast<size_t>(period), mean.data(), stdev.data());
+                sweep_period(bars, period, mean.data(), stdev.data(), group_multipliers.data(), rows.size(), rows.data());
+            }
+            for (size_t k = 0; k < rows.size(); ++k) out[order[begin + k]] = rows[k];
+            begin = end;
+        }
+    }
+
+    std::vector<double> trade_pnls(const BarColumns& bars, size_t c) const {
+        std::vector<double> pnls;
+        if (periods[c] < 1) return pnls;
+        TradingStats s;
+        std::vector<TradeEvent> events;
+        run_mean_reversion(bars, periods[c], multipliers[c], s, &events);
+        for (const TradeEvent& e : events) {
+            if (e.action == ACTION_SELL || e.action == ACTION_COVER) pnls.push_back(e.pnl);
+        }
+        return pnls;
+    }
+
+    int sma_period(size_t c) const { return periods[c]; }
+    double std_multiplier(size_t c) const { return multipliers[c]; }
+};
+
+// Compiled strategy parameter rows (n_configs * S::n_params, row-major)
+template <typename S>
+struct SignalRunner {
+    const double* params;
+    size_t n_configs;
+    bool long_short;
+
+    void run_all(const BarColumns& bars, BacktestMetrics* out) const {
+        for (const std::vector<size_t>& group : indicator_groups<S>(params, n_configs)) {
+            S signals;
+            signals.prepare(bars, params + group.front() * S::n_params);
+            for (const size_t r : group) {
+                out[r] = compute_metrics(run_signals(signals, bars, params + r * S::n_params, long_short), 0, 0.0);
+            }
+        }
+    }
+
+    // run_signals, keeping each close's P&L
+    std::vector<double> trade_pnls(const BarColumns& bars, size_t c) const {
+        const double* p = params + c * S::n_params;
+        S signals;
+        signals.prepare(bars, p);
+        std::vector<double> pnls;
+        TradingStats s;
+        for (size_t i = 1; i < bars.size; ++i) {
+            const int64_t trades = s.total_trades;
+            const double realized = s.total_pnl;
+            signal_step(s, bars.close[i], signals.at(i, p), long_short);
+            if (s.total_trades != trades) pnls.push_back(s.total_pnl - realized);
+        }
+        return pnls;
+    }
+
+    int sma_period(size_t) const { return 0; }
+    double std_multiplier(size_t) const { return 0.0; }
+};
+
+// out must hold runner.n_configs * n_samples rows, configuration-major.
+// block_size 0 picks default_block_size.
+template <typename Runner>
+void resample(const BarColumns& bars, const Runner& runner, int mode, size_t n_samples, size_t block_size,
+              uint64_t seed, BacktestMetrics* out, unsigned n_threads) {
+    const size_t n_configs = runner.n_configs;
+    if (n_configs == 0 || n_samples == 0) return;
+
+    if (mode == RESAMPLE_BARS) {
+        if (bars.size < 2) throw std::invalid_argument("block bootstrap needs at least two bars");
+        const size_t block = block_size ? block_size : default_block_size(bars.size - 1);
+        parallel_for(n_samples, n_threads, [&](size_t k) {
+            RandomStream rng(seed, k);
+            BarStore path;
+            block_bootstrap(bars, block, rng, path);
+            std::vector<BacktestMetrics> rows(n_configs);
+            runner.run_all(path.columns(), rows.data());
+            for (size_t c = 0; c < n_configs; ++c) out[c * n_samples + k] = rows[c];
+        });
+        return;
+    }
+    if (mode != RESAMPLE_TRADES_SHUFFLE && mode != RESAMPLE_TRADES_BOOTSTRAP) {
+        throw std::invalid_argument("unknown resample mode");
+    }
+
+    parallel_for(n_configs, n_threads, [&](size_t c) {
+        const std::vector<double> pnls = runner.trade_pnls(bars, c);
+        const size_t n = pnls.size();
+        std::vector<double> sample(n);
+        for (size_t k = 0; k < n_samples; ++k) {
+            RandomStream rng(seed, (static_cast<uint64_t>(c) << 32) ^ k);
+            if (mode == RESAMPLE_TRADES_SHUFFLE) {
+                sample = pnls;
+                for (size_t t = n; t > 1; --t) std::swap(sample[t - 1], sample[rng.below(t)]);
+            } else {
+                for (size_t t = 0; t < n; ++t) sample[t] = pnls[rng.below(n)];
+            }
+            out[c * n_samples + k] = replay_trades(sample.data(), n, runner.sma_period(c), runner.std_multiplier(c));
+        }
+    });
+}
+
+inline void resample_mean_reversion(const BarColumns& bars, const int* periods, const double* multipliers,
+                                    size_t n_configs, int mode, size_t n_samples, size_t block_size, uint64_t seed,
+                                    BacktestMetrics* out, unsigned n_threads) {
+    resample(bars, MeanReversionRunner{periods, multipliers, n_configs}, mode, n_samples, block_size, seed, out,
+             n_threads);
+}
+
+inline void resample_strategy(int kind, const BarColumns& bars, const double* params, size_t n_rows, bool long_short,
+                              int mode, size_t n_samples, size_t block_size, uint64_t seed, BacktestMetrics* out,
+                              unsigned n_threads) {
+    dispatch_strategy(kind, [&](auto tag) {
+        using S = decltype(tag);
+        check_params<S>(params, n_rows);
+        resample(bars, SignalRunner<S>{params, n_rows, long_short}, mode, n_samples, block_size, seed, out,
+                 n_threads);
+    });
+}
+
+}  // namespace bat
@@ -0,0 +1,178 @@
+// Memory-mapped CSV loader that fills a BarStore directly.
+//
+// Columns are located by header name (case-insensitive), so both the
+// research datasets (Volume,Open,Close,High,Low,timestamp) and the
+// fetch_polygon_data.py layout (timestamp,open,high,low,close,volume) load
+// without configuration. Numbers are parsed with std::from_chars and
+// timestamps are converted to epoch nanoseconds (timestamps.h).
+
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bar_store.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "timestamps.h"
+
+namespace bat {
+
+struct LoadReport {
+    int status = LOAD_OK;
+    std::string message;
+    size_t rows = 0;
+    size_t skipped = 0;
+    // The first few malformed lines, for warnings
+    std::vector<std::string> bad_lines;
+};
+
+namespace detail {
+
+constexpr size_t MAX_REPORTED_BAD_LINES = 10;
+
+enum CsvColumn { COL_TIMESTAMP = 0, COL_OPEN, COL_HIGH, COL_LOW, COL_CLOSE, COL_VOLUME, COL_COUNT };
+
+inline void trim(const char*& begin, const char*& end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '"')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '"' || end[-1] == '\r')) --end;
+}
+
+inline int column_for_name(const char* begin, const char* end) {
+    trim(begin, end);
+    std::string name(begin, end);
+    for (auto& ch : name) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    if (name == "timestamp" || name == "time" || name == "datetime" || name == "date" || name == "t") {
+        return COL_TIMESTAMP;
+    }
+    if (name == "open" || name == "o") return COL_OPEN;
+    if (name == "high" || name == "h") return COL_HIGH;
+    if (name == "low" || name == "l") return COL_LOW;
+    if (name == "close" || name == "c") return COL_CLOSE;
+    if (name == "volume" || name == "v") return COL_VOLUME;
+    return -1;
+}
+
+inline bool parse_double(const char* begin, const char* end, double& out) {
+    trim(begin, end);
+    if (begin < end && *begin == '+') ++begin;
+    if (begin >= end) return false;
+    auto result = std::from_chars(begin, end, out);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+inline const char* find_line_end(const char* p, const char* end) {
+    const void* nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return nl ? static_cast<const char*>(nl) : end;
+}
+
+}  // namespace detail
+
+// Parse CSV text in [data, data + size) into store
+inline LoadReport parse_csv_bars(const char* data, size_t size, BarStore& store) {
+    using namespace detail;
+    LoadReport report;
+    const char* p = data;
+    const char* end = data + size;
+
+    // Header: map each field index to a bar column
+    const char* header_end = find_line_end(p, end);
+    std::vector<int> field_columns;
+    int found[COL_COUNT] = {0, 0, 0, 0, 0, 0};
+    for (const char* field = p; field <= header_end;) {
+        const char* comma = static_cast<const char*>(std::memchr(field, ',', static_cast<size_t>(header_end - field)));
+        const char* field_end = comma ? comma : header_end;
+        const int column = column_for_name(field, field_end);
+        field_columns.push_back(column);
+        if (column >= 0) found[column] += 1;
+        if (!comma) break;
+        field = comma + 1;
+    }
+    for (int c = COL_TIMESTAMP; c <= COL_CLOSE; ++c) {
+        if (found[c] != 1) {
+            report.status = LOAD_BAD_HEADER;
+            report.message = "CSV header must name timestamp, open, high, low and close columns exactly once";
+            return report;
+        }
+    }
+    p = header_end < end ? header_end + 1 : end;
+
+    // Reserve from the average length of the first data lines
+    if (p < end) {
+        const char* probe = p;
+        size_t probe_lines = 0;
+        while (probe < end && probe_lines < 64) {
+            probe = find_line_end(probe, end) + 1;
+            ++probe_lines;
+        }
+        const size_t avg = static_cast<size_t>(probe - p) / (probe_lines ? probe_lines : 1);
+        if (avg > 0) store.reserve(static_cast<size_t>(end - p) / avg + 1);
+    }
+
+    const size_t n_fields = field_columns.size();
+    while (p < end) {
+        const char* line_end = find_line_end(p, end);
+        const char* line = p;
+        p = line_end < end ? line_end + 1 : end;
+
+        const char* content_end = line_end;
+        if (content_end > line && content_end[-1] == '\r') --content_end;
+        if (content_end == line) continue;  // blank line
+
+        int64_t ts = 0;
+        double values[COL_COUNT] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        bool ok = true;
+        size_t field_index = 0;
+        for (const char* field = line; ok;) {
+            const char* comma = static_cast<const char*>(std::memchr(field, ',', static_cast<size_t>(content_end - field)));
+            const char* field_end = comma ? comma : content_end;
+            const int column = field_index < n_fields ? field_columns[field_index] : -1;
+            if (column == COL_TIMESTAMP) {
+                ok = parse_timestamp(field, field_end, ts);
+            } else if (column >= 0) {
+                ok = parse_double(field, field_end, values[column]);
+            }
+            ++field_index;
+            if (!comma) break;
+            field = comma + 1;
+        }
+
+        if (!ok || field_index < n_fields) {
+            report.skipped += 1;
+            if (report.bad_lines.size() < MAX_REPORTED_BAD_LINES) {
+                report.bad_lines.emplace_back(line, content_end);
+            }
+            continue;
+        }
+        store.push_back(ts, values[COL_OPEN], values[COL_HIGH], values[COL_LOW], values[COL_CLOSE],
+                        values[COL_VOLUME]);
+    }
+
+    report.rows = store.size();
+    return report;
+}
+
+// Memory-map path and parse it into store
+inline LoadReport load_csv_bars(const std::string& path, BarStore& store) {
+    LoadReport report;
+    MappedFile file;
+    report.status = file.open(path, report.message);
+    if (report.status != LOAD_OK) return report;
+    return parse_csv_bars(file.data(), file.size(), store);
+}
+
+// Load several files concurrently; stores and reports must match paths in size
+inline void load_csv_bars_many(const std::vector<std::string>& paths, const std::vector<BarStore*>& stores,
+                               std::vector<LoadReport>& reports, unsigned n_threads) {
+    reports.resize(paths.size());
+    parallel_for(paths.size(), n_threads, [&](size_t i) {
+        reports[i] = load_csv_bars(paths[i], *stores[i]);
+    });
+}
+
+}  // namespace bat
@@ -4,6 +4,7 @@ Fetch historical data from Polygon API and save to CSV format compatible with ba
 
 Usage:
     python fetch_polygon_data.py <ticker> <timespan> <days> <output_file> [api_key]
+                                 [--cache-dir DIR] [--workers N] [--rate R]
 
 Examples:
     # Fetch 7 days of minute data for Bitcoin
@@ -15,33 +16,55 @@ Examples:
     # Fetch 365 days of daily data for AAPL
     python fetch_polygon_data.py AAPL day 365 aapl_data.csv YOUR_API_KEY
 
+    # Fetch 240 days of minute data for several tickers at once
+    python fetch_polygon_data.py SPY,QQQ,IWM minute 240 {ticker}_minute.csv YOUR_API_KEY
+
 Arguments:
-    ticker       - Symbol to fetch (e.g., AAPL, SPY, X:BTCUSD)
+    ticker       - Symbol to fetch (e.g., AAPL, SPY, X:BTCUSD), or a comma-separated list
     timespan     - Bar timespan: minute, hour, day, week, month
     days         - Number of days to fetch (lookback from today)
-    output_file  - Output CSV filename
+    output_file  - Output CSV filename; with several tickers it must contain {ticker}
     api_key      - Polygon API key (optional if set in environment)
+    --cache-dir  - Incremental bar cache (default: research/datasets/cache); a
+                   re-run only downloads the bars added since the last one
+    --workers    - Concurrent requests (default: 8)
+    --rate       - Requests per second across workers (default: 5; the free tier allows 5 a minute)
 """
 
+import argparse
 import sys
 import os
+import time
 from datetime import datetime, timedelta
 import pandas as pd
-import requests
 
+# data_providers/ lives at the repository root
+sys.path.append(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__)))))
+from data_providers.fetcher import FetchError, PolygonFetcher
+
+DEFAULT_CACHE_DIR = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), 'datasets', 'cache')
 
-def fetch_polygon_data(ticker, timespan, days, api_key):
+
+def fetch_polygon_data_many(tickers, timespan, days, api_key, cache_dir=DEFAULT_CACHE_DIR,
+                            max_workers=8, rate=5.0):
     """
-    Fetch historical aggregate bars from Polygon API
+    Fetch historical aggregate bars of several tickers from Polygon API
+
+    Every ticker's date range is split into page-sized chunks that are
+    downloaded concurrently under one request-rate budget; with a cache_dir
+    only the bars not cached yet are requested.
 
     Args:
-        ticker: Stock/crypto symbol
+        tickers: Stock/crypto symbols
         timespan: Bar interval (minute, hour, day, week, month)
         days: Number of days to look back
         api_key: Polygon API key
+        cache_dir: Incremental bar cache directory (None: no cache)
+        max_workers: Concurrent requests
+        rate: Requests per second
 
     Returns:
-        DataFrame with OHLCV data
+        {ticker: DataFrame with timestamp, open, high, low, close, volume}
     """
     to_date = datetime.now()
     from_date = to_date - timedelta(days=days)
@@ -49,51 +72,56 @@ def fetch_polygon_data(ticker, timespan, days, api_key):
     to_date_str = to_date.strftime('%Y-%m-%d')
     from_date_str = from_date.strftime('%Y-%m-%d')
 
-    # Polygon API endpoint
-    url = (
-        f"https://api.polygon.io/v2/aggs/ticker/{ticker}/range/1/{timespan}/"
-        f"{from_date_str}/{to_date_str}?adjusted=true&sort=asc&limit=100000&apiKey={api_key}"
-    )
-
-    print(f"Fetching data for {ticker}...")
+    print(f"Fetching data for {', '.join(tickers)}...")
     print(f"  Date range: {from_date_str} to {to_date_str}")
     print(f"  Timespan: {timespan}")
 
-    response = requests.get(url)
-
-    if response.status_code != 200:
-        print(f"Error: API request failed with status code {response.status_code}")
-        print(f"Response: {response.text}")
+    fetcher = PolygonFetcher(api_key, max_workers=max_workers, rate=rate, burst=max_workers, cache_dir=cache_dir)
+    started = time.perf_counter()
+    try:
+        bars = fetcher.fetch_many(tickers, timespan, from_date_str, to_date_str)
+    except FetchError as e:
+        print(f"Error: {e}")
         sys.exit(1)
+    finally:
+        fetcher.close()
+    elapsed = time.perf_counter() - started
+
+    frames = {}
+    for ticker, columns in bars.items():
+        if len(columns['timestamp']) == 0:
+            print(f"Error: No results returned from API for {ticker}")
+            sys.exit(1)
+        # Columns in the expected format: timestamp,open,high,low,close,volume
+        frames[ticker] = pd.DataFrame({
+            'timestamp': pd.to_datetime(columns['timestamp']),
+            'open': columns['open'],
+            'high': columns['high'],
+            'low': columns['low'],
+            'close': columns['close'],
+            'volume': columns['volume'],
+        })
+        print(f"  {ticker}: {len(frames[ticker])} bars")
+
+    print(f"  {fetcher.requests_made} requests in {elapsed:.1f}s")
+    return frames
+
+
+def fetch_polygon_data(ticker, timespan, days, api_key, cache_dir=DEFAULT_CACHE_DIR, max_workers=8, rate=5.0):
+    """
+    Fetch historical aggregate bars from Polygon API
 
-    data = response.json()
-
-    if 'results' not in data:
-        print(f"Error: No results returned from API")
-        print(f"Response: {data}")
-        sys.exit(1)
-
-    # Convert to DataFrame
-    df = pd.DataFrame(data['results'])
-
-    # Convert timestamp from milliseconds to readable format
-    df['timestamp'] = pd.to_datetime(df['t'], unit='ms')
-
-    # Rename columns to match expected format: timestamp,open,high,low,close,volume
-    df = df.rename(columns={
-        'o': 'open',
-        'h': 'high',
-        'l': 'low',
-        'c': 'close',
-        'v': 'volume'
-    })
-
-    # Keep only required columns in correct order
-    df = df[['timestamp', 'open', 'high', 'low', 'close', 'volume']]
-
-    print(f"  Fetched {len(df)} bars")
+    Args:
+        ticker: Stock/crypto symbol
+        timespan: Bar interval (minute, hour, day, week, month)
+        days: Number of days to look back
+        api_key: Polygon API key
+        cache_dir, max_workers, rate: As fetch_polygon_data_many
 
-    return df
+    Returns:
+        DataFrame with OHLCV data
+    """
+    return fetch_polygon_data_many([ticker], timespan, days, api_key, cache_dir, max_workers, rate)[ticker]
 
 
 def save_to_csv(df, output_file):
@@ -122,14 +150,28 @@ def main():
         print(__doc__)
         sys.exit(1)
 
-    ticker = sys.argv[1]
-    timespan = sys.argv[2]
-    days = int(sys.argv[3])
-    output_file = sys.argv[4]
+    parser = argparse.ArgumentParser(usage=__doc__)
+    parser.add_argument('ticker')
+    parser.add_argument('timespan')
+    parser.add_argument('days', type=int)
+    parser.add_argument('output_file')
+    parser.add_argument('api_key', nargs='?')
+    parser.add_argument('--cache-dir', default=DEFAULT_CACHE_DIR)
+    parser.add_argument('--workers', type=int, default=8)
+    parser.add_argument('--rate', type=float, default=5.0)
+    args = parser.parse_args()
+
+    tickers = [t.strip() for t in args.ticker.split(',') if t.strip()]
+    timespan = args.timespan
+    days = args.days
+    output_file = args.output_file
+    if len(tickers) > 1 and '{ticker}' not in output_file:
+        print("Error: output_file must contain {ticker} when fetching several tickers")
+        sys.exit(1)
 
     # Get API key from argument or environment
-    if len(sys.argv) > 5:
-        api_key = sys.argv[5]
+    if args.api_key:
+        api_key = args.api_key
     else:
         api_key = os.environ.get('POLYGON_API_KEY')
         if not api_key:
@@ -146,14 +188,21 @@ def main():
         sys.exit(1)
 
     # Fetch data
-    df = fetch_polygon_data(ticker, timespan, days, api_key)
+    frames = fetch_polygon_data_many(tickers, timespan, days, api_key, args.cache_dir or None,
+                                     args.workers, args.rate)
 
     # Save to CSV
-    save_to_csv(df, output_file)
+    outputs = []
+    for ticker, df in frames.items():
+        clean_ticker = ticker.replace(':', '_').replace('/', '_')
+        path = output_file.replace('{ticker}', clean_ticker)
+        save_to_csv(df, path)
+        outputs.append(path)
 
     print(f"\n✓ Ready to use with backtest.c:")
     print(f"  gcc -o backtest backtest.c -lm")
-    print(f"  ./backtest {output_file}")
+    for path in outputs:
+        print(f"  ./backtest {path}")
 
 
 if __name__ == '__main__':
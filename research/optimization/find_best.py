@@ -4,8 +4,9 @@ Walk-Forward Optimization for Mean Reversion Strategy
 
 This script finds the optimal parameters for the mean reversion strategy by:
 1. Training on the first 50% of data (optimization set)
-2. Testing on the 3rd quarter (validation set)
-3. Testing on the 4th quarter (out-of-sample test set)
+2. Resampling the top configurations for Monte Carlo confidence intervals
+3. Testing on the 3rd quarter (validation set)
+4. Testing on the 4th quarter (out-of-sample test set)
 
 This approach prevents overfitting by ensuring the best parameters are validated
 on truly unseen data.
@@ -15,12 +16,15 @@ Requirements:
       python setup.py build_ext --inplace
 
 Usage:
-    python find_best.py <csv_file>
+    python find_best.py <csv_file> [walk_forward_folds] [strategy]
 
 Example:
     python find_best.py btc_data.csv
+    python find_best.py btc_data.csv 12   # rolling walk-forward, see walk_forward_main
+    python find_best.py btc_data.csv 12 rsi   # walk-forward of a compiled strategy (strategy_grid)
 """
 
+import itertools
 import sys
 import os
 import pandas as pd
@@ -29,24 +33,28 @@ from datetime import datetime
 from typing import Dict, List, Tuple
 
 
-def split_data(csv_file: str) -> Tuple[str, str, str]:
+def split_data(csv_file: str) -> Tuple[object, object, object]:
     """
     Split data into training (50%), validation (25%), and test (25%) sets
 
+    The bars are loaded once (through the binary cache, see backtest.load_bars)
+    and each split is a zero-copy slice of the same store, so no temporary
+    files are written.
+
     Args:
         csv_file: Path to the input CSV file
 
     Returns:
-        Tuple of (train_file, validation_file, test_file) paths
+        Tuple of (train, validation, test) BarStore slices
     """
     print(f"\n{'='*60}")
     print("DATA SPLITTING")
     print(f"{'='*60}")
     print(f"Reading data from: {csv_file}")
 
-    # Read the CSV
-    df = pd.read_csv(csv_file)
-    total_rows = len(df)
+    backtest = import_backtest()
+    bars = backtest.load_bars(csv_file, verbose=False)
+    total_rows = len(bars)
 
     print(f"Total bars: {total_rows}")
 
@@ -55,79 +63,57 @@ def split_data(csv_file: str) -> Tuple[str, str, str]:
     validation_end = int(total_rows * 0.75)
 
     # Split the data
-    train_df = df.iloc[:train_end]
-    validation_df = df.iloc[train_end:validation_end]
-    test_df = df.iloc[validation_end:]
+    train = bars.slice(0, train_end)
+    validation = bars.slice(train_end, validation_end)
+    test = bars.slice(validation_end, total_rows)
 
     print(f"\nData splits:")
-    print(f"  Training set:   {len(train_df):6d} bars (50%)")
-    print(f"  Validation set: {len(validation_df):6d} bars (25%)")
-    print(f"  Test set:       {len(test_df):6d} bars (25%)")
-
-    # Create temporary files
-    base_name = os.path.splitext(csv_file)[0]
-    train_file = f"{base_name}_train.csv"
-    validation_file = f"{base_name}_validation.csv"
-    test_file = f"{base_name}_test.csv"
+    print(f"  Training set:   {len(train):6d} bars (50%)")
+    print(f"  Validation set: {len(validation):6d} bars (25%)")
+    print(f"  Test set:       {len(test):6d} bars (25%)")
 
-    # Save splits
-    train_df.to_csv(train_file, index=False)
-    validation_df.to_csv(validation_file, index=False)
-    test_df.to_csv(test_file, index=False)
+    return train, validation, test
 
-    print(f"\nTemporary files created:")
-    print(f"  {train_file}")
-    print(f"  {validation_file}")
-    print(f"  {test_file}")
 
-    return train_file, validation_file, test_file
+def import_backtest():
+    """Import the Cython backtest module, exiting with build instructions if missing"""
+    try:
+        import backtest
+        return backtest
+    except ImportError:
+        print("Error: Cython backtest module not found")
+        print("Please build the Cython extension first:")
+        print("  python setup.py build_ext --inplace")
+        sys.exit(1)
 
 
-def run_backtest(csv_file: str, sma_period: int, std_multiplier: float) -> Dict:
+def run_backtest(data, sma_period: int, std_multiplier: float) -> Dict:
     """
     Run the Cython backtest with given parameters and return results
 
     Args:
-        csv_file: Path to CSV data file
+        data: Path to CSV data file or a loaded BarStore
         sma_period: SMA period parameter
         std_multiplier: Standard deviation multiplier
 
     Returns:
         Dictionary with backtest results
     """
-    try:
-        # Import the Cython backtest module
-        import backtest
+    backtest = import_backtest()
 
+    try:
         # Run backtest silently and get metrics
-        metrics = backtest.run_backtest_silent(csv_file, sma_period, std_multiplier)
+        metrics = backtest.run_backtest_silent(data, sma_period, std_multiplier)
 
         return metrics
 
-    except ImportError:
-        print("Error: Cython backtest module not found")
-        print("Please build the Cython extension first:")
-        print("  python setup.py build_ext --inplace")
-        sys.exit(1)
     except Exception as e:
         print(f"  Error running backtest: {e}")
         return None
 
 
-def optimize_parameters(train_file: str) -> List[Dict]:
-    """
-    Test different parameter combinations on training data
-
-    Args:
-        train_file: Path to training data CSV
-
-    Returns:
-        List of results sorted by total P&L
-    """
-    print(f"\n{'='*60}")
-    print("PARAMETER OPTIMIZATION (Training Set)")
-    print(f"{'='*60}\n")
-
+def parameter_grid() -> Tuple[List[int], List[float]]:
+    """SMA periods and std multipliers searched by the optimizer"""
     # Parameter ranges to test - comprehensive search
     # SMA periods: from 1 to 100 with strategic spacing
     sma_periods = (
@@ -142,6 +128,50 @@ def optimize_parameters(train_file: str) -> List[Dict]:
         [round(x * 0.1, 1) for x in range(1, 11)] +    # 0.1-1.0: every 0.1
         [round(x * 0.25, 2) for x in range(5, 17)]     # 1.25-4.0: every 0.25
     )
+    return sma_periods, std_multipliers
+
+
+def strategy_grid(strategy: str) -> List[Dict]:
+    """Parameter rows searched by the walk-forward for a compiled strategy (backtest.STRATEGIES)"""
+    windows = [5, 10, 15, 20, 30, 40, 50]
+    num_stds = [1.0, 1.5, 2.0, 2.5, 3.0]
+    grids = {
+        'moving_average': {'short_window': [1, 2, 3, 5, 8], 'medium_window': [5, 10, 15, 20, 30],
+                           'long_window': [25, 50, 75, 100, 150, 200]},
+        'rsi': {'window': [5, 7, 10, 14, 21, 28], 'oversold_threshold': [15, 20, 25, 30, 35],
+                'overbought_threshold': [65, 70, 75, 80, 85]},
+        'macd': {'fast': [5, 8, 12, 16, 20], 'slow': [21, 26, 35, 50], 'signal': [5, 7, 9, 12]},
+        'bollinger_bands': {'window': windows, 'num_std': num_stds},
+        'mean_reversion_extreme': {'window': windows, 'num_std': num_stds},
+        'candlestick': {},
+    }
+    if strategy not in grids:
+        raise ValueError(f"no parameter grid for strategy: {strategy}")
+    names = list(grids[strategy])
+    rows = [dict(zip(names, values)) for values in itertools.product(*grids[strategy].values())]
+    if strategy == 'moving_average':
+        rows = [r for r in rows if r['short_window'] < r['medium_window'] < r['long_window']]
+    elif strategy == 'macd':
+        rows = [r for r in rows if r['fast'] < r['slow']]
+    return rows
+
+
+def optimize_parameters(train, n_threads: int = 0) -> List[Dict]:
+    """
+    Test different parameter combinations on training data
+
+    Args:
+        train: Training BarStore (or path to a training CSV)
+        n_threads: Worker threads for the native sweep (0 = all cores)
+
+    Returns:
+        List of results sorted by total P&L
+    """
+    print(f"\n{'='*60}")
+    print("PARAMETER OPTIMIZATION (Training Set)")
+    print(f"{'='*60}\n")
+
+    sma_periods, std_multipliers = parameter_grid()
 
     total_combinations = len(sma_periods) * len(std_multipliers)
     print(f"Testing {total_combinations} parameter combinations...")
@@ -151,36 +181,22 @@ def optimize_parameters(train_file: str) -> List[Dict]:
     print(f"  Range: {min(std_multipliers)} to {max(std_multipliers)}")
     print()
 
-    results = []
-    tested = 0
+    backtest = import_backtest()
     start_time = datetime.now()
 
-    # Test all combinations
-    for sma_period in sma_periods:
-        for std_mult in std_multipliers:
-            tested += 1
-
-            # Progress indicator with ETA
-            if tested > 1:
-                elapsed = (datetime.now() - start_time).total_seconds()
-                avg_time_per_test = elapsed / (tested - 1)
-                remaining = total_combinations - tested
-                eta_seconds = int(avg_time_per_test * remaining)
-                eta_minutes = eta_seconds // 60
-                eta_seconds = eta_seconds % 60
-                eta_str = f"ETA: {eta_minutes}m {eta_seconds}s"
-            else:
-                eta_str = "ETA: calculating..."
-
-            print(f"[{tested}/{total_combinations}] SMA={sma_period:3d}, Std={std_mult:.2f} | {eta_str}...", end=' ')
-
-            metrics = run_backtest(train_file, sma_period, std_mult)
-
-            if metrics and metrics['total_trades'] > 0:
-                results.append(metrics)
-                print(f"P&L=${metrics['total_pnl']:>10.2f}, Trades={metrics['total_trades']:4d}, WR={metrics['win_rate']:5.1f}%, Exp=${metrics['expectancy']:6.2f}")
-            else:
-                print("No trades")
+    # Evaluate the whole grid natively on the training bars
+    store = train if isinstance(train, backtest.BarStore) else backtest.load_bars(train, verbose=False)
+    if not store:
+        print("Error: No training data loaded")
+        return []
+
+    grid = backtest.sweep(store, sma_periods, std_multipliers, n_threads)
+
+    results = [
+        {name: row[name].item() for name in grid.dtype.names}
+        for row in grid
+        if row['total_trades'] > 0
+    ]
 
     # Sort by total P&L (descending)
     results.sort(key=lambda x: x['total_pnl'], reverse=True)
@@ -188,12 +204,12 @@ def optimize_parameters(train_file: str) -> List[Dict]:
     # Calculate total time
     total_time = (datetime.now() - start_time).total_seconds()
     minutes = int(total_time // 60)
-    seconds = int(total_time % 60)
+    seconds = total_time % 60
 
     print(f"\n{'='*60}")
     print("OPTIMIZATION RESULTS")
     print(f"{'='*60}")
-    print(f"\nTested {total_combinations} combinations in {minutes}m {seconds}s")
+    print(f"\nTested {total_combinations} combinations in {minutes}m {seconds:.2f}s")
     print(f"Valid results: {len(results)}")
     print(f"\nTop 20 parameter combinations (by P&L):\n")
     print(f"{'Rank':<6} {'SMA':<6} {'Std':<7} {'P&L':<14} {'Trades':<8} {'Win%':<8} {'PF':<8} {'Expectancy':<12}")
@@ -207,14 +223,14 @@ def optimize_parameters(train_file: str) -> List[Dict]:
     return results
 
 
-def validate_parameters(params_list: List[Dict], validation_file: str, test_file: str, top_n: int = 10) -> pd.DataFrame:
+def validate_parameters(params_list: List[Dict], validation, test, top_n: int = 10) -> pd.DataFrame:
     """
     Validate top N parameters on validation and test sets
 
     Args:
         params_list: List of parameter results from optimization
-        validation_file: Path to validation data
-        test_file: Path to test data
+        validation: Validation BarStore (or CSV path)
+        test: Test BarStore (or CSV path)
         top_n: Number of top parameters to validate
 
     Returns:
@@ -235,7 +251,7 @@ def validate_parameters(params_list: List[Dict], validation_file: str, test_file
 
         # Run on validation set
         print(f"  Validation set (Q3)...", end=' ')
-        val_metrics = run_backtest(validation_file, sma_period, std_mult)
+        val_metrics = run_backtest(validation, sma_period, std_mult)
         if val_metrics:
             print(f"P&L=${val_metrics['total_pnl']:.2f}, Trades={val_metrics['total_trades']}, WR={val_metrics['win_rate']:.1f}%")
         else:
@@ -244,7 +260,7 @@ def validate_parameters(params_list: List[Dict], validation_file: str, test_file
 
         # Run on test set
         print(f"  Test set (Q4)...", end=' ')
-        test_metrics = run_backtest(test_file, sma_period, std_mult)
+        test_metrics = run_backtest(test, sma_period, std_mult)
         if test_metrics:
             print(f"P&L=${test_metrics['total_pnl']:.2f}, Trades={test_metrics['total_trades']}, WR={test_metrics['win_rate']:.1f}%")
         else:
@@ -272,6 +288,75 @@ def validate_parameters(params_list: List[Dict], validation_file: str, test_file
     return pd.DataFrame(validation_results)
 
 
+def confidence_intervals(samples, level: float = 0.9) -> Dict:
+    """
+    Central interval and median of each resampled metric
+
+    Args:
+        samples: One configuration's row of backtest.resample()
+        level: Two-sided confidence level
+
+    Returns:
+        Dict of metric -> (low, median, high), plus 'p_profit', the share of
+        samples with a positive total P&L
+    """
+    tail = (1.0 - level) / 2.0
+    quantiles = [tail, 0.5, 1.0 - tail]
+    intervals = {
+        name: tuple(np.quantile(samples[name], quantiles).tolist())
+        for name in ('total_pnl', 'max_drawdown', 'max_drawdown_mtm', 'expectancy')
+    }
+    intervals['p_profit'] = float(np.mean(samples['total_pnl'] > 0)) if len(samples) else 0.0
+    return intervals
+
+
+def robustness_check(train, params_list: List[Dict], top_n: int = 20, mode: str = 'bars',
+                     n_samples: int = 1000, level: float = 0.9, seed: int = 0, n_threads: int = 0) -> List[Dict]:
+    """
+    Monte Carlo confidence intervals for the top N optimized parameters
+
+    Re-runs every configuration on resampled training data (backtest.resample):
+    block-bootstrapped bars by default, or its shuffled / bootstrapped trades.
+    A configuration whose P&L interval straddles zero owes its training
+    result to the particular path it was fitted on.
+
+    Returns:
+        List of dicts with the parameters and their confidence_intervals()
+    """
+    print(f"\n{'='*60}")
+    print(f"MONTE CARLO ROBUSTNESS (Top {top_n} Parameters, {n_samples} '{mode}' samples)")
+    print(f"{'='*60}\n")
+
+    backtest = import_backtest()
+    store = train if isinstance(train, backtest.BarStore) else backtest.load_bars(train, verbose=False)
+    configs = params_list[:top_n]
+    if not configs:
+        return []
+
+    start_time = datetime.now()
+    samples = backtest.resample(store, configs, mode=mode, n_samples=n_samples, seed=seed, n_threads=n_threads)
+    total_time = (datetime.now() - start_time).total_seconds()
+
+    pct = int(round(level * 100))
+    print(f"{'Rank':<6} {'SMA':<6} {'Std':<7} {'P&L':<12} {f'P&L {pct}% CI':<24} "
+          f"{f'Drawdown {pct}% CI':<22} {'Expectancy CI':<18} {'P(>0)':<6}")
+    print(f"{'-'*105}")
+
+    results = []
+    for i, (params, row) in enumerate(zip(configs, samples), 1):
+        intervals = confidence_intervals(row, level)
+        results.append({'sma_period': params['sma_period'], 'std_multiplier': params['std_multiplier'], **intervals})
+        pnl_lo, _, pnl_hi = intervals['total_pnl']
+        dd_lo, _, dd_hi = intervals['max_drawdown_mtm']
+        ex_lo, _, ex_hi = intervals['expectancy']
+        print(f"{i:<6} {params['sma_period']:<6} {params['std_multiplier']:<7.2f} ${params['total_pnl']:<11.2f} "
+              f"{f'[{pnl_lo:.2f}, {pnl_hi:.2f}]':<24} {f'[{dd_lo:.2f}, {dd_hi:.2f}]':<22} "
+              f"{f'[{ex_lo:.2f}, {ex_hi:.2f}]':<18} {intervals['p_profit']:<6.2f}")
+
+    print(f"\nResampled {len(configs)} x {n_samples} backtests in {total_time:.2f}s")
+    return results
+
+
 def print_final_results(results_df: pd.DataFrame):
     """
     Print final validation results with analysis
@@ -339,12 +424,168 @@ def print_final_results(results_df: pd.DataFrame):
     print(f"{'='*60}\n")
 
 
-def cleanup_temp_files(train_file: str, validation_file: str, test_file: str):
-    """Remove temporary data split files"""
-    for f in [train_file, validation_file, test_file]:
-        if os.path.exists(f):
-            os.remove(f)
-            print(f"Removed: {f}")
+def make_folds(n_bars: int, n_folds: int = 12, train_ratio: float = 4.0,
+               anchored: bool = False) -> List[Tuple[int, int, int, int]]:
+    """
+    Walk-forward folds as index ranges over one series
+
+    The series is cut into n_folds consecutive test windows that follow an
+    initial train window train_ratio times as long as a test window. Rolling
+    folds train on the train_ratio windows just before their test window;
+    anchored folds train on everything from bar 0.
+
+    Returns:
+        List of (train_begin, train_end, test_begin, test_end)
+    """
+    if n_folds < 1 or train_ratio <= 0:
+        raise ValueError("n_folds must be >= 1 and train_ratio > 0")
+    test_size = int(n_bars / (n_folds + train_ratio))
+    train_size = int(test_size * train_ratio)
+    if test_size < 1 or train_size < 1:
+        raise ValueError(f"{n_bars} bars are too few for {n_folds} folds")
+    folds = []
+    for k in range(n_folds):
+        test_begin = train_size + k * test_size
+        # The last fold absorbs the rounding remainder
+        test_end = n_bars if k == n_folds - 1 else test_begin + test_size
+        train_begin = 0 if anchored else test_begin - train_size
+        folds.append((train_begin, test_begin, test_begin, test_end))
+    return folds
+
+
+def merge_oos(total: Dict, fold_result: Dict) -> Dict:
+    """
+    Append one fold's out-of-sample run to the running totals
+
+    Folds are stitched on realized P&L: the fold starts at the running P&L,
+    so the combined drawdown is the larger of the fold's own drawdown and
+    the fall from the prior peak to the fold's lowest point.
+    """
+    test = fold_result['test']
+    start = total['total_pnl']
+    drawdown = max(total['max_drawdown'], test['max_drawdown'],
+                   total['peak'] - (start + fold_result['test_min_equity']))
+    merged = {
+        'folds': total['folds'] + 1,
+        'total_pnl': start + test['total_pnl'],
+        'total_trades': total['total_trades'] + test['total_trades'],
+        'winning_trades': total['winning_trades'] + test['winning_trades'],
+        'total_wins': total['total_wins'] + test['avg_win'] * test['winning_trades'],
+        'total_losses': total['total_losses'] + test['avg_loss'] * test['losing_trades'],
+        'profitable_folds': total['profitable_folds'] + (test['total_pnl'] > 0),
+        'max_drawdown': drawdown,
+        'peak': max(total['peak'], start + fold_result['test_peak_equity']),
+    }
+    trades = merged['total_trades']
+    merged['win_rate'] = merged['winning_trades'] / trades * 100 if trades else 0.0
+    merged['profit_factor'] = (merged['total_wins'] / merged['total_losses'] if merged['total_losses'] > 0
+                               else (999.99 if merged['total_wins'] > 0 else 0.0))
+    return merged
+
+
+def walk_forward(store, folds, n_threads: int = 0, batch_size: int = 0, strategy: str = 'mean_reversion'):
+    """
+    Run a walk-forward optimization, yielding each fold as it completes
+
+    Folds are evaluated natively in batches (batch_size folds per call,
+    0 = one batch per thread count), and every (fold, period) search in a
+    batch runs in parallel on the shared store. Any other strategy than
+    mean_reversion is a compiled one searched over strategy_grid(strategy),
+    in long-only mode; its fold results carry the chosen 'params'.
+
+    Yields:
+        (fold_result, oos_totals) with the running out-of-sample aggregate
+    """
+    backtest = import_backtest()
+    if strategy == 'mean_reversion':
+        sma_periods, std_multipliers = parameter_grid()
+        run_batch = lambda batch: backtest.walk_forward(store, batch, sma_periods, std_multipliers, n_threads)
+    else:
+        rows = strategy_grid(strategy)
+        run_batch = lambda batch: backtest.walk_forward_strategy(store, strategy, batch, rows, n_threads=n_threads)
+    batch_size = batch_size or max(os.cpu_count() or 1, 1)
+    totals = {'folds': 0, 'total_pnl': 0.0, 'total_trades': 0, 'winning_trades': 0, 'total_wins': 0.0,
+              'total_losses': 0.0, 'profitable_folds': 0, 'max_drawdown': 0.0, 'peak': 0.0,
+              'win_rate': 0.0, 'profit_factor': 0.0}
+    for start in range(0, len(folds), batch_size):
+        for fold_result in run_batch(folds[start:start + batch_size]):
+            totals = merge_oos(totals, fold_result)
+            yield fold_result, totals
+
+
+def _format_params(params) -> str:
+    return ", ".join(f"{name}={value:g}" for name, value in params.items()) if params else "-"
+
+
+def walk_forward_main(dataset: str, n_folds: int = 12, train_ratio: float = 4.0, anchored: bool = False,
+                      n_threads: int = 0, strategy: str = 'mean_reversion') -> pd.DataFrame:
+    """
+    Walk-forward optimization of a strategy over one dataset (mean reversion
+    by default, or any compiled strategy, see walk_forward)
+
+    Returns:
+        DataFrame with one row per fold (chosen parameters, train and test metrics)
+    """
+    backtest = import_backtest()
+    store = backtest.load_bars(dataset, verbose=False)
+    folds = make_folds(len(store), n_folds, train_ratio, anchored)
+    mean_reversion = strategy == 'mean_reversion'
+    if mean_reversion:
+        sma_periods, std_multipliers = parameter_grid()
+        grid_size = len(sma_periods) * len(std_multipliers)
+    else:
+        grid_size = len(strategy_grid(strategy))
+
+    print(f"\n{'='*60}")
+    print(f"WALK-FORWARD OPTIMIZATION ({strategy}, {'anchored' if anchored else 'rolling'}, {n_folds} folds)")
+    print(f"{'='*60}")
+    print(f"Bars: {len(store)}, test window: {folds[0][3] - folds[0][2]} bars, "
+          f"grid: {grid_size} combinations per fold\n")
+    params_header = f"{'SMA':<5} {'Std':<6}" if mean_reversion else f"{'Params':<12}"
+    print(f"{'Fold':<6} {'Train':<16} {'Test':<16} {params_header} {'Train P&L':<12} "
+          f"{'Test P&L':<12} {'OOS P&L':<12} {'OOS DD':<10}")
+    print(f"{'-'*100}")
+
+    start_time = datetime.now()
+    rows = []
+    totals = None
+    for fold_result, totals in walk_forward(store, folds, n_threads, strategy=strategy):
+        train_begin, train_end, test_begin, test_end = fold_result['fold']
+        train, test = fold_result['train'], fold_result['test']
+        chosen = ({'sma_period': train['sma_period'], 'std_multiplier': train['std_multiplier']}
+                  if mean_reversion else fold_result['params'] or {})
+        rows.append({
+            'fold': totals['folds'],
+            'train_begin': train_begin, 'train_end': train_end,
+            'test_begin': test_begin, 'test_end': test_end,
+            'selected': fold_result['selected'],
+            **chosen,
+            'train_pnl': train['total_pnl'], 'train_trades': train['total_trades'],
+            'test_pnl': test['total_pnl'], 'test_trades': test['total_trades'],
+            'test_win_rate': test['win_rate'], 'test_max_drawdown': test['max_drawdown'],
+            'oos_pnl': totals['total_pnl'],
+        })
+        if mean_reversion:
+            params = (f"{train['sma_period']:<5} {train['std_multiplier']:<6.2f}" if fold_result['selected']
+                      else f"{'-':<5} {'-':<6}")
+        else:
+            params = f"{_format_params(fold_result['params']):<12}"
+        print(f"{totals['folds']:<6} {f'{train_begin}-{train_end}':<16} {f'{test_begin}-{test_end}':<16} "
+              f"{params} ${train['total_pnl']:<11.2f} ${test['total_pnl']:<11.2f} "
+              f"${totals['total_pnl']:<11.2f} ${totals['max_drawdown']:<9.2f}")
+
+    elapsed = (datetime.now() - start_time).total_seconds()
+    if totals is not None:
+        print(f"\n{'='*60}")
+        print("OUT-OF-SAMPLE SUMMARY")
+        print(f"{'='*60}")
+        print(f"  Total P&L:         ${totals['total_pnl']:.2f}")
+        print(f"  Trades:            {totals['total_trades']} ({totals['win_rate']:.1f}% winners)")
+        print(f"  Profit factor:     {totals['profit_factor']:.2f}")
+        print(f"  Max drawdown:      ${totals['max_drawdown']:.2f}")
+        print(f"  Profitable folds:  {totals['profitable_folds']}/{totals['folds']}")
+        print(f"  Completed in {elapsed:.2f}s")
+    return pd.DataFrame(rows)
 
 
 def find_best_main(dataset="/datasets/btc_data.csv"):
@@ -365,20 +606,22 @@ def find_best_main(dataset="/datasets/btc_data.csv"):
 
     try:
         # Step 1: Split data
-        train_file, validation_file, test_file = split_data(csv_file)
+        train, validation, test = split_data(csv_file)
 
         # Step 2: Optimize parameters on training set
-        optimization_results = optimize_parameters(train_file)
+        optimization_results = optimize_parameters(train)
 
         if not optimization_results:
             print("\nError: No valid results from optimization")
-            cleanup_temp_files(train_file, validation_file, test_file)
             sys.exit(1)
 
-        # Step 3: Validate top parameters on validation and test sets
-        validation_df = validate_parameters(optimization_results, validation_file, test_file, top_n=10)
+        # Step 3: Monte Carlo confidence intervals on the training set
+        robustness_check(train, optimization_results, top_n=20)
 
-        # Step 4: Print final results and recommendations
+        # Step 4: Validate top parameters on validation and test sets
+        validation_df = validate_parameters(optimization_results, validation, test, top_n=10)
+
+        # Step 5: Print final results and recommendations
         print_final_results(validation_df)
 
         # Save results to CSV
@@ -386,31 +629,29 @@ def find_best_main(dataset="/datasets/btc_data.csv"):
         # validation_df.to_csv(output_file, index=False)
         # print(f"Results saved to: {output_file}\n")
 
-        # Cleanup
-        print("\nCleaning up temporary files...")
-        cleanup_temp_files(train_file, validation_file, test_file)
-
         print(f"\nCompleted at: {datetime.now().strftime('%Y-%m-%d %H:%M:%S')}")
         print(f"{'='*60}\n")
 
     except KeyboardInterrupt:
         print("\n\nOptimization interrupted by user")
-        print("\nCleaning up temporary files...")
-        cleanup_temp_files(train_file, validation_file, test_file)
         sys.exit(1)
     except Exception as e:
         print(f"\nError: {e}")
         import traceback
         traceback.print_exc()
-        print("\nCleaning up temporary files...")
-        cleanup_temp_files(train_file, validation_file, test_file)
         sys.exit(1)
 
 
 if __name__ == '__main__':
-    if len(sys.argv) != 2:
-        print("Usage: python find_best.py <csv_file>")
+    if len(sys.argv) not in (2, 3, 4):
+        print("Usage: python find_best.py <csv_file> [walk_forward_folds] [strategy]")
         print("Example: python find_best.py btc_data.csv")
+        print("         python find_best.py btc_data.csv 12")
+        print("         python find_best.py btc_data.csv 12 rsi")
         sys.exit(1)
 
-    find_best_main(sys.argv[1])
+    if len(sys.argv) >= 3:
+        walk_forward_main(sys.argv[1], n_folds=int(sys.argv[2]),
+                          strategy=sys.argv[3] if len(sys.argv) == 4 else 'mean_reversion')
+    else:
+        find_best_main(sys.argv[1])
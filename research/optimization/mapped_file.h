@@ -0,0 +1,72 @@
+// Read-only memory mapping of a whole file, shared by the CSV loader and the
+// binary bar cache.
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bat {
+
+enum LoadStatus { LOAD_OK = 0, LOAD_NOT_FOUND = 1, LOAD_IO_ERROR = 2, LOAD_BAD_HEADER = 3, LOAD_BAD_FORMAT = 4 };
+
+// Read-only mapping of a whole file; empty files map to a null range
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    int open(const std::string& path, std::string& message, bool sequential = true) {
+        close();
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            message = std::strerror(errno);
+            return errno == ENOENT ? LOAD_NOT_FOUND : LOAD_IO_ERROR;
+        }
+        struct stat st;
+        if (fstat(fd_, &st) != 0) {
+            message = std::strerror(errno);
+            close();
+            return LOAD_IO_ERROR;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (addr == MAP_FAILED) {
+                message = std::strerror(errno);
+                close();
+                return LOAD_IO_ERROR;
+            }
+            data_ = static_cast<const char*>(addr);
+            if (sequential) madvise(addr, size_, MADV_SEQUENTIAL);
+        }
+        return LOAD_OK;
+    }
+
+    void close() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+        data_ = nullptr;
+        size_ = 0;
+        fd_ = -1;
+    }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    int fd_ = -1;
+};
+
+}  // namespace bat
@@ -0,0 +1,176 @@
+// Mean reversion (Bollinger-style) state machine shared by execute_strategy
+// and the parameter sweep.
+//
+//   flat:  close < mean - k*std  -> long;  close > mean + k*std -> short
+//   long:  exit when close >= mean
+//   short: exit when close <= mean
+//
+// Windows with mean == 0 or std == 0 are skipped, and drawdown is tracked
+// on realized P&L, exactly as the original Cython loop did. Every bar is also
+// marked to market (realized P&L plus the open position at the close), which
+// gives the intrabar drawdown that realized-only tracking misses.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bar_store.h"
+#include "rolling.h"
+
+namespace bat {
+
+// Mirrors the fields of the TradingState extension type in backtest.pyx
+struct TradingStats {
+    int position = 0;
+    double entry_price = 0.0;
+    double total_pnl = 0.0;
+    double peak_equity = 0.0;
+    double max_drawdown = 0.0;
+    int64_t total_trades = 0;
+    int64_t winning_trades = 0;
+    int64_t losing_trades = 0;
+    double total_wins = 0.0;
+    double total_losses = 0.0;
+    double mtm_peak_equity = 0.0;
+    double mtm_max_drawdown = 0.0;
+};
+
+enum TradeAction { ACTION_BUY = 0, ACTION_SHORT = 1, ACTION_SELL = 2, ACTION_COVER = 3 };
+
+// One entry/exit, recorded only when a caller asks for a trade log
+struct TradeEvent {
+    size_t index;
+    int action;
+    double price;
+    double sma;
+    double band;
+    double entry_price;
+    double pnl;
+};
+
+// Derived metrics, laid out as one row of the sweep result
+struct BacktestMetrics {
+    int sma_period;
+    double std_multiplier;
+    int64_t total_trades;
+    int64_t winning_trades;
+    int64_t losing_trades;
+    double total_pnl;
+    double max_drawdown;
+    double max_drawdown_mtm;
+    double win_rate;
+    double avg_win;
+    double avg_loss;
+    double profit_factor;
+    double expectancy;
+};
+
+inline void close_trade(TradingStats& s, double pnl) {
+    s.total_pnl += pnl;
+    s.total_trades += 1;
+    if (pnl > 0) {
+        s.winning_trades += 1;
+        s.total_wins += pnl;
+    } else {
+        s.losing_trades += 1;
+        s.total_losses += std::fabs(pnl);
+    }
+    s.position = 0;
+}
+
+// Mark the position held into a bar at its close. Called before the bar's
+// action: a trade at the close leaves the marked equity unchanged.
+inline void mark_to_market(TradingStats& s, double price) {
+    const double equity = s.total_pnl + s.position * (price - s.entry_price);
+    if (equity > s.mtm_peak_equity) s.mtm_peak_equity = equity;
+    const double drawdown = s.mtm_peak_equity - equity;
+    if (drawdown > s.mtm_max_drawdown) s.mtm_max_drawdown = drawdown;
+}
+
+// Advance the state machine by one bar with precomputed mean/std
+inline void mean_reversion_step(TradingStats& s, size_t i, double price, double sma, double stdev,
+                                double std_multiplier, std::vector<TradeEvent>* events) {
+    mark_to_market(s, price);
+    if (sma == 0.0 || stdev == 0.0) return;
+
+    const double upper_band = sma + std_multiplier * stdev;
+    const double lower_band = sma - std_multiplier * stdev;
+
+    if (s.position == 0) {
+        if (price < lower_band) {
+            s.position = 1;
+            s.entry_price = price;
+            if (events) events->push_back({i, ACTION_BUY, price, sma, lower_band, price, 0.0});
+        } else if (price > upper_band) {
+            s.position = -1;
+            s.entry_price = price;
+            if (events) events->push_back({i, ACTION_SHORT, price, sma, upper_band, price, 0.0});
+        }
+    } else if (s.position == 1) {
+        if (price >= sma) {
+            const double pnl = price - s.entry_price;
+            close_trade(s, pnl);
+            if (events) events->push_back({i, ACTION_SELL, price, sma, sma, s.entry_price, pnl});
+        }
+    } else if (s.position == -1) {
+        if (price <= sma) {
+            const double pnl = s.entry_price - price;
+            close_trade(s, pnl);
+            if (events) events->push_back({i, ACTION_COVER, price, sma, sma, s.entry_price, pnl});
+        }
+    }
+
+    if (s.total_pnl > s.peak_equity) s.peak_equity = s.total_pnl;
+    const double current_drawdown = s.peak_equity - s.total_pnl;
+    if (current_drawdown > s.max_drawdown) s.max_drawdown = current_drawdown;
+}
+
+// Run the strategy over all bars from index sma_period onwards
+inline void run_mean_reversion(const BarColumns& bars, int sma_period, double std_multiplier,
+                               TradingStats& s, std::vector<TradeEvent>* events = nullptr) {
+    if (sma_period < 1) return;
+    const size_t period = static_cast<size_t>(sma_period);
+    RollingMoments moments(bars.close, bars.size, period);
+    double sma = 0.0, stdev = 0.0;
+    // Start the kernel at the first full window so its re-anchor points match
+    // rolling_mean_std and the sweep sees bit-identical bands
+    for (size_t i = period - 1; i < bars.size; ++i) {
+        moments.advance(i, sma, stdev);
+        if (i >= period) mean_reversion_step(s, i, bars.close[i], sma, stdev, std_multiplier, events);
+    }
+}
+
+inline BacktestMetrics compute_metrics(const TradingStats& s, int sma_period, double std_multiplier) {
+    BacktestMetrics m{};
+    m.sma_period = sma_period;
+    m.std_multiplier = std_multiplier;
+    m.total_trades = s.total_trades;
+    m.winning_trades = s.winning_trades;
+    m.losing_trades = s.losing_trades;
+    m.total_pnl = s.total_pnl;
+    m.max_drawdown = s.max_drawdown;
+    m.max_drawdown_mtm = s.mtm_max_drawdown;
+
+    if (s.total_trades > 0) {
+        const double trades = static_cast<double>(s.total_trades);
+        m.win_rate = s.winning_trades / trades * 100.0;
+        if (s.winning_trades > 0) m.avg_win = s.total_wins / s.winning_trades;
+        if (s.losing_trades > 0) m.avg_loss = s.total_losses / s.losing_trades;
+
+        if (s.winning_trades > 0 && s.losing_trades > 0) {
+            m.profit_factor = s.total_wins / s.total_losses;
+        } else if (s.winning_trades > 0 && s.losing_trades == 0) {
+            m.profit_factor = 999.99;  // Very high value to indicate perfect strategy
+        }
+
+        // Expectancy: (WinRate x AverageWin) - (LossRate x AverageLoss)
+        const double loss_rate = s.losing_trades / trades * 100.0;
+        m.expectancy = (m.win_rate / 100.0 * m.avg_win) - (loss_rate / 100.0 * m.avg_loss);
+    }
+    return m;
+}
+
+}  // namespace bat
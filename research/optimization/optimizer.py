@@ -0,0 +1,588 @@
+#!/usr/bin/env python3
+"""
+Sample-efficient parameter search (successive halving + TPE)
+
+A full grid grows as the product of every parameter's range, which is fine
+for the two mean reversion parameters but not for the 3-parameter
+MovingAverage / MACD / RSI strategies. This module searches a SearchSpace of
+any dimension instead:
+
+    - successive_halving() scores many configurations on a short prefix of
+      the data, keeps the best 1/eta of them, and re-scores the survivors on
+      an eta times longer prefix until the last rung uses all of it.
+    - TPESampler proposes configurations from a Tree-structured Parzen
+      Estimator fitted to the results so far: good and bad observations
+      each get a kernel density per dimension, and the candidate with the
+      best good/bad density ratio is picked.
+    - optimize() runs successive-halving brackets whose starting
+      configurations come from the sampler (as BOHB does), so later
+      brackets start from regions that did well on the full data.
+
+Objectives are batch callables, evaluate(configs, fraction) -> scores,
+higher is better. The fraction is the share of the series each score must
+use. MeanReversionObjective scores batches through the native sweep (one
+sweep call per SMA period in the batch). CompiledStrategyObjective scores
+a strategies/ preset through its compiled port (backtest.sweep_strategy),
+one call per batch; StrategyObjective runs the strategies/ class itself
+through BacktestEngine.
+
+Usage:
+    python optimizer.py <csv_file> [strategy] [n_trials]
+
+    strategy: mean_reversion (default), moving_average, macd, rsi,
+              bollinger_bands or mean_reversion_extreme
+"""
+
+import math
+import random
+import sys
+import os
+from concurrent.futures import ThreadPoolExecutor
+from datetime import datetime
+from typing import Callable, Dict, List, Sequence, Tuple
+
+
+class Int:
+    """Integer parameter in [low, high] (inclusive), optionally log-scaled"""
+
+    def __init__(self, low: int, high: int, log: bool = False):
+        if high < low or (log and low < 1):
+            raise ValueError("invalid integer range")
+        self.low, self.high, self.log = int(low), int(high), log
+
+    def to_unit(self, value) -> float:
+        lo, hi = self._bounds()
+        x = math.log(value) if self.log else float(value)
+        return 0.5 if hi == lo else (x - lo) / (hi - lo)
+
+    def from_unit(self, u: float) -> int:
+        lo, hi = self._bounds()
+        x = lo + min(max(u, 0.0), 1.0) * (hi - lo)
+        value = int(round(math.exp(x) if self.log else x))
+        return min(max(value, self.low), self.high)
+
+    def _bounds(self):
+        # Widen by half a step so every integer gets an equal share of [0, 1]
+        if self.log:
+            return math.log(self.low - 0.5), math.log(self.high + 0.5)
+        return self.low - 0.5, self.high + 0.5
+
+
+class Float:
+    """Real parameter in [low, high], optionally log-scaled or rounded to a step"""
+
+    def __init__(self, low: float, high: float, log: bool = False, step: float = None):
+        if high < low or (log and low <= 0):
+            raise ValueError("invalid float range")
+        self.low, self.high, self.log, self.step = float(low), float(high), log, step
+
+    def to_unit(self, value) -> float:
+        lo, hi = (math.log(self.low), math.log(self.high)) if self.log else (self.low, self.high)
+        x = math.log(value) if self.log else value
+        return 0.5 if hi == lo else (x - lo) / (hi - lo)
+
+    def from_unit(self, u: float) -> float:
+        lo, hi = (math.log(self.low), math.log(self.high)) if self.log else (self.low, self.high)
+        x = lo + min(max(u, 0.0), 1.0) * (hi - lo)
+        value = math.exp(x) if self.log else x
+        if self.step:
+            value = round(round((value - self.low) / self.step) * self.step + self.low, 10)
+        return min(max(value, self.low), self.high)
+
+
+class Choice:
+    """Categorical parameter"""
+
+    def __init__(self, *options):
+        if not options:
+            raise ValueError("Choice needs at least one option")
+        self.options = list(options)
+
+    def to_unit(self, value) -> float:
+        return (self.options.index(value) + 0.5) / len(self.options)
+
+    def from_unit(self, u: float):
+        return self.options[min(int(min(max(u, 0.0), 1.0) * len(self.options)), len(self.options) - 1)]
+
+
+class SearchSpace:
+    """
+    Named parameters plus an optional constraint
+
+    Args:
+        dims: name -> Int / Float / Choice
+        constraint: Optional predicate on a config dict (e.g. fast < slow);
+            configurations that fail it are never proposed
+    """
+
+    def __init__(self, dims: Dict[str, object], constraint: Callable[[Dict], bool] = None):
+        self.dims = dict(dims)
+        self.names = list(self.dims)
+        self.constraint = constraint
+
+    def valid(self, config: Dict) -> bool:
+        return self.constraint is None or bool(self.constraint(config))
+
+    def from_unit(self, point: Sequence[float]) -> Dict:
+        return {name: self.dims[name].from_unit(u) for name, u in zip(self.names, point)}
+
+    def to_unit(self, config: Dict) -> List[float]:
+        return [self.dims[name].to_unit(config[name]) for name in self.names]
+
+    def key(self, config: Dict) -> Tuple:
+        return tuple(config[name] for name in self.names)
+
+    def sample(self, rng: random.Random, max_tries: int = 1000) -> Dict:
+        for _ in range(max_tries):
+            config = self.from_unit([rng.random() for _ in self.names])
+            if self.valid(config):
+                return config
+        raise ValueError("no valid configuration found; check the constraint")
+
+
+class RandomSampler:
+    """Uniform sampling over the space (the TPE start-up phase, and a baseline)"""
+
+    def __init__(self, space: SearchSpace, seed: int = None):
+        self.space = space
+        self.rng = random.Random(seed)
+
+    def suggest(self, history: List[Tuple[Dict, float]]) -> Dict:
+        return self.space.sample(self.rng)
+
+
+class TPESampler:
+    """
+    Tree-structured Parzen Estimator (maximizing)
+
+    The best gamma share of the history forms the good density l(x) and the
+    rest the bad density g(x). Each is a product over dimensions of Gaussian
+    kernels in the unit cube plus a uniform prior component (smoothed option
+    frequencies for Choice dimensions). n_candidates
+    draws from l(x) are scored by log l(x) - log g(x) and the best valid,
+    not yet seen draw is returned.
+
+    Args:
+        space: SearchSpace to sample
+        gamma: Share of observations treated as good
+        n_startup: Random suggestions before the model is used
+        n_candidates: Draws from l(x) compared per suggestion
+        prior_weight: Weight of the uniform component in both densities
+        min_bandwidth: Kernel width floor in the unit cube
+        seed: Random seed
+    """
+
+    def __init__(self, space: SearchSpace, gamma: float = 0.25, n_startup: int = 10, n_candidates: int = 32,
+                 prior_weight: float = 1.0, min_bandwidth: float = 0.1, seed: int = None):
+        self.space = space
+        self.gamma = gamma
+        self.n_startup = n_startup
+        self.n_candidates = n_candidates
+        self.prior_weight = prior_weight
+        self.min_bandwidth = min_bandwidth
+        self.rng = random.Random(seed)
+
+    def suggest(self, history: List[Tuple[Dict, float]]) -> Dict:
+        # Pending suggestions (score None) only count as seen; -inf ranks last
+        scored = [(config, score) for config, score in history if score is not None and score == score]
+        if len(scored) < self.n_startup:
+            return self.space.sample(self.rng)
+
+        scored.sort(key=lambda item: item[1], reverse=True)
+        n_good = max(1, int(math.ceil(self.gamma * len(scored))))
+        good = [self.space.to_unit(config) for config, _ in scored[:n_good]]
+        bad = [self.space.to_unit(config) for config, _ in scored[n_good:]] or good
+        good_bw = self._bandwidths(good)
+        bad_bw = self._bandwidths(bad)
+        seen = {self.space.key(config) for config, _ in history}
+
+        best, best_score = None, -math.inf
+        for _ in range(self.n_candidates):
+            point = self._draw(good, good_bw)
+            config = self.space.from_unit(point)
+            if not self.space.valid(config) or self.space.key(config) in seen:
+                continue
+            point = self.space.to_unit(config)
+            score = self._log_density(point, good, good_bw) - self._log_density(point, bad, bad_bw)
+            if score > best_score:
+                best, best_score = config, score
+        return best if best is not None else self.space.sample(self.rng)
+
+    def _bandwidths(self, points: List[List[float]]) -> List[float]:
+        """Per-dimension Scott's-rule bandwidth, floored so kernels never collapse"""
+        n = len(points)
+        widths = []
+        for d in range(len(self.space.names)):
+            values = [p[d] for p in points]
+            mean = sum(values) / n
+            std = math.sqrt(sum((v - mean) ** 2 for v in values) / n)
+            widths.append(min(max(std * n ** (-1.0 / (len(self.space.names) + 4)), self.min_bandwidth), 1.0))
+        return widths
+
+    def _categorical(self, d: int, points) -> List[float]:
+        """Smoothed option probabilities of a Choice dimension"""
+        options = self.space.dims[self.space.names[d]].options
+        counts = [self.prior_weight / len(options)] * len(options)
+        for p in points:
+            counts[min(int(p[d] * len(options)), len(options) - 1)] += 1.0
+        total = sum(counts)
+        return [c / total for c in counts]
+
+    def _draw(self, points, widths) -> List[float]:
+        # Pick a kernel (or the uniform prior) and sample each dimension around it;
+        # Choice dimensions are drawn from their smoothed option frequencies
+        n = len(points)
+        k = self.rng.random() * (n + self.prior_weight)
+        center = points[int(k)] if k < n else None
+        point = []
+        for d, w in enumerate(widths):
+            if isinstance(self.space.dims[self.space.names[d]], Choice):
+                probs = self._categorical(d, points)
+                option = self.rng.choices(range(len(probs)), weights=probs)[0]
+                point.append((option + 0.5) / len(probs))
+            elif center is None:
+                point.append(self.rng.random())
+            else:
+                point.append(min(max(self.rng.gauss(center[d], w), 0.0), 1.0))
+        return point
+
+    def _log_density(self, point, points, widths) -> float:
+        n = len(points)
+        total = 0.0
+        for d, (x, w) in enumerate(zip(point, widths)):
+            if isinstance(self.space.dims[self.space.names[d]], Choice):
+                probs = self._categorical(d, points)
+                total += math.log(probs[min(int(x * len(probs)), len(probs) - 1)])
+                continue
+            norm = 1.0 / (w * math.sqrt(2 * math.pi))
+            kernel = sum(norm * math.exp(-0.5 * ((x - p[d]) / w) ** 2) for p in points)
+            total += math.log((kernel + self.prior_weight) / (n + self.prior_weight))
+        return total
+
+
+def _rung_fractions(min_fraction: float, eta: int) -> List[float]:
+    """min_fraction, min_fraction * eta, ... capped by a final full-data rung"""
+    fractions = []
+    fraction = min(max(min_fraction, 1e-6), 1.0)
+    while fraction < 1.0:
+        fractions.append(round(fraction, 12))
+        fraction *= eta
+    fractions.append(1.0)
+    return fractions
+
+
+def successive_halving(evaluate, configs: List[Dict], min_fraction: float = 1 / 27, eta: int = 3,
+                       key: Callable[[Dict], Tuple] = None,
+                       cache: Dict = None) -> List[Tuple[float, List[Tuple[Dict, float]]]]:
+    """
+    Score configs on growing prefixes, keeping the best 1/eta at each rung
+
+    Args:
+        evaluate: Batch objective, evaluate(configs, fraction) -> scores
+        configs: Starting configurations
+        min_fraction: Data share of the first rung; each rung multiplies it
+            by eta and the last rung uses all of the data
+        eta: Reduction factor
+        key: Hashable key of a config, for the cache
+        cache: Optional {(key, fraction): score} reused across brackets
+
+    Returns:
+        One (fraction, [(config, score), ...]) per rung, best first
+    """
+    if eta < 2:
+        raise ValueError("eta must be >= 2")
+    key = key or (lambda config: tuple(sorted(config.items())))
+    cache = {} if cache is None else cache
+    fractions = _rung_fractions(min_fraction, eta)
+
+    rungs = []
+    survivors = list(configs)
+    for r, fraction in enumerate(fractions):
+        todo = [c for c in survivors if (key(c), fraction) not in cache]
+        if todo:
+            for config, score in zip(todo, evaluate(todo, fraction)):
+                # Failed or NaN scores rank last
+                cache[(key(config), fraction)] = -math.inf if score is None or score != score else float(score)
+        ranked = sorted(((c, cache[(key(c), fraction)]) for c in survivors), key=lambda item: item[1], reverse=True)
+        rungs.append((fraction, ranked))
+        if r + 1 < len(fractions):
+            survivors = [c for c, _ in ranked[:max(1, len(ranked) // eta)]]
+    return rungs
+
+
+def optimize(evaluate, space: SearchSpace, n_trials: int = 243, sampler: str = 'tpe', eta: int = 3,
+             min_fraction: float = 1 / 27, bracket_size: int = 27, seed: int = None,
+             verbose: bool = True) -> List[Dict]:
+    """
+    Successive-halving brackets seeded by a sampler
+
+    Trials are the configurations started in the first rung, so n_trials
+    bounds the number of short-prefix evaluations; far fewer reach the full
+    data. Before each bracket the sampler is refitted on the full-data
+    results, or on the highest rung that already has enough of them.
+
+    Args:
+        evaluate: Batch objective, evaluate(configs, fraction) -> scores (higher is better)
+        space: SearchSpace
+        n_trials: Configurations to start
+        sampler: 'tpe' or 'random'
+        eta, min_fraction: Successive halving settings
+        bracket_size: Configurations per bracket
+        seed: Random seed
+
+    Returns:
+        Full-data results as dicts (parameters plus 'score'), best first
+    """
+    if sampler == 'tpe':
+        proposer = TPESampler(space, seed=seed)
+    elif sampler == 'random':
+        proposer = RandomSampler(space, seed=seed)
+    else:
+        raise ValueError(f"unknown sampler: {sampler}")
+
+    cache = {}
+    observed: Dict[float, Dict[Tuple, Tuple[Dict, float]]] = {}  # fraction -> key -> (config, score)
+    started = 0
+    bracket = 0
+    start_time = datetime.now()
+
+    while started < n_trials:
+        size = min(bracket_size, n_trials - started)
+        history = _model_history(observed, getattr(proposer, 'n_startup', 0))
+        configs, keys = [], set()
+        for _ in range(size * 4):
+            if len(configs) == size:
+                break
+            # Pending configs count as seen so a bracket does not repeat itself
+            config = proposer.suggest(history + [(c, None) for c in configs])
+            if space.key(config) not in keys:
+                keys.add(space.key(config))
+                configs.append(config)
+        started += size
+        bracket += 1
+
+        rungs = successive_halving(evaluate, configs, min_fraction, eta, key=space.key, cache=cache)
+        for fraction, ranked in rungs:
+            for config, score in ranked:
+                observed.setdefault(fraction, {})[space.key(config)] = (config, score)
+
+        if verbose:
+            best_config, best_score = rungs[-1][1][0]
+            elapsed = (datetime.now() - start_time).total_seconds()
+            print(f"Bracket {bracket}: {started}/{n_trials} trials, bracket best {best_score:.4f} "
+                  f"{_format_config(best_config)} ({elapsed:.1f}s)")
+
+    results = [dict(config, score=score) for config, score in observed.get(1.0, {}).values()]
+    results.sort(key=lambda row: row['score'], reverse=True)
+    return results
+
+
+def _model_history(observed, n_startup: int) -> List[Tuple[Dict, float]]:
+    """Observations of the highest rung with at least n_startup results"""
+    for fraction in sorted(observed, reverse=True):
+        if len(observed[fraction]) >= max(n_startup, 1):
+            return list(observed[fraction].values())
+    # Too few anywhere: hand over the largest rung so seen configs are skipped
+    if observed:
+        return list(max(observed.values(), key=len).values())
+    return []
+
+
+def _format_config(config: Dict) -> str:
+    return ", ".join(f"{name}={value:.4g}" if isinstance(value, float) else f"{name}={value}"
+                     for name, value in config.items())
+
+
+def _prefix_length(n_bars: int, fraction: float, minimum: int) -> int:
+    return min(n_bars, max(int(round(n_bars * fraction)), minimum))
+
+
+class MeanReversionObjective:
+    """
+    Mean reversion P&L through the native sweep (backtest.pyx)
+
+    A batch is grouped by SMA period and each group is one sweep() call on a
+    zero-copy prefix slice of the store, so the rolling mean/std is shared
+    by every multiplier of the period. Configs with no trades score -inf.
+    """
+
+    def __init__(self, store, metric: str = 'total_pnl', min_bars: int = 500, n_threads: int = 0):
+        self.store = store
+        self.metric = metric
+        self.min_bars = min_bars
+        self.n_threads = n_threads
+
+    def space(self) -> SearchSpace:
+        return SearchSpace({'sma_period': Int(1, 200, log=True), 'std_multiplier': Float(0.1, 4.0, step=0.05)})
+
+    def __call__(self, configs: List[Dict], fraction: float) -> List[float]:
+        import backtest
+        prefix = self.store.slice(0, _prefix_length(len(self.store), fraction, self.min_bars))
+        groups: Dict[int, List[int]] = {}
+        for i, config in enumerate(configs):
+            groups.setdefault(int(config['sma_period']), []).append(i)
+
+        scores = [-math.inf] * len(configs)
+        for period, members in groups.items():
+            multipliers = [float(configs[i]['std_multiplier']) for i in members]
+            rows = backtest.sweep(prefix, [period], multipliers, self.n_threads)
+            for i, row in zip(members, rows):
+                if row['total_trades'] > 0:
+                    scores[i] = float(row[self.metric])
+        return scores
+
+
+class CompiledStrategyObjective:
+    """
+    A compiled strategy (backtest.STRATEGIES) scored on a prefix of a BarStore
+
+    The whole batch is one sweep_strategy() call, which evaluates configs
+    sharing an indicator series against one precomputed series. Scores are
+    in price points for one unit, like MeanReversionObjective; configs with
+    no trades score -inf.
+    """
+
+    def __init__(self, store, strategy: str, metric: str = 'total_pnl', long_short: bool = False,
+                 min_bars: int = 500, n_threads: int = 0):
+        self.store = store
+        self.strategy = strategy
+        self.metric = metric
+        self.long_short = long_short
+        self.min_bars = min_bars
+        self.n_threads = n_threads
+
+    def __call__(self, configs: List[Dict], fraction: float) -> List[float]:
+        import backtest
+        prefix = self.store.slice(0, _prefix_length(len(self.store), fraction, self.min_bars))
+        rows = backtest.sweep_strategy(prefix, self.strategy, configs, self.long_short, self.n_threads)
+        return [float(row[self.metric]) if row['total_trades'] > 0 else -math.inf for row in rows]
+
+
+class StrategyObjective:
+    """
+    A strategies/ class scored with BacktestEngine on a prefix of a DataFrame
+
+    Configs with no completed trades score -inf, as in the other objectives,
+    so a config that sits out a losing stretch does not outrank every one
+    that trades.
+
+    Args:
+        df: OHLCV DataFrame with a timestamp column
+        strategy_cls: Strategy class taking the space's parameters as keyword arguments
+        metric: BacktestEngine.analyze_results key to maximize
+        engine_kwargs: BacktestEngine constructor arguments
+        min_bars: Shortest prefix evaluated
+        n_jobs: Threads per batch (the native execution core releases the GIL)
+    """
+
+    def __init__(self, df, strategy_cls, metric: str = 'percent_return', engine_kwargs: Dict = None,
+                 min_bars: int = 500, n_jobs: int = 1):
+        self.df = df
+        self.strategy_cls = strategy_cls
+        self.metric = metric
+        self.engine_kwargs = engine_kwargs or {}
+        self.min_bars = min_bars
+        self.n_jobs = max(1, n_jobs)
+
+    def _score(self, config: Dict, prefix) -> float:
+        from engines.backtest_engine import BacktestEngine
+        try:
+            engine = BacktestEngine(**self.engine_kwargs)
+            analysis = engine.evaluate(prefix, self.strategy_cls(**config))
+            # analyze_results counts closed trades, as total_trades does in the sweep rows
+            return float(analysis[self.metric]) if analysis['num_trades'] > 0 else -math.inf
+        except Exception as e:
+            print(f"  Error evaluating {_format_config(config)}: {e}")
+            return -math.inf
+
+    def __call__(self, configs: List[Dict], fraction: float) -> List[float]:
+        prefix = self.df.iloc[:_prefix_length(len(self.df), fraction, self.min_bars)]
+        if self.n_jobs == 1:
+            return [self._score(config, prefix) for config in configs]
+        with ThreadPoolExecutor(self.n_jobs) as pool:
+            return list(pool.map(lambda config: self._score(config, prefix), configs))
+
+
+def strategy_space(name: str) -> Tuple[type, SearchSpace]:
+    """Strategy class and search space for a strategies/ preset"""
+    if name == 'moving_average':
+        from strategies.moving_average import MovingAverageStrategy
+        return MovingAverageStrategy, SearchSpace(
+            {'short_window': Int(1, 20), 'medium_window': Int(2, 60), 'long_window': Int(5, 250, log=True)},
+            constraint=lambda c: c['short_window'] < c['medium_window'] < c['long_window'])
+    if name == 'macd':
+        from strategies.macd_strategy import MACDStrategy
+        return MACDStrategy, SearchSpace(
+            {'fast': Int(2, 40), 'slow': Int(5, 120, log=True), 'signal': Int(2, 40)},
+            constraint=lambda c: c['fast'] < c['slow'])
+    if name == 'rsi':
+        from strategies.rsi_strategy import RSIStrategy
+        return RSIStrategy, SearchSpace(
+            {'window': Int(2, 60), 'oversold_threshold': Float(5, 45, step=1.0),
+             'overbought_threshold': Float(55, 95, step=1.0)})
+    if name == 'bollinger_bands':
+        from strategies.bollinger_bands_strategy import BollingerBandsStrategy
+        return BollingerBandsStrategy, SearchSpace(
+            {'window': Int(2, 200, log=True), 'num_std': Float(0.5, 4.0, step=0.05)})
+    if name == 'mean_reversion_extreme':
+        from strategies.mean_reversion import MeanReversionExtremeStrategy
+        return MeanReversionExtremeStrategy, SearchSpace(
+            {'window': Int(2, 200, log=True), 'num_std': Float(0.5, 4.0, step=0.05)})
+    raise ValueError(f"unknown strategy preset: {name}")
+
+
+def _compiled_backtest():
+    """The backtest extension when it is built, else None"""
+    try:
+        import backtest
+    except ImportError:
+        return None
+    return backtest
+
+
+def optimizer_main(csv_file: str, strategy: str = 'mean_reversion', n_trials: int = 243,
+                   sampler: str = 'tpe', seed: int = None, compiled: bool = True) -> List[Dict]:
+    """
+    Optimize one strategy on a dataset and print the best full-data configurations
+
+    Presets with a compiled port are scored natively when the backtest
+    extension is built (compiled=False scores them through BacktestEngine).
+    """
+    print(f"\n{'='*60}")
+    print(f"{strategy.upper()} OPTIMIZER (successive halving + {sampler.upper()})")
+    print(f"{'='*60}")
+    print(f"Data file: {csv_file}, trials: {n_trials}\n")
+
+    if strategy == 'mean_reversion':
+        import backtest
+        objective = MeanReversionObjective(backtest.load_bars(csv_file, verbose=False))
+        space = objective.space()
+    elif compiled and _compiled_backtest() is not None and strategy in _compiled_backtest().STRATEGIES:
+        backtest = _compiled_backtest()
+        _, space = strategy_space(strategy)
+        objective = CompiledStrategyObjective(backtest.load_bars(csv_file, verbose=False), strategy)
+    else:
+        import pandas as pd
+        strategy_cls, space = strategy_space(strategy)
+        df = pd.read_csv(csv_file)
+        df.columns = [c if c == 'timestamp' else c.capitalize() for c in df.columns]
+        df['timestamp'] = pd.to_datetime(df['timestamp'])
+        objective = StrategyObjective(df, strategy_cls)
+
+    results = optimize(objective, space, n_trials=n_trials, sampler=sampler, seed=seed)
+    print(f"\nTop {min(10, len(results))} full-data configurations:")
+    for i, row in enumerate(results[:10], 1):
+        params = {name: row[name] for name in space.names}
+        print(f"  {i:<3} score={row['score']:.4f}  {_format_config(params)}")
+    return results
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        print("Usage: python optimizer.py <csv_file> "
+              "[mean_reversion|moving_average|macd|rsi|bollinger_bands|mean_reversion_extreme] [n_trials]")
+        sys.exit(1)
+    # Strategy presets import from the repository root
+    sys.path.insert(0, os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..')))
+    optimizer_main(sys.argv[1], sys.argv[2] if len(sys.argv) > 2 else 'mean_reversion',
+                   int(sys.argv[3]) if len(sys.argv) > 3 else 243)
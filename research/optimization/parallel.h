@@ -0,0 +1,46 @@
+// Minimal thread pool helpers for the native research kernels.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "worker_threads.h"
+
+namespace bat {
+
+inline unsigned resolve_thread_count(unsigned requested, size_t work_items) {
+    unsigned n = requested;
+    if (n == 0) {
+        n = std::thread::hardware_concurrency();
+        if (n == 0) n = 1;
+    }
+    if (work_items < n) n = static_cast<unsigned>(std::max<size_t>(work_items, 1));
+    return n;
+}
+
+// Run fn(item) for item in [0, n_items) across n_threads workers; an
+// exception from fn is rethrown here once every worker has stopped
+template <typename Fn>
+void parallel_for(size_t n_items, unsigned n_threads, Fn&& fn) {
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (;;) {
+            const size_t item = next.fetch_add(1, std::memory_order_relaxed);
+            if (item >= n_items) break;
+            fn(item);
+        }
+    };
+
+    const unsigned n = resolve_thread_count(n_threads, n_items);
+    if (n <= 1) {
+        worker();
+        return;
+    }
+    run_workers(n, worker);  // rethrows a worker's exception after the join
+}
+
+}  // namespace bat
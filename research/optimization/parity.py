@@ -0,0 +1,391 @@
+#!/usr/bin/env python3
+"""
+Parity checks between the native kernels and the code they replace
+
+Runs each kernel and its reference (the two-pass or Python version it
+replaced, or its pure-Python fallback) on a bundled research/datasets file
+and compares the outputs within the tolerance the kernel documents. Exits
+non-zero if any check fails, so it can gate a build.
+
+Groups (--only selects some):
+    rolling     rolling.h mean/std (backtest.rolling_bands) against the
+                two-pass calculate_sma / calculate_std, within 1e-9 * price
+    sweep       backtest.sweep over the find_best.py grid against one
+                execute_strategy run per pair, bit for bit
+    load        backtest.load_csv_data (csv_loader.h) against pandas
+                read_csv with round-trip float parsing, and .bars files
+                written by each of bar_file.h and data_providers/bar_file.py
+                and read by the other, bit for bit
+    indicators  every indicators/technical_indicators function on the
+                native kernels (native/indicators.h) against pandas: price
+                series within 1e-9 * price, RSI within 1e-7 points,
+                candlestick patterns exactly
+    engine      BacktestEngine.backtest on the native execution core
+                (native/execution.h) against its Python bar loop for every
+                strategies/ class in both trading modes, plus forex spread
+                and partial sizing runs: trade frames and per-bar equity
+                within 1e-9 relative (first --bars bars, the Python loop is slow)
+    metrics     for the same runs, analyze_results from the native
+                MetricsAccumulator (native/metrics.h) against the Python
+                loop's PyMetricsAccumulator, and against the trade frame
+                reduction it replaced for the keys that existed before,
+                within 1e-9 relative
+
+Checks whose extension is not built are reported as skipped.
+
+Requirements:
+    - Cython backtest module: python setup.py build_ext --inplace
+    - native/ extensions for the indicator and engine checks
+
+Usage:
+    python parity.py [csv_file] [--only GROUP[,GROUP]] [--bars N]
+"""
+
+import argparse
+import os
+import sys
+import tempfile
+
+import numpy as np
+
+# strategies/, indicators/ and engines/ live at the repository root
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+sys.path.append(REPO_ROOT)
+
+DATASET_DIR = os.path.join(REPO_ROOT, 'research', 'datasets')
+DEFAULT_DATASET = os.path.join(DATASET_DIR, 'X_BTCUSD_minute_2025-01-01_to_2025-09-01.csv')
+GROUPS = ('rolling', 'sweep', 'load', 'indicators', 'engine', 'metrics')
+FIELDS = ('timestamp', 'open', 'high', 'low', 'close', 'volume')
+
+
+class Parity:
+    """Collects check outcomes as flat records keyed by (group, name)"""
+
+    def __init__(self):
+        self.results = []
+
+    def check(self, group: str, name: str, ok: bool, detail: str = ''):
+        self.results.append({'group': group, 'name': name, 'ok': bool(ok), 'detail': detail})
+        print(f"  {group:<10} {name:<44} {'ok' if ok else 'FAILED':<8} {detail}")
+        return ok
+
+    def skip(self, group: str, name: str, reason: str):
+        """Record a check this build cannot run (missing extension or dependency)"""
+        self.results.append({'group': group, 'name': name, 'ok': None, 'detail': reason})
+        print(f"  {group:<10} {name:<44} {'skipped':<8} {reason}")
+
+    def failures(self) -> int:
+        return sum(1 for r in self.results if r['ok'] is False)
+
+
+def max_error(actual, expected, scale=None):
+    """
+    Largest |actual - expected|, relative to scale when given
+
+    NaNs must sit at the same positions in both; a mismatch counts as an
+    infinite error.
+    """
+    actual = np.asarray(actual, dtype=np.float64)
+    expected = np.asarray(expected, dtype=np.float64)
+    if actual.shape != expected.shape:
+        return np.inf
+    nan = np.isnan(expected)
+    if not np.array_equal(np.isnan(actual), nan):
+        return np.inf
+    if nan.all():
+        return 0.0
+    error = np.abs(actual - expected)
+    if scale is not None:
+        error = error / np.maximum(np.abs(np.asarray(scale, dtype=np.float64)), np.finfo(np.float64).tiny)
+    return float(error[~nan].max())
+
+
+def import_backtest():
+    try:
+        import backtest
+        return backtest
+    except ImportError:
+        return None
+
+
+def check_rolling(parity: Parity, csv_file: str):
+    backtest = import_backtest()
+    if backtest is None:
+        parity.skip('rolling', 'rolling_bands', 'backtest extension not built')
+        return
+    store = backtest.load_bars(csv_file, verbose=False)
+    close = np.asarray(store.close)
+    # The tolerance note in rolling.h covers periods up to 1000
+    for period in (2, 20, 100, 1000):
+        mean, std = backtest.rolling_bands(store, period)
+        ref_mean = np.array([backtest.calculate_sma(store, i, period) for i in range(len(store))])
+        ref_std = np.array([backtest.calculate_std(store, i, period, ref_mean[i]) for i in range(len(store))])
+        mean_error = max_error(mean, ref_mean, close)
+        std_error = max_error(std, ref_std, close)
+        parity.check('rolling', f'rolling_bands/period{period}', max(mean_error, std_error) <= 1e-9,
+                     f"mean {mean_error:.2e}, std {std_error:.2e} x price")
+
+
+def check_sweep(parity: Parity, csv_file: str):
+    backtest = import_backtest()
+    if backtest is None:
+        parity.skip('sweep', 'sweep', 'backtest extension not built')
+        return
+    from find_best import parameter_grid
+
+    store = backtest.load_bars(csv_file, verbose=False)
+    sma_periods, std_multipliers = parameter_grid()
+    rows = backtest.sweep(store, sma_periods, std_multipliers)
+    fields = (('total_trades', 'total_trades'), ('winning_trades', 'winning_trades'),
+              ('losing_trades', 'losing_trades'), ('total_pnl', 'total_pnl'),
+              ('max_drawdown', 'max_drawdown'), ('max_drawdown_mtm', 'mtm_max_drawdown'))
+    mismatches = []
+    k = 0
+    for sma_period in sma_periods:
+        for std_multiplier in std_multipliers:
+            state = backtest.TradingState()
+            backtest.execute_strategy(store, state, sma_period, std_multiplier, False)
+            row = rows[k]
+            k += 1
+            if any(row[column] != getattr(state, attr) for column, attr in fields):
+                mismatches.append((sma_period, std_multiplier))
+    detail = f"{len(rows)} pairs" if not mismatches else f"{len(mismatches)} of {len(rows)} differ, first {mismatches[0]}"
+    parity.check('sweep', 'sweep/execute_strategy', not mismatches, detail)
+
+
+def store_columns(store) -> dict:
+    """A BarStore's columns keyed by FIELDS (timestamp as epoch ns)"""
+    return {field: np.asarray(getattr(store, field)) for field in FIELDS}
+
+
+def frame_columns(df) -> dict:
+    """A dataset frame's columns keyed by FIELDS (timestamp as epoch ns)"""
+    import pandas as pd
+    columns = {field: df[field.capitalize()].to_numpy(dtype=np.float64) for field in FIELDS[1:]}
+    columns['timestamp'] = pd.to_datetime(df['timestamp']).to_numpy().astype('datetime64[ns]').view(np.int64)
+    return columns
+
+
+def compare_columns(parity: Parity, name: str, actual: dict, expected: dict):
+    """Check two sets of bar columns bit for bit"""
+    rows, expected_rows = len(actual['close']), len(expected['close'])
+    if rows != expected_rows:
+        parity.check('load', name, False, f"{rows} rows, expected {expected_rows}")
+        return
+    differ = [field for field in FIELDS
+              if not np.array_equal(np.asarray(actual[field]).view(np.int64 if field == 'timestamp' else np.float64),
+                                    expected[field])]
+    parity.check('load', name, not differ, f"{rows} rows" if not differ else f"differ: {', '.join(differ)}")
+
+
+def check_load(parity: Parity, csv_file: str):
+    import pandas as pd
+
+    backtest = import_backtest()
+    if backtest is None:
+        parity.skip('load', 'load_csv_data', 'backtest extension not built')
+        return
+    # from_chars rounds correctly, as does pandas' round-trip parser (not its default fast path)
+    expected = frame_columns(pd.read_csv(csv_file, float_precision='round_trip'))
+    store = backtest.load_csv_data(csv_file, verbose=False)
+    compare_columns(parity, 'load_csv_data/read_csv', store_columns(store), expected)
+
+    from data_providers.bar_file import read_bar_file, write_bar_file
+
+    with tempfile.TemporaryDirectory() as tmp:
+        native_file = os.path.join(tmp, 'native.bars')
+        store.save(native_file)
+        _, columns = read_bar_file(native_file)
+        compare_columns(parity, 'BarStore.save/read_bar_file', columns, expected)
+        del columns  # release the mapping before the directory is removed
+
+        numpy_file = os.path.join(tmp, 'numpy.bars')
+        write_bar_file(numpy_file, *(expected[field] for field in FIELDS))
+        compare_columns(parity, 'write_bar_file/open_bar_file', store_columns(backtest.open_bar_file(numpy_file)),
+                        expected)
+
+
+def load_frame(csv_file: str):
+    from data_providers.bar_file import load_dataset_frame
+    return load_dataset_frame(csv_file).reset_index(drop=True)
+
+
+def check_indicators(parity: Parity, df):
+    from indicators import technical_indicators as ti
+
+    native = ti._native
+    if native is None:
+        parity.skip('indicators', 'technical_indicators', 'native.indicators not built')
+        return
+    close = df['Close']
+    ohlc = (df['Open'], df['High'], df['Low'], df['Close'])
+    # (name, function, tolerance, scale): scale None compares absolute differences
+    cases = (
+        ('sma', lambda: {'sma': ti.sma(close, 20)}, 1e-9, close),
+        ('ema', lambda: {'ema': ti.ema(close, 20)}, 1e-9, close),
+        ('bollinger_bands', lambda: ti.bollinger_bands(close, 20, 2), 1e-9, close),
+        ('rsi', lambda: {'rsi': ti.rsi(close, 14)}, 1e-7, None),
+        ('macd', lambda: ti.macd(close, 12, 26, 9), 1e-9, close),
+    )
+    for name, fn, tolerance, scale in cases:
+        actual = fn()
+        ti._native = None
+        try:
+            expected = fn()
+        finally:
+            ti._native = native
+        errors = {key: max_error(actual[key], expected[key], scale) for key in expected}
+        worst = max(errors, key=errors.get)
+        parity.check('indicators', name, errors[worst] <= tolerance,
+                     f"{worst} {errors[worst]:.2e}{' x price' if scale is not None else ''}")
+
+    for name, fn in (('detect_candlestick_patterns', ti.detect_candlestick_patterns),
+                     ('candlestick_signal_patterns', ti.candlestick_signal_patterns)):
+        actual = fn(*ohlc)
+        ti._native = None
+        try:
+            expected = fn(*ohlc)
+        finally:
+            ti._native = native
+        equal = actual.equals(expected)
+        differ = int((actual != expected).to_numpy().sum()) if not equal and actual.shape == expected.shape else None
+        parity.check('indicators', name, equal, f"{len(df)} bars" if equal else f"{differ} values differ")
+
+
+def compare_frames(actual, expected, rtol: float):
+    """None if two frames match (same columns and order, values within rtol), else the first difference"""
+    from pandas.testing import assert_frame_equal
+    try:
+        assert_frame_equal(actual, expected, check_dtype=False, rtol=rtol, atol=0.0)
+    except AssertionError as e:
+        return str(e).strip().splitlines()[0]
+    return None
+
+
+def engine_cases():
+    """(name, strategy class, BacktestEngine keyword arguments) for the engine checks"""
+    from strategies.bollinger_bands_strategy import BollingerBandsStrategy
+    from strategies.candlestick_strategy import CandlestickPatternsStrategy
+    from strategies.macd_strategy import MACDStrategy
+    from strategies.mean_reversion import MeanReversionExtremeStrategy
+    from strategies.moving_average import MovingAverageStrategy
+    from strategies.rsi_strategy import RSIStrategy
+
+    strategies = (MovingAverageStrategy, MACDStrategy, RSIStrategy, BollingerBandsStrategy,
+                  MeanReversionExtremeStrategy, CandlestickPatternsStrategy)
+    cases = [(f"{cls.__name__}/{mode}", cls, {'trading_mode': mode})
+             for mode in ('long_only', 'long_short') for cls in strategies]
+    # Forex spreads (JPY pairs quote in 0.01 pips) and partial position sizing
+    for symbol in ('C:EURUSD', 'C:USDJPY'):
+        cases.append((f"RSIStrategy/long_short/{symbol}", RSIStrategy,
+                      {'trading_mode': 'long_short', 'symbol': symbol, 'spread_pips': 2.0}))
+    cases.append(("MACDStrategy/long_only/50%", MACDStrategy,
+                  {'trading_mode': 'long_only', 'position_percentage': 50.0}))
+    return cases
+
+
+def engine_runs(df):
+    """
+    Every engine_cases() case run on both paths
+
+    Returns:
+        list of (name, native engine, Python engine, native trades, Python
+        trades), or a reason string when the native path is unavailable
+    """
+    try:
+        from engines.backtest_engine import BacktestEngine, native_execution
+        cases = engine_cases()
+    except ImportError as e:
+        return f'import failed: {e}'
+    if native_execution is None:
+        return 'native.execution not built'
+
+    runs = []
+    for name, cls, options in cases:
+        native = BacktestEngine(use_native=True, **options)
+        python = BacktestEngine(use_native=False, **options)
+        runs.append((name, native, python, native.backtest(df, cls()), python.backtest(df, cls())))
+    return runs
+
+
+def check_engine(parity: Parity, runs):
+    if isinstance(runs, str):
+        parity.skip('engine', 'BacktestEngine.backtest', runs)
+        return
+    for name, native, python, trades, expected in runs:
+        difference = compare_frames(trades, expected, 1e-9)
+        if difference is None:
+            equity_error = max_error(native.equity_curve, python.equity_curve, python.equity_curve)
+            if equity_error > 1e-9:
+                difference = f"equity differs by {equity_error:.2e} relative"
+        parity.check('engine', name, difference is None, difference or f"{len(expected)} trades")
+
+
+def compare_analysis(actual: dict, expected: dict, rtol: float, keys=None):
+    """None if two analyze_results dicts agree on keys (default: all of expected's), else the first difference"""
+    if keys is None and set(actual) != set(expected):
+        return f"keys differ: {sorted(set(actual) ^ set(expected))}"
+    for key in keys if keys is not None else expected:
+        a, b = float(actual[key]), float(expected[key])
+        if np.isnan(a) and np.isnan(b):
+            continue
+        if not abs(a - b) <= rtol * max(1.0, abs(b)):
+            return f"{key}: {a!r} vs {b!r}"
+    return None
+
+
+def check_metrics(parity: Parity, runs):
+    if isinstance(runs, str):
+        parity.skip('metrics', 'analyze_results', runs)
+        return
+    for name, native, python, trades, _ in runs:
+        analysis = native.analyze_results()
+        difference = compare_analysis(analysis, python.analyze_results(), 1e-9)
+        if difference is None:
+            # A frame other than the run's own is reduced column by column, as before the accumulator
+            reduced = native.analyze_results(trades.copy())
+            difference = compare_analysis(analysis, reduced, 1e-9, keys=list(reduced))
+        parity.check('metrics', name, difference is None, difference or f"{analysis['num_trades']} closed trades")
+
+
+def main():
+    parser = argparse.ArgumentParser(usage=__doc__)
+    parser.add_argument('csv_file', nargs='?', default=DEFAULT_DATASET)
+    parser.add_argument('--only', default=','.join(GROUPS))
+    parser.add_argument('--bars', type=int, default=20000, help="bars for the engine and metrics groups (0 = all)")
+    args = parser.parse_args()
+
+    groups = [g.strip() for g in args.only.split(',') if g.strip()]
+    unknown = set(groups) - set(GROUPS)
+    if unknown:
+        parser.error(f"unknown group(s): {', '.join(sorted(unknown))}")
+    if not os.path.exists(args.csv_file):
+        parser.error(f"dataset not found: {args.csv_file}")
+
+    print(f"Parity checks on {args.csv_file}\n")
+    parity = Parity()
+    if 'rolling' in groups:
+        check_rolling(parity, args.csv_file)
+    if 'sweep' in groups:
+        check_sweep(parity, args.csv_file)
+    if 'load' in groups:
+        check_load(parity, args.csv_file)
+    df = load_frame(args.csv_file) if {'indicators', 'engine', 'metrics'} & set(groups) else None
+    if 'indicators' in groups:
+        check_indicators(parity, df)
+    if {'engine', 'metrics'} & set(groups):
+        runs = engine_runs(df.iloc[:args.bars].reset_index(drop=True) if args.bars > 0 else df)
+        if 'engine' in groups:
+            check_engine(parity, runs)
+        if 'metrics' in groups:
+            check_metrics(parity, runs)
+
+    failures = parity.failures()
+    skipped = sum(1 for r in parity.results if r['ok'] is None)
+    print(f"\n{len(parity.results) - failures - skipped} passed, {failures} failed, {skipped} skipped")
+    if failures:
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,123 @@
+// O(1)-per-bar rolling mean and population standard deviation.
+//
+// The window sums are kept relative to an anchor value close to the data
+// (sum of x - anchor and of (x - anchor)^2), which avoids the catastrophic
+// cancellation of naive sum / sum-of-squares on prices around 1e5. Every
+// REANCHOR_INTERVAL bars both sums are recomputed exactly over the window
+// around a fresh anchor, so rounding drift cannot accumulate across a long
+// series. Re-anchoring costs O(period), i.e. O(period / REANCHOR_INTERVAL)
+// amortized per bar.
+//
+// Tolerance: against the two-pass reference (calculate_sma / calculate_std in
+// backtest.pyx) the mean and std agree to within 1e-9 * |price| for periods up
+// to 1000, so signals only differ for prices within that distance of a band
+// or of the mean. With tick-rounded prices, closes that sit exactly on the
+// window mean are common and those exits can flip either way, so trade counts
+// may differ from the reference by a fraction of a percent.
+// Windows whose values are all identical return std == 0.0 exactly (and the
+// exact mean), matching the reference's "flat window" skip.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace bat {
+
+class RollingMoments {
+public:
+    static constexpr size_t REANCHOR_INTERVAL = 1024;
+
+    RollingMoments() = default;
+    RollingMoments(const double* values, size_t size, size_t period) { reset(values, size, period); }
+
+    void reset(const double* values, size_t size, size_t period) {
+        x_ = values;
+        n_ = size;
+        period_ = period;
+        initialized_ = false;
+    }
+
+    // Compute mean/std of the window ending at index i. Consecutive indices
+    // are O(1); any other jump re-anchors the window in O(period).
+    bool advance(size_t i, double& mean, double& stdev) {
+        if (period_ == 0 || i + 1 < period_ || i >= n_) {
+            mean = 0.0;
+            stdev = 0.0;
+            return false;
+        }
+
+        // Length of the run of identical values ending at i
+        if (i > 0 && x_[i] == x_[i - 1]) {
+            ++equal_run_;
+        } else {
+            equal_run_ = 1;
+        }
+
+        if (!initialized_ || i != last_ + 1 || since_anchor_ >= REANCHOR_INTERVAL) {
+            reanchor(i);
+        } else {
+            const double d_in = x_[i] - anchor_;
+            const double d_out = x_[i - period_] - anchor_;
+            sum_ += d_in - d_out;
+            sum_sq_ += d_in * d_in - d_out * d_out;
+            ++since_anchor_;
+        }
+        last_ = i;
+
+        if (equal_run_ >= period_) {
+            mean = x_[i];
+            stdev = 0.0;
+            return true;
+        }
+
+        const double p = static_cast<double>(period_);
+        const double m = sum_ / p;
+        double var = sum_sq_ / p - m * m;
+        if (var < 0.0) var = 0.0;
+        mean = anchor_ + m;
+        stdev = std::sqrt(var);
+        return true;
+    }
+
+private:
+    void reanchor(size_t i) {
+        const size_t start = i + 1 - period_;
+        anchor_ = x_[i];
+        sum_ = 0.0;
+        sum_sq_ = 0.0;
+        for (size_t j = start; j <= i; ++j) {
+            const double d = x_[j] - anchor_;
+            sum_ += d;
+            sum_sq_ += d * d;
+        }
+        if (!initialized_ || i != last_ + 1) {
+            // Rebuild the equal-value run when jumping into the series
+            equal_run_ = 1;
+            while (equal_run_ <= i && equal_run_ < period_ && x_[i - equal_run_] == x_[i]) ++equal_run_;
+        }
+        since_anchor_ = 0;
+        initialized_ = true;
+    }
+
+    const double* x_ = nullptr;
+    size_t n_ = 0;
+    size_t period_ = 0;
+    double anchor_ = 0.0;
+    double sum_ = 0.0;
+    double sum_sq_ = 0.0;
+    size_t since_anchor_ = 0;
+    size_t equal_run_ = 0;
+    size_t last_ = 0;
+    bool initialized_ = false;
+};
+
+// Fill mean[i] / stdev[i] for every bar; bars before the first full window get 0.0
+inline void rolling_mean_std(const double* values, size_t size, size_t period, double* mean, double* stdev) {
+    RollingMoments moments(values, size, period);
+    for (size_t i = 0; i < size; ++i) {
+        moments.advance(i, mean[i], stdev[i]);
+    }
+}
+
+}  // namespace bat
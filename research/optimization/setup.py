@@ -6,8 +6,11 @@ extensions = [
     Extension(
         "backtest",
         ["backtest.pyx"],
-        include_dirs=[np.get_include()],
-        extra_compile_args=["-O3"],
+        # strategy.h reuses the indicator kernels in native/
+        include_dirs=[np.get_include(), ".", "../../native"],
+        extra_compile_args=["-O3", "-std=c++17", "-pthread", "-fopenmp-simd"],
+        extra_link_args=["-pthread"],
+        define_macros=[("NPY_NO_DEPRECATED_API", "NPY_1_7_API_VERSION")],
     )
 ]
 
@@ -0,0 +1,407 @@
+// Compiled signal strategies for the sweep and walk-forward engines.
+//
+// The strategies/ classes all reduce to per-bar buy / sell signals that
+// BacktestEngine turns into positions. Here each one is a signal functor
+// that precomputes its indicator series once (prepare) and answers the
+// signal for one bar (at). run_signals<S> is the one state machine they
+// share, so it is compiled once per functor type with the signal test
+// inlined into the bar loop.
+//
+// A functor S provides:
+//   static constexpr size_t n_params            parameter row width
+//   static constexpr size_t n_indicator_params  leading params the
+//                                               indicator series depends on
+//   static bool valid(const double* p)
+//   static size_t warmup(const double* p)       bars the indicators need
+//                                               before their first signal
+//   void prepare(const BarColumns& bars, const double* p)
+//   Signal at(size_t i, const double* p) const
+//
+// Indicators come from native/indicators.h, the kernels behind
+// indicators/technical_indicators.py, so signals match the Python classes
+// bar for bar. A sweep groups parameter rows by their indicator params and
+// prepares each group once: RSI thresholds, band multipliers and the like
+// reuse one series.
+//
+// Positions are one unit and P&L is in price points, the same accounting as
+// the mean reversion engine (TradingStats, drawdown on realized and on
+// mark-to-market P&L), with
+// BacktestEngine's rules: bar 0 only seeds the indicators, long_only buys
+// when flat and sells when long, long_short reverses on the opposite signal.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "bar_store.h"
+#include "indicators.h"
+#include "mean_reversion.h"
+#include "parallel.h"
+#include "walk_forward.h"
+
+namespace bat {
+
+struct Signal {
+    bool buy;
+    bool sell;
+};
+
+// One bar of the shared position state machine
+inline void signal_step(TradingStats& s, double price, Signal signal, bool long_short) {
+    mark_to_market(s, price);
+    if (long_short) {
+        if (signal.buy && s.position != 1) {
+            if (s.position == -1) close_trade(s, s.entry_price - price);
+            s.position = 1;
+            s.entry_price = price;
+        } else if (signal.sell && s.position != -1) {
+            if (s.position == 1) close_trade(s, price - s.entry_price);
+            s.position = -1;
+            s.entry_price = price;
+        }
+    } else if (signal.buy && s.position == 0) {
+        s.position = 1;
+        s.entry_price = price;
+    } else if (signal.sell && s.position == 1) {
+        close_trade(s, price - s.entry_price);
+    }
+
+    if (s.total_pnl > s.peak_equity) s.peak_equity = s.total_pnl;
+    const double current_drawdown = s.peak_equity - s.total_pnl;
+    if (current_drawdown > s.max_drawdown) s.max_drawdown = current_drawdown;
+}
+
+// Run a prepared functor over bars [first, n), also tracking the lowest
+// realized P&L; the bars before first only seed the indicators
+template <typename S>
+TradingStats run_signals(const S& signals, const BarColumns& bars, const double* params, bool long_short,
+                         double* min_equity = nullptr, size_t first = 1) {
+    TradingStats s;
+    double lowest = 0.0;
+    for (size_t i = first; i < bars.size; ++i) {
+        signal_step(s, bars.close[i], signals.at(i, params), long_short);
+        if (s.total_pnl < lowest) lowest = s.total_pnl;
+    }
+    if (min_equity) *min_equity = lowest;
+    return s;
+}
+
+inline size_t window_param(double p) { return static_cast<size_t>(p); }
+inline bool valid_window(double p) { return p >= 1.0; }
+
+// MovingAverageStrategy: buy on the transition to short > medium > long,
+// sell on the transition to short < medium < long
+struct MovingAverageSignals {
+    static constexpr size_t n_params = 3;  // short_window, medium_window, long_window
+    static constexpr size_t n_indicator_params = 3;
+
+    std::vector<double> short_ma, medium_ma, long_ma;
+
+    static bool valid(const double* p) { return valid_window(p[0]) && valid_window(p[1]) && valid_window(p[2]); }
+    static size_t warmup(const double* p) {
+        return std::max({window_param(p[0]), window_param(p[1]), window_param(p[2])});
+    }
+
+    void prepare(const BarColumns& bars, const double* p) {
+        short_ma.resize(bars.size);
+        medium_ma.resize(bars.size);
+        long_ma.resize(bars.size);
+        rolling_mean(bars.close, bars.size, window_param(p[0]), short_ma.data());
+        rolling_mean(bars.close, bars.size, window_param(p[1]), medium_ma.data());
+        rolling_mean(bars.close, bars.size, window_param(p[2]), long_ma.data());
+    }
+
+    bool bullish(size_t i) const { return short_ma[i] > medium_ma[i] && medium_ma[i] > long_ma[i]; }
+    bool bearish(size_t i) const { return short_ma[i] < medium_ma[i] && medium_ma[i] < long_ma[i]; }
+
+    Signal at(size_t i, const double*) const {
+        return {bullish(i) && !(i > 0 && bullish(i - 1)), bearish(i) && !(i > 0 && bearish(i - 1))};
+    }
+};
+
+// RSIStrategy: buy below the oversold threshold, sell above the overbought one
+struct RsiSignals {
+    static constexpr size_t n_params = 3;  // window, oversold_threshold, overbought_threshold
+    static constexpr size_t n_indicator_params = 1;
+
+    std::vector<double> rsi_values;
+
+    static bool valid(const double* p) { return valid_window(p[0]); }
+    static size_t warmup(const double* p) { return window_param(p[0]); }
+
+    void prepare(const BarColumns& bars, const double* p) {
+        rsi_values.resize(bars.size);
+        rsi(bars.close, bars.size, window_param(p[0]), rsi_values.data());
+    }
+
+    Signal at(size_t i, const double* p) const { return {rsi_values[i] < p[1], rsi_values[i] > p[2]}; }
+};
+
+// MACDStrategy: buy when the MACD line crosses above the signal line, sell
+// when it crosses below
+struct MacdSignals {
+    static constexpr size_t n_params = 3;  // fast, slow, signal
+    static constexpr size_t n_indicator_params = 3;
+
+    std::vector<double> line, signal_line, histogram;
+
+    static bool valid(const double* p) { return valid_window(p[0]) && valid_window(p[1]) && valid_window(p[2]); }
+    // EMAs never fully forget their seed; slow + signal spans is where the
+    // signal line has settled
+    static size_t warmup(const double* p) {
+        return std::max(window_param(p[0]), window_param(p[1])) + window_param(p[2]);
+    }
+
+    void prepare(const BarColumns& bars, const double* p) {
+        line.resize(bars.size);
+        signal_line.resize(bars.size);
+        histogram.resize(bars.size);
+        macd(bars.close, bars.size, p[0], p[1], p[2], line.data(), signal_line.data(), histogram.data());
+    }
+
+    Signal at(size_t i, const double*) const {
+        // The first bar has no previous values, as with shift(1) in pandas
+        const double prev_line = i ? line[i - 1] : INDICATOR_NAN;
+        const double prev_signal = i ? signal_line[i - 1] : INDICATOR_NAN;
+        return {line[i] > signal_line[i] && prev_line <= prev_signal,
+                line[i] < signal_line[i] && prev_line >= prev_signal};
+    }
+};
+
+// Band strategies: BollingerBandsStrategy touches the bands (<= / >=),
+// MeanReversionExtremeStrategy needs a close beyond them (< / >). The
+// multiplier only scales the bands, so the series is the rolling mean and
+// std (the bollinger() loop) and every num_std of a window shares it.
+template <bool Inclusive>
+struct BandSignals {
+    static constexpr size_t n_params = 2;  // window, num_std
+    static constexpr size_t n_indicator_params = 1;
+
+    std::vector<double> middle, stdev;
+    const double* closes = nullptr;
+
+    static bool valid(const double* p) { return valid_window(p[0]); }
+    static size_t warmup(const double* p) { return window_param(p[0]); }
+
+    void prepare(const BarColumns& bars, const double* p) {
+        const size_t window = window_param(p[0]);
+        middle.resize(bars.size);
+        stdev.resize(bars.size);
+        RollingMean mean;
+        RollingVariance var;
+        for (size_t i = 0; i < bars.size; ++i) {
+            if (i >= window) {
+                mean.remove(bars.close[i - window]);
+                var.remove(bars.close[i - window]);
+            }
+            mean.add(bars.close[i]);
+            var.add(bars.close[i]);
+            middle[i] = mean.value(window);
+            stdev[i] = std::sqrt(var.value(window, 1));
+        }
+        closes = bars.close;
+    }
+
+    Signal at(size_t i, const double* p) const {
+        const double close = closes[i];
+        const double upper = middle[i] + stdev[i] * p[1];
+        const double lower = middle[i] - stdev[i] * p[1];
+        if (Inclusive) return {close <= lower, close >= upper};
+        return {close < lower, close > upper};
+    }
+};
+
+using BollingerSignals = BandSignals<true>;
+using MeanReversionExtremeSignals = BandSignals<false>;
+
+// CandlestickPatternsStrategy (candlestick_signal_patterns in
+// technical_indicators.py): buy on a hammer or a bullish engulfing bar, sell
+// on a shooting star, a hanging man (a hammer shape after a rising close) or
+// a bearish engulfing bar
+struct CandlestickSignals {
+    static constexpr size_t n_params = 0;
+    static constexpr size_t n_indicator_params = 0;
+
+    std::vector<int8_t> buy, sell;
+
+    static bool valid(const double*) { return true; }
+    static size_t warmup(const double*) { return 2; }  // engulfing and hanging man look two bars back
+
+    void prepare(const BarColumns& bars, const double*) {
+        std::vector<int8_t> shape(bars.size);
+        candlestick_patterns(bars.open, bars.high, bars.low, bars.close, bars.size, shape.data());
+        buy.assign(bars.size, 0);
+        sell.assign(bars.size, 0);
+        const double* o = bars.open;
+        const double* c = bars.close;
+        for (size_t i = 0; i < bars.size; ++i) {
+            const bool rising = i >= 2 && c[i - 1] > c[i - 2];
+            const bool hammer_shape = shape[i] == PATTERN_HAMMER;
+            bool bullish_engulfing = false, bearish_engulfing = false;
+            if (i >= 1) {
+                bullish_engulfing = c[i - 1] < o[i - 1] && c[i] > o[i] && o[i] <= c[i - 1] && c[i] >= o[i - 1];
+                bearish_engulfing = c[i - 1] > o[i - 1] && c[i] < o[i] && o[i] >= c[i - 1] && c[i] <= o[i - 1];
+            }
+            buy[i] = (hammer_shape && !rising) || bullish_engulfing;
+            sell[i] = shape[i] == PATTERN_SHOOTING_STAR || (hammer_shape && rising) || bearish_engulfing;
+        }
+    }
+
+    Signal at(size_t i, const double*) const { return {buy[i] != 0, sell[i] != 0}; }
+};
+
+// Parameter rows grouped by their indicator params, each group as a list of
+// row indices; rows keep their input order within a group
+template <typename S>
+std::vector<std::vector<size_t>> indicator_groups(const double* params, size_t n_rows) {
+    std::vector<size_t> order(n_rows);
+    for (size_t r = 0; r < n_rows; ++r) order[r] = r;
+    auto key_less = [params](size_t a, size_t b) {
+        return std::lexicographical_compare(params + a * S::n_params, params + a * S::n_params + S::n_indicator_params,
+                                            params + b * S::n_params, params + b * S::n_params + S::n_indicator_params);
+    };
+    std::stable_sort(order.begin(), order.end(), key_less);
+
+    std::vector<std::vector<size_t>> groups;
+    for (size_t k = 0; k < n_rows; ++k) {
+        if (groups.empty() || key_less(groups.back().front(), order[k])) groups.emplace_back();
+        groups.back().push_back(order[k]);
+    }
+    return groups;
+}
+
+template <typename S>
+void check_params(const double* params, size_t n_rows) {
+    for (size_t r = 0; r < n_rows; ++r) {
+        if (!S::valid(params + r * S::n_params)) throw std::invalid_argument("invalid strategy parameters");
+    }
+}
+
+// Evaluate every parameter row (n_rows * S::n_params values, row-major);
+// out[r] is row r's metrics. One task per indicator group.
+template <typename S>
+void sweep_signals(const BarColumns& bars, const double* params, size_t n_rows, bool long_short,
+                   BacktestMetrics* out, unsigned n_threads) {
+    check_params<S>(params, n_rows);
+    const std::vector<std::vector<size_t>> groups = indicator_groups<S>(params, n_rows);
+    parallel_for(groups.size(), n_threads, [&](size_t g) {
+        S signals;
+        signals.prepare(bars, params + groups[g].front() * S::n_params);
+        for (const size_t r : groups[g]) {
+            out[r] = compute_metrics(run_signals(signals, bars, params + r * S::n_params, long_short), 0, 0.0);
+        }
+    });
+}
+
+// Walk-forward over any functor, with the selection rule of walk_forward():
+// each fold keeps the train row with the best P&L among rows that traded and
+// runs it on the test range, its indicators warmed on the S::warmup bars
+// before test_begin. Phase 1 is one task per (fold, indicator group).
+// train_grid, when not null, receives n_folds * n_rows rows, fold-major.
+template <typename S>
+void walk_forward_signals(const BarColumns& bars, const WalkForwardFold* folds, size_t n_folds,
+                          const double* params, size_t n_rows, bool long_short, WalkForwardResult* out,
+                          BacktestMetrics* train_grid, unsigned n_threads) {
+    if (n_folds == 0) return;
+    check_params<S>(params, n_rows);
+    const std::vector<std::vector<size_t>> groups = indicator_groups<S>(params, n_rows);
+    std::vector<BacktestMetrics> local_grid;
+    BacktestMetrics* grid = train_grid;
+    if (grid == nullptr) {
+        local_grid.resize(n_folds * n_rows);
+        grid = local_grid.data();
+    }
+
+    const size_t n_groups = groups.size();
+    parallel_for(n_folds * n_groups, n_threads, [&](size_t task) {
+        const size_t f = task / n_groups;
+        const std::vector<size_t>& group = groups[task % n_groups];
+        const BarColumns train = bars.slice(folds[f].train_begin, folds[f].train_end);
+        S signals;
+        signals.prepare(train, params + group.front() * S::n_params);
+        for (const size_t r : group) {
+            grid[f * n_rows + r] = compute_metrics(run_signals(signals, train, params + r * S::n_params, long_short),
+                                                   0, 0.0);
+        }
+    });
+
+    parallel_for(n_folds, n_threads, [&](size_t f) {
+        const BacktestMetrics* rows = grid + f * n_rows;
+        WalkForwardResult& result = out[f];
+        result = WalkForwardResult{};
+        size_t best = n_rows;
+        for (size_t r = 0; r < n_rows; ++r) {
+            if (rows[r].total_trades > 0 && (best == n_rows || rows[r].total_pnl > rows[best].total_pnl)) best = r;
+        }
+        if (best == n_rows) {
+            result.train = compute_metrics(TradingStats(), 0, 0.0);
+            result.test = result.train;
+            return;
+        }
+        result.selected = 1;
+        result.row = best;
+        result.train = rows[best];
+
+        const double* p = params + best * S::n_params;
+        const size_t warm = std::min(folds[f].test_begin, S::warmup(p));
+        const BarColumns test = bars.slice(folds[f].test_begin - warm, folds[f].test_end);
+        S signals;
+        signals.prepare(test, p);
+        const TradingStats s = run_signals(signals, test, p, long_short, &result.test_min_equity,
+                                           std::max<size_t>(warm, 1));
+        result.test = compute_metrics(s, 0, 0.0);
+        result.test_peak_equity = s.peak_equity;
+    });
+}
+
+// Registry: every compiled strategy by id, for callers that pick one at run time
+enum StrategyKind {
+    STRATEGY_MOVING_AVERAGE = 0,
+    STRATEGY_RSI = 1,
+    STRATEGY_MACD = 2,
+    STRATEGY_BOLLINGER_BANDS = 3,
+    STRATEGY_MEAN_REVERSION_EXTREME = 4,
+    STRATEGY_CANDLESTICK = 5,
+};
+
+template <typename Fn>
+void dispatch_strategy(int kind, Fn&& fn) {
+    switch (kind) {
+        case STRATEGY_MOVING_AVERAGE: fn(MovingAverageSignals()); break;
+        case STRATEGY_RSI: fn(RsiSignals()); break;
+        case STRATEGY_MACD: fn(MacdSignals()); break;
+        case STRATEGY_BOLLINGER_BANDS: fn(BollingerSignals()); break;
+        case STRATEGY_MEAN_REVERSION_EXTREME: fn(MeanReversionExtremeSignals()); break;
+        case STRATEGY_CANDLESTICK: fn(CandlestickSignals()); break;
+        default: throw std::invalid_argument("unknown strategy");
+    }
+}
+
+inline size_t strategy_param_count(int kind) {
+    size_t n = 0;
+    dispatch_strategy(kind, [&](auto tag) { n = decltype(tag)::n_params; });
+    return n;
+}
+
+inline void sweep_strategy(int kind, const BarColumns& bars, const double* params, size_t n_rows, bool long_short,
+                           BacktestMetrics* out, unsigned n_threads) {
+    dispatch_strategy(kind, [&](auto tag) {
+        sweep_signals<decltype(tag)>(bars, params, n_rows, long_short, out, n_threads);
+    });
+}
+
+inline void walk_forward_strategy(int kind, const BarColumns& bars, const WalkForwardFold* folds, size_t n_folds,
+                                  const double* params, size_t n_rows, bool long_short, WalkForwardResult* out,
+                                  BacktestMetrics* train_grid, unsigned n_threads) {
+    dispatch_strategy(kind, [&](auto tag) {
+        walk_forward_signals<decltype(tag)>(bars, folds, n_folds, params, n_rows, long_short, out, train_grid,
+                                            n_threads);
+    });
+}
+
+}  // namespace bat
@@ -0,0 +1,167 @@
+// Multithreaded (sma_period, std_multiplier) grid search over one bar store.
+//
+// Workers pull periods from a shared atomic counter (parallel.h), so uneven
+// task costs balance out without a scheduler. Every worker only reads the
+// shared bar columns and writes its own output rows, so no locking is needed.
+//
+// Indicators are shared across multipliers: for a given period the rolling
+// mean/std series (rolling.h) is computed once and every multiplier is then
+// evaluated against it. Prefix sums would give all periods in one pass, but
+// on prices around 1e5 the differenced sums of squares lose too many digits
+// for small windows, while the anchored rolling kernel is already O(N) per
+// period.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "bar_store.h"
+#include "mean_reversion.h"
+#include "parallel.h"
+#include "rolling.h"
+
+namespace bat {
+
+// Per-multiplier strategy state, stored as one array per field so the
+// multiplier loop in sweep_period maps onto SIMD lanes. Counters are kept as
+// doubles to share the lane width of the price fields.
+struct MultiplierLanes {
+    explicit MultiplierLanes(size_t n)
+        : position(n, 0.0), entry_price(n, 0.0), total_pnl(n, 0.0), peak_equity(n, 0.0),
+          max_drawdown(n, 0.0), total_trades(n, 0.0), winning_trades(n, 0.0),
+          losing_trades(n, 0.0), total_wins(n, 0.0), total_losses(n, 0.0), mtm_peak_equity(n, 0.0),
+          mtm_max_drawdown(n, 0.0) {}
+
+    std::vector<double> position;
+    std::vector<double> entry_price;
+    std::vector<double> total_pnl;
+    std::vector<double> peak_equity;
+    std::vector<double> max_drawdown;
+    std::vector<double> total_trades;
+    std::vector<double> winning_trades;
+    std::vector<double> losing_trades;
+    std::vector<double> total_wins;
+    std::vector<double> total_losses;
+    std::vector<double> mtm_peak_equity;
+    std::vector<double> mtm_max_drawdown;
+
+    TradingStats stats(size_t lane) const {
+        TradingStats s;
+        s.position = static_cast<int>(position[lane]);
+        s.entry_price = entry_price[lane];
+        s.total_pnl = total_pnl[lane];
+        s.peak_equity = peak_equity[lane];
+        s.max_drawdown = max_drawdown[lane];
+        s.total_trades = static_cast<int64_t>(total_trades[lane]);
+        s.winning_trades = static_cast<int64_t>(winning_trades[lane]);
+        s.losing_trades = static_cast<int64_t>(losing_trades[lane]);
+        s.total_wins = total_wins[lane];
+        s.total_losses = total_losses[lane];
+        s.mtm_peak_equity = mtm_peak_equity[lane];
+        s.mtm_max_drawdown = mtm_max_drawdown[lane];
+        return s;
+    }
+};
+
+// Evaluate every multiplier for one period against a shared mean/std series.
+// This is mean_reversion_step written branch-free across lanes; each lane
+// performs the same floating point operations as the scalar version, so the
+// results are identical to running the multipliers one at a time.
+inline void sweep_period(const BarColumns& bars, int sma_period, const double* mean, const double* stdev,
+                         const double* multipliers, size_t n_multipliers, BacktestMetrics* out) {
+    MultiplierLanes lanes(n_multipliers);
+    double* __restrict position = lanes.position.data();
+    double* __restrict entry_price = lanes.entry_price.data();
+    double* __restrict total_pnl = lanes.total_pnl.data();
+    double* __restrict peak_equity = lanes.peak_equity.data();
+    double* __restrict max_drawdown = lanes.max_drawdown.data();
+    double* __restrict total_trades = lanes.total_trades.data();
+    double* __restrict winning_trades = lanes.winning_trades.data();
+    double* __restrict losing_trades = lanes.losing_trades.data();
+    double* __restrict total_wins = lanes.total_wins.data();
+    double* __restrict total_losses = lanes.total_losses.data();
+    double* __restrict mtm_peak_equity = lanes.mtm_peak_equity.data();
+    double* __restrict mtm_max_drawdown = lanes.mtm_max_drawdown.data();
+
+    for (size_t i = static_cast<size_t>(sma_period); i < bars.size; ++i) {
+        const double sma = mean[i];
+        const double sd = stdev[i];
+        const double price = bars.close[i];
+
+        // mark_to_market: every bar, before the skip and the bar's action
+#pragma omp simd
+        for (size_t m = 0; m < n_multipliers; ++m) {
+            const double equity = total_pnl[m] + position[m] * (price - entry_price[m]);
+            const double peak = equity > mtm_peak_equity[m] ? equity : mtm_peak_equity[m];
+            mtm_peak_equity[m] = peak;
+            const double drawdown = peak - equity;
+            mtm_max_drawdown[m] = drawdown > mtm_max_drawdown[m] ? drawdown : mtm_max_drawdown[m];
+        }
+        if (sma == 0.0 || sd == 0.0) continue;
+
+#pragma omp simd
+        for (size_t m = 0; m < n_multipliers; ++m) {
+            const double pos = position[m];
+            const double entry = entry_price[m];
+            const double lower_band = sma - multipliers[m] * sd;
+            const double upper_band = sma + multipliers[m] * sd;
+
+            const bool flat = pos == 0.0;
+            const bool go_long = flat && price < lower_band;
+            const bool go_short = flat && !(price < lower_band) && price > upper_band;
+            const bool exit_long = pos == 1.0 && price >= sma;
+            const bool exit_short = pos == -1.0 && price <= sma;
+            const bool closed = exit_long || exit_short;
+
+            const double pnl = exit_long ? price - entry : (exit_short ? entry - price : 0.0);
+            const bool win = closed && pnl > 0;
+            const bool loss = closed && !(pnl > 0);
+
+            const double pnl_total = total_pnl[m] + pnl;
+            total_pnl[m] = pnl_total;
+            total_trades[m] += closed ? 1.0 : 0.0;
+            winning_trades[m] += win ? 1.0 : 0.0;
+            losing_trades[m] += loss ? 1.0 : 0.0;
+            total_wins[m] += win ? pnl : 0.0;
+            total_losses[m] += loss ? std::fabs(pnl) : 0.0;
+
+            entry_price[m] = (go_long || go_short) ? price : entry;
+            position[m] = go_long ? 1.0 : (go_short ? -1.0 : (closed ? 0.0 : pos));
+
+            const double peak = pnl_total > peak_equity[m] ? pnl_total : peak_equity[m];
+            peak_equity[m] = peak;
+            const double drawdown = peak - pnl_total;
+            max_drawdown[m] = drawdown > max_drawdown[m] ? drawdown : max_drawdown[m];
+        }
+    }
+
+    for (size_t m = 0; m < n_multipliers; ++m) {
+        out[m] = compute_metrics(lanes.stats(m), sma_period, multipliers[m]);
+    }
+}
+
+// out must hold n_periods * n_multipliers rows, ordered period-major. Work is
+// split by period: each task computes the rolling mean/std series once and
+// evaluates all multipliers against it.
+inline void sweep_grid(const BarColumns& bars, const int* periods, size_t n_periods,
+                       const double* multipliers, size_t n_multipliers,
+                       BacktestMetrics* out, unsigned n_threads) {
+    if (n_periods == 0 || n_multipliers == 0) return;
+    parallel_for(n_periods, n_threads, [&](size_t p) {
+        const int period = periods[p];
+        BacktestMetrics* rows = out + p * n_multipliers;
+        if (period < 1) {
+            for (size_t m = 0; m < n_multipliers; ++m) {
+                rows[m] = compute_metrics(TradingStats(), period, multipliers[m]);
+            }
+            return;
+        }
+        std::vector<double> mean(bars.size), stdev(bars.size);
+        rolling_mean_std(bars.close, bars.size, static_cast<size_t>(period), mean.data(), stdev.data());
+        sweep_period(bars, period, mean.data(), stdev.data(), multipliers, n_multipliers, rows);
+    });
+}
+
+}  // namespace bat
@@ -0,0 +1,134 @@
+// Timestamp parsing to int64 nanoseconds since the Unix epoch (UTC).
+//
+// Accepts the formats our data files use:
+//   2025-01-01 00:00:00          (pandas default, research/datasets)
+//   2024-01-01T09:30:00Z         (fetch_polygon_data.py)
+//   2024-01-01T09:30:00.250+00:00
+//   1735689600000                (integer epoch in s, ms, us or ns)
+
+#pragma once
+
+#include <cstdint>
+
+namespace bat {
+
+constexpr int64_t NANOS_PER_SECOND = 1000000000LL;
+
+// Days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's algorithm)
+inline int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+namespace detail {
+
+inline bool read_digits(const char*& p, const char* end, int count, int64_t& out) {
+    int64_t value = 0;
+    for (int i = 0; i < count; ++i) {
+        if (p >= end || *p < '0' || *p > '9') return false;
+        value = value * 10 + (*p - '0');
+        ++p;
+    }
+    out = value;
+    return true;
+}
+
+inline bool expect(const char*& p, const char* end, char c) {
+    if (p >= end || *p != c) return false;
+    ++p;
+    return true;
+}
+
+}  // namespace detail
+
+// Integer epoch; the unit is inferred from the magnitude
+inline bool parse_epoch(const char* p, const char* end, int64_t& out_ns) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p >= end) return false;
+    int64_t value = 0;
+    for (; p < end; ++p) {
+        if (*p < '0' || *p > '9') return false;
+        value = value * 10 + (*p - '0');
+    }
+    if (value < 100000000000LL) {            // seconds (until year 5138)
+        value *= NANOS_PER_SECOND;
+    } else if (value < 100000000000000LL) {  // milliseconds
+        value *= 1000000LL;
+    } else if (value < 100000000000000000LL) {  // microseconds
+        value *= 1000LL;
+    }
+    out_ns = negative ? -value : value;
+    return true;
+}
+
+// Parse [begin, end) into out_ns; returns false on malformed input
+inline bool parse_timestamp(const char* begin, const char* end, int64_t& out_ns) {
+    while (begin < end && (*begin == ' ' || *begin == '"' || *begin == '\t')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '"' || end[-1] == '\r' ||
+                           end[-1] == '\n' || end[-1] == '\t')) --end;
+    if (begin >= end) return false;
+
+    // Plain integer epoch
+    const char* p = begin;
+    if (end - begin < 5 || begin[4] != '-') return parse_epoch(begin, end, out_ns);
+
+    int64_t year, month, day, hour = 0, minute = 0, second = 0, nanos = 0;
+    if (!detail::read_digits(p, end, 4, year) || !detail::expect(p, end, '-') ||
+        !detail::read_digits(p, end, 2, month) || !detail::expect(p, end, '-') ||
+        !detail::read_digits(p, end, 2, day)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+
+    if (p < end && (*p == ' ' || *p == 'T')) {
+        ++p;
+        if (!detail::read_digits(p, end, 2, hour) || !detail::expect(p, end, ':') ||
+            !detail::read_digits(p, end, 2, minute)) {
+            return false;
+        }
+        if (p < end && *p == ':') {
+            ++p;
+            if (!detail::read_digits(p, end, 2, second)) return false;
+        }
+        if (p < end && (*p == '.' || *p == ',')) {
+            ++p;
+            int64_t scale = 100000000LL;
+            while (p < end && *p >= '0' && *p <= '9') {
+                nanos += (*p - '0') * scale;
+                scale /= 10;
+                ++p;
+            }
+        }
+    }
+
+    int64_t offset_seconds = 0;
+    if (p < end) {
+        if (*p == 'Z' || *p == 'z') {
+            ++p;
+        } else if (*p == '+' || *p == '-') {
+            const int64_t sign = *p == '-' ? -1 : 1;
+            ++p;
+            int64_t off_h, off_m = 0;
+            if (!detail::read_digits(p, end, 2, off_h)) return false;
+            if (p < end && *p == ':') ++p;
+            if (p < end && !detail::read_digits(p, end, 2, off_m)) return false;
+            offset_seconds = sign * (off_h * 3600 + off_m * 60);
+        }
+    }
+    if (p != end) return false;
+
+    const int64_t days = days_from_civil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+    const int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second - offset_seconds;
+    out_ns = seconds * NANOS_PER_SECOND + nanos;
+    return true;
+}
+
+}  // namespace bat
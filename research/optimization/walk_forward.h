@@ -0,0 +1,121 @@
+// Walk-forward optimization over one loaded bar series.
+//
+// Folds are index ranges into the same BarColumns, so no fold copies data.
+// Each fold grid-searches (sma_period, std_multiplier) on its train range,
+// keeps the row with the best total P&L (among rows that traded, as
+// optimize_parameters does), and runs that pair on its test range.
+//
+// Phase 1 is one task per (fold, period) pair on the parallel_for pool, so
+// folds search in parallel and uneven periods balance out. A task computes
+// the rolling mean/std series for its period over the fold's train range
+// once and evaluates every multiplier against it (sweep_period). Each fold
+// keeps its own indicator cache rather than sharing one full-series series:
+// the rolling kernel re-anchors relative to where it starts, so a per-fold
+// series keeps every fold bit-identical to sweep() run on that slice.
+// Phase 2 is one task per fold for the out-of-sample run. Its series starts
+// period bars before test_begin (fewer when the data starts later), so the
+// selected pair's indicators are warm when the test range opens and it
+// trades from test_begin, as a live run continuing from the train range would.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "bar_store.h"
+#include "mean_reversion.h"
+#include "parallel.h"
+#include "rolling.h"
+#include "sweep.h"
+
+namespace bat {
+
+struct WalkForwardFold {
+    size_t train_begin;
+    size_t train_end;
+    size_t test_begin;
+    size_t test_end;
+};
+
+// One fold's outcome. test_min_equity / test_peak_equity are the lowest and
+// highest realized P&L reached in the test range; with max_drawdown they let
+// folds be stitched into one out-of-sample equity curve without replaying them.
+struct WalkForwardResult {
+    BacktestMetrics train;
+    BacktestMetrics test;
+    double test_min_equity;
+    double test_peak_equity;
+    int selected;  // 0 when no train row traded, test is then empty
+    size_t row;    // selected train grid row within the fold
+};
+
+// Mean reversion over a range with its precomputed mean/std series, also
+// tracking the lowest realized P&L
+inline TradingStats run_range(const BarColumns& bars, int sma_period, double std_multiplier, const double* mean,
+                              const double* stdev, double& min_equity) {
+    TradingStats s;
+    min_equity = 0.0;
+    for (size_t i = static_cast<size_t>(sma_period); i < bars.size; ++i) {
+        mean_reversion_step(s, i, bars.close[i], mean[i], stdev[i], std_multiplier, nullptr);
+        if (s.total_pnl < min_equity) min_equity = s.total_pnl;
+    }
+    return s;
+}
+
+// train_grid, when not null, receives every fold's full grid:
+// n_folds * n_periods * n_multipliers rows, fold-major then period-major.
+inline void walk_forward(const BarColumns& bars, const WalkForwardFold* folds, size_t n_folds,
+                         const int* periods, size_t n_periods, const double* multipliers, size_t n_multipliers,
+                         WalkForwardResult* out, BacktestMetrics* train_grid, unsigned n_threads) {
+    if (n_folds == 0) return;
+    const size_t grid_size = n_periods * n_multipliers;
+    std::vector<BacktestMetrics> local_grid;
+    BacktestMetrics* grid = train_grid;
+    if (grid == nullptr) {
+        local_grid.resize(n_folds * grid_size);
+        grid = local_grid.data();
+    }
+
+    // Phase 1: every (fold, period) train search, fold-major
+    parallel_for(n_folds * n_periods, n_threads, [&](size_t task) {
+        const size_t f = task / n_periods;
+        const size_t p = task % n_periods;
+        const WalkForwardFold& fold = folds[f];
+        sweep_grid(bars.slice(fold.train_begin, fold.train_end), periods + p, 1, multipliers, n_multipliers,
+                   grid + f * grid_size + p * n_multipliers, 1);
+    });
+
+    // Phase 2: pick each fold's best train row and run it out of sample
+    parallel_for(n_folds, n_threads, [&](size_t f) {
+        const BacktestMetrics* rows = grid + f * grid_size;
+        WalkForwardResult& result = out[f];
+        result = WalkForwardResult{};
+        size_t best = grid_size;
+        for (size_t k = 0; k < grid_size; ++k) {
+            if (rows[k].total_trades > 0 && (best == grid_size || rows[k].total_pnl > rows[best].total_pnl)) best = k;
+        }
+        if (best == grid_size) {
+            result.train = compute_metrics(TradingStats(), 0, 0.0);
+            result.test = result.train;
+            return;
+        }
+        result.selected = 1;
+        result.row = best;
+        result.train = rows[best];
+        const int period = rows[best].sma_period;
+        const double multiplier = rows[best].std_multiplier;
+
+        // Warm-up bars ahead of the test range; run_range trades from bar period of
+        // the slice, which is test_begin whenever the full warm-up exists
+        const size_t warm = std::min(folds[f].test_begin, static_cast<size_t>(period));
+        const BarColumns test = bars.slice(folds[f].test_begin - warm, folds[f].test_end);
+        std::vector<double> mean(test.size), stdev(test.size);
+        rolling_mean_std(test.close, test.size, static_cast<size_t>(period), mean.data(), stdev.data());
+        const TradingStats s = run_range(test, period, multiplier, mean.data(), stdev.data(), result.test_min_equity);
+        result.test = compute_metrics(s, period, multiplier);
+        result.test_peak_equity = s.peak_equity;
+    });
+}
+
+}  // namespace bat
@@ -3,16 +3,34 @@
 Similarity Analysis Script
 Analyzes and visualizes the similarity of price movements across different assets
 with the same timeframe and date range.
+
+Groups with more than STREAMING_MIN_ASSETS assets go through
+streaming_similarity: each CSV is read in chunks and folded into
+native/correlation's one-pass pairwise engine (timestamps aligned as an
+outer join, optional rolling windows), so the aligned returns matrix is
+never held in memory.
 """
 
+import heapq
 import os
 import re
+import sys
 import pandas as pd
 import numpy as np
 import matplotlib.pyplot as plt
 import seaborn as sns
 from pathlib import Path
-from typing import Dict, List, Tuple
+from typing import Dict, Iterator, List, Optional, Tuple
+
+# native/ lives at the repository root
+sys.path.append(str(Path(__file__).resolve().parent.parent))
+try:
+    from native.correlation import StreamingCorrelation
+except ImportError:  # extension not built, align and correlate with pandas
+    StreamingCorrelation = None
+
+STREAMING_MIN_ASSETS = 10
+CSV_CHUNK_ROWS = 200_000
 
 
 def parse_filename(filename: str) -> Dict[str, str]:
@@ -73,6 +91,14 @@ def calculate_similarity_metrics(data_dict: Dict[str, pd.DataFrame]) -> pd.DataF
     Returns:
         Correlation matrix as DataFrame
     """
+    if StreamingCorrelation is not None:
+        engine = StreamingCorrelation(len(data_dict))
+        for i, df in enumerate(data_dict.values()):
+            engine.push(i, pd.DatetimeIndex(df.index).asi8, df['returns'].to_numpy(dtype=np.float64))
+        engine.finish_all()
+        symbols = list(data_dict)
+        return pd.DataFrame(engine.correlation(), index=symbols, columns=symbols)
+
     # Create a combined DataFrame of returns
     returns_dict = {}
     for symbol, df in data_dict.items():
@@ -86,6 +112,129 @@ def calculate_similarity_metrics(data_dict: Dict[str, pd.DataFrame]) -> pd.DataF
     return correlation_matrix
 
 
+def iter_returns(file_path, chunk_rows: int = CSV_CHUNK_ROWS) -> Iterator[Tuple[np.ndarray, np.ndarray, np.ndarray]]:
+    """
+    load_and_prepare_data's returns, one CSV chunk at a time.
+
+    Yields:
+        (timestamps int64 ns, returns, closes) per chunk; the first return is
+        NaN and later chunks continue the pct_change of the previous one
+    """
+    prev_close = np.nan
+    for chunk in pd.read_csv(file_path, usecols=['timestamp', 'Close'], chunksize=chunk_rows):
+        timestamps = pd.DatetimeIndex(pd.to_datetime(chunk['timestamp'])).asi8
+        closes = chunk['Close'].to_numpy(dtype=np.float64)
+        previous = np.concatenate(([prev_close], closes[:-1]))
+        returns = closes / previous - 1.0
+        if len(closes):
+            prev_close = closes[-1]
+        yield timestamps, returns, closes
+
+
+def streaming_similarity(files: Dict[str, Path], window: int = 0, step: Optional[int] = None,
+                         chunk_rows: int = CSV_CHUNK_ROWS, n_threads: int = 0) -> Dict:
+    """
+    Correlation matrix (and optionally rolling correlations) straight from the CSVs.
+
+    The next chunk is always read from the series furthest behind in time,
+    so the engine only buffers roughly one chunk per series before aligning.
+
+    Args:
+        files: Symbol -> CSV path
+        window: Rolling window in aligned rows (0 = whole period only)
+        step: Aligned rows between rolling snapshots (default window // 10)
+        chunk_rows: CSV rows per read
+        n_threads: Worker threads for the pairwise update (0 = all cores)
+
+    Returns:
+        Dict with 'correlation' (DataFrame), 'stats' (per-symbol DataFrame
+        as in print_summary_stats) and, with window > 0, 'rolling' as
+        (timestamps DatetimeIndex, correlations [S, n, n])
+    """
+    symbols = list(files)
+    if StreamingCorrelation is None:
+        return _pandas_similarity(files, window, step)
+
+    step = max(1, step or window // 10) if window else 1024
+    engine = StreamingCorrelation(len(symbols), window, step, n_threads)
+    rolling_ts: List[np.ndarray] = []
+    rolling_corr: List[np.ndarray] = []
+    readers = {i: iter_returns(files[symbol], chunk_rows) for i, symbol in enumerate(symbols)}
+    first_close = np.full(len(symbols), np.nan)
+    last_close = np.full(len(symbols), np.nan)
+
+    # (last timestamp pushed, series): read from the series furthest behind
+    behind = [(np.iinfo(np.int64).min, i) for i in readers]
+    heapq.heapify(behind)
+    while behind:
+        _, i = heapq.heappop(behind)
+        chunk = next(readers[i], None)
+        if chunk is None:
+            engine.finish(i)
+            continue
+        timestamps, returns, closes = chunk
+        if len(closes):
+            if np.isnan(first_close[i]):
+                first_close[i] = closes[0]
+            last_close[i] = closes[-1]
+            engine.push(i, timestamps, returns)
+        heapq.heappush(behind, (int(timestamps[-1]) if len(timestamps) else np.iinfo(np.int64).min, i))
+        if window:
+            ts, corr = engine.snapshots()
+            if len(ts):
+                rolling_ts.append(ts)
+                rolling_corr.append(corr)
+    engine.finish_all()
+
+    count, mean, std = engine.series_stats()
+    result = {
+        'correlation': pd.DataFrame(engine.correlation(), index=symbols, columns=symbols),
+        'stats': pd.DataFrame({
+            'start_price': first_close,
+            'end_price': last_close,
+            'total_return': last_close / first_close - 1.0,
+            'volatility': std,
+            'mean_return': mean,
+            'observations': count,
+        }, index=symbols),
+    }
+    if window:
+        ts, corr = engine.snapshots()
+        rolling_ts.append(ts)
+        rolling_corr.append(corr)
+        result['rolling'] = (pd.DatetimeIndex(np.concatenate(rolling_ts)), np.concatenate(rolling_corr))
+    return result
+
+
+def _pandas_similarity(files: Dict[str, Path], window: int, step: Optional[int]) -> Dict:
+    """streaming_similarity with everything loaded, for when native/correlation is not built"""
+    data_dict = {symbol: load_and_prepare_data(path, symbol) for symbol, path in files.items()}
+    symbols = list(data_dict)
+    returns_df = pd.DataFrame({symbol: df['returns'] for symbol, df in data_dict.items()})
+    result = {
+        'correlation': returns_df.corr(),
+        'stats': pd.DataFrame({
+            'start_price': [df['Close'].iloc[0] for df in data_dict.values()],
+            'end_price': [df['Close'].iloc[-1] for df in data_dict.values()],
+            'total_return': [df['Close'].iloc[-1] / df['Close'].iloc[0] - 1.0 for df in data_dict.values()],
+            'volatility': returns_df.std().to_numpy(),
+            'mean_return': returns_df.mean().to_numpy(),
+            'observations': returns_df.count().to_numpy(dtype=np.float64),
+        }, index=symbols),
+    }
+    if window:
+        # Snapshots where the engine takes them: every step rows once the window is full, and at the end
+        step = max(1, step or window // 10)
+        n = len(returns_df)
+        ends = [e for e in range(step, n + 1, step) if e >= window]
+        if n % step and n >= window:
+            ends.append(n)
+        result['rolling'] = (returns_df.index[[e - 1 for e in ends]],
+                             np.array([returns_df.iloc[e - window:e].corr().to_numpy() for e in ends])
+                             .reshape(-1, len(symbols), len(symbols)))
+    return result
+
+
 def plot_normalized_prices(data_dict: Dict[str, pd.DataFrame], group_key: str, output_dir: Path):
     """
     Plot normalized prices for visual comparison.
@@ -122,11 +271,13 @@ def plot_correlation_heatmap(correlation_matrix: pd.DataFrame, group_key: str, o
         group_key: String identifying the group (timeframe and date range)
         output_dir: Directory to save the plot
     """
-    plt.figure(figsize=(10, 8))
+    n_assets = len(correlation_matrix)
+    size = max(10, n_assets * 0.15)
+    plt.figure(figsize=(size, size * 0.8))
 
     sns.heatmap(
         correlation_matrix,
-        annot=True,
+        annot=n_assets <= 20,
         fmt='.3f',
         cmap='coolwarm',
         center=0,
@@ -164,6 +315,39 @@ def print_summary_stats(data_dict: Dict[str, pd.DataFrame], correlation_matrix:
         print(f"  Volatility (std of returns): {df['returns'].std() * 100:.3f}%")
         print(f"  Mean Return: {df['returns'].mean() * 100:.4f}%")
 
+    print_correlation_analysis(correlation_matrix)
+
+
+def print_stream_summary(stats: pd.DataFrame, correlation_matrix: pd.DataFrame):
+    """
+    print_summary_stats for streaming_similarity results.
+
+    Args:
+        stats: streaming_similarity's per-symbol statistics
+        correlation_matrix: Correlation matrix DataFrame
+    """
+    print("\n" + "="*80)
+    print("SUMMARY STATISTICS")
+    print("="*80)
+
+    for symbol, row in stats.iterrows():
+        print(f"\n{symbol}:")
+        print(f"  Start Price: ${row['start_price']:,.2f}")
+        print(f"  End Price: ${row['end_price']:,.2f}")
+        print(f"  Total Return: {row['total_return'] * 100:.2f}%")
+        print(f"  Volatility (std of returns): {row['volatility'] * 100:.3f}%")
+        print(f"  Mean Return: {row['mean_return'] * 100:.4f}%")
+
+    print_correlation_analysis(correlation_matrix)
+
+
+def print_correlation_analysis(correlation_matrix: pd.DataFrame):
+    """
+    Print the correlation matrix and its most and least correlated pairs.
+
+    Args:
+        correlation_matrix: Correlation matrix DataFrame
+    """
     print("\n" + "="*80)
     print("CORRELATION ANALYSIS")
     print("="*80)
@@ -230,6 +414,16 @@ def main():
         print(f"Number of assets: {len(files)}")
         print(f"{'='*80}\n")
 
+        if len(files) > STREAMING_MIN_ASSETS:
+            # Too many assets to load and plot together: correlate straight from the CSVs
+            print("  Streaming correlation metrics...", end=' ')
+            result = streaming_similarity({metadata['symbol']: file_path for file_path, metadata in files})
+            print("Done")
+            print_stream_summary(result['stats'], result['correlation'])
+            print("\nGenerating visualizations:")
+            plot_correlation_heatmap(result['correlation'], group_key, output_dir)
+            continue
+
         # Load data for all files in the group
         data_dict = {}
         for file_path, metadata in files:
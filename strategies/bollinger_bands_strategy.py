@@ -1,5 +1,6 @@
 import pandas as pd
 from typing import Dict, Any, Optional
+from indicators.streaming import StreamingBollinger
 from indicators.technical_indicators import bollinger_bands
 
 
@@ -19,6 +20,7 @@ class BollingerBandsStrategy:
         }
         self.window = window
         self.num_std = num_std
+        self.reset_stream()
 
     def generate_signals(self, df: pd.DataFrame) -> pd.DataFrame:
         """Generate Bollinger Bands trading signals"""
@@ -28,7 +30,10 @@ class BollingerBandsStrategy:
         df = df.copy()
 
         # Calculate Bollinger Bands
-        df['bb_upper'], df['bb_middle'], df['bb_lower'] = bollinger_bands(df['Close'], self.window, self.num_std)
+        bands = bollinger_bands(df['Close'], self.window, self.num_std)
+        df['bb_upper'] = bands['upper']
+        df['bb_middle'] = bands['middle']
+        df['bb_lower'] = bands['lower']
 
         # Generate signals
         # Buy when price touches or goes below lower band
@@ -39,6 +44,19 @@ class BollingerBandsStrategy:
 
         return df
 
+    def reset_stream(self):
+        """Reset the band state behind on_bar"""
+        self._bands = StreamingBollinger(self.window, self.num_std)
+
+    def on_bar(self, bar: Dict[str, Any]) -> Dict[str, Any]:
+        """Update the bands with one bar and return its row with signals"""
+        row = dict(bar)
+        close = float(bar['Close'])
+        row['bb_upper'], row['bb_middle'], row['bb_lower'] = self._bands.update(close)
+        row['Buy Signal'] = close <= row['bb_lower']
+        row['Sell Signal'] = close >= row['bb_upper']
+        return row
+
     def get_signal_names(self) -> Dict[str, str]:
         return {
             'buy': 'Buy Signal',
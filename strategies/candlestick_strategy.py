@@ -1,6 +1,7 @@
 import pandas as pd
 from typing import Dict, Any, Optional
-from indicators.technical_indicators import detect_candlestick_patterns
+from indicators.streaming import StreamingCandlestickPatterns
+from indicators.technical_indicators import candlestick_signal_patterns
 
 
 class CandlestickPatternsStrategy:
@@ -13,6 +14,7 @@ class CandlestickPatternsStrategy:
     def __init__(self, **kwargs):
         self.name = "Candlestick Patterns"
         self.params = {**kwargs}
+        self.reset_stream()
 
     def generate_signals(self, df: pd.DataFrame) -> pd.DataFrame:
         """Generate candlestick pattern trading signals"""
@@ -22,7 +24,7 @@ class CandlestickPatternsStrategy:
         df = df.copy()
 
         # Detect candlestick patterns
-        patterns = detect_candlestick_patterns(df['Open'], df['High'], df['Low'], df['Close'])
+        patterns = candlestick_signal_patterns(df['Open'], df['High'], df['Low'], df['Close'])
 
         # Add pattern columns to main dataframe
         for pattern in patterns.columns:
@@ -44,6 +46,19 @@ class CandlestickPatternsStrategy:
 
         return df
 
+    def reset_stream(self):
+        """Reset the previous-bar state behind on_bar"""
+        self._patterns = StreamingCandlestickPatterns()
+
+    def on_bar(self, bar: Dict[str, Any]) -> Dict[str, Any]:
+        """Classify one bar against the previous two and return its row with signals"""
+        row = dict(bar)
+        row.update(self._patterns.update(float(bar['Open']), float(bar['High']), float(bar['Low']),
+                                         float(bar['Close'])))
+        row['Buy Signal'] = row['hammer'] or row['bullish_engulfing']
+        row['Sell Signal'] = row['shooting_star'] or row['hanging_man'] or row['bearish_engulfing']
+        return row
+
     def get_signal_names(self) -> Dict[str, str]:
         return {
             'buy': 'Buy Signal',
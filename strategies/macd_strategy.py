@@ -1,5 +1,6 @@
 import pandas as pd
 from typing import Dict, Any, Optional
+from indicators.streaming import StreamingMACD
 from indicators.technical_indicators import macd
 
 
@@ -21,6 +22,7 @@ class MACDStrategy:
         self.fast = fast
         self.slow = slow
         self.signal = signal
+        self.reset_stream()
 
     def generate_signals(self, df: pd.DataFrame) -> pd.DataFrame:
         """Generate MACD-based trading signals"""
@@ -30,7 +32,10 @@ class MACDStrategy:
         df = df.copy()
 
         # Calculate MACD
-        df['macd_line'], df['signal_line'], df['histogram'] = macd(df['Close'], self.fast, self.slow, self.signal)
+        macd_values = macd(df['Close'], self.fast, self.slow, self.signal)
+        df['macd_line'] = macd_values['macd']
+        df['signal_line'] = macd_values['signal']
+        df['histogram'] = macd_values['histogram']
 
         # Generate crossover signals
         df['macd_cross_above'] = (df['macd_line'] > df['signal_line']) & (df['macd_line'].shift(1) <= df['signal_line'].shift(1))
@@ -42,6 +47,27 @@ class MACDStrategy:
 
         return df
 
+    def reset_stream(self):
+        """Reset the MACD state behind on_bar"""
+        self._macd = StreamingMACD(self.fast, self.slow, self.signal)
+        self._prev_line = float('nan')
+        self._prev_signal = float('nan')
+
+    def on_bar(self, bar: Dict[str, Any]) -> Dict[str, Any]:
+        """Update MACD with one bar; crossovers compare against the previous bar"""
+        row = dict(bar)
+        line, signal, histogram = self._macd.update(bar['Close'])
+        row['macd_line'] = line
+        row['signal_line'] = signal
+        row['histogram'] = histogram
+        row['macd_cross_above'] = line > signal and self._prev_line <= self._prev_signal
+        row['macd_cross_below'] = line < signal and self._prev_line >= self._prev_signal
+        row['Buy Signal'] = row['macd_cross_above']
+        row['Sell Signal'] = row['macd_cross_below']
+        self._prev_line = line
+        self._prev_signal = signal
+        return row
+
     def get_signal_names(self) -> Dict[str, str]:
         return {
             'buy': 'Buy Signal',
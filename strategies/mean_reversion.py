@@ -1,5 +1,6 @@
 import pandas as pd
 from typing import Dict, Any, Optional
+from indicators.streaming import StreamingBollinger
 
 
 class MeanReversionExtremeStrategy:
@@ -14,6 +15,7 @@ class MeanReversionExtremeStrategy:
         self.params = {"window": window, "num_std": num_std, **kwargs}
         self.window = window
         self.num_std = num_std
+        self.reset_stream()
 
     def generate_signals(self, df: pd.DataFrame) -> pd.DataFrame:
         """Generate Bollinger Band mean reversion signals - exit at opposite extreme"""
@@ -34,6 +36,23 @@ class MeanReversionExtremeStrategy:
 
         return df
 
+    def reset_stream(self):
+        """Reset the indicator state behind on_bar"""
+        self._bands = StreamingBollinger(self.window, self.num_std)
+
+    def on_bar(self, bar: Dict[str, Any]) -> Dict[str, Any]:
+        """Incremental generate_signals: returns the new bar's row with indicators and signals"""
+        row = dict(bar)
+        close = float(bar['Close'])
+        upper, middle, lower = self._bands.update(close)
+        row['SMA'] = middle
+        row['STD'] = self._bands.std
+        row['Upper Band'] = upper
+        row['Lower Band'] = lower
+        row['Buy Signal'] = close < lower
+        row['Sell Signal'] = close > upper
+        return row
+
     def get_signal_names(self) -> Dict[str, str]:
         return {
             'buy': 'Buy Signal',
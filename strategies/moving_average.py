@@ -1,5 +1,6 @@
 import pandas as pd
 from typing import Dict, Any, Optional
+from indicators.streaming import StreamingSMA
 from indicators.technical_indicators import sma
 
 
@@ -20,6 +21,7 @@ class MovingAverageStrategy:
         self.short_window = short_window
         self.medium_window = medium_window
         self.long_window = long_window
+        self.reset_stream()
     
     def generate_signals(self, df: pd.DataFrame) -> pd.DataFrame:
         """Generate moving average crossover signals"""
@@ -52,6 +54,33 @@ class MovingAverageStrategy:
 
         return df
     
+    def reset_stream(self):
+        """Reset the moving averages and alignment state behind on_bar"""
+        self._short = StreamingSMA(self.short_window)
+        self._medium = StreamingSMA(self.medium_window)
+        self._long = StreamingSMA(self.long_window)
+        self._prev_bullish = False
+        self._prev_bearish = False
+
+    def on_bar(self, bar: Dict[str, Any]) -> Dict[str, Any]:
+        """Feed one bar; returns its generate_signals row in O(1)"""
+        row = dict(bar)
+        close = float(bar['Close'])
+        short = self._short.update(close)
+        medium = self._medium.update(close)
+        long = self._long.update(close)
+        row['short_mavg'] = short
+        row['medium_mavg'] = medium
+        row['long_mavg'] = long
+
+        bullish_alignment = short > medium and medium > long
+        bearish_alignment = short < medium and medium < long
+        row['Buy Signal'] = bullish_alignment and not self._prev_bullish
+        row['Sell Signal'] = bearish_alignment and not self._prev_bearish
+        self._prev_bullish = bullish_alignment
+        self._prev_bearish = bearish_alignment
+        return row
+
     def get_signal_names(self) -> Dict[str, str]:
         return {
             'buy': 'Buy Signal',
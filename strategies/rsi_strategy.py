@@ -1,5 +1,6 @@
 import pandas as pd
 from typing import Dict, Any, Optional
+from indicators.streaming import StreamingRSI
 from indicators.technical_indicators import rsi
 
 
@@ -21,6 +22,7 @@ class RSIStrategy:
         self.window = window
         self.oversold_threshold = oversold_threshold
         self.overbought_threshold = overbought_threshold
+        self.reset_stream()
 
     def generate_signals(self, df: pd.DataFrame) -> pd.DataFrame:
         """Generate RSI-based trading signals"""
@@ -38,6 +40,19 @@ class RSIStrategy:
 
         return df
 
+    def reset_stream(self):
+        """Reset the RSI state behind on_bar"""
+        self._rsi = StreamingRSI(self.window)
+
+    def on_bar(self, bar: Dict[str, Any]) -> Dict[str, Any]:
+        """Update RSI with one bar and return the bar's row with signals"""
+        row = dict(bar)
+        value = self._rsi.update(bar['Close'])
+        row['rsi'] = value
+        row['Buy Signal'] = value < self.oversold_threshold
+        row['Sell Signal'] = value > self.overbought_threshold
+        return row
+
     def get_signal_names(self) -> Dict[str, str]:
         return {
             'buy': 'Buy Signal',
@@ -8,7 +8,8 @@ import subprocess
 
 sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 sys.path.append('research')
-from research.optimization.find_best import find_best_main
+from research.optimization.find_best import find_best_main, walk_forward_main
+from data_providers.bar_file import load_dataset_frame, write_dataset_cache
 
 from strategies.mean_reversion import MeanReversionExtremeStrategy
 from strategies.moving_average import MovingAverageStrategy
@@ -695,10 +696,17 @@ class TradingCLI:
         try:
             print("Fetching data...")
 
-            if not self.data_provider:
-                print(" Polygon data provider not configured. Please configure it first.")
-                return
-            df = self.data_provider.get_data(**data_params)
+            # Reuse a downloaded dataset (through its binary cache) when one matches
+            dataset_path = self._dataset_path(data_params['ticker'], data_params['timespan'],
+                                              data_params['from_date'], data_params['to_date'])
+            if os.path.exists(dataset_path):
+                print(f"Using local dataset {os.path.basename(dataset_path)}")
+                df = load_dataset_frame(dataset_path)
+            else:
+                if not self.data_provider:
+                    print(" Polygon data provider not configured. Please configure it first.")
+                    return
+                df = self.data_provider.get_data(**data_params)
 
             print(f"✓ Retrieved {len(df)} data points")
 
@@ -1394,6 +1402,13 @@ class TradingCLI:
             else:
                 print("Invalid choice. Please select a number between 1 and 4.")
 
+    def _dataset_path(self, ticker, timeframe, start, end):
+        """Path of a downloaded dataset in research/datasets"""
+        clean_ticker = ticker.replace(':', '_').replace('/', '_')
+        filename = f"{clean_ticker}_{timeframe}_{start}_to_{end}.csv"
+        script_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        return os.path.join(script_dir, 'research', 'datasets', filename)
+
     def download_dataset(self, ticker, start, end, timeframe, limit=50000):
 
     
@@ -1407,17 +1422,11 @@ class TradingCLI:
                 limit=limit
             )
 
-            clean_ticker = ticker.replace(':', '_').replace('/', '_')
-            filename = f"{clean_ticker}_{timeframe}_{start}_to_{end}.csv"
-
-            script_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
-            datasets_dir = os.path.join(script_dir, 'research', 'datasets')
-
-            os.makedirs(datasets_dir, exist_ok=True)
-
-            filepath = os.path.join(datasets_dir, filename)
+            filepath = self._dataset_path(ticker, timeframe, start, end)
+            os.makedirs(os.path.dirname(filepath), exist_ok=True)
 
             df.to_csv(filepath, index=False)
+            write_dataset_cache(filepath, df)
 
             print(f"✓ Dataset successfully downloaded")
 
@@ -1430,8 +1439,12 @@ class TradingCLI:
             dataset_path = input("Enter path to dataset CSV (default: /research/datasets/X_BTCUSD_minute_2025-01-01_to_2025-09-01.csv): ").strip()
             if not dataset_path:
                 dataset_path = "/Users/brunoinzunza/Documents/GitHub/BAT/research/datasets/X_BTCUSD_minute_2025-01-01_to_2025-09-01.csv"
+            folds = input("Walk-forward folds (press Enter for a single train/validation/test split): ").strip()
             print(f"\nStarting optimization for {dataset_path}...")
-            find_best_main(dataset_path)
+            if folds:
+                walk_forward_main(dataset_path, n_folds=int(folds))
+            else:
+                find_best_main(dataset_path)
         return
 
     def main_menu(self):
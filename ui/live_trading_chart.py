@@ -3,14 +3,87 @@ import matplotlib.animation as animation
 import pandas as pd
 import numpy as np
 from datetime import datetime, timedelta
-from matplotlib.patches import Rectangle
+from matplotlib.collections import LineCollection, PolyCollection
+from matplotlib.colors import to_rgba
 from matplotlib.lines import Line2D
 from typing import Optional, Dict, Any
+import threading
+from collections import deque
 import warnings
 warnings.filterwarnings('ignore')
 
+from data_providers.bar_ring import BarHistory
 from data_providers.alpaca_provider import AlpacaDataProvider, AlpacaBroker, SimulatedBroker
 from engines.live_trading_engine import LiveTradingEngine
+from engines.order_gateway import AsyncOrderGateway
+
+
+class CandleArtists:
+    """
+    Candlestick wicks and bodies as two collections updated in place
+
+    Candles are placed at absolute bar numbers, so when the window moves on
+    by one bar the geometry of the bars still in view is reused and only the
+    new bar (and a last bar whose OHLC changed) is rebuilt.
+    """
+
+    def __init__(self, ax, bull_color: str, bear_color: str, width: float = 0.6):
+        self.half = width / 2
+        self.bull = to_rgba(bull_color, 0.8)
+        self.bear = to_rgba(bear_color, 0.8)
+        self.first = 0
+        self.ohlc = np.empty((0, 4))
+        self.segments = np.empty((0, 2, 2))
+        self.verts = np.empty((0, 4, 2))
+        self.colors = np.empty((0, 4))
+        self.updated = 0  # candles rebuilt by the last update()
+        self.wicks = LineCollection([], colors='black', linewidths=1, zorder=2)
+        self.bodies = PolyCollection([], edgecolors='black', linewidths=0.5, zorder=3)
+        ax.add_collection(self.wicks)
+        ax.add_collection(self.bodies)
+
+    def update(self, first: int, ohlc: np.ndarray):
+        """Show rows of ohlc (open, high, low, close) at bars first, first + 1, ..."""
+        n = len(ohlc)
+        segments = np.empty((n, 2, 2))
+        verts = np.empty((n, 4, 2))
+        colors = np.empty((n, 4))
+        stale = np.ones(n, dtype=bool)
+
+        # Rows still in view from the previous window keep their geometry
+        shift = first - self.first
+        overlap = max(0, min(len(self.ohlc) - shift, n)) if shift >= 0 else 0
+        if overlap:
+            segments[:overlap] = self.segments[shift:shift + overlap]
+            verts[:overlap] = self.verts[shift:shift + overlap]
+            colors[:overlap] = self.colors[shift:shift + overlap]
+            same = self.ohlc[shift:shift + overlap] == ohlc[:overlap]
+            stale[:overlap] = ~same.all(axis=1)
+
+        rows = np.flatnonzero(stale)
+        if len(rows):
+            o, h, l, c = (ohlc[rows, k] for k in range(4))
+            x = (first + rows).astype(float)
+            segments[rows, 0, 0] = segments[rows, 1, 0] = x
+            segments[rows, 0, 1] = l
+            segments[rows, 1, 1] = h
+            bottom, top = np.minimum(o, c), np.maximum(o, c)
+            verts[rows, :, 0] = np.column_stack([x - self.half, x + self.half, x + self.half, x - self.half])
+            verts[rows, :, 1] = np.column_stack([bottom, bottom, top, top])
+            colors[rows] = np.where((c >= o)[:, None], self.bull, self.bear)
+
+        self.first, self.ohlc = first, ohlc.copy()
+        self.segments, self.verts, self.colors = segments, verts, colors
+        self.updated = len(rows)
+        self.wicks.set_segments(segments)
+        self.bodies.set_verts(verts)
+        self.bodies.set_facecolor(colors)
+
+    def price_range(self):
+        """(lowest low, highest high) of the candles shown, or (None, None)"""
+        if not len(self.ohlc):
+            return None, None
+        return float(np.nanmin(self.ohlc[:, 2])), float(np.nanmax(self.ohlc[:, 1]))
 
 
 class LiveTradingChart:
@@ -29,7 +102,8 @@ class LiveTradingChart:
                  position_percentage: float = None,
                  data_provider = None,
                  broker_interface = None,
-                 lookback: int = 100):
+                 lookback: int = 100,
+                 async_orders: bool = True):
 
         self.strategy = strategy
         self.symbol = symbol
@@ -79,6 +153,10 @@ class LiveTradingChart:
                 initial_balance = 10000
                 print(f"Simulation Balance: ${initial_balance:,.2f}")
 
+        if async_orders and self.broker is not None and AsyncOrderGateway.supports(self.broker):
+            # Orders return without waiting on the broker; fills stream into a local book
+            self.broker = AsyncOrderGateway(self.broker).start()
+
         self.trading_engine = LiveTradingEngine(
             data_provider=self.data_provider,
             broker_interface=self.broker,
@@ -121,140 +199,197 @@ class LiveTradingChart:
         self.indicator_ax.set_ylabel('Indicator Values')
         self.indicator_ax.grid(True, alpha=0.3)
 
-        # Data storage
-        self.data_history = pd.DataFrame()
+        # Data storage: a fixed SPSC ring the data-feed thread writes and the
+        # chart reads; data_history is built from it on demand
         self.max_candles = 100
         self.min_data_points = max(50, getattr(strategy, 'window', 20) + 10)  # Ensure enough data for strategy
+        self.bars = BarHistory(capacity=4 * max(self.max_candles, self.min_data_points),
+                               window=max(self.max_candles, self.min_data_points))
+        self._derived_rows = deque(maxlen=self.bars.ring.window)  # on_bar indicator/signal columns
+        self._history = None
+        self._history_version = -1
+        self._initial_loaded = False
+        self._consumed_initial = False
+        self._feed_thread = None
+        self._feed_stop = threading.Event()
+        self._stream = None  # provider push stream, when the provider has one
 
         # Trading state
         self.data_ready = False
 
+        # Chart artists, kept across frames (see draw_candlesticks)
+        self._first_bar = 0
+        self._artists = {}
+        self._transient = []
+        self._touched = set()
+        self._legend_labels = {}
+        self._info_text = None
+
+        # Strategies with on_bar get one incremental update per new bar
+        # instead of generate_signals over the whole history
+        self.streaming = hasattr(strategy, 'on_bar')
+
         # Colors
         self.bull_color = '#2E8B57'  # Sea Green
         self.bear_color = '#DC143C'  # Crimson
         self.bg_color = '#F5F5F5'    # White Smoke
 
         plt.style.use('default')
+        self.candles = CandleArtists(self.main_ax, self.bull_color, self.bear_color)
         self.fig.patch.set_facecolor(self.bg_color)
 
+    def _fetch_initial_bars(self) -> pd.DataFrame:
+        """Bulk-load the initial window from the data provider"""
+        print(f"Initializing {self.symbol} data...")
+
+        # Check if using forex (OANDA) or stocks/crypto (Alpaca) or other providers
+        if self.is_forex:
+            # Use OANDA data provider
+            initial_df = self.data_provider.get_data(
+                ticker=self.symbol,
+                timespan='M1',
+                limit=self.lookback
+            )
+        elif hasattr(self.data_provider, 'get_recent_bars_public'):
+            # Use Alpaca's public endpoint to get recent bars immediately
+            initial_df = self.data_provider.get_recent_bars_public(self.symbol, limit=self.min_data_points + 10)
+        else:
+            # Generic data provider (e.g., Synth) - use get_live_data
+            # For providers that only return single data points, accumulate data over time
+            initial_df = self.data_provider.get_live_data(self.symbol)
+            print(f"Note: Using live data provider - chart will build history as data arrives")
+            # Mark as ready even with minimal data for real-time providers
+            self.data_ready = True
+        return initial_df
+
+    def _fetch_latest_bar(self):
+        """Get the latest bar from the data provider as a dict, or None"""
+        if self.is_forex:
+            # Use OANDA get_latest_candle
+            latest_candle = self.data_provider.get_latest_candle(self.symbol)
+            if not latest_candle:
+                return None
+            # Convert OANDA timestamp string to datetime
+            timestamp = latest_candle.get('time', datetime.now())
+            if isinstance(timestamp, str):
+                timestamp = pd.to_datetime(timestamp)
+
+            return {
+                'timestamp': timestamp,
+                'Open': latest_candle['open'],
+                'High': latest_candle['high'],
+                'Low': latest_candle['low'],
+                'Close': latest_candle['close'],
+                'Volume': latest_candle.get('volume', 0)
+            }
+        elif hasattr(self.data_provider, 'get_latest_bar'):
+            # Use Alpaca get_latest_bar
+            return self.data_provider.get_latest_bar(self.symbol)
+        else:
+            # Generic provider (e.g., Synth) - use get_live_data
+            df = self.data_provider.get_live_data(self.symbol)
+            if not df.empty:
+                return df.iloc[0].to_dict()
+            return None
+
+    def fetch_data(self) -> bool:
+        """
+        Producer side: push new bars from the data provider into the ring
+
+        Runs on the data-feed thread when one is started, otherwise inline
+        from fetch_and_process_data.
+
+        Returns:
+            False when the initial load failed
+        """
+        if not self._initial_loaded:
+            initial_df = self._fetch_initial_bars()
+            if initial_df.empty:
+                print(f"Failed to get initial data")
+                return False
+            # Keep only what we need
+            for bar in initial_df.tail(self.min_data_points).to_dict('records'):
+                self.bars.push_bar(bar)
+            self._initial_loaded = True
+            return True
+
+        # Bars that are not newer than the last one (or arrive while the ring
+        # is full) are skipped; the next poll fetches the latest bar again
+        latest_bar = self._fetch_latest_bar()
+        if latest_bar:
+            self.bars.push_bar(latest_bar)
+        return True
+
+    def _consume_bars(self):
+        """Consumer side: run newly pushed bars through the strategy"""
+        live = self._consumed_initial
+        if self.streaming and self.bars.consumed == 0 and self.bars.ring.pending() > 0:
+            # Warm the indicator state up from scratch on the initial window
+            self.strategy.reset_stream()
+        while True:
+            bar = self.bars.pop_bar()
+            if bar is None:
+                break
+
+            if live:
+                # Display OHLCV data (use 5 decimals for forex precision)
+                decimals = 5 if self.is_forex else 2
+                print(f"\nNEW DATA - {self.symbol} at {bar['timestamp'].strftime('%H:%M:%S')}")
+                print(f"    O: ${bar['Open']:.{decimals}f} | H: ${bar['High']:.{decimals}f} | L: ${bar['Low']:.{decimals}f} | C: ${bar['Close']:.{decimals}f} | V: {bar['Volume']:.0f}")
+
+                # Check for active position and display unrealized PnL
+                self._display_position_update(bar['Close'])
+
+            if self.streaming:
+                row = self.strategy.on_bar(bar)
+                self._derived_rows.append({k: v for k, v in row.items() if k not in bar})
+
+        if not live and self.bars.consumed > 0:
+            self._consumed_initial = True
+            if len(self.bars) >= self.min_data_points:
+                self.data_ready = True
+                print(f"Ready for live trading with {len(self.bars)} bars")
+            else:
+                print(f"Starting with {len(self.bars)} bar(s), will accumulate more over time")
+
+    @property
+    def data_history(self) -> pd.DataFrame:
+        """The last max_candles bars with indicator columns, built on demand from the ring"""
+        if self._history is None or self._history_version != self.bars.consumed:
+            if self.bars.consumed == 0:
+                self._history = pd.DataFrame()
+            else:
+                frame = self.bars.to_frame(self.max_candles)
+                if self._derived_rows:
+                    derived = pd.DataFrame(list(self._derived_rows)[-len(frame):])
+                    frame = pd.concat([frame, derived], axis=1)
+                self._history = frame
+            self._history_version = self.bars.consumed
+        return self._history
+
     def fetch_and_process_data(self):
         """Fetch data - initial bulk load then live updates"""
         try:
-            # Initial data loading phase
-            if self.data_history.empty:
-                print(f"Initializing {self.symbol} data...")
-
-                # Check if using forex (OANDA) or stocks/crypto (Alpaca) or other providers
-                if self.is_forex:
-                    # Use OANDA data provider
-                    initial_df = self.data_provider.get_data(
-                        ticker=self.symbol,
-                        timespan='M1',
-                        limit=self.lookback
-                    )
-                elif hasattr(self.data_provider, 'get_recent_bars_public'):
-                    # Use Alpaca's public endpoint to get recent bars immediately
-                    initial_df = self.data_provider.get_recent_bars_public(self.symbol, limit=self.min_data_points + 10)
-                else:
-                    # Generic data provider (e.g., Synth) - use get_live_data
-                    # For providers that only return single data points, accumulate data over time
-                    initial_df = self.data_provider.get_live_data(self.symbol)
-                    print(f"Note: Using live data provider - chart will build history as data arrives")
-                    # Mark as ready even with minimal data for real-time providers
-                    self.data_ready = True
-
-                if not initial_df.empty:
-                    # Use the fetched data, keep only what we need
-                    self.data_history = initial_df.tail(self.min_data_points).copy().reset_index(drop=True)
-
-                    # Mark as ready since we have enough data
-                    if len(self.data_history) >= self.min_data_points:
-                        self.data_ready = True
-                        print(f"Ready for live trading with {len(self.data_history)} bars")
-                    else:
-                        print(f"Starting with {len(self.data_history)} bar(s), will accumulate more over time")
-                else:
-                    print(f"Failed to get initial data")
+            if self._feed_thread is None and self._stream is None:
+                if not self.fetch_data():
                     return None
+            elif not self._initial_loaded:
+                return None
 
-            # Live data update phase (after initial load)
-            else:
-                # Get latest bar for live updates
-                if self.is_forex:
-                    # Use OANDA get_latest_candle
-                    latest_candle = self.data_provider.get_latest_candle(self.symbol)
-                    if latest_candle:
-                        # Convert OANDA timestamp string to datetime
-                        timestamp = latest_candle.get('time', datetime.now())
-                        if isinstance(timestamp, str):
-                            timestamp = pd.to_datetime(timestamp)
-
-                        latest_bar = {
-                            'timestamp': timestamp,
-                            'Open': latest_candle['open'],
-                            'High': latest_candle['high'],
-                            'Low': latest_candle['low'],
-                            'Close': latest_candle['close'],
-                            'Volume': latest_candle.get('volume', 0)
-                        }
-                    else:
-                        latest_bar = None
-                elif hasattr(self.data_provider, 'get_latest_bar'):
-                    # Use Alpaca get_latest_bar
-                    latest_bar = self.data_provider.get_latest_bar(self.symbol)
-                else:
-                    # Generic provider (e.g., Synth) - use get_live_data
-                    df = self.data_provider.get_live_data(self.symbol)
-                    if not df.empty:
-                        latest_bar = df.iloc[0].to_dict()
-                    else:
-                        latest_bar = None
-
-                if not latest_bar:
-                    # Continue with existing data silently
-                    pass
-                else:
-                    # Convert to DataFrame row
-                    new_row = pd.DataFrame([latest_bar])
-
-                    # Check if this is a new timestamp (avoid duplicates)
-                    # Ensure both timestamps are timezone-aware for comparison
-                    latest_ts = pd.to_datetime(latest_bar['timestamp'])
-                    if latest_ts.tz is None:
-                        latest_ts = latest_ts.tz_localize('UTC')
-
-                    last_historical_ts = self.data_history['timestamp'].iloc[-1]
-                    if last_historical_ts.tz is None:
-                        last_historical_ts = last_historical_ts.tz_localize('UTC')
-
-                    if latest_ts > last_historical_ts:
-                        # Convert timestamp to datetime for display
-                        display_time = pd.to_datetime(latest_bar['timestamp'])
-
-                        # Display OHLCV data (use 5 decimals for forex precision)
-                        decimals = 5 if self.is_forex else 2
-                        print(f"\nNEW DATA - {self.symbol} at {display_time.strftime('%H:%M:%S')}")
-                        print(f"    O: ${latest_bar['Open']:.{decimals}f} | H: ${latest_bar['High']:.{decimals}f} | L: ${latest_bar['Low']:.{decimals}f} | C: ${latest_bar['Close']:.{decimals}f} | V: {latest_bar['Volume']:.0f}")
-
-                        # Check for active position and display unrealized PnL
-                        self._display_position_update(latest_bar['Close'])
-
-                        # Add new bar
-                        self.data_history = pd.concat([self.data_history, new_row], ignore_index=True)
-
-                        # Keep only max_candles
-                        if len(self.data_history) > self.max_candles:
-                            self.data_history = self.data_history.tail(self.max_candles).reset_index(drop=True)
+            self._consume_bars()
+            if self.bars.consumed == 0:
+                return None
 
             # Process data if we have enough
-            if len(self.data_history) >= self.min_data_points:
+            if len(self.bars) >= self.min_data_points:
                 if not self.data_ready:
                     self.data_ready = True
 
                 # Generate signals with strategy
                 try:
-                    df_with_signals = self.strategy.generate_signals(self.data_history.copy())
-                    self.data_history = df_with_signals
+                    if not self.streaming:
+                        df_with_signals = self.strategy.generate_signals(self.data_history.copy())
+                        self._history = df_with_signals
 
                     # Process trading signals
                     self._process_trading_signals()
@@ -270,6 +405,50 @@ class LiveTradingChart:
             traceback.print_exc()
             return None
 
+    def start_data_feed(self, poll_interval: float):
+        """
+        Feed live bars from a background thread: the provider's push stream
+        when it has one, otherwise polling every poll_interval seconds
+
+        Ingestion then runs independently of the FuncAnimation callback,
+        which only drains the ring and redraws.
+        """
+        if self._feed_thread is not None or self._stream is not None:
+            return
+
+        if hasattr(self.data_provider, 'stream_bars'):
+            # Persistent provider stream: bars are pushed into the ring as they close
+            try:
+                self._stream = self.data_provider.stream_bars(
+                    self.symbol, lambda _symbol, bar: self.bars.push_bar(bar))
+                return
+            except Exception as e:
+                print(f"Could not open the data stream, polling instead: {e}")
+
+        self._feed_stop.clear()
+
+        def feed():
+            while not self._feed_stop.is_set():
+                try:
+                    self.fetch_data()
+                except Exception as e:
+                    print(f"Error fetching data: {e}")
+                self._feed_stop.wait(poll_interval)
+
+        self._feed_thread = threading.Thread(target=feed, name=f"{self.symbol} data feed", daemon=True)
+        self._feed_thread.start()
+
+    def stop_data_feed(self):
+        """Stop the background data feed"""
+        if self._stream is not None:
+            self._stream.stop()
+            self._stream = None
+        if self._feed_thread is None:
+            return
+        self._feed_stop.set()
+        self._feed_thread.join(timeout=5)
+        self._feed_thread = None
+
     def _process_trading_signals(self):
         """Process trading signals and execute trades"""
         try:
@@ -290,12 +469,21 @@ class LiveTradingChart:
             if buy_signal or sell_signal:
                 # Use percentage-based position sizing if configured, otherwise use fixed quantity
                 quantity_to_use = None if self.position_percentage is not None else self.quantity
-                self.trading_engine.process_signals(
-                    self.data_history,
-                    self.strategy,
-                    self.symbol,
-                    quantity_to_use
-                )
+                if self.streaming:
+                    self.trading_engine.process_signal_row(
+                        latest_row.to_dict(),
+                        self.strategy,
+                        self.symbol,
+                        quantity_to_use,
+                        n_bars=self.bars.consumed
+                    )
+                else:
+                    self.trading_engine.process_signals(
+                        self.data_history,
+                        self.strategy,
+                        self.symbol,
+                        quantity_to_use
+                    )
 
         except Exception as e:
             print(f"Error processing trading signals: {e}")
@@ -346,69 +534,126 @@ class LiveTradingChart:
         except Exception:
             return 0
 
+    # Frame rendering: artists are created once and updated in place, so a
+    # frame only moves data into existing lines, markers and collections.
+    # Candles sit at absolute bar positions (bars consumed so far), so a new
+    # bar appends one candle instead of shifting every artist.
+
+    def _begin_frame(self):
+        """Drop last frame's one-off artists (fills, bars, notices)"""
+        for artist in self._transient:
+            artist.remove()
+        self._transient = []
+        self._touched = set()
+
+    def _end_frame(self):
+        """Remove persistent artists the strategy did not draw this frame"""
+        for key in [key for key in self._artists if key not in self._touched]:
+            self._artists.pop(key).remove()
+
+    def _transient_artist(self, artist):
+        self._transient.append(artist)
+        return artist
+
+    def _line(self, ax, x, y, label: str, **style):
+        key = (id(ax), 'line', label)
+        self._touched.add(key)
+        line = self._artists.get(key)
+        if line is None:
+            line, = ax.plot(x, y, label=label, **style)
+            self._artists[key] = line
+        else:
+            line.set_data(x, y)
+        return line
+
+    def _hline(self, ax, y: float, label: str, **style):
+        key = (id(ax), 'hline', label)
+        self._touched.add(key)
+        if key not in self._artists:
+            self._artists[key] = ax.axhline(y=y, label=label, **style)
+
+    def _hspan(self, ax, y0: float, y1: float, label: str, **style):
+        key = (id(ax), 'hspan', label)
+        self._touched.add(key)
+        if key not in self._artists:
+            self._artists[key] = ax.axhspan(y0, y1, label=label, **style)
+
+    def _markers(self, ax, x, y, label: str, **style):
+        key = (id(ax), 'markers', label)
+        self._touched.add(key)
+        points = np.column_stack([np.asarray(x, dtype=float), np.asarray(y, dtype=float)])
+        scatter = self._artists.get(key)
+        if scatter is None:
+            self._artists[key] = ax.scatter(points[:, 0], points[:, 1], label=label, **style)
+        else:
+            scatter.set_offsets(points)
+
+    def _refresh_legend(self, ax):
+        """Rebuild an axis legend only when its set of labels changed"""
+        labels = tuple(ax.get_legend_handles_labels()[1])
+        if labels == self._legend_labels.get(id(ax)):
+            return
+        self._legend_labels[id(ax)] = labels
+        if labels:
+            ax.legend(loc='upper left', fontsize=8)
+        elif ax.get_legend() is not None:
+            ax.get_legend().remove()
+
+    def _positions(self, df: pd.DataFrame) -> np.ndarray:
+        """Chart x of each row: its absolute bar number"""
+        return np.arange(self._first_bar, self._first_bar + len(df))
+
     def draw_candlesticks(self):
         """Draw candlestick chart with indicators"""
-        self.main_ax.clear()
-        self.indicator_ax.clear()
+        self._begin_frame()
 
         if self.data_history is None or len(self.data_history) < 1:
             # Show data collection status
-            self.main_ax.text(0.5, 0.5, 'Collecting Market Data...',
-                            horizontalalignment='center', verticalalignment='center',
-                            transform=self.main_ax.transAxes, fontsize=16)
+            self._transient_artist(self.main_ax.text(0.5, 0.5, 'Collecting Market Data...',
+                                                     horizontalalignment='center', verticalalignment='center',
+                                                     transform=self.main_ax.transAxes, fontsize=16))
             return
 
         # Show data collection progress if not ready
         if not self.data_ready:
             progress = len(self.data_history) / self.min_data_points * 100
             progress_text = f'Building Data Window: {len(self.data_history)}/{self.min_data_points} bars ({progress:.1f}%)'
-            self.main_ax.text(0.5, 0.9, progress_text,
-                            horizontalalignment='center', verticalalignment='center',
-                            transform=self.main_ax.transAxes, fontsize=12,
-                            bbox=dict(boxstyle='round', facecolor='yellow', alpha=0.7))
+            self._transient_artist(self.main_ax.text(0.5, 0.9, progress_text,
+                                                     horizontalalignment='center', verticalalignment='center',
+                                                     transform=self.main_ax.transAxes, fontsize=12,
+                                                     bbox=dict(boxstyle='round', facecolor='yellow', alpha=0.7)))
 
-        df = self.data_history.copy()
+        df = self.data_history
+        self._first_bar = max(0, self._history_version - len(df))
 
         # Setup main chart
         self.main_ax.set_title(f'{self.symbol} Live Trading - {self.strategy.name}')
-        self.main_ax.set_ylabel('Price (USD)')
-        self.main_ax.grid(True, alpha=0.3)
-
-        # Draw candlesticks
-        for i, (idx, row) in enumerate(df.iterrows()):
-            open_price = row['Open']
-            high_price = row['High']
-            low_price = row['Low']
-            close_price = row['Close']
-
-            # Determine candle color
-            color = self.bull_color if close_price >= open_price else self.bear_color
-
-            # Draw wick
-            self.main_ax.plot([i, i], [low_price, high_price], color='black', linewidth=1)
 
-            # Draw body
-            body_height = abs(close_price - open_price)
-            body_bottom = min(open_price, close_price)
-
-            rect = Rectangle((i - 0.3, body_bottom), 0.6, body_height,
-                           facecolor=color, edgecolor='black', alpha=0.8)
-            self.main_ax.add_patch(rect)
+        # Candles: only new or changed bars get new geometry
+        ohlc = df[['Open', 'High', 'Low', 'Close']].to_numpy(dtype=np.float64)
+        self.candles.update(self._first_bar, ohlc)
 
         # Draw strategy-specific indicators
         self._draw_strategy_indicators(df)
 
         # Draw trading signals
         self._draw_trading_signals(df)
+        self._end_frame()
+
+        for ax in (self.main_ax, self.indicator_ax):
+            self._refresh_legend(ax)
 
         # Setup x-axis
         self._setup_time_axis(df)
 
-        # Auto-scale
+        # Auto-scale (collections are not part of relim: add the candle range)
         self.main_ax.relim()
-        self.main_ax.autoscale_view()
+        low, high = self.candles.price_range()
+        if low is not None:
+            self.main_ax.update_datalim([(self._first_bar, low), (self._first_bar + len(df), high)])
+        self.main_ax.autoscale_view(scalex=False)
         self.indicator_ax.relim()
-        self.indicator_ax.autoscale_view()
+        self.indicator_ax.autoscale_view(scalex=False)
 
         # Add performance summary
         self._add_performance_text()
@@ -416,16 +661,11 @@ class LiveTradingChart:
     def _draw_strategy_indicators(self, df: pd.DataFrame):
         """Draw strategy-specific indicators dynamically"""
         try:
-            x_axis = range(len(df))
+            x_axis = self._positions(df)
 
             # Get the strategy's indicators
             strategy_indicators = self.strategy.get_indicators()
 
-            # Clear indicator axis first
-            self.indicator_ax.clear()
-            self.indicator_ax.set_xlabel('Time')
-            self.indicator_ax.grid(True, alpha=0.3)
-
             # Draw indicators based on strategy type
             strategy_name = self.strategy.name.lower()
 
@@ -449,73 +689,67 @@ class LiveTradingChart:
             else:
                 self._draw_generic_indicators(df, x_axis, strategy_indicators)
 
-            # Add legends
-            if self.main_ax.get_legend_handles_labels()[0]:
-                self.main_ax.legend(loc='upper left', fontsize=8)
-            if self.indicator_ax.get_legend_handles_labels()[0]:
-                self.indicator_ax.legend(loc='upper left', fontsize=8)
-
         except Exception as e:
             print(f"Error drawing indicators: {e}")
 
     def _draw_bollinger_bands(self, df: pd.DataFrame, x_axis):
         """Draw Bollinger Bands indicators"""
         if 'bb_upper' in df.columns and 'bb_lower' in df.columns:
-            self.main_ax.plot(x_axis, df['bb_upper'], label='BB Upper', color='red', alpha=0.6, linestyle='--')
-            self.main_ax.plot(x_axis, df['bb_lower'], label='BB Lower', color='green', alpha=0.6, linestyle='--')
-            self.main_ax.fill_between(x_axis, df['bb_upper'], df['bb_lower'], alpha=0.1, color='blue', label='BB Band')
+            self._line(self.main_ax, x_axis, df['bb_upper'], label='BB Upper', color='red', alpha=0.6, linestyle='--')
+            self._line(self.main_ax, x_axis, df['bb_lower'], label='BB Lower', color='green', alpha=0.6, linestyle='--')
+            self._transient_artist(self.main_ax.fill_between(x_axis, df['bb_upper'], df['bb_lower'], alpha=0.1, color='blue', label='BB Band'))
 
         if 'bb_middle' in df.columns:
-            self.main_ax.plot(x_axis, df['bb_middle'], label='BB Middle (SMA)', color='blue', alpha=0.8)
+            self._line(self.main_ax, x_axis, df['bb_middle'], label='BB Middle (SMA)', color='blue', alpha=0.8)
 
         self.indicator_ax.set_ylabel('Bollinger Band %')
         # Calculate BB percentage (position within bands)
         if all(col in df.columns for col in ['bb_upper', 'bb_lower', 'Close']):
             bb_percent = (df['Close'] - df['bb_lower']) / (df['bb_upper'] - df['bb_lower']) * 100
-            self.indicator_ax.plot(x_axis, bb_percent, label='BB %', color='purple')
-            self.indicator_ax.axhline(y=80, color='red', linestyle='--', alpha=0.5, label='Overbought')
-            self.indicator_ax.axhline(y=20, color='green', linestyle='--', alpha=0.5, label='Oversold')
+            self._line(self.indicator_ax, x_axis, bb_percent, label='BB %', color='purple')
+            self._hline(self.indicator_ax, 80, label='Overbought', color='red', linestyle='--', alpha=0.5)
+            self._hline(self.indicator_ax, 20, label='Oversold', color='green', linestyle='--', alpha=0.5)
             self.indicator_ax.set_ylim(0, 100)
 
     def _draw_mean_reversion_indicators(self, df: pd.DataFrame, x_axis):
         """Draw Mean Reversion strategy indicators"""
         if 'SMA' in df.columns:
-            self.main_ax.plot(x_axis, df['SMA'], label='SMA', color='blue', alpha=0.8, linewidth=2)
+            self._line(self.main_ax, x_axis, df['SMA'], label='SMA', color='blue', alpha=0.8, linewidth=2)
 
         if 'Upper Band' in df.columns and 'Lower Band' in df.columns:
-            self.main_ax.plot(x_axis, df['Upper Band'], label='Upper Band (+2σ)', color='red', alpha=0.6, linestyle='--')
-            self.main_ax.plot(x_axis, df['Lower Band'], label='Lower Band (-2σ)', color='green', alpha=0.6, linestyle='--')
-            self.main_ax.fill_between(x_axis, df['Upper Band'], df['Lower Band'], alpha=0.1, color='gray', label='±2σ Range')
+            self._line(self.main_ax, x_axis, df['Upper Band'], label='Upper Band (+2σ)', color='red', alpha=0.6, linestyle='--')
+            self._line(self.main_ax, x_axis, df['Lower Band'], label='Lower Band (-2σ)', color='green', alpha=0.6, linestyle='--')
+            self._transient_artist(self.main_ax.fill_between(x_axis, df['Upper Band'], df['Lower Band'], alpha=0.1, color='gray', label='±2σ Range'))
 
 
     def _draw_rsi_indicators(self, df: pd.DataFrame, x_axis):
         """Draw RSI strategy indicators"""
         if 'rsi' in df.columns:
-            self.indicator_ax.plot(x_axis, df['rsi'], label='RSI', color='purple', linewidth=2)
-            self.indicator_ax.axhline(y=70, color='red', linestyle='--', alpha=0.7, label='Overbought (70)')
-            self.indicator_ax.axhline(y=30, color='green', linestyle='--', alpha=0.7, label='Oversold (30)')
-            self.indicator_ax.axhline(y=50, color='gray', linestyle=':', alpha=0.5, label='Midline')
+            self._line(self.indicator_ax, x_axis, df['rsi'], label='RSI', color='purple', linewidth=2)
+            self._hline(self.indicator_ax, 70, label='Overbought (70)', color='red', linestyle='--', alpha=0.7)
+            self._hline(self.indicator_ax, 30, label='Oversold (30)', color='green', linestyle='--', alpha=0.7)
+            self._hline(self.indicator_ax, 50, label='Midline', color='gray', linestyle=':', alpha=0.5)
             self.indicator_ax.set_ylim(0, 100)
             self.indicator_ax.set_ylabel('RSI Value')
 
             # Add background coloring for zones
-            self.indicator_ax.fill_between(x_axis, 70, 100, alpha=0.1, color='red', label='Overbought Zone')
-            self.indicator_ax.fill_between(x_axis, 0, 30, alpha=0.1, color='green', label='Oversold Zone')
+            self._hspan(self.indicator_ax, 70, 100, label='Overbought Zone', alpha=0.1, color='red')
+            self._hspan(self.indicator_ax, 0, 30, label='Oversold Zone', alpha=0.1, color='green')
 
     def _draw_macd_indicators(self, df: pd.DataFrame, x_axis):
         """Draw MACD strategy indicators"""
         if 'macd_line' in df.columns:
-            self.indicator_ax.plot(x_axis, df['macd_line'], label='MACD Line', color='blue', linewidth=2)
+            self._line(self.indicator_ax, x_axis, df['macd_line'], label='MACD Line', color='blue', linewidth=2)
 
         if 'signal_line' in df.columns:
-            self.indicator_ax.plot(x_axis, df['signal_line'], label='Signal Line', color='red', linewidth=2)
+            self._line(self.indicator_ax, x_axis, df['signal_line'], label='Signal Line', color='red', linewidth=2)
 
         if 'histogram' in df.columns:
             # Color histogram bars based on positive/negative values
             colors = ['green' if x >= 0 else 'red' for x in df['histogram']]
-            self.indicator_ax.bar(x_axis, df['histogram'], label='MACD Histogram', alpha=0.6, color=colors)
+            self._transient_artist(self.indicator_ax.bar(x_axis, df['histogram'], label='MACD Histogram', alpha=0.6, color=colors))
 
-        self.indicator_ax.axhline(y=0, color='black', linestyle='-', alpha=0.5, label='Zero Line')
+        self._hline(self.indicator_ax, 0, label='Zero Line', color='black', linestyle='-', alpha=0.5)
         self.indicator_ax.set_ylabel('MACD Values')
 
     def _draw_generic_indicators(self, df: pd.DataFrame, x_axis, indicators):
@@ -539,12 +773,12 @@ class LiveTradingChart:
         colors = ['blue', 'red', 'green', 'orange', 'purple', 'brown']
         for i, indicator in enumerate(main_indicators):
             color = colors[i % len(colors)]
-            self.main_ax.plot(x_axis, df[indicator], label=indicator, color=color, alpha=0.7)
+            self._line(self.main_ax, x_axis, df[indicator], label=indicator, color=color, alpha=0.7)
 
         # Draw oscillator indicators
         for i, indicator in enumerate(oscillator_indicators):
             color = colors[i % len(colors)]
-            self.indicator_ax.plot(x_axis, df[indicator], label=indicator, color=color, linewidth=2)
+            self._line(self.indicator_ax, x_axis, df[indicator], label=indicator, color=color, linewidth=2)
 
         if oscillator_indicators:
             self.indicator_ax.set_ylabel('Oscillator Values')
@@ -553,35 +787,32 @@ class LiveTradingChart:
         """Draw buy/sell signals and trade executions on chart"""
         try:
             signal_names = self.strategy.get_signal_names()
-            x_axis = range(len(df))
 
             # Buy signals
             if signal_names['buy'] in df.columns:
-                buy_signals = df[df[signal_names['buy']] == True]
-                if not buy_signals.empty:
-                    buy_indices = [df.index.get_loc(idx) for idx in buy_signals.index]
-                    buy_prices = buy_signals['Close'].values
-                    self.main_ax.scatter(buy_indices, buy_prices, color='green', marker='^',
-                                       s=100, label='Buy Signal', zorder=5)
+                buy_rows = np.flatnonzero(df[signal_names['buy']].to_numpy() == True)
+                if len(buy_rows):
+                    buy_prices = df['Close'].to_numpy()[buy_rows]
+                    self._markers(self.main_ax, self._first_bar + buy_rows, buy_prices, label='Buy Signal',
+                                  color='green', marker='^', s=100, zorder=5)
 
                     # DEBUG: Frontend signal logging
-                    print(f"\n[FRONTEND] Drawing {len(buy_signals)} BUY signals:")
-                    for idx, price in zip(buy_indices[-3:], buy_prices[-3:]):  # Last 3 signals
+                    print(f"\n[FRONTEND] Drawing {len(buy_rows)} BUY signals:")
+                    for idx, price in zip(buy_rows[-3:], buy_prices[-3:]):  # Last 3 signals
                         timestamp = df.iloc[idx]['timestamp']
                         print(f"  Index: {idx} | Time: {timestamp} | Price: ${price:.2f}")
 
             # Sell signals
             if signal_names['sell'] in df.columns:
-                sell_signals = df[df[signal_names['sell']] == True]
-                if not sell_signals.empty:
-                    sell_indices = [df.index.get_loc(idx) for idx in sell_signals.index]
-                    sell_prices = sell_signals['Close'].values
-                    self.main_ax.scatter(sell_indices, sell_prices, color='red', marker='v',
-                                       s=100, label='Sell Signal', zorder=5)
+                sell_rows = np.flatnonzero(df[signal_names['sell']].to_numpy() == True)
+                if len(sell_rows):
+                    sell_prices = df['Close'].to_numpy()[sell_rows]
+                    self._markers(self.main_ax, self._first_bar + sell_rows, sell_prices, label='Sell Signal',
+                                  color='red', marker='v', s=100, zorder=5)
 
                     # DEBUG: Frontend signal logging
-                    print(f"\n[FRONTEND] Drawing {len(sell_signals)} SELL signals:")
-                    for idx, price in zip(sell_indices[-3:], sell_prices[-3:]):  # Last 3 signals
+                    print(f"\n[FRONTEND] Drawing {len(sell_rows)} SELL signals:")
+                    for idx, price in zip(sell_rows[-3:], sell_prices[-3:]):  # Last 3 signals
                         timestamp = df.iloc[idx]['timestamp']
                         print(f"  Index: {idx} | Time: {timestamp} | Price: ${price:.2f}")
 
@@ -591,6 +822,14 @@ class LiveTradingChart:
         except Exception as e:
             print(f"Error drawing signals: {e}")
 
+    @staticmethod
+    def _naive_times(values) -> np.ndarray:
+        """datetime64 values with any timezone dropped, for comparison"""
+        times = pd.to_datetime(pd.Series(list(values)))
+        if getattr(times.dt, 'tz', None) is not None:
+            times = times.dt.tz_localize(None)
+        return times.to_numpy(dtype='datetime64[ns]')
+
     def _draw_executed_trades(self, df: pd.DataFrame):
         """Draw executed trades on chart"""
         try:
@@ -599,89 +838,42 @@ class LiveTradingChart:
             if len(trade_history) == 0:
                 return
 
-            # Create a mapping of timestamps to dataframe indices
-            timestamp_to_index = {}
-            for i, row in df.iterrows():
-                timestamp_to_index[row['timestamp']] = i
-
-            # Group trades by action type
-            buy_trades = []
-            sell_trades = []
-            close_trades = []
-
-            for _, trade in trade_history.iterrows():
-                trade_time = trade['timestamp']
-
-                # Normalize timezone info to avoid comparison errors
-                # Convert to timezone-naive datetime for consistent comparison
-                if pd.api.types.is_datetime64tz_dtype(type(trade_time)) or (hasattr(trade_time, 'tz') and trade_time.tz is not None):
-                    trade_time = pd.to_datetime(trade_time).tz_localize(None)
-                else:
-                    trade_time = pd.to_datetime(trade_time)
-
-                # Find closest timestamp in our data
-                closest_index = None
-                min_diff = None
-
-                for ts, idx in timestamp_to_index.items():
-                    # Ensure chart timestamp is also timezone-naive
-                    if pd.api.types.is_datetime64tz_dtype(type(ts)) or (hasattr(ts, 'tz') and ts.tz is not None):
-                        chart_ts = pd.to_datetime(ts).tz_localize(None)
-                    else:
-                        chart_ts = pd.to_datetime(ts)
-
-                    try:
-                        diff = abs((chart_ts - trade_time).total_seconds())
-                        if min_diff is None or diff < min_diff:
-                            min_diff = diff
-                            closest_index = idx
-                    except (TypeError, AttributeError) as e:
-                        # Skip if there are still datetime conversion issues
-                        continue
-
-                if closest_index is not None:
-                    action = trade['action']
-                    if action in ['buy_long']:
-                        buy_trades.append((closest_index, trade['price']))
-                    elif action in ['sell_short']:
-                        sell_trades.append((closest_index, trade['price']))
-                    elif action in ['close_position', 'close_long', 'close_short']:
-                        close_trades.append((closest_index, trade['price']))
-
-            # DEBUG: Frontend trade marker logging
-            if buy_trades:
-                print(f"\n[FRONTEND] Drawing {len(buy_trades)} BUY trade markers:")
-                for idx, price in buy_trades[-3:]:  # Last 3 trades
-                    timestamp = df.iloc[idx]['timestamp']
-                    print(f"  Index: {idx} | Time: {timestamp} | Price: ${price:.2f}")
+            # Nearest chart bar of each trade (timezone-naive, bars are in time order)
+            try:
+                chart_times = self._naive_times(df['timestamp'])
+                trade_times = self._naive_times(trade_history['timestamp'])
+            except (TypeError, ValueError):
+                return
+            right = np.clip(np.searchsorted(chart_times, trade_times), 1, len(chart_times) - 1) if len(chart_times) > 1 \
+                else np.zeros(len(trade_times), dtype=np.int64)
+            left = np.maximum(right - 1, 0)
+            nearer_left = np.abs(trade_times - chart_times[left]) <= np.abs(chart_times[right] - trade_times)
+            rows = np.where(nearer_left, left, right)
+
+            actions = trade_history['action'].to_numpy()
+            prices = trade_history['price'].to_numpy(dtype=float)
+            groups = (
+                ('BUY', np.isin(actions, ['buy_long']), 'Buy Executed',
+                 dict(color='darkgreen', marker='o', s=80, zorder=6, edgecolors='white', linewidths=2)),
+                ('SELL', np.isin(actions, ['sell_short']), 'Sell Executed',
+                 dict(color='darkred', marker='o', s=80, zorder=6, edgecolors='white', linewidths=2)),
+                ('CLOSE', np.isin(actions, ['close_position', 'close_long', 'close_short']), 'Position Closed',
+                 dict(color='orange', marker='x', s=100, zorder=6, linewidths=3)),
+            )
 
-            if sell_trades:
-                print(f"\n[FRONTEND] Drawing {len(sell_trades)} SELL trade markers:")
-                for idx, price in sell_trades[-3:]:  # Last 3 trades
-                    timestamp = df.iloc[idx]['timestamp']
-                    print(f"  Index: {idx} | Time: {timestamp} | Price: ${price:.2f}")
+            for name, mask, label, style in groups:
+                if not mask.any():
+                    continue
+                trade_rows, trade_prices = rows[mask], prices[mask]
 
-            if close_trades:
-                print(f"\n[FRONTEND] Drawing {len(close_trades)} CLOSE trade markers:")
-                for idx, price in close_trades[-3:]:  # Last 3 trades
+                # DEBUG: Frontend trade marker logging
+                print(f"\n[FRONTEND] Drawing {len(trade_rows)} {name} trade markers:")
+                for idx, price in zip(trade_rows[-3:], trade_prices[-3:]):  # Last 3 trades
                     timestamp = df.iloc[idx]['timestamp']
                     print(f"  Index: {idx} | Time: {timestamp} | Price: ${price:.2f}")
 
-            # Draw trade markers
-            if buy_trades:
-                indices, prices = zip(*buy_trades)
-                self.main_ax.scatter(indices, prices, color='darkgreen', marker='o',
-                                   s=80, label='Buy Executed', zorder=6, edgecolors='white', linewidths=2)
-
-            if sell_trades:
-                indices, prices = zip(*sell_trades)
-                self.main_ax.scatter(indices, prices, color='darkred', marker='o',
-                                   s=80, label='Sell Executed', zorder=6, edgecolors='white', linewidths=2)
-
-            if close_trades:
-                indices, prices = zip(*close_trades)
-                self.main_ax.scatter(indices, prices, color='orange', marker='x',
-                                   s=100, label='Position Closed', zorder=6, linewidths=3)
+                # Draw trade markers
+                self._markers(self.main_ax, self._first_bar + trade_rows, trade_prices, label=label, **style)
 
         except Exception as e:
             print(f"Error drawing executed trades: {e}")
@@ -690,19 +882,16 @@ class LiveTradingChart:
         """Setup time axis labels"""
         try:
             if len(df) > 0:
-                timestamps = [ts.strftime('%H:%M') for ts in df['timestamp']]
-                tick_positions = list(range(len(df)))
-
-                # Show every nth timestamp to avoid crowding
-                show_every = max(1, len(timestamps) // 8)
-                tick_labels = [timestamps[i] if i % show_every == 0 else ''
-                             for i in range(len(timestamps))]
+                # Label every nth bar to avoid crowding
+                show_every = max(1, len(df) // 8)
+                rows = list(range(0, len(df), show_every))
+                tick_positions = [self._first_bar + i for i in rows]
+                tick_labels = [df['timestamp'].iloc[i].strftime('%H:%M') for i in rows]
 
-                self.main_ax.set_xticks(tick_positions)
-                self.main_ax.set_xticklabels(tick_labels, rotation=45)
-
-                self.indicator_ax.set_xticks(tick_positions)
-                self.indicator_ax.set_xticklabels(tick_labels, rotation=45)
+                for ax in (self.main_ax, self.indicator_ax):
+                    ax.set_xlim(self._first_bar - 1, self._first_bar + len(df))
+                    ax.set_xticks(tick_positions)
+                    ax.set_xticklabels(tick_labels, rotation=45)
 
         except Exception as e:
             print(f"Error setting up time axis: {e}")
@@ -752,9 +941,12 @@ class LiveTradingChart:
                 f"Win Rate: {performance['win_rate']:.1f}%"
             )
 
-            self.main_ax.text(0.02, 0.98, info_text, transform=self.main_ax.transAxes,
-                            fontsize=10, verticalalignment='top',
-                            bbox=dict(boxstyle='round', facecolor='wheat', alpha=0.8))
+            if self._info_text is None:
+                self._info_text = self.main_ax.text(0.02, 0.98, info_text, transform=self.main_ax.transAxes,
+                                                    fontsize=10, verticalalignment='top',
+                                                    bbox=dict(boxstyle='round', facecolor='wheat', alpha=0.8))
+            else:
+                self._info_text.set_text(info_text)
 
         except Exception as e:
             print(f"Error adding performance text: {e}")
@@ -780,8 +972,10 @@ class LiveTradingChart:
         print(f"Paper trading: {self.paper_trading}")
         print("=" * 50)
 
-        # Initial data fetch
+        # Initial data fetch, then live bars arrive on the feed thread
         self.fetch_and_process_data()
+        if self._initial_loaded:
+            self.start_data_feed(update_interval / 1000)
 
         # Start animation
         ani = animation.FuncAnimation(
@@ -799,7 +993,10 @@ class LiveTradingChart:
 
     def stop_trading(self):
         """Stop live trading"""
+        self.stop_data_feed()
         self.trading_engine.stop()
+        if isinstance(self.broker, AsyncOrderGateway):
+            self.broker.stop()
         print("Live trading stopped")
 
     def get_trade_history(self):